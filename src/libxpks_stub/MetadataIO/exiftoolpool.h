@@ -0,0 +1,25 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef EXIFTOOLPOOL_H
+#define EXIFTOOLPOOL_H
+
+#include <QString>
+
+namespace libxpks {
+    namespace io {
+        // long-lived exiftool processes are started in background
+        void warmUpExiftoolPool(const QString &exiftoolPath);
+        // should be called before application exits
+        void shutdownExiftoolPool();
+    }
+}
+
+#endif // EXIFTOOLPOOL_H
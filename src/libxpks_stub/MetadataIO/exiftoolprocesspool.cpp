@@ -0,0 +1,370 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "exiftoolprocesspool.h"
+#include <QProcess>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <Helpers/threadhelpers.h>
+#include <Helpers/exiftoolframing.h>
+#include <Common/defines.h>
+#include "exiftoolpool.h"
+
+#define EXIFTOOL_POOL_MAX_SIZE 4
+#define EXIFTOOL_START_TIMEOUT 5000
+#define EXIFTOOL_STOP_TIMEOUT 3000
+#define EXIFTOOL_WARMUP_TIMEOUT 10000
+#define EXIFTOOL_READ_QUANTUM 100
+// more restarts in a row means exiftool cannot work with this path
+#define EXIFTOOL_MAX_STARTS_COUNT 10
+
+namespace libxpks {
+    namespace io {
+        ExiftoolDaemon::ExiftoolDaemon(const QString &exiftoolPath, int index):
+            m_ExiftoolPath(exiftoolPath),
+            m_Process(nullptr),
+            m_PendingCount(0),
+            m_LastCommandID(0),
+            m_Index(index),
+            m_StartsCount(0)
+        {
+            getTelemetry().setName(QString("Exiftool#%1").arg(index));
+        }
+
+        ExiftoolDaemon::~ExiftoolDaemon() {
+            Q_ASSERT(m_Process == nullptr);
+        }
+
+        void ExiftoolDaemon::submitCommand(const std::shared_ptr<ExiftoolCommand> &command) {
+            m_PendingCount.fetchAndAddOrdered(1);
+            std::shared_ptr<ExiftoolTask> task(new ExiftoolTask(command));
+            if (submitItem(task) == INVALID_BATCH_ID) {
+                m_PendingCount.fetchAndSubOrdered(1);
+            }
+        }
+
+        bool ExiftoolDaemon::initWorker() {
+            LOG_DEBUG << "#" << m_Index;
+            // process is started with the first command in the worker thread
+            return true;
+        }
+
+        void ExiftoolDaemon::processOneItem(std::shared_ptr<ExiftoolTask> &item) {
+            ExiftoolCommand &command = *item->m_Command;
+
+            bool success = executeCommand(command);
+            // crashed process is restarted and the command is tried once more
+            if (!success && !isCancelled() && (m_Process == nullptr)) {
+                LOG_WARNING << "Retrying command in exiftool #" << m_Index;
+                if (command.m_OutputHandler != nullptr) {
+                    command.m_OutputHandler->resetOutput();
+                }
+
+                success = executeCommand(command);
+            }
+
+            command.m_Success = success;
+            m_PendingCount.fetchAndSubOrdered(1);
+        }
+
+        void ExiftoolDaemon::workerStopped() {
+            LOG_DEBUG << "#" << m_Index;
+            stopProcess();
+            emit stopped();
+        }
+
+        bool ExiftoolDaemon::executeCommand(ExiftoolCommand &command) {
+            if (!ensureStarted()) { return false; }
+
+            const quint32 commandID = ++m_LastCommandID;
+
+            QByteArray commandText;
+            QString error;
+            if (!Helpers::frameExiftoolCommand(command.m_Arguments, commandID, commandText, error)) {
+                // nothing was written so the process is still usable
+                LOG_WARNING << error;
+                command.m_Errors.append(error.toUtf8());
+                return false;
+            }
+
+            m_Process->write(commandText);
+
+            const QByteArray readyMarker = Helpers::makeExiftoolReadyMarker(commandID);
+            const bool success = readResponse(readyMarker, command);
+
+            if (!command.m_Errors.isEmpty()) {
+                LOG_DEBUG << "STDERR [Exiftool]:" << QString::fromUtf8(command.m_Errors);
+            }
+
+            if (!success) {
+                // state of the process is unknown after a timeout
+                LOG_WARNING << "Command" << commandID << "failed in exiftool #" << m_Index;
+                killProcess();
+            } else {
+                m_StartsCount = 0;
+            }
+
+            return success;
+        }
+
+        bool ExiftoolDaemon::ensureStarted() {
+            if ((m_Process != nullptr) && (m_Process->state() == QProcess::Running)) { return true; }
+
+            if (m_Process != nullptr) {
+                LOG_WARNING << "Exiftool #" << m_Index << "has died with exit code" << m_Process->exitCode();
+                killProcess();
+            }
+
+            if (m_StartsCount >= EXIFTOOL_MAX_STARTS_COUNT) {
+                LOG_WARNING << "Exiftool #" << m_Index << "was restarted too many times";
+                return false;
+            }
+
+            m_StartsCount++;
+            m_OutputBuffer.clear();
+
+            m_Process = new QProcess();
+            QStringList arguments;
+            arguments << "-stay_open" << "True" << "-@" << "-";
+
+            LOG_INFO << "Starting exiftool #" << m_Index << ":" << m_ExiftoolPath;
+            m_Process->start(m_ExiftoolPath, arguments);
+
+            const bool started = m_Process->waitForStarted(EXIFTOOL_START_TIMEOUT);
+            if (!started) {
+                LOG_WARNING << "Failed to start exiftool:" << m_Process->errorString();
+                killProcess();
+            }
+
+            return started;
+        }
+
+        bool ExiftoolDaemon::readResponse(const QByteArray &readyMarker, ExiftoolCommand &command) {
+            QElapsedTimer timer;
+            timer.start();
+
+            IExiftoolOutputHandler *outputHandler = command.m_OutputHandler;
+            bool found = false;
+
+            while (!found) {
+                int endIndex = 0;
+                const int markerIndex = Helpers::findExiftoolReadyMarker(m_OutputBuffer, readyMarker, endIndex);
+                if (markerIndex != -1) {
+                    if (outputHandler != nullptr) {
+                        if (markerIndex > 0) {
+                            outputHandler->handleOutput(m_OutputBuffer.left(markerIndex));
+                        }
+                    } else {
+                        command.m_Output = m_OutputBuffer.left(markerIndex);
+                    }
+
+                    m_OutputBuffer.remove(0, endIndex);
+                    found = true;
+                    break;
+                }
+
+                if (outputHandler != nullptr) {
+                    // the tail can be the beginning of the marker
+                    const int completeSize = m_OutputBuffer.size() - readyMarker.size() + 1;
+                    if (completeSize > 0) {
+                        outputHandler->handleOutput(m_OutputBuffer.left(completeSize));
+                        m_OutputBuffer.remove(0, completeSize);
+                    }
+                }
+
+                const qint64 remainingMs = (qint64)command.m_TimeoutMs - timer.elapsed();
+                if (remainingMs <= 0) {
+                    LOG_WARNING << "Timeout while waiting for" << readyMarker;
+                    break;
+                }
+
+                if (m_Process->state() != QProcess::Running) {
+                    LOG_WARNING << "Exiftool exited while processing a command";
+                    break;
+                }
+
+                if (m_Process->waitForReadyRead((int)qMin<qint64>(remainingMs, EXIFTOOL_READ_QUANTUM))) {
+                    m_OutputBuffer.append(m_Process->readAllStandardOutput());
+                    if (outputHandler != nullptr) { timer.restart(); }
+                }
+
+                // stderr pipe should never get full
+                command.m_Errors.append(m_Process->readAllStandardError());
+            }
+
+            if (m_Process->state() == QProcess::Running) {
+                command.m_Errors.append(m_Process->readAllStandardError());
+            }
+
+            return found;
+        }
+
+        void ExiftoolDaemon::stopProcess() {
+            if (m_Process == nullptr) { return; }
+
+            if (m_Process->state() == QProcess::Running) {
+                LOG_INFO << "Stopping exiftool #" << m_Index;
+                m_Process->write("-stay_open" EXIFTOOL_ARGUMENTS_NEWLINE "False" EXIFTOOL_ARGUMENTS_NEWLINE);
+                if (!m_Process->waitForFinished(EXIFTOOL_STOP_TIMEOUT)) {
+                    LOG_WARNING << "Exiftool #" << m_Index << "did not stop in time";
+                }
+            }
+
+            killProcess();
+        }
+
+        void ExiftoolDaemon::killProcess() {
+            if (m_Process == nullptr) { return; }
+
+            if (m_Process->state() != QProcess::NotRunning) {
+                m_Process->kill();
+                m_Process->waitForFinished(EXIFTOOL_STOP_TIMEOUT);
+            }
+
+            delete m_Process;
+            m_Process = nullptr;
+            m_OutputBuffer.clear();
+        }
+
+        ExiftoolProcessPool::ExiftoolProcessPool():
+            m_IsShutdown(false)
+        {
+        }
+
+        ExiftoolProcessPool &ExiftoolProcessPool::getInstance() {
+            static ExiftoolProcessPool instance;
+            return instance;
+        }
+
+        int ExiftoolProcessPool::getOptimalSize() {
+            return Helpers::getOptimalWorkersCount(EXIFTOOL_POOL_MAX_SIZE);
+        }
+
+        void ExiftoolProcessPool::warmUp(const QString &exiftoolPath) {
+            LOG_DEBUG << exiftoolPath;
+            if (exiftoolPath.isEmpty()) { return; }
+
+            QMutexLocker locker(&m_DaemonsMutex);
+            Q_UNUSED(locker);
+
+            if (m_IsShutdown) { return; }
+
+            if (m_ExiftoolPath != exiftoolPath) {
+                stopUnsafe();
+                startUnsafe(exiftoolPath);
+            }
+
+            // nobody waits for the result
+            for (auto *daemon: m_Daemons) {
+                std::shared_ptr<ExiftoolCommand> command(new ExiftoolCommand(QStringList() << "-ver", EXIFTOOL_WARMUP_TIMEOUT));
+                daemon->submitCommand(command);
+            }
+        }
+
+        void ExiftoolProcessPool::shutdown() {
+            LOG_DEBUG << "#";
+
+            QMutexLocker locker(&m_DaemonsMutex);
+            Q_UNUSED(locker);
+
+            m_IsShutdown = true;
+            stopUnsafe();
+        }
+
+        bool ExiftoolProcessPool::submit(const QString &exiftoolPath, const std::shared_ptr<ExiftoolCommand> &command) {
+            Q_ASSERT(command);
+
+            QMutexLocker locker(&m_DaemonsMutex);
+            Q_UNUSED(locker);
+
+            ExiftoolDaemon *daemon = getDaemonUnsafe(exiftoolPath);
+            if (daemon == nullptr) {
+                LOG_WARNING << "Exiftool pool is not available";
+                return false;
+            }
+
+            daemon->submitCommand(command);
+            return true;
+        }
+
+        bool ExiftoolProcessPool::execute(const QString &exiftoolPath, const std::shared_ptr<ExiftoolCommand> &command) {
+            if (!submit(exiftoolPath, command)) { return false; }
+
+            // daemon enforces the timeout of the command itself
+            command->m_Done.acquire();
+            return command->m_Success;
+        }
+
+        void ExiftoolProcessPool::startUnsafe(const QString &exiftoolPath) {
+            const int poolSize = getOptimalSize();
+            LOG_INFO << "Starting" << poolSize << "exiftool process(es)";
+
+            m_ExiftoolPath = exiftoolPath;
+            m_Daemons.reserve(poolSize);
+
+            for (int i = 0; i < poolSize; ++i) {
+                ExiftoolDaemon *daemon = new ExiftoolDaemon(exiftoolPath, i);
+
+                QThread *thread = new QThread();
+                daemon->moveToThread(thread);
+
+                QObject::connect(thread, &QThread::started, daemon, &ExiftoolDaemon::process);
+                QObject::connect(daemon, &ExiftoolDaemon::stopped, thread, &QThread::quit);
+
+                QObject::connect(daemon, &ExiftoolDaemon::stopped, daemon, &ExiftoolDaemon::deleteLater);
+                QObject::connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+
+                thread->start(QThread::LowPriority);
+                m_Daemons.push_back(daemon);
+            }
+        }
+
+        void ExiftoolProcessPool::stopUnsafe() {
+            if (m_Daemons.empty()) { return; }
+
+            LOG_INFO << "Stopping" << m_Daemons.size() << "exiftool process(es)";
+            // dropped commands are released by their tasks
+            for (auto *daemon: m_Daemons) {
+                daemon->stopWorking();
+            }
+
+            m_Daemons.clear();
+            m_ExiftoolPath.clear();
+        }
+
+        ExiftoolDaemon *ExiftoolProcessPool::getDaemonUnsafe(const QString &exiftoolPath) {
+            if (m_IsShutdown || exiftoolPath.isEmpty()) { return nullptr; }
+
+            if (m_ExiftoolPath != exiftoolPath) {
+                // exiftool path was changed in settings
+                stopUnsafe();
+                startUnsafe(exiftoolPath);
+            }
+
+            ExiftoolDaemon *leastBusy = nullptr;
+            for (auto *daemon: m_Daemons) {
+                if ((leastBusy == nullptr) || (daemon->getPendingCount() < leastBusy->getPendingCount())) {
+                    leastBusy = daemon;
+                }
+            }
+
+            return leastBusy;
+        }
+
+        void warmUpExiftoolPool(const QString &exiftoolPath) {
+            ExiftoolProcessPool::getInstance().warmUp(exiftoolPath);
+        }
+
+        void shutdownExiftoolPool() {
+            ExiftoolProcessPool::getInstance().shutdown();
+        }
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef EXIFTOOLPROCESSPOOL_H
+#define EXIFTOOLPROCESSPOOL_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMutex>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <memory>
+#include <vector>
+#include <Common/itemprocessingworker.h>
+
+class QProcess;
+
+namespace libxpks {
+    namespace io {
+        class IExiftoolOutputHandler {
+        public:
+            virtual ~IExiftoolOutputHandler() {}
+            // called from the exiftool thread with the next piece of stdout
+            virtual void handleOutput(const QByteArray &chunk) = 0;
+            // output received so far belongs to a failed attempt
+            virtual void resetOutput() = 0;
+        };
+
+        struct ExiftoolCommand {
+            ExiftoolCommand(const QStringList &arguments, int timeoutMs, IExiftoolOutputHandler *outputHandler=nullptr):
+                m_Arguments(arguments),
+                m_TimeoutMs(timeoutMs),
+                m_OutputHandler(outputHandler),
+                m_Success(false)
+            { }
+
+            QStringList m_Arguments;
+            // empty when output is streamed to the handler
+            QByteArray m_Output;
+            QByteArray m_Errors;
+            // for streamed commands the timeout is counted since the last output
+            int m_TimeoutMs;
+            IExiftoolOutputHandler *m_OutputHandler;
+            bool m_Success;
+            // released when the command is done, failed or dropped from the queue
+            QSemaphore m_Done;
+        };
+
+        struct ExiftoolTask {
+            ExiftoolTask(const std::shared_ptr<ExiftoolCommand> &command):
+                m_Command(command)
+            { }
+
+            ~ExiftoolTask() { m_Command->m_Done.release(); }
+
+            std::shared_ptr<ExiftoolCommand> m_Command;
+        };
+
+        // single "exiftool -stay_open True -@ -" process owned by the worker thread;
+        // every command is framed with -execute and the process is restarted if it dies
+        class ExiftoolDaemon : public QObject, public Common::ItemProcessingWorker<ExiftoolTask>
+        {
+            Q_OBJECT
+        public:
+            ExiftoolDaemon(const QString &exiftoolPath, int index);
+            virtual ~ExiftoolDaemon();
+
+        public:
+            const QString &getExiftoolPath() const { return m_ExiftoolPath; }
+            int getPendingCount() const { return m_PendingCount.load(); }
+            void submitCommand(const std::shared_ptr<ExiftoolCommand> &command);
+
+        protected:
+            virtual bool initWorker() override;
+            virtual void processOneItem(std::shared_ptr<ExiftoolTask> &item) override;
+            virtual void onQueueIsEmpty() override { }
+            virtual void workerStopped() override;
+
+        public slots:
+            void process() { doWork(); }
+
+        signals:
+            void stopped();
+
+        private:
+            bool executeCommand(ExiftoolCommand &command);
+            bool ensureStarted();
+            bool readResponse(const QByteArray &readyMarker, ExiftoolCommand &command);
+            void stopProcess();
+            void killProcess();
+
+        private:
+            QString m_ExiftoolPath;
+            QProcess *m_Process;
+            QByteArray m_OutputBuffer;
+            QAtomicInt m_PendingCount;
+            quint32 m_LastCommandID;
+            int m_Index;
+            int m_StartsCount;
+        };
+
+        class ExiftoolProcessPool
+        {
+        private:
+            ExiftoolProcessPool();
+
+        public:
+            static ExiftoolProcessPool &getInstance();
+            // how many commands can be processed in parallel
+            static int getOptimalSize();
+
+        public:
+            // starts processes in background so the first command does not pay for perl startup
+            void warmUp(const QString &exiftoolPath);
+            void shutdown();
+            // returns immediately, m_Done of the command is released when it is processed;
+            // false means the command was not queued and nobody will release it
+            bool submit(const QString &exiftoolPath, const std::shared_ptr<ExiftoolCommand> &command);
+            // blocks until the command is processed by one of the processes
+            bool execute(const QString &exiftoolPath, const std::shared_ptr<ExiftoolCommand> &command);
+
+        private:
+            void startUnsafe(const QString &exiftoolPath);
+            void stopUnsafe();
+            ExiftoolDaemon *getDaemonUnsafe(const QString &exiftoolPath);
+
+        private:
+            QMutex m_DaemonsMutex;
+            std::vector<ExiftoolDaemon *> m_Daemons;
+            QString m_ExiftoolPath;
+            volatile bool m_IsShutdown;
+        };
+    }
+}
+
+#endif // EXIFTOOLPROCESSPOOL_H
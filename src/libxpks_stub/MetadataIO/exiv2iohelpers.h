@@ -0,0 +1,53 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef EXIV2IOHELPERS_H
+#define EXIV2IOHELPERS_H
+
+#include <QString>
+#include <QStringList>
+
+namespace Models {
+    class ArtworkMetadata;
+}
+
+namespace MetadataIO {
+    struct OriginalMetadata;
+    class ArtworksSnapshot;
+}
+
+namespace libxpks {
+    namespace io {
+        struct Exiv2BasicMetadata {
+            QString m_Title;
+            QString m_Description;
+            QStringList m_Keywords;
+        };
+
+        // should be called in the main thread before any other exiv2 call
+        void initializeExiv2();
+        // formats with XMP, IPTC and EXIF which exiv2 can both read and write
+        bool isExiv2SupportedFile(const QString &filepath);
+        // everything goes to other artworks when exiv2 is disabled in settings
+        void splitByExiv2Support(const MetadataIO::ArtworksSnapshot &artworks, bool useExiv2,
+                                 MetadataIO::ArtworksSnapshot &exiv2Artworks,
+                                 MetadataIO::ArtworksSnapshot &otherArtworks);
+        // false means the file should be processed with exiftool
+        bool readMetadataWithExiv2(const QString &filepath, MetadataIO::OriginalMetadata &result);
+        // values from each standard separately without any fallbacks
+        bool readStandardsWithExiv2(const QString &filepath,
+                                    Exiv2BasicMetadata &xmpMetadata,
+                                    Exiv2BasicMetadata &exifMetadata,
+                                    Exiv2BasicMetadata &iptcMetadata);
+        bool writeMetadataWithExiv2(Models::ArtworkMetadata *artwork, bool useBackups);
+    }
+}
+
+#endif // EXIV2IOHELPERS_H
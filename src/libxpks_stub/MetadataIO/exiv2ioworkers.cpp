@@ -0,0 +1,139 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "exiv2ioworkers.h"
+#include <Models/artworkmetadata.h>
+#include <MetadataIO/metadatareadinghub.h>
+#include <MetadataIO/originalmetadata.h>
+#include <Helpers/asynccoordinator.h>
+#include <Common/defines.h>
+#include "exiv2iohelpers.h"
+#include "metadatareadingworker.h"
+#include "metadatawritingworker.h"
+
+namespace libxpks {
+    namespace io {
+        Exiv2IOWorker::Exiv2IOWorker(const MetadataIO::ArtworksSnapshot &artworks,
+                                     Helpers::AsyncCoordinator *asyncCoordinator,
+                                     int workersCount):
+            Common::ItemProcessingWorker<Models::ArtworkMetadataLocker>(0xffffffff, workersCount),
+            m_ArtworksSnapshot(artworks),
+            m_AsyncCoordinator(asyncCoordinator),
+            m_RemainingCount((int)artworks.size())
+        {
+            Q_ASSERT(!m_ArtworksSnapshot.empty());
+            getTelemetry().setName("Exiv2IO");
+        }
+
+        Exiv2IOWorker::~Exiv2IOWorker() {
+            LOG_DEBUG << "destroyed";
+        }
+
+        bool Exiv2IOWorker::initWorker() {
+            LOG_INFO << "Processing" << m_ArtworksSnapshot.size() << "item(s) in" << getWorkersCount() << "thread(s)";
+            submitItems(m_ArtworksSnapshot.getRawData());
+            return true;
+        }
+
+        void Exiv2IOWorker::processOneItem(std::shared_ptr<Models::ArtworkMetadataLocker> &item) {
+            Models::ArtworkMetadata *artwork = item->getArtworkMetadata();
+            bool success = false;
+
+            try {
+                success = processArtwork(artwork);
+            }
+            catch (...) {
+                LOG_WARNING << "Exception while processing" << artwork->getFilepath();
+                success = false;
+            }
+
+            if (!success) {
+                QMutexLocker locker(&m_FallbackMutex);
+                Q_UNUSED(locker);
+                m_FallbackItems.push_back(item);
+            }
+
+            if (m_RemainingCount.fetchAndSubOrdered(1) == 1) {
+                LOG_DEBUG << "All items processed";
+                stopWorking(false);
+            }
+        }
+
+        void Exiv2IOWorker::workerStopped() {
+            Helpers::AsyncCoordinatorUnlocker unlocker(m_AsyncCoordinator);
+            Q_UNUSED(unlocker);
+
+            logTelemetry();
+
+            if (!m_FallbackItems.empty()) {
+                LOG_INFO << m_FallbackItems.size() << "item(s) will be processed with exiftool";
+                MetadataIO::ArtworksSnapshot fallbackSnapshot(m_FallbackItems);
+                processFallback(fallbackSnapshot);
+            }
+
+            emit stopped();
+        }
+
+        Exiv2ReadingWorker::Exiv2ReadingWorker(const MetadataIO::ArtworksSnapshot &artworksToRead,
+                                               Models::SettingsModel *settingsModel,
+                                               MetadataIO::MetadataReadingHub *readingHub,
+                                               int workersCount):
+            Exiv2IOWorker(artworksToRead, readingHub->getCoordinator(), workersCount),
+            m_ReadingHub(readingHub),
+            m_SettingsModel(settingsModel)
+        {
+            Q_ASSERT(settingsModel != nullptr);
+        }
+
+        bool Exiv2ReadingWorker::processArtwork(Models::ArtworkMetadata *artwork) {
+            std::shared_ptr<MetadataIO::OriginalMetadata> result(new MetadataIO::OriginalMetadata());
+            const bool success = readMetadataWithExiv2(artwork->getFilepath(), *result);
+
+            if (success) {
+                m_ReadingHub->push(result);
+            }
+
+            return success;
+        }
+
+        void Exiv2ReadingWorker::processFallback(const MetadataIO::ArtworksSnapshot &artworks) {
+            ExiftoolImageReadingWorker exiftoolWorker(artworks, m_SettingsModel, m_ReadingHub);
+            exiftoolWorker.readMetadata();
+        }
+
+        Exiv2WritingWorker::Exiv2WritingWorker(const MetadataIO::ArtworksSnapshot &artworksToWrite,
+                                               Helpers::AsyncCoordinator *asyncCoordinator,
+                                               Models::SettingsModel *settingsModel,
+                                               bool useBackups,
+                                               int workersCount):
+            Exiv2IOWorker(artworksToWrite, asyncCoordinator, workersCount),
+            m_AsyncCoordinator(asyncCoordinator),
+            m_SettingsModel(settingsModel),
+            m_UseBackups(useBackups)
+        {
+            Q_ASSERT(settingsModel != nullptr);
+        }
+
+        bool Exiv2WritingWorker::processArtwork(Models::ArtworkMetadata *artwork) {
+            const bool success = writeMetadataWithExiv2(artwork, m_UseBackups);
+
+            if (success) {
+                artwork->resetModified();
+            }
+
+            return success;
+        }
+
+        void Exiv2WritingWorker::processFallback(const MetadataIO::ArtworksSnapshot &artworks) {
+            ExiftoolImageWritingWorker exiftoolWorker(artworks, m_AsyncCoordinator, m_SettingsModel, m_UseBackups);
+            exiftoolWorker.writeMetadata();
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef EXIV2IOWORKERS_H
+#define EXIV2IOWORKERS_H
+
+#include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
+#include <memory>
+#include <Common/itemprocessingworker.h>
+#include <MetadataIO/artworkssnapshot.h>
+
+namespace Helpers {
+    class AsyncCoordinator;
+}
+
+namespace Models {
+    class ArtworkMetadata;
+    class SettingsModel;
+}
+
+namespace MetadataIO {
+    class MetadataReadingHub;
+}
+
+namespace libxpks {
+    namespace io {
+        // processes every artwork in one of the consumer threads and stops when all are done;
+        // artworks exiv2 failed with are processed with exiftool at the end
+        class Exiv2IOWorker : public QObject, public Common::ItemProcessingWorker<Models::ArtworkMetadataLocker>
+        {
+            Q_OBJECT
+        public:
+            Exiv2IOWorker(const MetadataIO::ArtworksSnapshot &artworks,
+                          Helpers::AsyncCoordinator *asyncCoordinator,
+                          int workersCount);
+            virtual ~Exiv2IOWorker();
+
+        protected:
+            virtual bool initWorker() override;
+            virtual void processOneItem(std::shared_ptr<Models::ArtworkMetadataLocker> &item) override;
+            virtual void onQueueIsEmpty() override { }
+            virtual void workerStopped() override;
+
+        protected:
+            virtual bool processArtwork(Models::ArtworkMetadata *artwork) = 0;
+            virtual void processFallback(const MetadataIO::ArtworksSnapshot &artworks) = 0;
+
+        public slots:
+            void process() { doWork(); }
+
+        signals:
+            void stopped();
+
+        private:
+            MetadataIO::ArtworksSnapshot m_ArtworksSnapshot;
+            MetadataIO::ArtworksSnapshot::Container m_FallbackItems;
+            QMutex m_FallbackMutex;
+            Helpers::AsyncCoordinator *m_AsyncCoordinator;
+            QAtomicInt m_RemainingCount;
+        };
+
+        class Exiv2ReadingWorker : public Exiv2IOWorker
+        {
+            Q_OBJECT
+        public:
+            Exiv2ReadingWorker(const MetadataIO::ArtworksSnapshot &artworksToRead,
+                               Models::SettingsModel *settingsModel,
+                               MetadataIO::MetadataReadingHub *readingHub,
+                               int workersCount);
+
+        protected:
+            virtual bool processArtwork(Models::ArtworkMetadata *artwork) override;
+            virtual void processFallback(const MetadataIO::ArtworksSnapshot &artworks) override;
+
+        private:
+            MetadataIO::MetadataReadingHub *m_ReadingHub;
+            Models::SettingsModel *m_SettingsModel;
+        };
+
+        class Exiv2WritingWorker : public Exiv2IOWorker
+        {
+            Q_OBJECT
+        public:
+            Exiv2WritingWorker(const MetadataIO::ArtworksSnapshot &artworksToWrite,
+                               Helpers::AsyncCoordinator *asyncCoordinator,
+                               Models::SettingsModel *settingsModel,
+                               bool useBackups,
+                               int workersCount);
+
+        protected:
+            virtual bool processArtwork(Models::ArtworkMetadata *artwork) override;
+            virtual void processFallback(const MetadataIO::ArtworksSnapshot &artworks) override;
+
+        private:
+            Helpers::AsyncCoordinator *m_AsyncCoordinator;
+            Models::SettingsModel *m_SettingsModel;
+            bool m_UseBackups;
+        };
+    }
+}
+
+#endif // EXIV2IOWORKERS_H
@@ -14,22 +14,23 @@
 #include <QJsonArray>
 #include <QFile>
 #include <QDir>
-#include <QTemporaryFile>
 #include <QImageReader>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
 #include <Models/settingsmodel.h>
 #include <Models/artworkmetadata.h>
 #include <Helpers/asynccoordinator.h>
 #include <MetadataIO/metadatareadinghub.h>
 #include <Helpers/constants.h>
 #include <Common/defines.h>
+#include "exiftoolprocesspool.h"
 
-#ifdef Q_OS_WIN
-#define _X86_
-#include <fileapi.h>
-#include <io.h>
-#else
-#include <unistd.h>
-#endif
+#define EXIFTOOL_READ_BASE_TIMEOUT 10000
+#define EXIFTOOL_READ_FILE_TIMEOUT 1000
+// perl startup and tags table loading is not worth it for fewer files
+#define MIN_FILES_PER_SHARD 20
+#define PROGRESS_REPORT_STEP 50
 
 #define SOURCEFILE QLatin1String("SourceFile")
 #define TITLE QLatin1String("Title")
@@ -150,8 +151,10 @@ namespace libxpks {
                                                                MetadataIO::MetadataReadingHub *readingHub):
             m_ItemsToReadSnapshot(artworksToRead),
             m_ReadingHub(readingHub),
-            m_ExiftoolProcess(nullptr),
             m_SettingsModel(settingsModel),
+            m_ParsedCount(0),
+            m_ShardIndex(0),
+            m_ShardsCount(1),
             m_ReadSuccess(false)
         {
             Q_ASSERT(readingHub != nullptr);
@@ -169,102 +172,41 @@ namespace libxpks {
 
             Q_UNUSED(unlocker);
 
-            bool success = false;
-            initWorker();
-
-            QTemporaryFile argumentsFile;
-
-            if (argumentsFile.open()) {
-                LOG_INFO << "Created arguments file" << argumentsFile.fileName();
-
-                QStringList exiftoolArguments = createArgumentsList();
-                foreach (const QString &line, exiftoolArguments) {
-                    argumentsFile.write(line.toUtf8());
-#ifdef Q_OS_WIN
-                    argumentsFile.write("\r\n");
-#else
-                    argumentsFile.write("\n");
-#endif
-                }
-
-                argumentsFile.flush();
-
-                LOG_DEBUG << "Waiting for tempfile bytes written...";
-#ifdef Q_OS_WIN
-                HANDLE fileHandle = (HANDLE)_get_osfhandle(argumentsFile.handle());
-                bool flushResult = FlushFileBuffers(fileHandle);
-                LOG_DEBUG << "Windows flush result:" << flushResult;
-#else
-                int fsyncResult = fsync(argumentsFile.handle());
-                LOG_DEBUG << "fsync result:" << fsyncResult;
-#endif
-                argumentsFile.close();
-
-                QString exiftoolPath = m_SettingsModel->getExifToolPath();
-                QStringList arguments;
-#ifdef Q_OS_WIN
-                arguments << "-charset" << "FileName=UTF8";
-
-                /*
-            QString exiftoolCommand = QString("\"\"%1\" -charset filename=UTF8 -@ \"%2\"\"").arg(exiftoolPath).arg(tempFilename);
-            LOG_DEBUG << "Windows command is:" << exiftoolCommand;
-            m_ExiftoolProcess->setTextModeEnabled(false);
-            m_ExiftoolProcess->setProgram("cmd.exe");
-            m_ExiftoolProcess->setArguments(QStringList() << "/U" << "/c");
-            m_ExiftoolProcess->setNativeArguments(exiftoolCommand);
-            m_ExiftoolProcess->start();
-            */
-#endif
-                arguments << "-@" << argumentsFile.fileName();
-                LOG_INFO << "Starting exiftool process:" << exiftoolPath;
-                m_ExiftoolProcess->start(exiftoolPath, arguments);
+            m_ReadSuccess = readMetadata();
+            emit stopped();
+        }
 
-                success = m_ExiftoolProcess->waitForFinished();
-                LOG_DEBUG << "Exiftool process finished.";
+        bool ExiftoolImageReadingWorker::readMetadata() {
+            const int timeout = EXIFTOOL_READ_BASE_TIMEOUT + EXIFTOOL_READ_FILE_TIMEOUT * (int)m_ItemsToReadSnapshot.size();
+            // results are pushed to the hub from handleOutput() while exiftool is still working
+            std::shared_ptr<ExiftoolCommand> command(new ExiftoolCommand(createArgumentsList(), timeout, this));
 
-                int exitCode = m_ExiftoolProcess->exitCode();
-                QProcess::ExitStatus exitStatus = m_ExiftoolProcess->exitStatus();
+            QString exiftoolPath = m_SettingsModel->getExifToolPath();
+            LOG_INFO << "Shard" << (m_ShardIndex + 1) << "of" << m_ShardsCount << ": reading" << m_ItemsToReadSnapshot.size() << "item(s) with" << exiftoolPath;
+            reportProgress();
 
-                success = success &&
-                        (exitCode == 0) &&
-                        (exitStatus == QProcess::NormalExit);
+            QElapsedTimer timer;
+            timer.start();
 
-                LOG_INFO << "Exiftool exitcode =" << exitCode << "exitstatus =" << exitStatus;
-                LOG_DEBUG << "Temporary file:" << argumentsFile.fileName();
+            bool success = ExiftoolProcessPool::getInstance().execute(exiftoolPath, command);
+            LOG_INFO << "Shard" << (m_ShardIndex + 1) << "of" << m_ShardsCount << ": exiftool finished:" << success << "in" << timer.elapsed() << "ms";
 
-                QByteArray stdoutByteArray = m_ExiftoolProcess->readAllStandardOutput();
-                parseExiftoolOutput(stdoutByteArray);
+            LOG_INFO << "Shard" << (m_ShardIndex + 1) << "of" << m_ShardsCount << ": parsed" << m_ParsedCount << "item(s)";
+            reportProgress();
+            if (m_OutputStream.hasIncompleteObject()) {
+                LOG_WARNING << "Exiftool output ended in the middle of an object";
             }
 
-            m_ReadSuccess = success;
-            emit stopped();
-        }
-
-        void ExiftoolImageReadingWorker::innerProcessFinished(int exitCode, QProcess::ExitStatus exitStatus) {
-            Q_UNUSED(exitStatus);
-            LOG_DEBUG << "Exiftool finished with exitcode" << exitCode;
-
-            QByteArray stderrByteArray = m_ExiftoolProcess->readAllStandardError();
-            QString stderrText = QString::fromUtf8(stderrByteArray);
-            LOG_DEBUG << "STDERR [Exiftool]:" << stderrText;
-        }
-
-        void ExiftoolImageReadingWorker::initWorker() {
-            m_ExiftoolProcess = new QProcess(this);
-            QObject::connect(m_ExiftoolProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
-                             this, &ExiftoolImageReadingWorker::innerProcessFinished);
+            return success;
         }
 
         QStringList ExiftoolImageReadingWorker::createArgumentsList() {
             QStringList arguments;
             arguments.reserve(m_ItemsToReadSnapshot.size() + 10);
 
-            /*
-         * Related to the hack in windows for UTF8-encoded paths
 #ifdef Q_OS_WIN
-        arguments << "-charset" << "FileName=UTF8";
+            arguments << "-charset" << "FileName=UTF8";
 #endif
-*/
             arguments << "-json" << "-ignoreMinorErrors" << "-e";
             arguments << "-ObjectName" << "-Title";
             arguments << "-ImageDescription" << "-Description" << "-Caption-Abstract";
@@ -280,36 +222,159 @@ namespace libxpks {
             return arguments;
         }
 
-        void ExiftoolImageReadingWorker::parseExiftoolOutput(const QByteArray &output) {
-            LOG_DEBUG << "Parsing JSON output of exiftool...";
-            QJsonDocument document = QJsonDocument::fromJson(output);
-            if (document.isArray()) {
-                QJsonArray filesArray = document.array();
+        void ExiftoolImageReadingWorker::handleOutput(const QByteArray &chunk) {
+            m_ParsedObjects.clear();
+            m_OutputStream.feed(chunk, m_ParsedObjects);
+
+            for (auto &objectJson: m_ParsedObjects) {
+                parseExiftoolObject(objectJson);
+            }
+        }
+
+        void ExiftoolImageReadingWorker::resetOutput() {
+            LOG_DEBUG << "#";
+            // already pushed results stay in the hub and
+            // the same files are skipped in the output of the retry
+            m_OutputStream.reset();
+        }
+
+        void ExiftoolImageReadingWorker::parseExiftoolObject(const QByteArray &objectJson) {
+            QJsonParseError error;
+            QJsonDocument document = QJsonDocument::fromJson(objectJson, &error);
+            if (!document.isObject()) {
+                LOG_WARNING << "Exiftool Output Parsing Error:" << error.errorString();
+                return;
+            }
+
+            std::shared_ptr<MetadataIO::OriginalMetadata> result(new MetadataIO::OriginalMetadata());
+            jsonObjectToImportResult(document.object(), result.get());
+
+            Q_ASSERT(!result->m_FilePath.isEmpty());
+
+            if (m_PushedFilepaths.contains(result->m_FilePath)) {
+                LOG_DEBUG << "Skipping already parsed file:" << result->m_FilePath;
+                return;
+            }
+
+            QImageReader reader(result->m_FilePath);
+            result->m_ImageSize = reader.size();
+
+            QFileInfo fi(result->m_FilePath);
+            result->m_FileSize = fi.size();
+
+            m_PushedFilepaths.insert(result->m_FilePath);
+            m_ReadingHub->push(result);
+            m_ParsedCount++;
+
+            LOG_DEBUG << "Parsed file:" << result->m_FilePath;
+
+            if (m_ParsedCount % PROGRESS_REPORT_STEP == 0) {
+                reportProgress();
+            }
+        }
+
+        void ExiftoolImageReadingWorker::reportProgress() {
+            m_ReadingHub->reportShardProgress(m_ShardIndex, m_ParsedCount, (int)m_ItemsToReadSnapshot.size());
+        }
+
+        ExiftoolShardingWorker::ExiftoolShardingWorker(const MetadataIO::ArtworksSnapshot &artworksToRead,
+                                                       Models::SettingsModel *settingsModel,
+                                                       MetadataIO::MetadataReadingHub *readingHub):
+            m_ItemsToReadSnapshot(artworksToRead),
+            m_ReadingHub(readingHub),
+            m_SettingsModel(settingsModel)
+        {
+            Q_ASSERT(readingHub != nullptr);
+            Q_ASSERT(settingsModel != nullptr);
+        }
+
+        void ExiftoolShardingWorker::process() {
+            auto *asyncCoordinator = m_ReadingHub->getCoordinator();
+            // every shard is locked before this one is unlocked
+            Helpers::AsyncCoordinatorUnlocker unlocker(asyncCoordinator);
+            Q_UNUSED(unlocker);
+
+            std::vector<MetadataIO::ArtworksSnapshot> shards;
+            createShards(shards);
+
+            const int shardsCount = (int)shards.size();
+            LOG_INFO << "Reading" << m_ItemsToReadSnapshot.size() << "item(s) in" << shardsCount << "exiftool shard(s)";
+
+            for (int i = 0; i < shardsCount; ++i) {
+                startShard(shards[i], i, shardsCount);
+            }
+
+            emit stopped();
+        }
+
+        void ExiftoolShardingWorker::createShards(std::vector<MetadataIO::ArtworksSnapshot> &shards) const {
+            const MetadataIO::ArtworksSnapshot &artworks = m_ItemsToReadSnapshot;
+            const size_t size = artworks.size();
+            if (size == 0) { return; }
 
-                int size = filesArray.size();
-                for (int i = 0; i < size; ++i) {
-                    const QJsonValue &fileJson = filesArray.at(i);
-                    if (fileJson.isObject()) {
-                        QJsonObject fileObject = fileJson.toObject();
-                        std::shared_ptr<MetadataIO::OriginalMetadata> result(new MetadataIO::OriginalMetadata());
-                        jsonObjectToImportResult(fileObject, result.get());
+            std::vector<qint64> filesSizes;
+            filesSizes.reserve(size);
+            qint64 totalBytes = 0;
 
-                        Q_ASSERT(!result->m_FilePath.isEmpty());
+            for (size_t i = 0; i < size; ++i) {
+                Models::ArtworkMetadata *artwork = artworks.get(i);
+                const qint64 fileSize = QFileInfo(artwork->getFilepath()).size();
+                filesSizes.push_back(fileSize);
+                totalBytes += fileSize;
+            }
+
+            // exiftool time is dominated by files count for small files and by bytes for big ones
+            // so shard is closed when it reaches its fair share of either of them
+            const size_t maxShardsCount = qMax<size_t>(1, size / MIN_FILES_PER_SHARD);
+            const size_t shardsCount = qMin<size_t>((size_t)ExiftoolProcessPool::getOptimalSize(), maxShardsCount);
+            const size_t filesPerShard = (size + shardsCount - 1) / shardsCount;
+            const qint64 bytesPerShard = (totalBytes + (qint64)shardsCount - 1) / (qint64)shardsCount;
 
-                        QImageReader reader(result->m_FilePath);
-                        result->m_ImageSize = reader.size();
+            shards.reserve(shardsCount);
+            shards.emplace_back();
+            qint64 shardBytes = 0;
+
+            for (size_t i = 0; i < size; ++i) {
+                MetadataIO::ArtworksSnapshot &shard = shards.back();
+                if (shard.empty()) { shard.reserve(filesPerShard); }
 
-                        QFileInfo fi(result->m_FilePath);
-                        result->m_FileSize = fi.size();
+                shard.append(artworks.get(i));
+                shardBytes += filesSizes[i];
 
-                        m_ReadingHub->push(result);
+                const bool isFull = (shard.size() >= filesPerShard) ||
+                        ((bytesPerShard > 0) && (shardBytes >= bytesPerShard));
+                const bool isLastShard = (shards.size() >= shardsCount);
 
-                        LOG_DEBUG << "Parsed file:" << result->m_FilePath;
-                    }
+                if (isFull && !isLastShard && (i + 1 < size)) {
+                    LOG_DEBUG << "Shard" << shards.size() << ":" << shard.size() << "file(s)," << shardBytes << "bytes";
+                    shards.emplace_back();
+                    shardBytes = 0;
                 }
-            } else {
-                LOG_WARNING << "Exiftool Output Parsing Error";
             }
+
+            LOG_DEBUG << "Shard" << shards.size() << ":" << shards.back().size() << "file(s)," << shardBytes << "bytes";
+        }
+
+        void ExiftoolShardingWorker::startShard(const MetadataIO::ArtworksSnapshot &shard, int shardIndex, int shardsCount) {
+            Helpers::AsyncCoordinatorLocker locker(m_ReadingHub->getCoordinator());
+            Q_UNUSED(locker);
+
+            ExiftoolImageReadingWorker *readingWorker = new ExiftoolImageReadingWorker(shard,
+                                                                                       m_SettingsModel,
+                                                                                       m_ReadingHub);
+            readingWorker->setShard(shardIndex, shardsCount);
+
+            QThread *thread = new QThread();
+            readingWorker->moveToThread(thread);
+
+            QObject::connect(thread, &QThread::started, readingWorker, &ExiftoolImageReadingWorker::process);
+            QObject::connect(readingWorker, &ExiftoolImageReadingWorker::stopped, thread, &QThread::quit);
+
+            QObject::connect(readingWorker, &ExiftoolImageReadingWorker::stopped, readingWorker, &ExiftoolImageReadingWorker::deleteLater);
+            QObject::connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+
+            LOG_DEBUG << "Starting thread for shard" << (shardIndex + 1);
+            thread->start();
         }
     }
 }
@@ -15,13 +15,16 @@
 #include <QVector>
 #include <QHash>
 #include <QString>
-#include <QProcess>
 #include <QStringList>
 #include <QByteArray>
 #include <QHash>
+#include <QSet>
 #include <QSize>
+#include <vector>
 #include <MetadataIO/originalmetadata.h>
 #include <MetadataIO/artworkssnapshot.h>
+#include <Helpers/jsonobjectstream.h>
+#include "exiftoolprocesspool.h"
 
 namespace Models {
     class ArtworkMetadata;
@@ -34,7 +37,7 @@ namespace MetadataIO {
 
 namespace libxpks {
     namespace io {
-        class ExiftoolImageReadingWorker : public QObject
+        class ExiftoolImageReadingWorker : public QObject, public IExiftoolOutputHandler
         {
             Q_OBJECT
         public:
@@ -49,26 +52,64 @@ namespace libxpks {
         public slots:
             void process();
 
-        private slots:
-            void innerProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-
         public:
             void dismiss() { emit stopped(); }
             bool success() const { return m_ReadSuccess; }
+            // reads in the calling thread, pushing results to the hub
+            bool readMetadata();
+            void setShard(int shardIndex, int shardsCount) { m_ShardIndex = shardIndex; m_ShardsCount = shardsCount; }
+
+            // IExiftoolOutputHandler interface
+        public:
+            virtual void handleOutput(const QByteArray &chunk) override;
+            virtual void resetOutput() override;
 
         private:
-            void initWorker();
             QStringList createArgumentsList();
-            void parseExiftoolOutput(const QByteArray &output);
-            void readSizes();
+            void parseExiftoolObject(const QByteArray &objectJson);
+            void reportProgress();
 
         private:
             MetadataIO::ArtworksSnapshot m_ItemsToReadSnapshot;
             MetadataIO::MetadataReadingHub *m_ReadingHub;
-            QProcess *m_ExiftoolProcess;
             Models::SettingsModel *m_SettingsModel;
+            Helpers::JsonObjectStream m_OutputStream;
+            std::vector<QByteArray> m_ParsedObjects;
+            // files already pushed to the hub before exiftool was restarted
+            QSet<QString> m_PushedFilepaths;
+            int m_ParsedCount;
+            int m_ShardIndex;
+            int m_ShardsCount;
             volatile bool m_ReadSuccess;
         };
+
+        // splits artworks into shards and starts a reading worker for each of them,
+        // sizes of files are checked here and not in the thread which starts import
+        class ExiftoolShardingWorker : public QObject
+        {
+            Q_OBJECT
+        public:
+            explicit ExiftoolShardingWorker(const MetadataIO::ArtworksSnapshot &artworksToRead,
+                                            Models::SettingsModel *settingsModel,
+                                            MetadataIO::MetadataReadingHub *readingHub);
+
+        signals:
+            void stopped();
+
+        public slots:
+            void process();
+
+        public:
+            void createShards(std::vector<MetadataIO::ArtworksSnapshot> &shards) const;
+
+        private:
+            void startShard(const MetadataIO::ArtworksSnapshot &shard, int shardIndex, int shardsCount);
+
+        private:
+            MetadataIO::ArtworksSnapshot m_ItemsToReadSnapshot;
+            MetadataIO::MetadataReadingHub *m_ReadingHub;
+            Models::SettingsModel *m_SettingsModel;
+        };
     }
 }
 
@@ -13,7 +13,8 @@
 
 #include <QObject>
 #include <QVector>
-#include <QProcess>
+#include <QStringList>
+#include <vector>
 #include <MetadataIO/artworkssnapshot.h>
 
 namespace Helpers {
@@ -39,6 +40,8 @@ namespace libxpks {
 
         public:
             bool success() const { return m_WriteSuccess; }
+            // writes in the calling thread, every saved artwork is marked as not modified
+            bool writeMetadata();
 
         signals:
             void stopped();
@@ -46,16 +49,11 @@ namespace libxpks {
         public slots:
             void process();
 
-        private slots:
-            void innerProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-
         private:
-            void initWorker();
-            QStringList createArgumentsList(const QString &jsonFilePath);
-            void setArtworksSaved();
+            QStringList createArgumentsList(Models::ArtworkMetadata *artwork);
+            void writeItems(const std::vector<size_t> &indices, std::vector<size_t> &failedIndices);
 
         private:
-            QProcess *m_ExiftoolProcess;
             MetadataIO::ArtworksSnapshot m_ItemsToWriteSnapshot;
             Helpers::AsyncCoordinator *m_AsyncCoordinator;
             Models::SettingsModel *m_SettingsModel;
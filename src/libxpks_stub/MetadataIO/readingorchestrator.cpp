@@ -12,10 +12,17 @@
 #include <QThread>
 #include <QVector>
 #include <QMutexLocker>
+#include <Helpers/threadhelpers.h>
 #include <Models/artworkmetadata.h>
+#include <Models/settingsmodel.h>
 #include <Common/defines.h>
 #include <MetadataIO/metadatareadinghub.h>
 #include "metadatareadingworker.h"
+#include "exiftoolprocesspool.h"
+#include "exiv2iohelpers.h"
+#include "exiv2ioworkers.h"
+
+#define EXIV2_MAX_WORKERS 4
 
 namespace libxpks {
     namespace io {
@@ -38,22 +45,59 @@ namespace libxpks {
             Helpers::AsyncCoordinatorStarter deferredStarter(asyncCoordinator, -1);
             Q_UNUSED(deferredStarter);
 
-            Helpers::AsyncCoordinatorLocker locker(asyncCoordinator);
+            initializeExiv2();
+
+            MetadataIO::ArtworksSnapshot exiv2Artworks, exiftoolArtworks;
+            splitByExiv2Support(m_ItemsToReadSnapshot, m_SettingsModel->getUseExiv2(), exiv2Artworks, exiftoolArtworks);
+
+            if (!exiv2Artworks.empty()) {
+                startExiv2Reading(exiv2Artworks);
+            }
+
+            LOG_INFO << "Reading" << exiv2Artworks.size() << "item(s) with exiv2 and" <<
+                        exiftoolArtworks.size() << "item(s) with exiftool";
+
+            if (!exiftoolArtworks.empty()) {
+                startExiftoolReading(exiftoolArtworks);
+            }
+        }
+
+        void ReadingOrchestrator::startExiv2Reading(const MetadataIO::ArtworksSnapshot &artworks) {
+            Helpers::AsyncCoordinatorLocker locker(m_ReadingHub->getCoordinator());
             Q_UNUSED(locker);
 
-            ExiftoolImageReadingWorker *readingWorker = new ExiftoolImageReadingWorker(m_ItemsToReadSnapshot,
-                                                                                       m_SettingsModel,
-                                                                                       m_ReadingHub);
+            const int workersCount = qMin((int)artworks.size(), Helpers::getOptimalWorkersCount(EXIV2_MAX_WORKERS));
+            Exiv2ReadingWorker *readingWorker = new Exiv2ReadingWorker(artworks, m_SettingsModel, m_ReadingHub, workersCount);
+
             QThread *thread = new QThread();
             readingWorker->moveToThread(thread);
 
-            QObject::connect(thread, &QThread::started, readingWorker, &ExiftoolImageReadingWorker::process);
-            QObject::connect(readingWorker, &ExiftoolImageReadingWorker::stopped, thread, &QThread::quit);
+            QObject::connect(thread, &QThread::started, readingWorker, &Exiv2ReadingWorker::process);
+            QObject::connect(readingWorker, &Exiv2ReadingWorker::stopped, thread, &QThread::quit);
+
+            QObject::connect(readingWorker, &Exiv2ReadingWorker::stopped, readingWorker, &Exiv2ReadingWorker::deleteLater);
+            QObject::connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+
+            LOG_DEBUG << "Starting exiv2 thread...";
+            thread->start();
+        }
+
+        void ReadingOrchestrator::startExiftoolReading(const MetadataIO::ArtworksSnapshot &artworks) {
+            Helpers::AsyncCoordinatorLocker locker(m_ReadingHub->getCoordinator());
+            Q_UNUSED(locker);
+
+            ExiftoolShardingWorker *shardingWorker = new ExiftoolShardingWorker(artworks, m_SettingsModel, m_ReadingHub);
+
+            QThread *thread = new QThread();
+            shardingWorker->moveToThread(thread);
+
+            QObject::connect(thread, &QThread::started, shardingWorker, &ExiftoolShardingWorker::process);
+            QObject::connect(shardingWorker, &ExiftoolShardingWorker::stopped, thread, &QThread::quit);
 
-            QObject::connect(readingWorker, &ExiftoolImageReadingWorker::stopped, readingWorker, &ExiftoolImageReadingWorker::deleteLater);
+            QObject::connect(shardingWorker, &ExiftoolShardingWorker::stopped, shardingWorker, &ExiftoolShardingWorker::deleteLater);
             QObject::connect(thread, &QThread::finished, thread, &QThread::deleteLater);
 
-            LOG_DEBUG << "Starting thread...";
+            LOG_DEBUG << "Starting sharding thread...";
             thread->start();
         }
     }
@@ -28,6 +28,11 @@ namespace libxpks {
         public:
             void startReading();
 
+        private:
+            void startExiv2Reading(const MetadataIO::ArtworksSnapshot &artworks);
+            // shards are created in the background since file sizes are checked
+            void startExiftoolReading(const MetadataIO::ArtworksSnapshot &artworks);
+
         private:
             const MetadataIO::ArtworksSnapshot &m_ItemsToReadSnapshot;
             MetadataIO::MetadataReadingHub *m_ReadingHub;
@@ -13,9 +13,15 @@
 #include <QThread>
 #include <Helpers/indiceshelper.h>
 #include <Models/artworkmetadata.h>
+#include <Models/settingsmodel.h>
 #include <Common/defines.h>
 #include "metadatawritingworker.h"
+#include "exiv2iohelpers.h"
+#include "exiv2ioworkers.h"
 #include <Helpers/asynccoordinator.h>
+#include <Helpers/threadhelpers.h>
+
+#define EXIV2_MAX_WORKERS 4
 
 namespace libxpks {
     namespace io {
@@ -40,10 +46,49 @@ namespace libxpks {
             Helpers::AsyncCoordinatorStarter deferredStarter(m_AsyncCoordinator, -1);
             Q_UNUSED(deferredStarter);
 
+            initializeExiv2();
+
+            MetadataIO::ArtworksSnapshot exiv2Artworks, exiftoolArtworks;
+            splitByExiv2Support(m_ItemsToWriteSnapshot, m_SettingsModel->getUseExiv2(), exiv2Artworks, exiftoolArtworks);
+            LOG_INFO << "Writing" << exiv2Artworks.size() << "item(s) with exiv2 and" << exiftoolArtworks.size() << "with exiftool";
+
+            if (!exiv2Artworks.empty()) {
+                startExiv2Writing(exiv2Artworks, useBackups);
+            }
+
+            if (!exiftoolArtworks.empty()) {
+                startExiftoolWriting(exiftoolArtworks, useBackups);
+            }
+        }
+
+        void WritingOrchestrator::startExiv2Writing(const MetadataIO::ArtworksSnapshot &artworks, bool useBackups) {
+            Helpers::AsyncCoordinatorLocker locker(m_AsyncCoordinator);
+            Q_UNUSED(locker);
+
+            const int workersCount = qMin((int)artworks.size(), Helpers::getOptimalWorkersCount(EXIV2_MAX_WORKERS));
+            auto *writingWorker = new Exiv2WritingWorker(artworks,
+                                                         m_AsyncCoordinator,
+                                                         m_SettingsModel,
+                                                         useBackups,
+                                                         workersCount);
+            QThread *thread = new QThread();
+            writingWorker->moveToThread(thread);
+
+            QObject::connect(thread, &QThread::started, writingWorker, &Exiv2WritingWorker::process);
+            QObject::connect(writingWorker, &Exiv2WritingWorker::stopped, thread, &QThread::quit);
+
+            QObject::connect(writingWorker, &Exiv2WritingWorker::stopped, writingWorker, &Exiv2WritingWorker::deleteLater);
+            QObject::connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+
+            thread->start();
+            LOG_INFO << "Started exiv2 writing worker...";
+        }
+
+        void WritingOrchestrator::startExiftoolWriting(const MetadataIO::ArtworksSnapshot &artworks, bool useBackups) {
             Helpers::AsyncCoordinatorLocker locker(m_AsyncCoordinator);
             Q_UNUSED(locker);
 
-            auto *writingWorker = new ExiftoolImageWritingWorker(m_ItemsToWriteSnapshot,
+            auto *writingWorker = new ExiftoolImageWritingWorker(artworks,
                                                                  m_AsyncCoordinator,
                                                                  m_SettingsModel,
                                                                  useBackups);
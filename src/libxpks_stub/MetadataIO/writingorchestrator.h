@@ -27,6 +27,10 @@ namespace libxpks {
             void startWriting(bool useBackups, bool useDirectExport=true);
             void startMetadataWiping(bool useBackups);
 
+        private:
+            void startExiv2Writing(const MetadataIO::ArtworksSnapshot &artworks, bool useBackups);
+            void startExiftoolWriting(const MetadataIO::ArtworksSnapshot &artworks, bool useBackups);
+
         private:
             const MetadataIO::ArtworksSnapshot &m_ItemsToWriteSnapshot;
             Models::SettingsModel *m_SettingsModel;
@@ -39,11 +39,13 @@ LIBS += -lcurl
 
 macx {
     INCLUDEPATH += "../../vendors/libcurl/include"
+    INCLUDEPATH += "../../vendors/exiv2-0.25/include"
 }
 
 win32 {
     DEFINES += QT_NO_PROCESS_COMBINED_ARGUMENT_START
     INCLUDEPATH += "../../vendors/libcurl/include"
+    INCLUDEPATH += "../../vendors/exiv2-0.25/include"
 
     LIBS -= -lcurl
 
@@ -70,6 +72,10 @@ HEADERS += \
     MetadataIO/metadatawritingworker.h \
     MetadataIO/readingorchestrator.h \
     MetadataIO/writingorchestrator.h \
+    MetadataIO/exiftoolpool.h \
+    MetadataIO/exiftoolprocesspool.h \
+    MetadataIO/exiv2iohelpers.h \
+    MetadataIO/exiv2ioworkers.h \
     Connectivity/ftpcoordinator.h \
     Connectivity/conectivityhelpers.h \
     Connectivity/curlftpuploader.h \
@@ -82,6 +88,9 @@ SOURCES += \
     MetadataIO/metadatawritingworker.cpp \
     MetadataIO/readingorchestrator.cpp \
     MetadataIO/writingorchestrator.cpp \
+    MetadataIO/exiftoolprocesspool.cpp \
+    MetadataIO/exiv2iohelpers.cpp \
+    MetadataIO/exiv2ioworkers.cpp \
     Connectivity/conectivityhelpers.cpp \
     Connectivity/curlftpuploader.cpp \
     Connectivity/ftpcoordinator.cpp \
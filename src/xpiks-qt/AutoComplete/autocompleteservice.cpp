@@ -90,6 +90,12 @@ namespace AutoComplete {
         return isBusy;
     }
 
+    void AutoCompleteService::logStatistics() const {
+        if (m_AutoCompleteWorker != NULL) {
+            m_AutoCompleteWorker->logTelemetry();
+        }
+    }
+
     void AutoCompleteService::submitItem(QString *item) {
         Q_UNUSED(item);
     }
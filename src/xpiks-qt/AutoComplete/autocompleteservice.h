@@ -48,6 +48,7 @@ namespace AutoComplete {
 
         virtual bool isAvailable() const override { return true; }
         virtual bool isBusy() const override;
+        void logStatistics() const;
 
     protected:
         virtual void submitItem(QString *item) override;
@@ -30,6 +30,8 @@ namespace AutoComplete {
     {
         Q_ASSERT(presetsManager != nullptr);
         Q_ASSERT(autoCompleteModel != nullptr);
+        setLoadPriority(Helpers::LoadPriority::Interactive);
+        getTelemetry().setName("AutoComplete");
     }
 
     AutoCompleteWorker::~AutoCompleteWorker() {
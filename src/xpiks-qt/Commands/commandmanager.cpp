@@ -65,6 +65,11 @@
 #include "../Connectivity/requestsservice.h"
 #include "../AutoComplete/keywordsautocompletemodel.h"
 #include "../MetadataIO/csvexportmodel.h"
+#include "../Helpers/loadmonitor.h"
+
+#ifndef CORE_TESTS
+#include <exiftoolpool.h>
+#endif
 
 Commands::CommandManager::CommandManager():
     QObject(),
@@ -654,6 +659,8 @@ void Commands::CommandManager::afterConstructionCallback() {
     Q_UNUSED(deferredStarter);
 
     m_AfterInitCalled = true;
+    Helpers::LoadMonitor::getInstance().startMonitoring();
+
     std::shared_ptr<Common::ServiceStartParams> emptyParams;
     std::shared_ptr<Common::ServiceStartParams> coordinatorParams(
                 new Helpers::AsyncCoordinatorStartParams(&m_InitCoordinator));
@@ -674,6 +681,7 @@ void Commands::CommandManager::afterConstructionCallback() {
     m_WarningsService->startService(emptyParams);
     m_AutoCompleteService->startService(coordinatorParams);
     m_TranslationService->startService(coordinatorParams);
+    m_MainDelegator.updateThrottlingPolicies();
 
     QCoreApplication::processEvents();
 
@@ -731,6 +739,12 @@ void Commands::CommandManager::executeMaintenanceJobs() {
 #if !defined(INTEGRATION_TESTS)
     m_MaintenanceService->moveSettings(m_SettingsModel);
     m_MaintenanceService->upgradeImagesCache(m_ImageCachingService);
+    // evicted thumbnails leave holes in the pack that compaction reclaims
+    m_MaintenanceService->evictThumbnails(m_ImageCachingService, m_VideoCachingService,
+                                          m_SettingsModel->getImagesCacheMaxSizeMB(),
+                                          m_SettingsModel->getVideosCacheMaxSizeMB());
+    m_MaintenanceService->compactImagesCache(m_ImageCachingService);
+    m_MaintenanceService->compactMetadataCache(m_MetadataIOService, m_SettingsModel->getMetadataCacheMaxSizeMB());
 
     m_MaintenanceService->cleanupLogs();
     m_MaintenanceService->cleanupUpdatesArtifacts();
@@ -753,6 +767,8 @@ void Commands::CommandManager::beforeDestructionCallback() const {
     #endif
 #endif
 
+    logQueuesStatistics();
+
     m_MainDelegator.clearCurrentItem();
 
     m_ArtworksRepository->stopListeningToUnavailableFiles();
@@ -766,6 +782,7 @@ void Commands::CommandManager::beforeDestructionCallback() const {
     m_VideoCachingService->stopService();
     m_UpdateService->stopChecking();
     m_MetadataIOService->stopService();
+    libxpks::io::shutdownExiftoolPool();
 #endif
     m_SpellCheckerService->stopService();
     m_WarningsService->stopService();
@@ -785,6 +802,18 @@ void Commands::CommandManager::beforeDestructionCallback() const {
 #endif
 }
 
+void Commands::CommandManager::logQueuesStatistics() const {
+    LOG_INFO << "Queues statistics:";
+
+#ifndef CORE_TESTS
+    m_ImageCachingService->logStatistics();
+    m_MetadataIOService->logStatistics();
+#endif
+    m_SpellCheckerService->logStatistics();
+    m_WarningsService->logStatistics();
+    m_AutoCompleteService->logStatistics();
+}
+
 #ifdef INTEGRATION_TESTS
 void Commands::CommandManager::cleanup() {
     LOG_INTEGRATION_TESTS << "#";
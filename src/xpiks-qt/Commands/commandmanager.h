@@ -214,6 +214,7 @@ namespace Commands {
 
     public:
         void beforeDestructionCallback() const;
+        void logQueuesStatistics() const;
 
 #ifdef INTEGRATION_TESTS
         void cleanup();
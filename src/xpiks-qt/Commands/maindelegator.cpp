@@ -48,6 +48,7 @@
 #include "../QuickBuffer/currenteditableproxyartwork.h"
 #include "../Maintenance/maintenanceservice.h"
 #include "../QMLExtensions/videocachingservice.h"
+#include "../Helpers/loadmonitor.h"
 #include "../QMLExtensions/artworksupdatehub.h"
 #include "../Helpers/asynccoordinator.h"
 #include "../Helpers/database.h"
@@ -337,6 +338,30 @@ namespace Commands {
     #endif
     }
 
+    void MainDelegator::prioritizePreviews(const MetadataIO::WeakArtworksSnapshot &visibleArtworks,
+                                           const MetadataIO::WeakArtworksSnapshot &nextArtworks) const {
+    #ifndef CORE_TESTS
+        auto *imageCachingService = m_CommandManager->getImageCachingService();
+        if (imageCachingService != NULL) {
+            imageCachingService->prioritizePreviews(visibleArtworks, nextArtworks);
+        }
+    #else
+        Q_UNUSED(visibleArtworks);
+        Q_UNUSED(nextArtworks);
+    #endif
+    }
+
+    void MainDelegator::cancelPreviews(const QVector<Common::ID_t> &removedArtworkIDs) const {
+    #ifndef CORE_TESTS
+        auto *videoCachingService = m_CommandManager->getVideoCachingService();
+        if (videoCachingService != NULL) {
+            videoCachingService->cancelThumbnails(removedArtworkIDs);
+        }
+    #else
+        Q_UNUSED(removedArtworkIDs);
+    #endif
+    }
+
     void MainDelegator::submitKeywordForSpellCheck(Common::BasicKeywordsModel *item, int keywordIndex) const {
         Q_ASSERT(item != NULL);
         auto *spellCheckerService = m_CommandManager->getSpellCheckerService();
@@ -660,6 +685,34 @@ namespace Commands {
         }
     }
 
+    void MainDelegator::updateThrottlingPolicies() {
+        LOG_DEBUG << "#";
+        auto *settingsModel = m_CommandManager->getSettingsModel();
+        if (settingsModel == NULL) { return; }
+
+    #ifndef CORE_TESTS
+        auto *imageCachingService = m_CommandManager->getImageCachingService();
+        if (imageCachingService != NULL) {
+            imageCachingService->setThrottlingPolicy(Helpers::toThrottlingPolicy(settingsModel->getImageCachingThrottling()));
+        }
+
+        auto *videoCachingService = m_CommandManager->getVideoCachingService();
+        if (videoCachingService != NULL) {
+            videoCachingService->setThrottlingPolicy(Helpers::toThrottlingPolicy(settingsModel->getVideoCachingThrottling()));
+        }
+    #endif
+
+        auto *spellCheckerService = m_CommandManager->getSpellCheckerService();
+        if (spellCheckerService != NULL) {
+            spellCheckerService->setThrottlingPolicy(Helpers::toThrottlingPolicy(settingsModel->getSpellCheckThrottling()));
+        }
+
+        auto *warningsService = m_CommandManager->getWarningsService();
+        if (warningsService != NULL) {
+            warningsService->setThrottlingPolicy(Helpers::toThrottlingPolicy(settingsModel->getWarningsThrottling()));
+        }
+    }
+
     void MainDelegator::generateCompletions(const QString &prefix, Common::BasicKeywordsModel *source) const {
     #ifndef CORE_TESTS
         auto *autoCompleteService = m_CommandManager->getAutoCompleteService();
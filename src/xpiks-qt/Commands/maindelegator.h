@@ -172,6 +172,9 @@ namespace Commands {
 
     public:
         void generatePreviews(const MetadataIO::ArtworksSnapshot &snapshot) const;
+        void prioritizePreviews(const MetadataIO::WeakArtworksSnapshot &visibleArtworks,
+                                const MetadataIO::WeakArtworksSnapshot &nextArtworks) const;
+        void cancelPreviews(const QVector<Common::ID_t> &removedArtworkIDs) const;
         void submitKeywordForSpellCheck(Common::BasicKeywordsModel *item, int keywordIndex) const;
         void submitForSpellCheck(const MetadataIO::WeakArtworksSnapshot &items) const;
         void submitForSpellCheck(const std::vector<Common::BasicKeywordsModel *> &items) const;
@@ -213,6 +216,7 @@ namespace Commands {
         void restartSpellChecking();
         void disableSpellChecking();
         void disableDuplicatesCheck();
+        void updateThrottlingPolicies();
         void generateCompletions(const QString &prefix, Common::BasicKeywordsModel *source) const;
 
     public:
@@ -21,6 +21,7 @@
 #include "../UndoRedo/removedirectoryitem.h"
 #include "../Common/defines.h"
 #include "../Models/imageartwork.h"
+#include "../Models/videoartwork.h"
 
 namespace Commands {
     std::shared_ptr<ICommandResult> RemoveArtworksCommand::execute(const ICommandManager *commandManagerInterface) const {
@@ -38,6 +39,7 @@ namespace Commands {
 
         QStringList removedItemsFilepathes;
         QStringList removedAttachedVectors;
+        QVector<Common::ID_t> removedVideoIDs;
         removedItemsFilepathes.reserve(count);
         removedAttachedVectors.reserve(count);
 
@@ -63,6 +65,10 @@ namespace Commands {
                         } else {
                             removedAttachedVectors.append("");
                         }
+
+                        if (dynamic_cast<Models::VideoArtwork*>(artwork) != NULL) {
+                            removedVideoIDs.append(artwork->getItemID());
+                        }
                     }
                 }
             }
@@ -75,6 +81,8 @@ namespace Commands {
         if (artworksToRemoveCount > 0) {
             QVector<QPair<int, int> > rangesToRemove;
             Helpers::indicesToRanges(removedItemsIndices, rangesToRemove);
+            // pending thumbnails would keep removed videos alive for a long time
+            xpiks->cancelPreviews(removedVideoIDs);
             artItemsModel->removeItemsFromRanges(rangesToRemove);
 
             xpiks->clearCurrentItem();
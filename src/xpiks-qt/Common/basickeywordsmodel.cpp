@@ -9,6 +9,7 @@
  */
 
 #include "basickeywordsmodel.h"
+#include <atomic>
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
@@ -23,9 +24,15 @@
 #include "basickeywordsmodelimpl.h"
 
 namespace Common {
+    quint64 generateModelID() {
+        static std::atomic<quint64> lastModelID(0);
+        return ++lastModelID;
+    }
+
     BasicKeywordsModel::BasicKeywordsModel(Hold &hold, QObject *parent):
         AbstractListModel(parent),
-        m_Impl(new BasicKeywordsModelImpl(hold))
+        m_Impl(new BasicKeywordsModelImpl(hold)),
+        m_ModelID(generateModelID())
     {}
 
 #ifdef CORE_TESTS
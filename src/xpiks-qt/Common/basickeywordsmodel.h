@@ -81,6 +81,8 @@ namespace Common {
         virtual QHash<int, QByteArray> roleNames() const override;
 
     public:
+        // unique for the lifetime of the application, unlike the address
+        quint64 getModelID() const { return m_ModelID; }
         int getKeywordsCount();
         QSet<QString> getKeywordsSet();
         virtual QString getKeywordsString();
@@ -156,6 +158,7 @@ namespace Common {
     private:
         QReadWriteLock m_KeywordsLock;
         std::shared_ptr<BasicKeywordsModelImpl> m_Impl;
+        quint64 m_ModelID;
     };
 }
 
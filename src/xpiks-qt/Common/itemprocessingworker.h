@@ -13,110 +13,190 @@
 
 #include <QWaitCondition>
 #include <QMutex>
+#include <QHash>
 #include <deque>
+#include <map>
 #include <memory>
 #include <vector>
 #include <tuple>
+#include <thread>
 #include <algorithm>
 #include "../Common/flags.h"
 #include "../Common/defines.h"
 #include "../Helpers/threadhelpers.h"
+#include "../Helpers/loadmonitor.h"
+#include "../Helpers/queuetelemetry.h"
+
+#define WORKER_FIXED_DELAY 500
+#define WORKER_YIELD_QUANTUM 10
+// statistics are logged when queue is drained after this many items
+#define WORKER_TELEMETRY_LOG_THRESHOLD 500
+
+#define INVALID_ITEM_KEY 0
 
 namespace Common {
+    // lanes are drained in order: nothing from a lower lane is taken
+    // while any consumer has items in a higher one
+    enum ProcessingLane {
+        LaneInteractive = 0,
+        LaneVisible = 1,
+        LaneBulk = 2,
+        LanesCount = 3
+    };
+
+    typedef quint64 item_key_t;
+
+    // key for supersession: newer pending item with the same key replaces the older one
+    inline item_key_t makeItemKey(quint64 id, Common::flag_t flags) {
+        return ((id + 1) << 8) | (flags & 0xFF);
+    }
+
+    // each of workersCount consumers owns a deque per lane and steals from the
+    // back of the most loaded sibling when own deque is drained;
+    // separators fire only when every item submitted before them is processed
     template<typename T>
     class ItemProcessingWorker
     {
     public:
         typedef quint32 batch_id_t;
+        typedef quint32 epoch_t;
         typedef std::tuple<std::shared_ptr<T>, Common::flag_t, batch_id_t> ItemType;
 
+    private:
+        struct QueueEntry {
+            QueueEntry():
+                m_Flags(0),
+                m_BatchID(INVALID_BATCH_ID),
+                m_Epoch(0),
+                m_EnqueuedAt(0),
+                m_Key(INVALID_ITEM_KEY),
+                m_Sequence(0)
+            { }
+
+            QueueEntry(const std::shared_ptr<T> &item, Common::flag_t flags, batch_id_t batchID, epoch_t epoch, qint64 enqueuedAt,
+                       item_key_t key = INVALID_ITEM_KEY, quint32 sequence = 0):
+                m_Item(item),
+                m_Flags(flags),
+                m_BatchID(batchID),
+                m_Epoch(epoch),
+                m_EnqueuedAt(enqueuedAt),
+                m_Key(key),
+                m_Sequence(sequence)
+            { }
+
+            // keyed entries keep the actual item in m_PendingByKey
+            std::shared_ptr<T> m_Item;
+            Common::flag_t m_Flags;
+            batch_id_t m_BatchID;
+            epoch_t m_Epoch;
+            qint64 m_EnqueuedAt;
+            item_key_t m_Key;
+            quint32 m_Sequence;
+        };
+
+        struct PendingKeyed {
+            std::shared_ptr<T> m_Item;
+            batch_id_t m_BatchID;
+            epoch_t m_Epoch;
+            quint32 m_Sequence;
+            int m_Lane;
+        };
+
+        struct ConsumerQueue {
+            std::deque<QueueEntry> m_Lanes[LanesCount];
+        };
+
     public:
-        ItemProcessingWorker(int delayPeriod = 0xffffffff):
+        ItemProcessingWorker(int delayPeriod = 0xffffffff, int workersCount = 1):
+            m_Queues(std::max(workersCount, 1)),
             m_BatchID(1),
+            m_Epoch(0),
+            m_NextQueue(0),
+            m_KeySequence(0),
+            m_MaxBatchSize(1),
+            m_ActiveCount(0),
+            m_ReportedPendingCount(0),
             m_DelayPeriod(delayPeriod),
+            m_ThrottlingPolicy(Helpers::ThrottlingPolicy::NoThrottling),
+            m_LoadPriority(Helpers::LoadPriority::Normal),
             m_Cancel(false),
+            m_IsStopping(false),
             m_IsRunning(false)
         { }
 
-        virtual ~ItemProcessingWorker() { }
+        virtual ~ItemProcessingWorker() {
+            Helpers::LoadMonitor::getInstance().addPendingWork(m_LoadPriority, -m_ReportedPendingCount);
+        }
 
     private:
         enum WorkerFlags {
             FlagIsSeparator = 1 << 0,
-            FlagIsStopper = 1 << 1,
-            FlagIsWithDelay = 1 << 2
+            FlagIsWithDelay = 1 << 1
         };
 
     protected:
         inline bool getIsSeparatorFlag(Common::flag_t flags) const { return Common::HasFlag(flags, FlagIsSeparator); }
-        inline bool getIsStopperFlag(Common::flag_t flags) const { return Common::HasFlag(flags, FlagIsStopper); }
         inline bool getWithDelayFlag(Common::flag_t flags) const { return Common::HasFlag(flags, FlagIsWithDelay); }
 
     public:
         void submitSeparator() {
-            if (m_Cancel) { return; }
+            if (m_Cancel || m_IsStopping) { return; }
 
             m_QueueMutex.lock();
             {
-                Common::flag_t flags = 0;
-                Common::SetFlag(flags, FlagIsSeparator);
-
-                bool wasEmpty = m_Queue.empty();
-                m_Queue.emplace_back(std::shared_ptr<T>(), flags, INVALID_BATCH_ID);
+                m_Separators.push_back(m_Epoch);
+                m_Epoch++;
 
-                if (wasEmpty) {
-                    m_WaitAnyItem.wakeOne();
-                }
+                m_WaitAnyItem.wakeOne();
             }
             m_QueueMutex.unlock();
         }
 
         batch_id_t submitItem(const std::shared_ptr<T> &item) {
-            if (m_Cancel) {
+            return submitItem(item, LaneVisible);
+        }
+
+        // item with a valid key replaces the pending item with the same key
+        batch_id_t submitItem(const std::shared_ptr<T> &item, ProcessingLane lane, item_key_t key = INVALID_ITEM_KEY) {
+            if (m_Cancel || m_IsStopping) {
                 return INVALID_BATCH_ID;
             }
 
             batch_id_t batchID;
-            Common::flag_t flags = 0;
             m_QueueMutex.lock();
             {
                 batchID = getNextBatchID();
-                bool wasEmpty = m_Queue.empty();
-                m_Queue.emplace_back(item, flags, batchID);
+                enqueueUnsafe(item, lane, batchID, key, false);
+                syncPendingLoadUnsafe();
 
-                if (wasEmpty) {
-                    m_WaitAnyItem.wakeOne();
-                }
+                m_WaitAnyItem.wakeOne();
             }
             m_QueueMutex.unlock();
 
             return batchID;
         }
 
-        batch_id_t submitFirst(const std::shared_ptr<T> &item) {
-            if (m_Cancel) {
+        batch_id_t submitFirst(const std::shared_ptr<T> &item, item_key_t key = INVALID_ITEM_KEY) {
+            if (m_Cancel || m_IsStopping) {
                 return INVALID_BATCH_ID;
             }
 
             batch_id_t batchID;
-            Common::flag_t flags = 0;
             m_QueueMutex.lock();
             {
                 batchID = getNextBatchID();
-                bool wasEmpty = m_Queue.empty();
-                m_Queue.emplace_front(item, flags, batchID);
+                enqueueUnsafe(item, LaneInteractive, batchID, key, true);
+                syncPendingLoadUnsafe();
 
-                if (wasEmpty) {
-                    m_WaitAnyItem.wakeOne();
-                }
+                m_WaitAnyItem.wakeOne();
             }
             m_QueueMutex.unlock();
 
             return batchID;
         }
 
-        batch_id_t submitItems(const std::vector<std::shared_ptr<T> > &items) {
-            if (m_Cancel) {
+        batch_id_t submitItems(const std::vector<std::shared_ptr<T> > &items, ProcessingLane lane = LaneBulk) {
+            if (m_Cancel || m_IsStopping) {
                 return INVALID_BATCH_ID;
             }
 
@@ -125,20 +205,29 @@ namespace Common {
             m_QueueMutex.lock();
             {
                 batchID = getNextBatchID();
-                bool wasEmpty = m_Queue.empty();
 
                 const size_t size = items.size();
+                const size_t queuesCount = m_Queues.size();
+                // contiguous chunks keep neighbour items on the same consumer
+                const size_t chunkSize = std::max<size_t>((size + queuesCount - 1) / queuesCount, 1);
+                const size_t firstQueue = getNextQueueIndex();
+                const qint64 enqueuedAt = m_Telemetry.getTimestamp();
+
                 for (size_t i = 0; i < size; ++i) {
                     auto &item = items.at(i);
 
                     Common::flag_t flags = commonFlags;
                     if (i % m_DelayPeriod == 0) { Common::SetFlag(flags, FlagIsWithDelay); }
 
-                    m_Queue.emplace_back(item, flags, batchID);
+                    const size_t queueIndex = (firstQueue + i / chunkSize) % queuesCount;
+                    m_Queues[queueIndex].m_Lanes[lane].emplace_back(item, flags, batchID, m_Epoch, enqueuedAt);
                 }
 
-                if (wasEmpty) {
-                    m_WaitAnyItem.wakeOne();
+                if (size > 0) {
+                    m_Outstanding[m_Epoch] += (int)size;
+                    m_Telemetry.recordEnqueued((int)size);
+                    syncPendingLoadUnsafe();
+                    m_WaitAnyItem.wakeAll();
                 }
             }
             m_QueueMutex.unlock();
@@ -146,10 +235,123 @@ namespace Common {
             return batchID;
         }
 
+        // keyed items can be moved between lanes later or superseded one by one
+        batch_id_t submitItems(const std::vector<std::shared_ptr<T> > &items,
+                               const std::vector<item_key_t> &keys,
+                               ProcessingLane lane) {
+            Q_ASSERT(items.size() == keys.size());
+            if (m_Cancel || m_IsStopping) {
+                return INVALID_BATCH_ID;
+            }
+
+            batch_id_t batchID;
+            m_QueueMutex.lock();
+            {
+                batchID = getNextBatchID();
+
+                const size_t size = std::min(items.size(), keys.size());
+                for (size_t i = 0; i < size; ++i) {
+                    enqueueUnsafe(items.at(i), lane, batchID, keys.at(i), false);
+                }
+
+                if (size > 0) {
+                    syncPendingLoadUnsafe();
+                    m_WaitAnyItem.wakeAll();
+                }
+            }
+            m_QueueMutex.unlock();
+
+            return batchID;
+        }
+
+        // pending keyed items from higher lanes go to the back of the lower one
+        // keys that are not pending or are already low enough are ignored
+        int demoteItems(const std::vector<item_key_t> &keys, ProcessingLane lane) {
+            int demotedCount = 0;
+
+            m_QueueMutex.lock();
+            {
+                const qint64 enqueuedAt = m_Telemetry.getTimestamp();
+
+                for (auto key: keys) {
+                    auto it = m_PendingByKey.find(key);
+                    if (it == m_PendingByKey.end()) { continue; }
+
+                    PendingKeyed &pending = it.value();
+                    if (pending.m_Lane >= (int)lane) { continue; }
+
+                    // queued entry becomes stale and is skipped when taken
+                    pending.m_Sequence = ++m_KeySequence;
+                    pending.m_Lane = (int)lane;
+
+                    m_Queues[getNextQueueIndex()].m_Lanes[lane].emplace_back(std::shared_ptr<T>(), 0, pending.m_BatchID,
+                                                                             pending.m_Epoch, enqueuedAt,
+                                                                             key, pending.m_Sequence);
+                    m_Outstanding[pending.m_Epoch]++;
+                    demotedCount++;
+                }
+
+                if (demotedCount > 0) {
+                    syncPendingLoadUnsafe();
+                }
+            }
+            m_QueueMutex.unlock();
+
+            return demotedCount;
+        }
+
+        // pending keyed items are dropped right away so whatever they hold is released
+        int cancelItems(const std::vector<item_key_t> &keys) {
+            int cancelledCount = 0;
+            bool isEmpty = false;
+
+            m_QueueMutex.lock();
+            {
+                for (auto key: keys) {
+                    cancelledCount += m_PendingByKey.remove(key);
+                }
+
+                if (cancelledCount > 0) {
+                    // otherwise stale entries count as pending work until taken
+                    removeStaleEntriesUnsafe();
+
+                    isEmpty = areQueuesEmptyUnsafe();
+                    syncPendingLoadUnsafe();
+
+                    if (hasReadySeparatorUnsafe() || m_IsStopping) {
+                        m_WaitAnyItem.wakeAll();
+                    }
+                }
+            }
+            m_QueueMutex.unlock();
+
+            if (isEmpty) {
+                onQueueIsEmpty();
+            }
+
+            return cancelledCount;
+        }
+
         void cancelPendingJobs() {
             m_QueueMutex.lock();
             {
-                m_Queue.clear();
+                for (auto &queue: m_Queues) {
+                    for (auto &lane: queue.m_Lanes) {
+                        for (auto &entry: lane) {
+                            releaseEpochUnsafe(entry.m_Epoch);
+                        }
+
+                        lane.clear();
+                    }
+                }
+
+                m_PendingByKey.clear();
+                m_Separators.clear();
+                syncPendingLoadUnsafe();
+
+                if (m_IsStopping) {
+                    m_WaitAnyItem.wakeAll();
+                }
             }
             m_QueueMutex.unlock();
 
@@ -162,13 +364,37 @@ namespace Common {
             bool isEmpty = false;
             m_QueueMutex.lock();
             {
-                m_Queue.erase(std::remove_if(m_Queue.begin(), m_Queue.end(),
-                                             [&batchID](const ItemType &item) {
-                    return std::get<2>(item) == batchID;
-                }),
-                              m_Queue.end());
+                for (auto &queue: m_Queues) {
+                    for (auto &lane: queue.m_Lanes) {
+                        auto it = std::remove_if(lane.begin(), lane.end(),
+                                                 [&batchID](const QueueEntry &entry) {
+                            return entry.m_BatchID == batchID;
+                        });
+
+                        for (auto removedIt = it; removedIt != lane.end(); ++removedIt) {
+                            releaseEpochUnsafe(removedIt->m_Epoch);
+                        }
+
+                        lane.erase(it, lane.end());
+                    }
+                }
 
-                isEmpty = m_Queue.empty();
+                // queued entries of cancelled keyed items will be skipped when taken
+                auto keyIt = m_PendingByKey.begin();
+                while (keyIt != m_PendingByKey.end()) {
+                    if (keyIt.value().m_BatchID == batchID) {
+                        keyIt = m_PendingByKey.erase(keyIt);
+                    } else {
+                        ++keyIt;
+                    }
+                }
+
+                isEmpty = areQueuesEmptyUnsafe();
+                syncPendingLoadUnsafe();
+
+                if (hasReadySeparatorUnsafe() || m_IsStopping) {
+                    m_WaitAnyItem.wakeAll();
+                }
             }
             m_QueueMutex.unlock();
 
@@ -179,17 +405,37 @@ namespace Common {
 
         bool hasPendingJobs() {
             QMutexLocker locker(&m_QueueMutex);
-            bool isEmpty = m_Queue.empty();
+            bool isEmpty = areQueuesEmptyUnsafe() && m_Separators.empty();
             return !isEmpty;
         }
 
         bool isCancelled() const { return m_Cancel; }
         bool isRunning() const { return m_IsRunning; }
+        int getWorkersCount() const { return (int)m_Queues.size(); }
+
+        // opt-in: drain up to maxBatchSize items with one lock and pass them to processBatch()
+        void setMaxBatchSize(size_t maxBatchSize) { m_MaxBatchSize = std::max<size_t>(maxBatchSize, 1); }
+        size_t getMaxBatchSize() const { return m_MaxBatchSize; }
+
+        Helpers::QueueTelemetry &getTelemetry() { return m_Telemetry; }
+        void logTelemetry() const { m_Telemetry.logSummary(); }
+
+        // can be changed from other thread while worker is running
+        void setThrottlingPolicy(Helpers::ThrottlingPolicy policy) { m_ThrottlingPolicy = policy; }
+        Helpers::ThrottlingPolicy getThrottlingPolicy() const { return m_ThrottlingPolicy; }
+
+        void setLoadPriority(Helpers::LoadPriority priority) {
+            QMutexLocker locker(&m_QueueMutex);
+            Helpers::LoadMonitor &monitor = Helpers::LoadMonitor::getInstance();
+            monitor.addPendingWork(m_LoadPriority, -m_ReportedPendingCount);
+            monitor.addPendingWork(priority, m_ReportedPendingCount);
+            m_LoadPriority = priority;
+        }
 
         void doWork() {
             if (initWorker()) {
                 m_IsRunning = true;
-                runWorkerLoop();
+                runWorkers();
                 m_IsRunning = false;
             } else {
                 m_Cancel = true;
@@ -198,20 +444,29 @@ namespace Common {
             workerStopped();
         }
 
+        // when not immediately, consumers exit only after everything
+        // submitted before the stop (items and separators) is processed
         void stopWorking(bool immediately=true) {
-            m_Cancel = true;
+            if (immediately) {
+                m_Cancel = true;
+            } else {
+                m_IsStopping = true;
+            }
 
             m_QueueMutex.lock();
             {
                 if (immediately) {
-                    m_Queue.clear();
-                }
+                    for (auto &queue: m_Queues) {
+                        for (auto &lane: queue.m_Lanes) { lane.clear(); }
+                    }
 
-                Common::flag_t flags = 0;
-                Common::SetFlag(flags, FlagIsStopper);
+                    m_PendingByKey.clear();
+                    m_Separators.clear();
+                    m_Outstanding.clear();
+                    syncPendingLoadUnsafe();
+                }
 
-                m_Queue.emplace_back(std::shared_ptr<T>(), flags, INVALID_BATCH_ID);
-                m_WaitAnyItem.wakeOne();
+                m_WaitAnyItem.wakeAll();
             }
             m_QueueMutex.unlock();
         }
@@ -232,9 +487,39 @@ namespace Common {
             processOneItem(item);
         }
 
-        void runWorkerLoop() {
+        // called instead of processOneItemEx() when max batch size is more than 1;
+        // batch never contains separators
+        virtual void processBatch(std::vector<ItemType> &batch) {
+            for (auto &item: batch) {
+                if (m_Cancel) { break; }
+                processOneItemEx(std::get<0>(item), std::get<2>(item), std::get<1>(item));
+            }
+        }
+
+        void runWorkers() {
+            const size_t workersCount = m_Queues.size();
+            LOG_INFO << "Starting" << workersCount << "consumer(s)";
+
             m_IdleEvent.set();
 
+            // consumer #0 runs in the thread the worker was moved to
+            std::vector<std::thread> helpers;
+            helpers.reserve(workersCount - 1);
+            for (size_t i = 1; i < workersCount; ++i) {
+                helpers.emplace_back([this, i]() { runWorkerLoop(i); });
+            }
+
+            runWorkerLoop(0);
+
+            for (auto &helper: helpers) {
+                helper.join();
+            }
+        }
+
+        void runWorkerLoop(size_t queueIndex) {
+            std::vector<ItemType> batch;
+            std::vector<epoch_t> epochs;
+
             for (;;) {
                 if (m_Cancel) {
                     LOG_INFO << "Cancelled. Exiting...";
@@ -242,62 +527,331 @@ namespace Common {
                 }
 
                 bool noMoreItems = false;
-                std::shared_ptr<T> item;
-                Common::flag_t flags = 0;
-                batch_id_t batchID = INVALID_BATCH_ID;
+                bool isSeparator = false;
+                batch.clear();
+                epochs.clear();
+
+                bool isDrained = false;
 
                 m_QueueMutex.lock();
                 {
-                    while (m_Queue.empty()) {
+                    while (!m_Cancel && !hasReadySeparatorUnsafe() && areQueuesEmptyUnsafe() &&
+                           !isDrainedUnsafe()) {
                         bool waitResult = m_WaitAnyItem.wait(&m_QueueMutex);
                         if (!waitResult) {
                             LOG_WARNING << "Waiting failed for new items";
                         }
                     }
 
-                    auto &nextItem = m_Queue.front();
-                    item = std::get<0>(nextItem);
-                    flags = std::get<1>(nextItem);
-                    batchID = std::get<2>(nextItem);
-                    m_Queue.pop_front();
+                    if (isDrainedUnsafe()) {
+                        // let other consumers exit too
+                        isDrained = true;
+                        m_WaitAnyItem.wakeAll();
+                    } else if (!m_Cancel) {
+                        if (hasReadySeparatorUnsafe()) {
+                            m_Separators.pop_front();
+                            Common::flag_t flags = 0;
+                            Common::SetFlag(flags, FlagIsSeparator);
+                            batch.emplace_back(std::shared_ptr<T>(), flags, INVALID_BATCH_ID);
+                            isSeparator = true;
+                        } else {
+                            QueueEntry entry;
+                            while ((batch.size() < m_MaxBatchSize) && takeItemUnsafe(queueIndex, entry)) {
+                                batch.emplace_back(entry.m_Item, entry.m_Flags, entry.m_BatchID);
+                                epochs.push_back(entry.m_Epoch);
+                            }
+
+                            noMoreItems = areQueuesEmptyUnsafe();
+                            syncPendingLoadUnsafe();
+                        }
 
-                    noMoreItems = m_Queue.empty();
+                        if (!batch.empty()) {
+                            m_ActiveCount++;
+                            m_IdleEvent.reset();
+                        }
+                    }
                 }
                 m_QueueMutex.unlock();
 
-                if ((item.get() == nullptr) && getIsStopperFlag(flags)) { break; }
+                if (isDrained) {
+                    LOG_INFO << "All items processed. Exiting...";
+                    break;
+                }
 
-                m_IdleEvent.reset();
-                {
-                    try {
-                        processOneItemEx(item, batchID, flags);
+                if (!batch.empty()) {
+                    Common::flag_t batchFlags = 0;
+
+                    if (!m_Cancel) {
+                        const qint64 startedAt = m_Telemetry.getTimestamp();
+
+                        try {
+                            if (isSeparator || (m_MaxBatchSize == 1)) {
+                                ItemType &first = batch.front();
+                                batchFlags = std::get<1>(first);
+                                processOneItemEx(std::get<0>(first), std::get<2>(first), batchFlags);
+                            } else {
+                                for (auto &item: batch) { batchFlags |= std::get<1>(item); }
+                                processBatch(batch);
+                            }
+                        }
+                        catch (...) {
+                            LOG_WARNING << "Exception while processing item!";
+                        }
+
+                        if (!isSeparator) {
+                            m_Telemetry.recordProcessed(startedAt, (int)batch.size());
+                            throttle(batchFlags);
+                        }
                     }
-                    catch (...) {
-                        LOG_WARNING << "Exception while processing item!";
+
+                    m_QueueMutex.lock();
+                    {
+                        for (auto epoch: epochs) {
+                            releaseEpochUnsafe(epoch);
+                        }
+
+                        m_ActiveCount--;
+                        if (m_ActiveCount == 0) {
+                            m_IdleEvent.set();
+                        }
+
+                        // separator could have been waiting for this item in other consumer
+                        if (hasReadySeparatorUnsafe()) {
+                            m_WaitAnyItem.wakeOne();
+                        } else if (isDrainedUnsafe()) {
+                            m_WaitAnyItem.wakeAll();
+                        }
                     }
+                    m_QueueMutex.unlock();
                 }
-                m_IdleEvent.set();
 
-                if (noMoreItems) {
+                if (noMoreItems && !m_Cancel) {
+                    m_Telemetry.logSummaryIfNeeded(WORKER_TELEMETRY_LOG_THRESHOLD);
                     onQueueIsEmpty();
                 }
             }
         }
 
+        void throttle(Common::flag_t flags) {
+            switch (m_ThrottlingPolicy) {
+            case Helpers::ThrottlingPolicy::NoThrottling:
+                break;
+            case Helpers::ThrottlingPolicy::FixedDelay:
+                if (getWithDelayFlag(flags)) {
+                    // force context switch for more imporant tasks
+                    QThread::msleep(WORKER_FIXED_DELAY);
+                }
+                break;
+            case Helpers::ThrottlingPolicy::Adaptive: {
+                Helpers::LoadMonitor &monitor = Helpers::LoadMonitor::getInstance();
+                int yieldedMs = 0;
+                // budget is checked every time so the worker resumes as soon as load drops
+                while (!m_Cancel &&
+                       (yieldedMs < monitor.getYieldBudgetMs(m_LoadPriority))) {
+                    QThread::msleep(WORKER_YIELD_QUANTUM);
+                    yieldedMs += WORKER_YIELD_QUANTUM;
+                }
+                break;
+            }
+            }
+        }
+
     private:
         inline batch_id_t getNextBatchID() {
             batch_id_t id = m_BatchID++;
             return id;
         }
 
+        inline size_t getNextQueueIndex() {
+            size_t index = m_NextQueue % m_Queues.size();
+            m_NextQueue++;
+            return index;
+        }
+
+        void enqueueUnsafe(const std::shared_ptr<T> &item, ProcessingLane lane, batch_id_t batchID, item_key_t key, bool toFront) {
+            std::shared_ptr<T> itemToQueue = item;
+            quint32 sequence = 0;
+
+            if (key != INVALID_ITEM_KEY) {
+                auto it = m_PendingByKey.find(key);
+                if (it != m_PendingByKey.end()) {
+                    PendingKeyed &pending = it.value();
+                    pending.m_Item = item;
+                    pending.m_BatchID = batchID;
+
+                    // queued entry will pick up the new item unless it has to be processed
+                    // sooner or a separator was submitted in between
+                    if ((pending.m_Epoch == m_Epoch) && ((int)lane >= pending.m_Lane)) { return; }
+                }
+
+                sequence = ++m_KeySequence;
+                // previously queued entry for this key (if any) becomes stale and is skipped
+                m_PendingByKey.insert(key, PendingKeyed{item, batchID, m_Epoch, sequence, (int)lane});
+                itemToQueue.reset();
+            }
+
+            const qint64 enqueuedAt = m_Telemetry.getTimestamp();
+            auto &queue = m_Queues[getNextQueueIndex()].m_Lanes[lane];
+            if (toFront) {
+                queue.emplace_front(itemToQueue, 0, batchID, m_Epoch, enqueuedAt, key, sequence);
+            } else {
+                queue.emplace_back(itemToQueue, 0, batchID, m_Epoch, enqueuedAt, key, sequence);
+            }
+
+            m_Outstanding[m_Epoch]++;
+            m_Telemetry.recordEnqueued(1);
+        }
+
+        void syncPendingLoadUnsafe() {
+            int pendingCount = 0;
+            for (auto &queue: m_Queues) {
+                for (auto &lane: queue.m_Lanes) {
+                    pendingCount += (int)lane.size();
+                }
+            }
+
+            m_Telemetry.recordDepth(pendingCount);
+
+            const int delta = pendingCount - m_ReportedPendingCount;
+            if (delta != 0) {
+                Helpers::LoadMonitor::getInstance().addPendingWork(m_LoadPriority, delta);
+                m_ReportedPendingCount = pendingCount;
+            }
+        }
+
+        bool areQueuesEmptyUnsafe() const {
+            for (auto &queue: m_Queues) {
+                for (auto &lane: queue.m_Lanes) {
+                    if (!lane.empty()) { return false; }
+                }
+            }
+
+            return true;
+        }
+
+        bool hasReadySeparatorUnsafe() const {
+            if (m_Separators.empty()) { return false; }
+            const epoch_t separatorEpoch = m_Separators.front();
+            // separator is ready when nothing from its or earlier epochs is queued or in progress
+            return m_Outstanding.empty() || (m_Outstanding.begin()->first > separatorEpoch);
+        }
+
+        // stopping consumers wait only for separators that still have to fire
+        bool isDrainedUnsafe() const {
+            return m_IsStopping && areQueuesEmptyUnsafe() && m_Separators.empty();
+        }
+
+        void releaseEpochUnsafe(epoch_t epoch) {
+            auto it = m_Outstanding.find(epoch);
+            if (it == m_Outstanding.end()) { return; }
+
+            it->second--;
+            if (it->second <= 0) {
+                m_Outstanding.erase(it);
+            }
+        }
+
+        // entry of a keyed item that was superseded, demoted or cancelled
+        bool isStaleEntryUnsafe(const QueueEntry &entry) const {
+            if (entry.m_Key == INVALID_ITEM_KEY) { return false; }
+
+            auto it = m_PendingByKey.constFind(entry.m_Key);
+            return (it == m_PendingByKey.constEnd()) || (it.value().m_Sequence != entry.m_Sequence);
+        }
+
+        void removeStaleEntriesUnsafe() {
+            for (auto &queue: m_Queues) {
+                for (auto &lane: queue.m_Lanes) {
+                    auto it = std::remove_if(lane.begin(), lane.end(),
+                                             [this](const QueueEntry &entry) {
+                        return isStaleEntryUnsafe(entry);
+                    });
+
+                    for (auto removedIt = it; removedIt != lane.end(); ++removedIt) {
+                        releaseEpochUnsafe(removedIt->m_Epoch);
+                    }
+
+                    lane.erase(it, lane.end());
+                }
+            }
+        }
+
+        bool popEntryUnsafe(size_t queueIndex, QueueEntry &entry) {
+            const size_t size = m_Queues.size();
+
+            for (int lane = 0; lane < LanesCount; ++lane) {
+                auto &ownQueue = m_Queues[queueIndex].m_Lanes[lane];
+                if (!ownQueue.empty()) {
+                    entry = ownQueue.front();
+                    ownQueue.pop_front();
+                    return true;
+                }
+
+                size_t victimIndex = queueIndex;
+                size_t victimSize = 0;
+                for (size_t i = 0; i < size; ++i) {
+                    const size_t queueSize = m_Queues[i].m_Lanes[lane].size();
+                    if ((i != queueIndex) && (queueSize > victimSize)) {
+                        victimIndex = i;
+                        victimSize = queueSize;
+                    }
+                }
+
+                if (victimSize > 0) {
+                    auto &victimQueue = m_Queues[victimIndex].m_Lanes[lane];
+                    entry = victimQueue.back();
+                    victimQueue.pop_back();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool takeItemUnsafe(size_t queueIndex, QueueEntry &entry) {
+            while (popEntryUnsafe(queueIndex, entry)) {
+                if (entry.m_Key == INVALID_ITEM_KEY) {
+                    m_Telemetry.recordDequeued(entry.m_EnqueuedAt);
+                    return true;
+                }
+
+                auto it = m_PendingByKey.find(entry.m_Key);
+                if ((it != m_PendingByKey.end()) && (it.value().m_Sequence == entry.m_Sequence)) {
+                    entry.m_Item = it.value().m_Item;
+                    entry.m_BatchID = it.value().m_BatchID;
+                    m_PendingByKey.erase(it);
+                    m_Telemetry.recordDequeued(entry.m_EnqueuedAt);
+                    return true;
+                }
+
+                // item was superseded by a newer entry or cancelled
+                releaseEpochUnsafe(entry.m_Epoch);
+            }
+
+            return false;
+        }
+
     private:
         Helpers::ManualResetEvent m_IdleEvent;
+        Helpers::QueueTelemetry m_Telemetry;
         QWaitCondition m_WaitAnyItem;
         QMutex m_QueueMutex;
-        std::deque<ItemType> m_Queue;
+        std::vector<ConsumerQueue> m_Queues;
+        QHash<item_key_t, PendingKeyed> m_PendingByKey;
+        std::deque<epoch_t> m_Separators;
+        std::map<epoch_t, int> m_Outstanding;
         batch_id_t m_BatchID;
+        epoch_t m_Epoch;
+        size_t m_NextQueue;
+        quint32 m_KeySequence;
+        size_t m_MaxBatchSize;
+        int m_ActiveCount;
+        int m_ReportedPendingCount;
         unsigned int m_DelayPeriod;
+        volatile Helpers::ThrottlingPolicy m_ThrottlingPolicy;
+        Helpers::LoadPriority m_LoadPriority;
         volatile bool m_Cancel;
+        volatile bool m_IsStopping;
         volatile bool m_IsRunning;
     };
 }
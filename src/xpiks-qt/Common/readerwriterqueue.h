@@ -13,8 +13,11 @@
 
 #include <QMutexLocker>
 #include <QMutex>
+#include <QAtomicInt>
+#include <QString>
 #include <vector>
 #include <memory>
+#include "../Helpers/queuetelemetry.h"
 
 namespace Common {
     // queue optimized for "many writers - 1 reader" case
@@ -22,14 +25,25 @@ namespace Common {
     class ReaderWriterQueue
     {
     public:
-        ReaderWriterQueue() {}
+        ReaderWriterQueue(const QString &name = QString("ReaderWriterQueue")):
+            m_Telemetry(name),
+            m_Size(0)
+        {}
 
     public:
         void push(const std::shared_ptr<T> &item) {
-            QMutexLocker writeLocker(&m_WriteMutex);
-            Q_UNUSED(writeLocker);
+            const qint64 timestamp = m_Telemetry.getTimestamp();
+
+            {
+                QMutexLocker writeLocker(&m_WriteMutex);
+                Q_UNUSED(writeLocker);
 
-            m_WriteQueue.push_back(item);
+                m_WriteQueue.push_back(item);
+                m_WriteTimestamps.push_back(timestamp);
+            }
+
+            m_Telemetry.recordEnqueued(1);
+            m_Telemetry.recordDepth(m_Size.fetchAndAddOrdered(1) + 1);
         }
 
         void reservePush(size_t n) {
@@ -37,6 +51,7 @@ namespace Common {
             Q_UNUSED(writeLocker);
 
             m_WriteQueue.reserve(n);
+            m_WriteTimestamps.reserve(n);
         }
 
         bool popAll(std::vector<std::shared_ptr<T> > &out) {
@@ -54,11 +69,19 @@ namespace Common {
                 }
 
                 if (!m_ReadQueue.empty()) {
+                    for (auto timestamp: m_ReadTimestamps) {
+                        m_Telemetry.recordDequeued(timestamp);
+                    }
+
+                    m_Size.fetchAndAddOrdered(-(int)m_ReadQueue.size());
+                    m_ReadTimestamps.clear();
                     m_ReadQueue.swap(out);
                     success = !out.empty();
                 }
             }
 
+            m_Telemetry.recordDepth(m_Size.load());
+
             return success;
         }
 
@@ -106,7 +129,10 @@ namespace Common {
                 }
 
                 if (!m_ReadQueue.empty()) {
+                    m_Telemetry.recordDequeued(m_ReadTimestamps.back());
+                    m_ReadTimestamps.pop_back();
                     m_ReadQueue.pop_back();
+                    m_Size.fetchAndAddOrdered(-1);
                     success = true;
                 }
             }
@@ -136,9 +162,17 @@ namespace Common {
 
                 m_ReadQueue.clear();
                 m_WriteQueue.clear();
+                m_ReadTimestamps.clear();
+                m_WriteTimestamps.clear();
+                m_Size.store(0);
             }
+
+            m_Telemetry.recordDepth(0);
         }
 
+        Helpers::QueueTelemetry &getTelemetry() { return m_Telemetry; }
+        void logTelemetry() const { m_Telemetry.logSummary(); }
+
         size_t size() {
             QMutexLocker readLocker(&m_ReadMutex);
             Q_UNUSED(readLocker);
@@ -159,13 +193,16 @@ namespace Common {
             if (size == 0) { return; }
 
             m_ReadQueue.reserve(size + m_ReadQueue.size());
+            m_ReadTimestamps.reserve(size + m_ReadTimestamps.size());
 
             // reverse in order to use pop_back() in read
             for (size_t i = size; i >= 1; i--) {
                 m_ReadQueue.push_back(m_WriteQueue[i - 1]);
+                m_ReadTimestamps.push_back(m_WriteTimestamps[i - 1]);
             }
 
             m_WriteQueue.clear();
+            m_WriteTimestamps.clear();
         }
 
     private:
@@ -173,6 +210,11 @@ namespace Common {
         QMutex m_WriteMutex;
         std::vector<std::shared_ptr<T> > m_ReadQueue;
         std::vector<std::shared_ptr<T> > m_WriteQueue;
+        // enqueue time of items in the same order as queues
+        std::vector<qint64> m_ReadTimestamps;
+        std::vector<qint64> m_WriteTimestamps;
+        Helpers::QueueTelemetry m_Telemetry;
+        QAtomicInt m_Size;
     };
 }
 
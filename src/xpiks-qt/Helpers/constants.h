@@ -44,7 +44,11 @@ namespace Constants {
     const char FAILED_PLUGINS_DIR[] = "invalid";
     const char IMAGE_CACHE_TABLE[] = "imgcache";
     const char VIDEO_CACHE_TABLE[] = "vidcache";
+    const char IMAGE_ACCESS_TABLE[] = "imgaccess";
+    const char VIDEO_ACCESS_TABLE[] = "vidaccess";
     const char METADATA_CACHE_TABLE[] = "metadatacache";
+    const char METADATA_SEARCH_TABLE[] = "metadatasearch";
+    const char METADATA_ACCESS_TABLE[] = "metadataaccess";
 
     // different for DEBUG and RELEASE
 
@@ -195,7 +199,15 @@ namespace Constants {
     const char saveSession[] = "saveSession";
     const char useProgressiveSuggestionPreviews[] = "useProgressiveSuggestionPreviews";
     const char progressiveSuggestionIncrement[] = "progressiveSuggestionIncrement";
+    const char metadataCacheMaxSizeMB[] = "metadataCacheMaxSizeMB";
+    const char imagesCacheMaxSizeMB[] = "imagesCacheMaxSizeMB";
+    const char videosCacheMaxSizeMB[] = "videosCacheMaxSizeMB";
     const char useDirectExiftoolExport[] = "useDirectExiftoolExport";
+    const char useExiv2[] = "useExiv2";
+    const char imageCachingThrottling[] = "imageCachingThrottling";
+    const char videoCachingThrottling[] = "videoCachingThrottling";
+    const char spellCheckThrottling[] = "spellCheckThrottling";
+    const char warningsThrottling[] = "warningsThrottling";
     const char suggestorSearchTypeIndex[] = "suggestorSearchTypeIndex";
     const char useAutoImport[] = "useAutoImport";
 }
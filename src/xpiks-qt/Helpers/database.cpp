@@ -10,6 +10,9 @@
 
 #include "database.h"
 #include <QDir>
+#include <QStringList>
+#include <QCryptographicHash>
+#include <QtEndian>
 #include <string>
 #include <cstring>
 #include <cmath>
@@ -21,6 +24,8 @@
 
 #define MEGABYTE (1024*1024)
 #define MAX_BLOB_BYTES (10*MEGABYTE)
+// has to be less than SQLITE_MAX_VARIABLE_NUMBER
+#define GET_MANY_CHUNK_SIZE 100
 
 namespace Helpers {
     QString ensureDBDirectoryExists(const QString &dbDirName) {
@@ -104,6 +109,27 @@ namespace Helpers {
         return !anyFault;
     }
 
+    bool bindSqliteText(sqlite3_stmt *statement, int index, const QString &text) {
+        Q_ASSERT(statement != nullptr);
+        bool anyFault = false;
+
+        const QByteArray utf8 = text.toUtf8();
+        int rc = sqlite3_bind_text(statement, index, utf8.data(), utf8.size(), SQLITE_TRANSIENT);
+        if (rc != SQLITE_OK) {
+            LOG_WARNING << "Failed to bind statement's text. Error:" << sqlite3_errstr(rc);
+            anyFault = true;
+        }
+
+        return !anyFault;
+    }
+
+    qint64 fullTextRowID(const QByteArray &key) {
+        // 63 bits of sha1 make collisions negligible for any realistic library
+        const QByteArray hash = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+        const quint64 prefix = qFromBigEndian<quint64>((const uchar *)hash.constData());
+        return (qint64)(prefix & Q_UINT64_C(0x7FFFFFFFFFFFFFFF));
+    }
+
     void finalizeSqliteStatement(sqlite3_stmt *statement) {
         if (statement != nullptr) {
             int rc = sqlite3_finalize(statement);
@@ -113,8 +139,111 @@ namespace Helpers {
         }
     }
 
-    Database::Database(int id, AsyncCoordinator *finalizeCoordinator):
+    bool prepareSqliteStatement(sqlite3 *database, const QString &sql, sqlite3_stmt **statement) {
+        std::string sqlStr = sql.toStdString();
+        int rc = sqlite3_prepare_v2(database, sqlStr.c_str(), -1, statement, 0);
+        if (rc != SQLITE_OK) {
+            LOG_WARNING << "Failed to prepare statement" << sql << "Error:" << sqlite3_errstr(rc);
+        }
+
+        return rc == SQLITE_OK;
+    }
+
+    bool getSqliteValue(sqlite3_stmt *getStatement, const QByteArray &key, QByteArray &value) {
+        int rc = 0;
+        bool success = false;
+
+        do {
+            if (!bindSqliteBlob(getStatement, 1, key)) { break; }
+
+            rc = sqlite3_step(getStatement);
+            if (rc != SQLITE_ROW) {
+                if (rc != SQLITE_DONE) {
+                    LOG_WARNING << "Failed to step GET statement. Error:" << sqlite3_errstr(rc);
+                }
+                break;
+            }
+
+            if (!readSqliteBlob(getStatement, 0, value)) { break; }
+
+            rc = sqlite3_step(getStatement);
+            if (rc != SQLITE_DONE) {
+                LOG_WARNING << "Table structure is wrong: another row with same key seems to exist.";
+                Q_ASSERT(false);
+                break;
+            }
+
+            success = true;
+        } while (false);
+
+        cleanupSqliteStatement(getStatement);
+
+        return success;
+    }
+
+    int getManySqliteValues(sqlite3_stmt *getManyStatement, const QVector<QByteArray> &keysList, QVector<QPair<QByteArray, QByteArray> > &keyValueList) {
+        int foundCount = 0;
+        const int size = keysList.size();
+
+        for (int chunkStart = 0; chunkStart < size; chunkStart += GET_MANY_CHUNK_SIZE) {
+            const int chunkEnd = qMin(chunkStart + GET_MANY_CHUNK_SIZE, size);
+            bool anyFault = false;
+            int rc = 0;
+
+            // same statement for every chunk: unused parameters stay NULL and match nothing
+            for (int i = chunkStart; i < chunkEnd; ++i) {
+                if (!bindSqliteBlob(getManyStatement, i - chunkStart + 1, keysList.at(i))) {
+                    anyFault = true;
+                    break;
+                }
+            }
+
+            if (!anyFault) {
+                while (SQLITE_ROW == (rc = sqlite3_step(getManyStatement))) {
+                    QByteArray key, value;
+
+                    if (!readSqliteBlob(getManyStatement, 0, key)) { continue; }
+                    if (!readSqliteBlob(getManyStatement, 1, value)) { continue; }
+
+                    keyValueList.append(QPair<QByteArray, QByteArray>(key, value));
+                    foundCount++;
+                }
+
+                if (rc != SQLITE_DONE) {
+                    LOG_WARNING << "Failed to step GET MANY statement. Error:" << sqlite3_errstr(rc);
+                }
+            }
+
+            cleanupSqliteStatement(getManyStatement);
+        }
+
+        return foundCount;
+    }
+
+    void foreachSqliteRow(sqlite3_stmt *allStatement, const std::function<bool (QByteArray &, QByteArray &)> &action) {
+        int rc = 0;
+
+        while (SQLITE_ROW == (rc = sqlite3_step(allStatement))) {
+            QByteArray key, value;
+
+            if (!readSqliteBlob(allStatement, 0, key)) { continue; }
+            if (!readSqliteBlob(allStatement, 1, value)) { continue; }
+
+            const bool shouldContinue = action(key, value);
+            if (!shouldContinue) { break; }
+        }
+
+        if ((rc != SQLITE_DONE) && (rc != SQLITE_ROW)) {
+            LOG_WARNING << "Error while going through the ALL statement." << sqlite3_errstr(rc);
+            Q_ASSERT(false);
+        }
+
+        cleanupSqliteStatement(allStatement);
+    }
+
+    Database::Database(int id, int readersCount, AsyncCoordinator *finalizeCoordinator):
         m_ID(id),
+        m_ReadersCount(readersCount),
         m_FinalizeCoordinator(finalizeCoordinator),
         m_Database(nullptr),
         m_IsOpened(false)
@@ -136,6 +265,9 @@ namespace Helpers {
         m_Started(false)
     {
         Q_ASSERT(database != nullptr);
+        // autocommit is off only inside of another transaction
+        if (sqlite3_get_autocommit(m_Database) == 0) { return; }
+
         int rc = sqlite3_exec(m_Database, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
         if (rc == SQLITE_OK) {
             m_Started = true;
@@ -144,6 +276,95 @@ namespace Helpers {
         }
     }
 
+    Database::Transaction::Transaction(Database *database):
+        Transaction(database->m_Database)
+    {
+    }
+
+    Database::ReadersPool::ReadersPool() {
+    }
+
+    bool Database::ReadersPool::open(const char *fullDbPath, int readersCount) {
+        LOG_DEBUG << fullDbPath << readersCount;
+        Q_ASSERT(m_Connections.empty());
+
+        int flags = 0;
+        flags |= SQLITE_OPEN_READONLY;
+        // every connection is used by one thread at a time
+        flags |= SQLITE_OPEN_NOMUTEX;
+
+        for (int i = 0; i < readersCount; ++i) {
+            sqlite3 *connection = nullptr;
+            const int result = sqlite3_open_v2(fullDbPath, &connection, flags, nullptr);
+            if (result != SQLITE_OK) {
+                LOG_WARNING << "Opening reader for" << fullDbPath << "failed! Error:" << sqlite3_errstr(result);
+                sqlite3_close(connection);
+                break;
+            }
+
+            m_FreeReaders.push_back((int)m_Connections.size());
+            m_Connections.push_back(connection);
+        }
+
+        return (int)m_Connections.size() == readersCount;
+    }
+
+    void Database::ReadersPool::close() {
+        LOG_DEBUG << m_Connections.size() << "reader(s)";
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        Q_ASSERT(m_FreeReaders.size() == m_Connections.size());
+
+        for (auto *connection: m_Connections) {
+            const int closeResult = sqlite3_close(connection);
+            if (closeResult != SQLITE_OK) {
+                LOG_WARNING << "Failed to close a reader. Error:" << sqlite3_errstr(closeResult);
+            }
+        }
+
+        m_Connections.clear();
+        m_FreeReaders.clear();
+    }
+
+    int Database::ReadersPool::acquire() {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        if (m_Connections.empty()) { return -1; }
+
+        while (m_FreeReaders.empty()) {
+            m_ReaderReleased.wait(&m_Mutex);
+        }
+
+        const int index = m_FreeReaders.back();
+        m_FreeReaders.pop_back();
+        return index;
+    }
+
+    void Database::ReadersPool::release(int index) {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        m_FreeReaders.push_back(index);
+        m_ReaderReleased.wakeOne();
+    }
+
+    Database::ReaderLocker::ReaderLocker(ReadersPool *readersPool):
+        m_ReadersPool(readersPool),
+        m_Index(-1)
+    {
+        if (m_ReadersPool != nullptr) {
+            m_Index = m_ReadersPool->acquire();
+        }
+    }
+
+    Database::ReaderLocker::~ReaderLocker() {
+        if (m_Index != -1) {
+            m_ReadersPool->release(m_Index);
+        }
+    }
+
     Database::Transaction::~Transaction() {
         if (!m_Started) { return; }
 
@@ -170,6 +391,7 @@ namespace Helpers {
             doClose();
         } else {
             m_IsOpened = true;
+            m_FullDbPath = QByteArray(fullDbPath);
             LOG_INFO << "Database" << fullDbPath << "has been opened";
         }
 
@@ -184,20 +406,24 @@ namespace Helpers {
         }
     }
 
-    bool Database::initialize() {
-        LOG_DEBUG << "#" << m_ID;
+    bool Database::initialize(bool incrementalVacuum) {
+        LOG_DEBUG << "#" << m_ID << incrementalVacuum;
         Q_ASSERT(m_IsOpened);
         Q_ASSERT(m_Database != nullptr);
 
-        executeStatement("PRAGMA auto_vacuum = 0;");
+        executeStatement(incrementalVacuum ? "PRAGMA auto_vacuum = INCREMENTAL;" : "PRAGMA auto_vacuum = 0;");
         executeStatement("PRAGMA cache_size = -20000;");
         executeStatement("PRAGMA case_sensitive_like = true;");
         executeStatement("PRAGMA encoding = \"UTF-8\";");
+        // WAL with normal locking lets read-only connections work in parallel with the writer
         executeStatement("PRAGMA journal_mode = WAL;");
-        executeStatement("PRAGMA locking_mode = EXCLUSIVE;");
         executeStatement("PRAGMA synchronous = NORMAL;");
         // executeStatement("PRAGMA quick_check;");
 
+        if ((m_ReadersCount > 0) && !m_ReadersPool.open(m_FullDbPath.data(), m_ReadersCount)) {
+            LOG_WARNING << "Failed to open all readers for #" << m_ID;
+        }
+
         return true;
     }
 
@@ -207,6 +433,10 @@ namespace Helpers {
         for (auto &table: m_Tables) {
             table->finalize();
         }
+
+        for (auto &table: m_FullTextTables) {
+            table->finalize();
+        }
     }
 
     void Database::sync() {
@@ -217,6 +447,33 @@ namespace Helpers {
         }
     }
 
+    bool Database::getSizeBytes(qint64 &totalBytes, qint64 &freeBytes) {
+        qint64 pageSize = 0, pageCount = 0, freelistCount = 0;
+
+        const bool success = queryPragma("PRAGMA page_size;", pageSize) &&
+                queryPragma("PRAGMA page_count;", pageCount) &&
+                queryPragma("PRAGMA freelist_count;", freelistCount);
+
+        if (success) {
+            totalBytes = pageSize * pageCount;
+            freeBytes = pageSize * freelistCount;
+        }
+
+        return success;
+    }
+
+    bool Database::getIsIncrementalVacuum() {
+        qint64 autoVacuum = 0;
+        // 2 stands for INCREMENTAL
+        return queryPragma("PRAGMA auto_vacuum;", autoVacuum) && (autoVacuum == 2);
+    }
+
+    bool Database::vacuumIncrementally(int pagesCount) {
+        LOG_DEBUG << "#" << m_ID << pagesCount;
+        const std::string pragma = QString("PRAGMA incremental_vacuum(%1);").arg(pagesCount).toStdString();
+        return executeStatement(pragma.c_str());
+    }
+
     std::shared_ptr<Database::Table> Database::getTable(const QString &name) {
         LOG_DEBUG << "#" << m_ID << name;
         std::shared_ptr<Database::Table> table;
@@ -228,7 +485,7 @@ namespace Helpers {
 
         int rc = sqlite3_exec(m_Database, createStr.c_str(), nullptr, nullptr, nullptr);
         if (rc == SQLITE_OK) {
-            table.reset(new Database::Table(m_Database, name));
+            table.reset(new Database::Table(m_Database, &m_ReadersPool, name));
 
             if (table->initialize()) {
                 m_Tables.push_back(table);
@@ -244,16 +501,44 @@ namespace Helpers {
         return table;
     }
 
-    Database::Table::Table(sqlite3 *database, const QString &tableName):
+    std::shared_ptr<Database::FullTextTable> Database::getFullTextTable(const QString &name, const QStringList &columns, const QVector<double> &weights) {
+        LOG_DEBUG << "#" << m_ID << name << columns;
+        Q_ASSERT(columns.size() == weights.size());
+        std::shared_ptr<Database::FullTextTable> table;
+
+        QString createSql = QString("CREATE VIRTUAL TABLE IF NOT EXISTS %1 USING fts5("
+                                    "key UNINDEXED, category UNINDEXED, %2, "
+                                    "tokenize = 'unicode61 remove_diacritics 1');").arg(name).arg(columns.join(", "));
+        std::string createStr = createSql.toStdString();
+
+        int rc = sqlite3_exec(m_Database, createStr.c_str(), nullptr, nullptr, nullptr);
+        if (rc == SQLITE_OK) {
+            table.reset(new Database::FullTextTable(m_Database, &m_ReadersPool, name, columns, weights));
+
+            if (table->initialize()) {
+                m_FullTextTables.push_back(table);
+            } else {
+                LOG_WARNING << "Initializing the full text table" << name << "failed";
+                table->finalize();
+                table.reset();
+            }
+        } else {
+            LOG_WARNING << "Creating a full text table failed! Error:" << sqlite3_errstr(rc);
+        }
+
+        return table;
+    }
+
+    Database::Table::Table(sqlite3 *database, ReadersPool *readersPool, const QString &tableName):
         m_TableName(tableName),
         m_Database(database),
-        m_GetStatement(nullptr),
+        m_ReadersPool(readersPool),
         m_SetStatement(nullptr),
         m_AddStatement(nullptr),
-        m_DelStatement(nullptr),
-        m_AllStatement(nullptr)
+        m_DelStatement(nullptr)
     {
         Q_ASSERT(database != nullptr);
+        Q_ASSERT(readersPool != nullptr);
         Q_ASSERT(Helpers::is7BitAscii(tableName.toUtf8()));
     }
 
@@ -261,50 +546,49 @@ namespace Helpers {
         LOG_DEBUG << m_TableName;
         Q_ASSERT(m_Database != nullptr);
 
-        int rc = 0;
         bool anyError = false;
 
         do {
-            std::string selectStr = QString("SELECT value FROM %1 WHERE key=?").arg(m_TableName).toStdString();
-            rc = sqlite3_prepare_v2(m_Database, selectStr.c_str(), -1, &m_GetStatement, 0);
-            if (rc != SQLITE_OK) {
-                LOG_WARNING << "Failed to prepare GET statement:" << sqlite3_errstr(rc);
+            if (!prepareReadStatements(m_Database, m_WriterReadStatements)) {
                 anyError = true;
                 break;
             }
 
-            std::string insertStr = QString("INSERT OR REPLACE INTO %1 (key, value) VALUES (?, ?)").arg(m_TableName).toStdString();
-            rc = sqlite3_prepare_v2(m_Database, insertStr.c_str(), -1, &m_SetStatement, 0);
-            if (rc != SQLITE_OK) {
-                LOG_WARNING << "Failed to prepare SET statement:" << sqlite3_errstr(rc);
+            if (!prepareSqliteStatement(m_Database,
+                                        QString("INSERT OR REPLACE INTO %1 (key, value) VALUES (?, ?)").arg(m_TableName),
+                                        &m_SetStatement)) {
                 anyError = true;
                 break;
             }
 
-            std::string addStr = QString("INSERT OR IGNORE INTO %1 (key, value) VALUES (?, ?)").arg(m_TableName).toStdString();
-            rc = sqlite3_prepare_v2(m_Database, addStr.c_str(), -1, &m_AddStatement, 0);
-            if (rc != SQLITE_OK) {
-                LOG_WARNING << "Failed to prepare ADD statement:" << sqlite3_errstr(rc);
+            if (!prepareSqliteStatement(m_Database,
+                                        QString("INSERT OR IGNORE INTO %1 (key, value) VALUES (?, ?)").arg(m_TableName),
+                                        &m_AddStatement)) {
                 anyError = true;
                 break;
             }
 
-            std::string deleteStr = QString("DELETE FROM %1 WHERE key=?").arg(m_TableName).toStdString();
-            rc = sqlite3_prepare_v2(m_Database, deleteStr.c_str(), -1, &m_DelStatement, 0);
-            if (rc != SQLITE_OK) {
-                LOG_WARNING << "Failed to prepare DEL statement:" << sqlite3_errstr(rc);
+            if (!prepareSqliteStatement(m_Database,
+                                        QString("DELETE FROM %1 WHERE key=?").arg(m_TableName),
+                                        &m_DelStatement)) {
                 anyError = true;
                 break;
             }
+        } while (false);
 
-            std::string selectAllStr = QString("SELECT key, value FROM %1").arg(m_TableName).toStdString();
-            rc = sqlite3_prepare_v2(m_Database, selectAllStr.c_str(), -1, &m_AllStatement, 0);
-            if (rc != SQLITE_OK) {
-                LOG_WARNING << "Failed to prepare SELECT ALL statement:" << sqlite3_errstr(rc);
-                anyError = true;
-                break;
+        if (!anyError) {
+            const int readersCount = m_ReadersPool->getSize();
+            m_ReaderStatements.resize(readersCount);
+
+            for (int i = 0; i < readersCount; ++i) {
+                if (!prepareReadStatements(m_ReadersPool->getConnection(i), m_ReaderStatements[i])) {
+                    LOG_WARNING << "Failed to prepare reader statements. Falling back to the writer connection";
+                    for (auto &statements: m_ReaderStatements) { finalizeReadStatements(statements); }
+                    m_ReaderStatements.clear();
+                    break;
+                }
             }
-        } while (false);
+        }
 
         return !anyError;
     }
@@ -312,49 +596,39 @@ namespace Helpers {
     void Database::Table::finalize() {
         LOG_DEBUG << m_TableName;
 
-        finalizeSqliteStatement(m_GetStatement);
+        finalizeReadStatements(m_WriterReadStatements);
+        for (auto &statements: m_ReaderStatements) {
+            finalizeReadStatements(statements);
+        }
+
         finalizeSqliteStatement(m_SetStatement);
         finalizeSqliteStatement(m_AddStatement);
         finalizeSqliteStatement(m_DelStatement);
-        finalizeSqliteStatement(m_AllStatement);
     }
 
     bool Database::Table::tryGetValue(const QByteArray &key, QByteArray &value) {
-        Q_ASSERT(m_GetStatement != nullptr);
         Q_ASSERT(!key.isEmpty());
         if (key.isEmpty()) { return false; }
 
-        int rc = 0;
-        bool success = false;
-
         LOG_INTEGR_TESTS_OR_DEBUG << key;
 
-        do {
-            if (!bindSqliteBlob(m_GetStatement, 1, key)) { break; }
-
-            rc = sqlite3_step(m_GetStatement);
-            if (rc != SQLITE_ROW) {
-                if (rc != SQLITE_DONE) {
-                    LOG_WARNING << "Failed to step GET statement. Error:" << sqlite3_errstr(rc);
-                }
-                break;
-            }
-
-            if (!readSqliteBlob(m_GetStatement, 0, value)) { break; }
+        bool success = false;
+        withReadStatements([&](ReadStatements &statements) {
+            success = getSqliteValue(statements.m_GetStatement, key, value);
+        });
 
-            rc = sqlite3_step(m_GetStatement);
-            if (rc != SQLITE_DONE) {
-                LOG_WARNING << "Table structure is wrong: another row with same key seems to exist.";
-                Q_ASSERT(false);
-                break;
-            }
+        return success;
+    }
 
-            success = true;
-        } while (false);
+    int Database::Table::tryGetMany(const QVector<QByteArray> &keysList, QVector<QPair<QByteArray, QByteArray> > &keyValueList) {
+        LOG_DEBUG << keysList.size() << "key(s)";
 
-        cleanupSqliteStatement(m_GetStatement);
+        int foundCount = 0;
+        withReadStatements([&](ReadStatements &statements) {
+            foundCount = getManySqliteValues(statements.m_GetManyStatement, keysList, keyValueList);
+        });
 
-        return success;
+        return foundCount;
     }
 
     bool Database::Table::trySetValue(const QByteArray &key, const QByteArray &value) {
@@ -516,35 +790,421 @@ namespace Helpers {
     }
 
     void Database::Table::foreachRow(const std::function<bool (QByteArray &, QByteArray &)> &action) {
-        Q_ASSERT(m_AllStatement != nullptr);
         LOG_DEBUG << "#";
 
-        int rc = 0;
+        withReadStatements([&](ReadStatements &statements) {
+            foreachSqliteRow(statements.m_AllStatement, action);
+        });
+    }
+
+    int Database::Table::getPage(const QByteArray &afterKey, int limit, QVector<QPair<QByteArray, QByteArray> > &keyValueList) {
+        LOG_DEBUG << limit;
+
+        int foundCount = 0;
+        withReadStatements([&](ReadStatements &statements) {
+            sqlite3_stmt *pageStatement = statements.m_PageStatement;
+            int rc = 0;
+
+            do {
+                // empty blob is less than any key
+                rc = afterKey.isEmpty() ? sqlite3_bind_zeroblob(pageStatement, 1, 0) :
+                                          (bindSqliteBlob(pageStatement, 1, afterKey) ? SQLITE_OK : SQLITE_ERROR);
+                if (rc != SQLITE_OK) { break; }
+
+                rc = sqlite3_bind_int(pageStatement, 2, limit);
+                if (rc != SQLITE_OK) { break; }
+
+                while (SQLITE_ROW == (rc = sqlite3_step(pageStatement))) {
+                    QByteArray key, value;
+
+                    if (!readSqliteBlob(pageStatement, 0, key)) { continue; }
+                    if (!readSqliteBlob(pageStatement, 1, value)) { continue; }
+
+                    keyValueList.append(QPair<QByteArray, QByteArray>(key, value));
+                    foundCount++;
+                }
+
+                if (rc != SQLITE_DONE) {
+                    LOG_WARNING << "Failed to step PAGE statement. Error:" << sqlite3_errstr(rc);
+                }
+            } while (false);
+
+            cleanupSqliteStatement(pageStatement);
+        });
+
+        return foundCount;
+    }
+
+    bool Database::Table::prepareReadStatements(sqlite3 *database, ReadStatements &statements) {
+        bool anyError = false;
 
         do {
-            while (SQLITE_ROW == (rc = sqlite3_step(m_AllStatement))) {
-                QByteArray key, value;
+            if (!prepareSqliteStatement(database,
+                                        QString("SELECT value FROM %1 WHERE key=?").arg(m_TableName),
+                                        &statements.m_GetStatement)) {
+                anyError = true;
+                break;
+            }
 
-                if (!readSqliteBlob(m_AllStatement, 0, key)) { continue; }
-                if (!readSqliteBlob(m_AllStatement, 1, value)) { continue; }
+            QStringList placeholders;
+            placeholders.reserve(GET_MANY_CHUNK_SIZE);
+            for (int i = 0; i < GET_MANY_CHUNK_SIZE; ++i) { placeholders.append("?"); }
 
-                const bool shouldContinue = action(key, value);
-                if (!shouldContinue) { break; }
+            if (!prepareSqliteStatement(database,
+                                        QString("SELECT key, value FROM %1 WHERE key IN (%2)").arg(m_TableName).arg(placeholders.join(',')),
+                                        &statements.m_GetManyStatement)) {
+                anyError = true;
+                break;
             }
 
-            if ((rc != SQLITE_DONE) && (rc != SQLITE_ROW)) {
-                LOG_WARNING << "Error while going through the ALL statement." << sqlite3_errstr(rc);
-                Q_ASSERT(false);
+            if (!prepareSqliteStatement(database,
+                                        QString("SELECT key, value FROM %1").arg(m_TableName),
+                                        &statements.m_AllStatement)) {
+                anyError = true;
+                break;
+            }
+
+            if (!prepareSqliteStatement(database,
+                                        QString("SELECT key, value FROM %1 WHERE key > ? ORDER BY key LIMIT ?").arg(m_TableName),
+                                        &statements.m_PageStatement)) {
+                anyError = true;
+                break;
+            }
+        } while (false);
+
+        return !anyError;
+    }
+
+    void Database::Table::finalizeReadStatements(ReadStatements &statements) {
+        finalizeSqliteStatement(statements.m_GetStatement);
+        finalizeSqliteStatement(statements.m_GetManyStatement);
+        finalizeSqliteStatement(statements.m_AllStatement);
+        finalizeSqliteStatement(statements.m_PageStatement);
+
+        statements = ReadStatements();
+    }
+
+    void Database::Table::withReadStatements(const std::function<void (ReadStatements &)> &action) {
+        ReaderLocker readerLocker(m_ReaderStatements.empty() ? nullptr : m_ReadersPool);
+        const int readerIndex = readerLocker.getIndex();
+
+        if (readerIndex != -1) {
+            action(m_ReaderStatements[readerIndex]);
+        } else {
+            QMutexLocker locker(&m_WriterReadMutex);
+            Q_UNUSED(locker);
+
+            action(m_WriterReadStatements);
+        }
+    }
+
+    Database::FullTextTable::FullTextTable(sqlite3 *database, ReadersPool *readersPool, const QString &tableName,
+                                           const QStringList &columns, const QVector<double> &weights):
+        m_TableName(tableName),
+        m_Columns(columns),
+        m_Weights(weights),
+        m_Database(database),
+        m_ReadersPool(readersPool),
+        m_WriterSearchStatement(nullptr),
+        m_ExistsStatement(nullptr),
+        m_InsertStatement(nullptr),
+        m_DeleteStatement(nullptr)
+    {
+        Q_ASSERT(database != nullptr);
+        Q_ASSERT(readersPool != nullptr);
+        Q_ASSERT(Helpers::is7BitAscii(tableName.toUtf8()));
+    }
+
+    bool Database::FullTextTable::initialize() {
+        LOG_DEBUG << m_TableName;
+        Q_ASSERT(m_Database != nullptr);
+
+        // key and category are not indexed and do not affect the rank
+        QStringList bm25Args;
+        bm25Args << m_TableName << "0.0" << "0.0";
+        for (double weight: m_Weights) { bm25Args << QString::number(weight, 'f', 2); }
+
+        QStringList placeholders;
+        for (int i = 0; i < m_Columns.size(); ++i) { placeholders.append("?"); }
+
+        const QString searchSql = QString("SELECT key FROM %1 WHERE %1 MATCH ?1 AND (?2 = 0 OR category = ?2) "
+                                          "ORDER BY bm25(%2) LIMIT ?3 OFFSET ?4").arg(m_TableName).arg(bm25Args.join(", "));
+
+        bool anyError = false;
+
+        do {
+            if (!prepareSqliteStatement(m_Database, searchSql, &m_WriterSearchStatement)) {
+                anyError = true;
+                break;
+            }
+
+            if (!prepareSqliteStatement(m_Database,
+                                        QString("SELECT rowid FROM %1 WHERE rowid=?").arg(m_TableName),
+                                        &m_ExistsStatement)) {
+                anyError = true;
+                break;
+            }
+
+            if (!prepareSqliteStatement(m_Database,
+                                        QString("INSERT INTO %1 (rowid, key, category, %2) VALUES (?, ?, ?, %3)")
+                                        .arg(m_TableName).arg(m_Columns.join(", ")).arg(placeholders.join(", ")),
+                                        &m_InsertStatement)) {
+                anyError = true;
+                break;
+            }
+
+            if (!prepareSqliteStatement(m_Database,
+                                        QString("DELETE FROM %1 WHERE rowid=?").arg(m_TableName),
+                                        &m_DeleteStatement)) {
+                anyError = true;
+                break;
+            }
+        } while (false);
+
+        if (!anyError) {
+            const int readersCount = m_ReadersPool->getSize();
+
+            for (int i = 0; i < readersCount; ++i) {
+                sqlite3_stmt *statement = nullptr;
+                if (!prepareSqliteStatement(m_ReadersPool->getConnection(i), searchSql, &statement)) {
+                    LOG_WARNING << "Failed to prepare reader statements. Falling back to the writer connection";
+                    for (auto *readerStatement: m_ReaderSearchStatements) { finalizeSqliteStatement(readerStatement); }
+                    m_ReaderSearchStatements.clear();
+                    break;
+                }
+
+                m_ReaderSearchStatements.push_back(statement);
+            }
+        }
+
+        return !anyError;
+    }
+
+    void Database::FullTextTable::finalize() {
+        LOG_DEBUG << m_TableName;
+
+        finalizeSqliteStatement(m_WriterSearchStatement);
+        for (auto *statement: m_ReaderSearchStatements) {
+            finalizeSqliteStatement(statement);
+        }
+
+        finalizeSqliteStatement(m_ExistsStatement);
+        finalizeSqliteStatement(m_InsertStatement);
+        finalizeSqliteStatement(m_DeleteStatement);
+
+        m_WriterSearchStatement = nullptr;
+        m_ReaderSearchStatements.clear();
+        m_ExistsStatement = nullptr;
+        m_InsertStatement = nullptr;
+        m_DeleteStatement = nullptr;
+    }
+
+    bool Database::FullTextTable::isEmpty() {
+        LOG_DEBUG << m_TableName;
+
+        sqlite3_stmt *statement = nullptr;
+        if (!prepareSqliteStatement(m_Database, QString("SELECT rowid FROM %1 LIMIT 1").arg(m_TableName), &statement)) {
+            return false;
+        }
+
+        const int rc = sqlite3_step(statement);
+        if ((rc != SQLITE_ROW) && (rc != SQLITE_DONE)) {
+            LOG_WARNING << "Failed to step EMPTY statement. Error:" << sqlite3_errstr(rc);
+        }
+
+        finalizeSqliteStatement(statement);
+
+        return rc == SQLITE_DONE;
+    }
+
+    bool Database::FullTextTable::trySetMany(const QVector<FullTextRecord> &records) {
+        Q_ASSERT(m_InsertStatement != nullptr);
+        LOG_DEBUG << records.size() << "record(s)";
+
+        bool anyError = false;
+
+        Transaction t(m_Database);
+        Q_UNUSED(t);
+
+        for (auto &record: records) {
+            const qint64 rowID = fullTextRowID(record.m_Key);
+
+            if (!tryDeleteRecord(rowID) ||
+                    !tryInsertRecord(rowID, record)) {
+                LOG_WARNING << "Failed to set" << record.m_Key;
+                anyError = true;
+            }
+        }
+
+        return !anyError;
+    }
+
+    int Database::FullTextTable::tryAddMany(const QVector<FullTextRecord> &records) {
+        Q_ASSERT(m_InsertStatement != nullptr);
+        LOG_DEBUG << records.size() << "record(s)";
+
+        int addedCount = 0;
+
+        Transaction t(m_Database);
+        Q_UNUSED(t);
+
+        for (auto &record: records) {
+            const qint64 rowID = fullTextRowID(record.m_Key);
+            if (containsRecord(rowID)) { continue; }
+
+            if (tryInsertRecord(rowID, record)) {
+                addedCount++;
+            } else {
+                LOG_WARNING << "Failed to add" << record.m_Key;
+            }
+        }
+
+        return addedCount;
+    }
+
+    bool Database::FullTextTable::tryDeleteMany(const QVector<QByteArray> &keysList) {
+        Q_ASSERT(m_DeleteStatement != nullptr);
+        LOG_DEBUG << keysList.size() << "key(s)";
+
+        bool anyError = false;
+
+        Transaction t(m_Database);
+        Q_UNUSED(t);
+
+        for (auto &key: keysList) {
+            if (!tryDeleteRecord(fullTextRowID(key))) {
+                LOG_WARNING << "Failed to delete" << key;
+                anyError = true;
             }
+        }
+
+        return !anyError;
+    }
+
+    int Database::FullTextTable::search(const QString &matchExpression, int category, int limit, int offset, QVector<QByteArray> &keysList) {
+        LOG_INTEGR_TESTS_OR_DEBUG << matchExpression << category << limit << offset;
+
+        int foundCount = 0;
+
+        withSearchStatement([&](sqlite3_stmt *searchStatement) {
+            int rc = 0;
+
+            do {
+                if (!bindSqliteText(searchStatement, 1, matchExpression)) { break; }
+
+                if ((sqlite3_bind_int(searchStatement, 2, category) != SQLITE_OK) ||
+                        (sqlite3_bind_int(searchStatement, 3, limit) != SQLITE_OK) ||
+                        (sqlite3_bind_int(searchStatement, 4, offset) != SQLITE_OK)) {
+                    LOG_WARNING << "Failed to bind SEARCH parameters";
+                    break;
+                }
+
+                while (SQLITE_ROW == (rc = sqlite3_step(searchStatement))) {
+                    QByteArray key;
+                    if (!readSqliteBlob(searchStatement, 0, key)) { continue; }
+
+                    keysList.append(key);
+                    foundCount++;
+                }
+
+                if (rc != SQLITE_DONE) {
+                    // malformed match expression ends up here as well
+                    LOG_WARNING << "Failed to step SEARCH statement. Error:" << sqlite3_errstr(rc);
+                }
+            } while (false);
+
+            cleanupSqliteStatement(searchStatement);
+        });
+
+        return foundCount;
+    }
+
+    bool Database::FullTextTable::tryDeleteRecord(qint64 rowID) {
+        int rc = sqlite3_bind_int64(m_DeleteStatement, 1, rowID);
+        if (rc == SQLITE_OK) {
+            rc = sqlite3_step(m_DeleteStatement);
+            if (rc != SQLITE_DONE) {
+                LOG_WARNING << "Failed to step DELETE statement. Error:" << sqlite3_errstr(rc);
+            }
+        } else {
+            LOG_WARNING << "Failed to bind DELETE rowid. Error:" << sqlite3_errstr(rc);
+        }
+
+        cleanupSqliteStatement(m_DeleteStatement);
+
+        return rc == SQLITE_DONE;
+    }
+
+    bool Database::FullTextTable::tryInsertRecord(qint64 rowID, const FullTextRecord &record) {
+        Q_ASSERT(record.m_Values.size() == m_Columns.size());
+        if (record.m_Values.size() != m_Columns.size()) { return false; }
+
+        int rc = 0;
+        bool success = false;
+
+        do {
+            if (sqlite3_bind_int64(m_InsertStatement, 1, rowID) != SQLITE_OK) { break; }
+            if (!bindSqliteBlob(m_InsertStatement, 2, record.m_Key)) { break; }
+            if (sqlite3_bind_int(m_InsertStatement, 3, record.m_Category) != SQLITE_OK) { break; }
+
+            bool anyFault = false;
+            const int size = record.m_Values.size();
+            for (int i = 0; i < size; ++i) {
+                if (!bindSqliteText(m_InsertStatement, i + 4, record.m_Values.at(i))) {
+                    anyFault = true;
+                    break;
+                }
+            }
+
+            if (anyFault) { break; }
+
+            rc = sqlite3_step(m_InsertStatement);
+            if (rc != SQLITE_DONE) {
+                LOG_WARNING << "Failed to step INSERT statement. Error:" << sqlite3_errstr(rc);
+                break;
+            }
+
+            success = true;
         } while (false);
 
-        cleanupSqliteStatement(m_AllStatement);
+        cleanupSqliteStatement(m_InsertStatement);
+
+        return success;
+    }
+
+    bool Database::FullTextTable::containsRecord(qint64 rowID) {
+        bool contains = false;
+
+        int rc = sqlite3_bind_int64(m_ExistsStatement, 1, rowID);
+        if (rc == SQLITE_OK) {
+            rc = sqlite3_step(m_ExistsStatement);
+            contains = (rc == SQLITE_ROW);
+        }
+
+        cleanupSqliteStatement(m_ExistsStatement);
+
+        return contains;
+    }
+
+    void Database::FullTextTable::withSearchStatement(const std::function<void (sqlite3_stmt *)> &action) {
+        ReaderLocker readerLocker(m_ReaderSearchStatements.empty() ? nullptr : m_ReadersPool);
+        const int readerIndex = readerLocker.getIndex();
+
+        if (readerIndex != -1) {
+            action(m_ReaderSearchStatements[readerIndex]);
+        } else {
+            QMutexLocker locker(&m_WriterReadMutex);
+            Q_UNUSED(locker);
+
+            action(m_WriterSearchStatement);
+        }
     }
 
     void Database::doClose() {
         LOG_DEBUG << "#" << m_ID;
 
         finalize();
+        m_ReadersPool.close();
 
         const int closeResult = sqlite3_close(m_Database);
         if (closeResult != SQLITE_OK) {
@@ -567,6 +1227,27 @@ namespace Helpers {
         return success;
     }
 
+    bool Database::queryPragma(const char *pragma, qint64 &value) {
+        sqlite3_stmt *statement = nullptr;
+        int rc = sqlite3_prepare_v2(m_Database, pragma, -1, &statement, 0);
+        if (rc != SQLITE_OK) {
+            LOG_WARNING << "Failed to prepare (" << pragma << "). Error:" << sqlite3_errstr(rc);
+            return false;
+        }
+
+        rc = sqlite3_step(statement);
+        const bool success = (rc == SQLITE_ROW);
+        if (success) {
+            value = sqlite3_column_int64(statement, 0);
+        } else {
+            LOG_WARNING << "Failed to query (" << pragma << "). Error:" << sqlite3_errstr(rc);
+        }
+
+        finalizeSqliteStatement(statement);
+
+        return success;
+    }
+
     DatabaseManager::DatabaseManager():
         QObject(),
         m_LastDatabaseID(0),
@@ -600,12 +1281,12 @@ namespace Helpers {
         m_Initialized = false;
     }
 
-    std::shared_ptr<Database> DatabaseManager::openDatabase(const QString &dbName) {
+    std::shared_ptr<Database> DatabaseManager::openDatabase(const QString &dbName, int readersCount) {
         Q_ASSERT(m_Initialized);
-        LOG_DEBUG << dbName;
+        LOG_DEBUG << dbName << readersCount << "reader(s)";
 
         const int id = getNextID();
-        std::shared_ptr<Database> db(new Database(id, &m_FinalizeCoordinator));
+        std::shared_ptr<Database> db(new Database(id, readersCount, &m_FinalizeCoordinator));
 
         QDir databasesDir(m_DBDirPath);
         Q_ASSERT(databasesDir.exists());
@@ -16,8 +16,10 @@
 #include <QDataStream>
 #include <QAtomicInt>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QHash>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <QPair>
 #include <vector>
@@ -26,36 +28,25 @@
 #include "asynccoordinator.h"
 #include "../Common/defines.h"
 
+#define DATABASE_READERS_COUNT 3
+
 struct sqlite3;
 struct sqlite3_stmt;
 
 namespace Helpers {
-    template<class TValue>
-    void restoreFailedItems(QHash<QString, TValue> &hash, QVector<QPair<QByteArray, QByteArray> > &keyValuesList, const QVector<int> &failedIndices) {
-        for (auto &index: failedIndices) {
-            auto &keyValuePair = keyValuesList[index];
-            QString key = QString::fromUtf8(keyValuePair.first);
-
-            TValue value;
-            QByteArray &rawData = keyValuePair.second;
-            QDataStream ds(&rawData, QIODevice::ReadOnly);
-            ds >> value;
-
-            hash.insert(key, value);
-        }
-    }
-
     // super simple wrapper over sqlite
     // to make it look like a key-value storage
     class Database {
     public:
-        Database(int id, AsyncCoordinator *finalizeCoordinator);
+        Database(int id, int readersCount, AsyncCoordinator *finalizeCoordinator);
         virtual ~Database();
 
-    private:
+    public:
+        // nested transactions are no-op so outer one can span several table operations
         class Transaction {
         public:
             Transaction(sqlite3 *database);
+            Transaction(Database *database);
             virtual ~Transaction();
 
         private:
@@ -63,10 +54,58 @@ namespace Helpers {
             bool m_Started;
         };
 
+    private:
+        // read-only connections, each one is used by a single thread at a time
+        class ReadersPool {
+        public:
+            ReadersPool();
+
+        public:
+            bool open(const char *fullDbPath, int readersCount);
+            void close();
+            int getSize() const { return (int)m_Connections.size(); }
+            sqlite3 *getConnection(int index) const { return m_Connections.at(index); }
+            int acquire();
+            void release(int index);
+
+        private:
+            QMutex m_Mutex;
+            QWaitCondition m_ReaderReleased;
+            std::vector<sqlite3 *> m_Connections;
+            std::vector<int> m_FreeReaders;
+        };
+
+        class ReaderLocker {
+        public:
+            ReaderLocker(ReadersPool *readersPool);
+            ~ReaderLocker();
+
+        public:
+            int getIndex() const { return m_Index; }
+
+        private:
+            ReadersPool *m_ReadersPool;
+            int m_Index;
+        };
+
+        struct ReadStatements {
+            ReadStatements():
+                m_GetStatement(nullptr),
+                m_GetManyStatement(nullptr),
+                m_AllStatement(nullptr),
+                m_PageStatement(nullptr)
+            { }
+
+            sqlite3_stmt *m_GetStatement;
+            sqlite3_stmt *m_GetManyStatement;
+            sqlite3_stmt *m_AllStatement;
+            sqlite3_stmt *m_PageStatement;
+        };
+
     public:
         class Table {
         public:
-            Table(sqlite3 *database, const QString &tableName);
+            Table(sqlite3 *database, ReadersPool *readersPool, const QString &tableName);
 
         public:
             bool initialize();
@@ -74,6 +113,8 @@ namespace Helpers {
 
         public:
             bool tryGetValue(const QByteArray &key, QByteArray &value);
+            // found key-value pairs are appended in arbitrary order
+            int tryGetMany(const QVector<QByteArray> &keysList, QVector<QPair<QByteArray, QByteArray> > &keyValueList);
             bool trySetValue(const QByteArray &key, const QByteArray &value);
             bool tryAddValue(const QByteArray &key, const QByteArray &value);
             bool trySetMany(const QVector<QPair<QByteArray, QByteArray> > &keyValueList, QVector<int> &failedIndices);
@@ -81,34 +122,104 @@ namespace Helpers {
             bool tryDeleteRecord(const QByteArray &key);
             bool tryDeleteMany(const QVector<QByteArray> &keysList);
             void foreachRow(const std::function<bool (QByteArray &, QByteArray &)> &action);
+            // rows ordered by key that go after afterKey (empty key means from the start)
+            int getPage(const QByteArray &afterKey, int limit, QVector<QPair<QByteArray, QByteArray> > &keyValueList);
+
+        private:
+            bool prepareReadStatements(sqlite3 *database, ReadStatements &statements);
+            void finalizeReadStatements(ReadStatements &statements);
+            void withReadStatements(const std::function<void (ReadStatements &)> &action);
 
         private:
+            // guards read statements of the writer connection
+            // used when there are no read-only connections
+            QMutex m_WriterReadMutex;
             QString m_TableName;
             sqlite3 *m_Database;
-            sqlite3_stmt *m_GetStatement;
+            ReadersPool *m_ReadersPool;
+            ReadStatements m_WriterReadStatements;
+            std::vector<ReadStatements> m_ReaderStatements;
             sqlite3_stmt *m_SetStatement;
             sqlite3_stmt *m_AddStatement;
             sqlite3_stmt *m_DelStatement;
-            sqlite3_stmt *m_AllStatement;
+        };
+
+    public:
+        struct FullTextRecord {
+            QByteArray m_Key;
+            int m_Category;
+            // one value per indexed column
+            QStringList m_Values;
+        };
+
+        // fts5 index over a key-value table
+        // rows are addressed by the hash of the key
+        class FullTextTable {
+        public:
+            FullTextTable(sqlite3 *database, ReadersPool *readersPool, const QString &tableName,
+                          const QStringList &columns, const QVector<double> &weights);
+
+        public:
+            bool initialize();
+            void finalize();
+
+        public:
+            bool isEmpty();
+            bool trySetMany(const QVector<FullTextRecord> &records);
+            int tryAddMany(const QVector<FullTextRecord> &records);
+            bool tryDeleteMany(const QVector<QByteArray> &keysList);
+            // keys are appended best match first, category 0 matches everything
+            int search(const QString &matchExpression, int category, int limit, int offset, QVector<QByteArray> &keysList);
+
+        private:
+            bool tryDeleteRecord(qint64 rowID);
+            bool tryInsertRecord(qint64 rowID, const FullTextRecord &record);
+            bool containsRecord(qint64 rowID);
+            void withSearchStatement(const std::function<void (sqlite3_stmt *)> &action);
+
+        private:
+            // guards search statement of the writer connection
+            QMutex m_WriterReadMutex;
+            QString m_TableName;
+            QStringList m_Columns;
+            QVector<double> m_Weights;
+            sqlite3 *m_Database;
+            ReadersPool *m_ReadersPool;
+            sqlite3_stmt *m_WriterSearchStatement;
+            std::vector<sqlite3_stmt *> m_ReaderSearchStatements;
+            sqlite3_stmt *m_ExistsStatement;
+            sqlite3_stmt *m_InsertStatement;
+            sqlite3_stmt *m_DeleteStatement;
         };
 
     public:
         bool open(const char *fullDbPath);
         void close();
-        bool initialize();
+        // incremental vacuum has effect only for newly created databases
+        bool initialize(bool incrementalVacuum = false);
         void finalize();
         void sync();
+        bool getSizeBytes(qint64 &totalBytes, qint64 &freeBytes);
+        bool getIsIncrementalVacuum();
+        bool vacuumIncrementally(int pagesCount);
         std::shared_ptr<Table> getTable(const QString &name);
+        // returns nullptr if sqlite is built without fts5
+        std::shared_ptr<FullTextTable> getFullTextTable(const QString &name, const QStringList &columns, const QVector<double> &weights);
 
     private:
         void doClose();
         bool executeStatement(const char *stmt);
+        bool queryPragma(const char *pragma, qint64 &value);
 
     private:
         int m_ID;
+        int m_ReadersCount;
         AsyncCoordinator *m_FinalizeCoordinator;
         sqlite3 *m_Database;
+        QByteArray m_FullDbPath;
+        ReadersPool m_ReadersPool;
         std::vector<std::shared_ptr<Table> > m_Tables;
+        std::vector<std::shared_ptr<FullTextTable> > m_FullTextTables;
         volatile bool m_IsOpened;
     };
 
@@ -130,7 +241,8 @@ namespace Helpers {
         int closeEnvironment();
 
     public:
-        std::shared_ptr<Database> openDatabase(const QString &dbName);
+        // every database gets one writer connection and readersCount read-only ones
+        std::shared_ptr<Database> openDatabase(const QString &dbName, int readersCount = DATABASE_READERS_COUNT);
 
     public:
         void prepareToFinalize();
@@ -162,6 +274,10 @@ namespace Helpers {
             if (m_WriteAheadLog.contains(key)) {
                 contains = true;
                 value = m_WriteAheadLog[key];
+            } else if (m_FlushedItems.contains(key)) {
+                // written but maybe not yet committed
+                contains = true;
+                value = m_FlushedItems[key];
             }
 
             return contains;
@@ -174,6 +290,16 @@ namespace Helpers {
             m_WriteAheadLog.insert(key, value);
         }
 
+        bool setIfAbsent(const TKey &key, const TValue &value) {
+            QWriteLocker walLocker(&m_LockWAL);
+            Q_UNUSED(walLocker);
+
+            if (m_WriteAheadLog.contains(key)) { return false; }
+
+            m_WriteAheadLog.insert(key, value);
+            return true;
+        }
+
         void setMany(const QHash<TKey, TValue> &existing) {
             if (existing.isEmpty()) { return; }
 
@@ -188,15 +314,22 @@ namespace Helpers {
             }
         }
 
-        void flush(std::shared_ptr<Database::Table> &dbTable) {
-            LOG_DEBUG << "#";
+        // items written inside of an outer transaction have to stay
+        // readable until it is committed and releaseFlushed() is called
+        void flush(std::shared_ptr<Database::Table> &dbTable, bool inOuterTransaction = false) {
+            LOG_DEBUG << inOuterTransaction;
             if (m_WriteAheadLog.empty()) { return; }
 
             QVector<QPair<QByteArray, QByteArray> > keyValuesList;
+            // original keys of keyValuesList items
+            QVector<TKey> keysList;
+            QHash<TKey, TValue> flushedItems;
             {
                 QWriteLocker walLocker(&m_LockWAL);
                 Q_UNUSED(walLocker);
 
+                flushedItems = m_WriteAheadLog;
+
                 auto it = m_WriteAheadLog.begin();
                 auto itEnd = m_WriteAheadLog.end();
                 for (; it != itEnd; ++it) {
@@ -206,45 +339,92 @@ namespace Helpers {
                     QByteArray rawKey = keyToByteArray(key);
                     QByteArray rawValue;
 
-                    QDataStream ds(&rawValue, QIODevice::WriteOnly);
-                    ds << value;
-                    Q_ASSERT(ds.status() != QDataStream::WriteFailed);
-
-                    if (ds.status() != QDataStream::WriteFailed) {
+                    if (valueToByteArray(value, rawValue)) {
                         keyValuesList.push_back(QPair<QByteArray, QByteArray>(rawKey, rawValue));
+                        keysList.push_back(key);
                     }
                 }
 
+                // readers of other connections see the items
+                // only after commit so they are served from here until then
+                auto itFlushed = m_WriteAheadLog.begin();
+                auto itFlushedEnd = m_WriteAheadLog.end();
+                for (; itFlushed != itFlushedEnd; ++itFlushed) {
+                    m_FlushedItems.insert(itFlushed.key(), itFlushed.value());
+                }
+
                 m_WriteAheadLog.clear();
             }
 
-            if (keyValuesList.isEmpty()) { return; }
-
-            QVector<int> failedIndices;
-            bool success = doFlush(dbTable, keyValuesList, failedIndices);
-            if (success) {
-                LOG_INFO << "WAL has been flushed successfully";
-            } else {
-                LOG_WARNING << "Failed to flush WAL successfully. Restoring failed items...";
-                QWriteLocker locker(&m_LockWAL);
-                Q_UNUSED(locker);
-                Helpers::restoreFailedItems<TValue>(m_WriteAheadLog, keyValuesList, failedIndices);
+            if (!keyValuesList.isEmpty()) {
+                QVector<int> failedIndices;
+                bool success = doFlush(dbTable, keyValuesList, failedIndices);
+                if (success) {
+                    LOG_INFO << "WAL has been flushed successfully";
+                } else {
+                    LOG_WARNING << "Failed to flush WAL successfully. Restoring failed items...";
+                    QWriteLocker locker(&m_LockWAL);
+                    Q_UNUSED(locker);
+                    restoreFailedItems(keysList, flushedItems, failedIndices);
+                }
+
+                onFlushed(flushedItems);
+            }
+
+            if (!inOuterTransaction) {
+                releaseFlushed();
             }
         }
 
+        void releaseFlushed() {
+            QWriteLocker locker(&m_LockWAL);
+            Q_UNUSED(locker);
+            m_FlushedItems.clear();
+        }
+
         int size() {
             QReadLocker locker(&m_LockWAL);
             Q_UNUSED(locker);
             return m_WriteAheadLog.size();
         }
 
+    private:
+        void restoreFailedItems(const QVector<TKey> &keysList, const QHash<TKey, TValue> &flushedItems,
+                                const QVector<int> &failedIndices) {
+            for (auto &index: failedIndices) {
+                const TKey &key = keysList.at(index);
+
+                // items set during the flush are newer
+                if (!m_WriteAheadLog.contains(key)) {
+                    m_WriteAheadLog.insert(key, flushedItems.value(key));
+                }
+            }
+        }
+
+    protected:
+        virtual bool valueToByteArray(const TValue &value, QByteArray &rawValue) const {
+            QDataStream ds(&rawValue, QIODevice::WriteOnly);
+            ds << value;
+            Q_ASSERT(ds.status() != QDataStream::WriteFailed);
+            return ds.status() != QDataStream::WriteFailed;
+        }
+
+        virtual bool byteArrayToValue(const QByteArray &rawValue, TValue &value) const {
+            QDataStream ds(rawValue);
+            ds >> value;
+            return ds.status() == QDataStream::Ok;
+        }
+
     protected:
         virtual QByteArray keyToByteArray(const TKey &key) const = 0;
         virtual bool doFlush(std::shared_ptr<Database::Table> &dbTable, const QVector<QPair<QByteArray, QByteArray> > &keyValuesList, QVector<int> &failedIndices) = 0;
+        // failed items are flushed again next time so this has to be idempotent
+        virtual void onFlushed(const QHash<TKey, TValue> &flushedItems) { Q_UNUSED(flushedItems); }
 
     private:
         QReadWriteLock m_LockWAL;
         QHash<TKey, TValue> m_WriteAheadLog;
+        QHash<TKey, TValue> m_FlushedItems;
     };
 }
 
@@ -0,0 +1,77 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "exiftoolframing.h"
+#include "../Common/defines.h"
+
+namespace Helpers {
+    static bool hasNewline(const QString &argument) {
+        return argument.contains(QChar('\n')) || argument.contains(QChar('\r'));
+    }
+
+    static bool isTagAssignment(const QString &argument) {
+        // e.g. -IPTC:Keywords=keyword or -XMP:Title+=title
+        if (!argument.startsWith(QChar('-'))) { return false; }
+
+        const int assignIndex = argument.indexOf(QChar('='));
+        if (assignIndex <= 1) { return false; }
+
+        // newline in the name of the tag cannot be fixed
+        return !hasNewline(argument.left(assignIndex));
+    }
+
+    bool frameExiftoolCommand(const QStringList &arguments, quint32 commandID, QByteArray &commandText, QString &error) {
+        QByteArray text;
+
+        for (auto &argument: arguments) {
+            if (!hasNewline(argument)) {
+                text.append(argument.toUtf8());
+            } else if (isTagAssignment(argument)) {
+                LOG_WARNING << "Replacing newlines in" << argument;
+                QString singleLine = argument;
+                singleLine.replace(QLatin1String("\r\n"), QLatin1String(" "));
+                singleLine.replace(QChar('\r'), QChar(' '));
+                singleLine.replace(QChar('\n'), QChar(' '));
+                text.append(singleLine.toUtf8());
+            } else {
+                // otherwise rest of the argument becomes a separate one
+                error = QString("Argument cannot contain newlines: %1").arg(argument);
+                return false;
+            }
+
+            text.append(EXIFTOOL_ARGUMENTS_NEWLINE);
+        }
+
+        text.append(QString("-execute%1").arg(commandID).toLatin1());
+        text.append(EXIFTOOL_ARGUMENTS_NEWLINE);
+
+        commandText.swap(text);
+        return true;
+    }
+
+    QByteArray makeExiftoolReadyMarker(quint32 commandID) {
+        return QString("{ready%1}").arg(commandID).toLatin1();
+    }
+
+    int findExiftoolReadyMarker(const QByteArray &buffer, const QByteArray &readyMarker, int &endIndex) {
+        const int markerIndex = buffer.indexOf(readyMarker);
+        if (markerIndex == -1) { return -1; }
+
+        // marker is followed by the newline
+        int index = markerIndex + readyMarker.size();
+        while ((index < buffer.size()) &&
+               ((buffer.at(index) == '\r') || (buffer.at(index) == '\n'))) {
+            index++;
+        }
+
+        endIndex = index;
+        return markerIndex;
+    }
+}
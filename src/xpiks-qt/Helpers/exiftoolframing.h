@@ -0,0 +1,37 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef EXIFTOOLFRAMING_H
+#define EXIFTOOLFRAMING_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#ifdef Q_OS_WIN
+#define EXIFTOOL_ARGUMENTS_NEWLINE "\r\n"
+#else
+#define EXIFTOOL_ARGUMENTS_NEWLINE "\n"
+#endif
+
+namespace Helpers {
+    // "exiftool -stay_open True -@ -" reads one argument per line and
+    // runs the command when it gets "-execute<ID>" line; in response it
+    // prints output of the command followed by "{ready<ID>}" line
+
+    // newlines in tag values are replaced with spaces, any other argument
+    // with a newline (e.g. file path) cannot be passed and command is rejected
+    bool frameExiftoolCommand(const QStringList &arguments, quint32 commandID, QByteArray &commandText, QString &error);
+    QByteArray makeExiftoolReadyMarker(quint32 commandID);
+    // returns index of the marker or -1, endIndex is set past the marker and its newline
+    int findExiftoolReadyMarker(const QByteArray &buffer, const QByteArray &readyMarker, int &endIndex);
+}
+
+#endif // EXIFTOOLFRAMING_H
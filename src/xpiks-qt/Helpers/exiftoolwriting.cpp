@@ -0,0 +1,97 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "exiftoolwriting.h"
+#include <QThread>
+#include "../Common/defines.h"
+
+// summary line printed when the file failed
+#define EXIFTOOL_NOT_UPDATED_ERRORS QLatin1String("weren't updated due to errors")
+// minor errors are printed as warnings because of -m
+#define EXIFTOOL_ERROR_PREFIX QLatin1String("Error:")
+
+#define XMP_TITLE QLatin1String("-XMP:Title=")
+#define IPTC_OBJECTNAME QLatin1String("-IPTC:ObjectName=")
+#define XMP_DESCRIPTION QLatin1String("-XMP:Description=")
+#define EXIF_IMAGEDESCRIPTION QLatin1String("-EXIF:ImageDescription=")
+#define IPTC_CAPTIONABSTRACT QLatin1String("-IPTC:Caption-Abstract=")
+#define IPTC_KEYWORDS QLatin1String("-IPTC:Keywords=")
+#define XMP_SUBJECT QLatin1String("-XMP:Subject=")
+
+namespace Helpers {
+    void makeExiftoolWriteArguments(const QString &title, const QString &description,
+                                    const QStringList &keywords, QStringList &arguments) {
+        // every argument is a separate line for exiftool
+        QString simpleTitle = title.simplified();
+        QString simpleDescription = description.simplified();
+
+        if (simpleTitle.isEmpty()) {
+            simpleTitle = simpleDescription;
+        }
+
+        arguments << (XMP_TITLE + simpleTitle) << (IPTC_OBJECTNAME + simpleTitle);
+        arguments << (XMP_DESCRIPTION + simpleDescription) << (EXIF_IMAGEDESCRIPTION + simpleDescription) << (IPTC_CAPTIONABSTRACT + simpleDescription);
+
+        // several assignments of a list tag in one command replace its values
+        QStringList nonEmptyKeywords = keywords;
+        nonEmptyKeywords.removeAll(QString());
+
+        if (nonEmptyKeywords.isEmpty()) {
+            arguments << IPTC_KEYWORDS << XMP_SUBJECT;
+        } else {
+            for (auto &keyword: nonEmptyKeywords) {
+                arguments << (IPTC_KEYWORDS + keyword);
+            }
+
+            for (auto &keyword: nonEmptyKeywords) {
+                arguments << (XMP_SUBJECT + keyword);
+            }
+        }
+    }
+
+    bool isExiftoolWriteSuccessful(const QByteArray &output, const QByteArray &errors) {
+        const QString stdoutText = QString::fromUtf8(output);
+        const QString stderrText = QString::fromUtf8(errors);
+
+        const bool anyError = stdoutText.contains(EXIFTOOL_NOT_UPDATED_ERRORS) ||
+                stderrText.contains(EXIFTOOL_ERROR_PREFIX);
+
+        if (anyError) {
+            LOG_WARNING << "STDOUT [ExifTool]:" << stdoutText << "STDERR [ExifTool]:" << stderrText;
+        }
+
+        return !anyError;
+    }
+
+    std::vector<size_t> writeWithRetries(size_t itemsCount, int retriesCount, int retryDelayMs,
+                                         const WriteItemsFunction &writeItems) {
+        std::vector<size_t> pendingIndices, failedIndices;
+        pendingIndices.reserve(itemsCount);
+        for (size_t i = 0; i < itemsCount; ++i) {
+            pendingIndices.push_back(i);
+        }
+
+        for (int attempt = 0; attempt <= retriesCount; ++attempt) {
+            if (attempt > 0) {
+                LOG_INFO << "Retrying" << pendingIndices.size() << "failed item(s) in" << retryDelayMs << "ms";
+                // locked files are usually available again a bit later
+                QThread::msleep(retryDelayMs);
+            }
+
+            failedIndices.clear();
+            writeItems(pendingIndices, failedIndices);
+            pendingIndices.swap(failedIndices);
+
+            if (pendingIndices.empty()) { break; }
+        }
+
+        return pendingIndices;
+    }
+}
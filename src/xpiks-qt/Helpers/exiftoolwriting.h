@@ -0,0 +1,34 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef EXIFTOOLWRITING_H
+#define EXIFTOOLWRITING_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+namespace Helpers {
+    // tag assignments for title, description and keywords of one file
+    void makeExiftoolWriteArguments(const QString &title, const QString &description,
+                                    const QStringList &keywords, QStringList &arguments);
+    // there is no exit code for a single command of the running exiftool
+    bool isExiftoolWriteSuccessful(const QByteArray &output, const QByteArray &errors);
+
+    // writes items with given indices and collects indices of failed ones
+    typedef std::function<void (const std::vector<size_t> &indices, std::vector<size_t> &failedIndices)> WriteItemsFunction;
+    // only failed items are written again after a delay, returns items failed in all attempts
+    std::vector<size_t> writeWithRetries(size_t itemsCount, int retriesCount, int retryDelayMs,
+                                         const WriteItemsFunction &writeItems);
+}
+
+#endif // EXIFTOOLWRITING_H
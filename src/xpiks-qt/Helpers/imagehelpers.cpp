@@ -0,0 +1,368 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "imagehelpers.h"
+#include <QImageReader>
+#include <QImageIOHandler>
+#include <QFile>
+#include <QTransform>
+#include <QtEndian>
+#include <cstring>
+#include "../Common/defines.h"
+
+// decode with some margin so smooth scaling still has pixels to average
+#define DECODE_OVERSAMPLING 2
+// metadata segments are written before the image data
+#define EMBEDDED_THUMBNAIL_SCAN_BYTES (256*1024)
+#define MAX_THUMBNAIL_UPSCALE 2
+
+#define JPEG_MARKER_SOI 0xD8
+#define JPEG_MARKER_EOI 0xD9
+#define JPEG_MARKER_SOS 0xDA
+#define JPEG_MARKER_APP1 0xE1
+
+#define TIFF_TAG_ORIENTATION 0x0112
+#define TIFF_TAG_JPEG_OFFSET 0x0201
+#define TIFF_TAG_JPEG_LENGTH 0x0202
+#define TIFF_TAG_XMP 0x02BC
+#define TIFF_IFD_ENTRY_SIZE 12
+
+#define EXIF_SIGNATURE "Exif\0\0"
+#define EXIF_SIGNATURE_SIZE 6
+#define XMP_SIGNATURE "http://ns.adobe.com/xap/1.0/"
+#define XMP_THUMBNAIL_TAG "xmpGImg:image"
+
+#define ORIENTATION_NORMAL 1
+#define ORIENTATION_MAX 8
+
+namespace Helpers {
+    QSize getOversampledSize(const QSize &originalSize, const QSize &targetSize) {
+        QSize fittedSize = originalSize.scaled(targetSize, Qt::KeepAspectRatio);
+        return (fittedSize * DECODE_OVERSAMPLING).boundedTo(originalSize);
+    }
+
+    QSize getDecodeSize(QImageReader &reader, const QSize &targetSize) {
+        const QSize originalSize = reader.size();
+        if (!originalSize.isValid() || !targetSize.isValid()) { return originalSize; }
+
+        if (!reader.supportsOption(QImageIOHandler::ScaledSize)) { return originalSize; }
+
+        return getOversampledSize(originalSize, targetSize);
+    }
+
+    QImage readScaledImage(QImageReader &reader, const QSize &targetSize) {
+        const QSize originalSize = reader.size();
+        const QSize decodeSize = getDecodeSize(reader, targetSize);
+
+        if (decodeSize.isValid() && (decodeSize != originalSize)) {
+            reader.setScaledSize(decodeSize);
+        }
+
+        // same as embedded thumbnails which are rotated too
+        reader.setAutoTransform(true);
+
+        QImage image = reader.read();
+        if (image.isNull()) {
+            LOG_WARNING << "Failed to read" << reader.fileName() << reader.errorString();
+            return image;
+        }
+
+        if (!targetSize.isValid()) { return image; }
+
+        const QSize imageSize = image.size();
+        // formats without downscaled decoding get cheap reduction first
+        const QSize intermediateSize = getOversampledSize(imageSize, targetSize);
+        if (intermediateSize != imageSize) {
+            image = image.scaled(intermediateSize, Qt::KeepAspectRatio, Qt::FastTransformation);
+        }
+
+        return image.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QImage readScaledImage(const QString &filepath, const QSize &targetSize, QSize *originalSize) {
+        QImageReader reader(filepath);
+
+        if (originalSize != nullptr) {
+            *originalSize = reader.size();
+        }
+
+        QImage image = readScaledImage(reader, targetSize);
+
+        if ((originalSize != nullptr) && !originalSize->isValid()) {
+            *originalSize = image.size();
+        }
+
+        return image;
+    }
+
+    // minimal TIFF structure reader over the bytes already in memory
+    class TiffView {
+    public:
+        TiffView(const QByteArray &data, int start, int size):
+            m_Data(data),
+            m_Start(start),
+            m_Size(size),
+            m_IsLittleEndian(true)
+        { }
+
+    public:
+        bool readHeader(quint32 &firstIFD) {
+            if (m_Size < 8) { return false; }
+
+            const char *header = m_Data.constData() + m_Start;
+            if ((header[0] == 'I') && (header[1] == 'I')) {
+                m_IsLittleEndian = true;
+            } else if ((header[0] == 'M') && (header[1] == 'M')) {
+                m_IsLittleEndian = false;
+            } else {
+                return false;
+            }
+
+            quint16 magic = 0;
+            return read16(2, magic) && (magic == 42) && read32(4, firstIFD);
+        }
+
+        bool getNextIFD(quint32 ifdOffset, quint32 &nextIFD) const {
+            quint16 entriesCount = 0;
+            return read16(ifdOffset, entriesCount) &&
+                    read32(ifdOffset + 2 + entriesCount * TIFF_IFD_ENTRY_SIZE, nextIFD);
+        }
+
+        bool findTag(quint32 ifdOffset, quint16 tag, quint32 &count, quint32 &value) const {
+            quint16 entriesCount = 0;
+            if (!read16(ifdOffset, entriesCount)) { return false; }
+
+            bool found = false;
+            for (quint16 i = 0; i < entriesCount; ++i) {
+                const quint32 entryOffset = ifdOffset + 2 + i * TIFF_IFD_ENTRY_SIZE;
+                quint16 entryTag = 0, type = 0;
+                if (!read16(entryOffset, entryTag) || !read16(entryOffset + 2, type)) { return false; }
+                if (entryTag != tag) { continue; }
+
+                if (!read32(entryOffset + 4, count)) { return false; }
+
+                // SHORT values are left aligned in the value field
+                if (type == 3) {
+                    quint16 shortValue = 0;
+                    found = read16(entryOffset + 8, shortValue);
+                    value = shortValue;
+                } else {
+                    found = read32(entryOffset + 8, value);
+                }
+
+                break;
+            }
+
+            return found;
+        }
+
+        bool getBytes(quint32 offset, quint32 length, QByteArray &bytes) const {
+            if (!contains(offset, length)) { return false; }
+            bytes = m_Data.mid(m_Start + (int)offset, (int)length);
+            return true;
+        }
+
+    private:
+        bool contains(quint32 offset, quint32 length) const {
+            return ((quint64)offset + length) <= (quint64)m_Size;
+        }
+
+        bool read16(quint32 offset, quint16 &value) const {
+            if (!contains(offset, 2)) { return false; }
+            const uchar *src = (const uchar *)m_Data.constData() + m_Start + offset;
+            value = m_IsLittleEndian ? qFromLittleEndian<quint16>(src) : qFromBigEndian<quint16>(src);
+            return true;
+        }
+
+        bool read32(quint32 offset, quint32 &value) const {
+            if (!contains(offset, 4)) { return false; }
+            const uchar *src = (const uchar *)m_Data.constData() + m_Start + offset;
+            value = m_IsLittleEndian ? qFromLittleEndian<quint32>(src) : qFromBigEndian<quint32>(src);
+            return true;
+        }
+
+    private:
+        const QByteArray &m_Data;
+        int m_Start;
+        int m_Size;
+        bool m_IsLittleEndian;
+    };
+
+    bool isJpegData(const QByteArray &data) {
+        return (data.size() > 4) &&
+                ((uchar)data.at(0) == 0xFF) &&
+                ((uchar)data.at(1) == JPEG_MARKER_SOI);
+    }
+
+    bool findXmpThumbnail(const QByteArray &xmp, QByteArray &jpegData) {
+        int index = xmp.indexOf(XMP_THUMBNAIL_TAG);
+        if (index == -1) { return false; }
+
+        index += (int)strlen(XMP_THUMBNAIL_TAG);
+        if (index >= xmp.size()) { return false; }
+
+        // either attribute xmpGImg:image="..." or element <xmpGImg:image>...</xmpGImg:image>
+        int start = -1, end = -1;
+        const char next = xmp.at(index);
+        if ((next == '=') && (index + 1 < xmp.size())) {
+            const char quote = xmp.at(index + 1);
+            start = index + 2;
+            end = xmp.indexOf(quote, start);
+        } else if (next == '>') {
+            start = index + 1;
+            end = xmp.indexOf('<', start);
+        }
+
+        if ((start < 0) || (end <= start)) { return false; }
+
+        QByteArray base64 = xmp.mid(start, end - start);
+        // line breaks are usually escaped
+        base64.replace("&#xA;", "");
+        jpegData = QByteArray::fromBase64(base64);
+
+        return isJpegData(jpegData);
+    }
+
+    int readExifOrientation(TiffView &tiff) {
+        quint32 firstIFD = 0;
+        quint32 count = 0, value = 0;
+        if (!tiff.readHeader(firstIFD)) { return ORIENTATION_NORMAL; }
+        if (!tiff.findTag(firstIFD, TIFF_TAG_ORIENTATION, count, value)) { return ORIENTATION_NORMAL; }
+
+        if ((value < ORIENTATION_NORMAL) || (value > ORIENTATION_MAX)) { return ORIENTATION_NORMAL; }
+        return (int)value;
+    }
+
+    bool findExifThumbnail(TiffView &tiff, QByteArray &jpegData) {
+        quint32 firstIFD = 0, secondIFD = 0;
+        if (!tiff.readHeader(firstIFD)) { return false; }
+
+        // IFD0 describes the main image, IFD1 describes the thumbnail
+        if (!tiff.getNextIFD(firstIFD, secondIFD) || (secondIFD == 0)) { return false; }
+
+        quint32 count = 0;
+        quint32 jpegOffset = 0, jpegLength = 0;
+        if (!tiff.findTag(secondIFD, TIFF_TAG_JPEG_OFFSET, count, jpegOffset)) { return false; }
+        if (!tiff.findTag(secondIFD, TIFF_TAG_JPEG_LENGTH, count, jpegLength)) { return false; }
+
+        return tiff.getBytes(jpegOffset, jpegLength, jpegData) && isJpegData(jpegData);
+    }
+
+    bool findTiffXmpThumbnail(TiffView &tiff, QByteArray &jpegData) {
+        quint32 firstIFD = 0;
+        quint32 count = 0, offset = 0;
+        if (!tiff.readHeader(firstIFD)) { return false; }
+        if (!tiff.findTag(firstIFD, TIFF_TAG_XMP, count, offset)) { return false; }
+
+        QByteArray xmp;
+        return tiff.getBytes(offset, count, xmp) && findXmpThumbnail(xmp, jpegData);
+    }
+
+    bool findJpegThumbnail(const QByteArray &data, QByteArray &jpegData, int &orientation) {
+        const int size = data.size();
+        const uchar *bytes = (const uchar *)data.constData();
+        int position = 2;
+        bool found = false, exifFound = false;
+
+        // orientation is in EXIF even if the thumbnail is in XMP
+        while (!(found && exifFound) && (position + 4 <= size)) {
+            if (bytes[position] != 0xFF) { break; }
+
+            const uchar marker = bytes[position + 1];
+            if ((marker == JPEG_MARKER_SOS) || (marker == JPEG_MARKER_EOI)) { break; }
+
+            const int segmentSize = qFromBigEndian<quint16>(bytes + position + 2);
+            const int segmentStart = position + 4;
+            const int segmentDataSize = segmentSize - 2;
+            if ((segmentDataSize < 0) || (segmentStart + segmentDataSize > size)) { break; }
+
+            if (marker == JPEG_MARKER_APP1) {
+                const char *segment = data.constData() + segmentStart;
+
+                if ((segmentDataSize > EXIF_SIGNATURE_SIZE) &&
+                        (memcmp(segment, EXIF_SIGNATURE, EXIF_SIGNATURE_SIZE) == 0)) {
+                    TiffView tiff(data, segmentStart + EXIF_SIGNATURE_SIZE, segmentDataSize - EXIF_SIGNATURE_SIZE);
+                    exifFound = true;
+                    orientation = readExifOrientation(tiff);
+                    found = found || findExifThumbnail(tiff, jpegData);
+                } else if (!found &&
+                           (segmentDataSize > (int)sizeof(XMP_SIGNATURE)) &&
+                           (memcmp(segment, XMP_SIGNATURE, sizeof(XMP_SIGNATURE)) == 0)) {
+                    const QByteArray xmp = QByteArray::fromRawData(segment, segmentDataSize);
+                    found = findXmpThumbnail(xmp, jpegData);
+                }
+            }
+
+            position = segmentStart + segmentDataSize;
+        }
+
+        return found;
+    }
+
+    bool readEmbeddedThumbnail(const QString &filepath, QByteArray &jpegData, int &orientation) {
+        QFile file(filepath);
+        if (!file.open(QIODevice::ReadOnly)) { return false; }
+
+        const QByteArray data = file.read(EMBEDDED_THUMBNAIL_SCAN_BYTES);
+        file.close();
+
+        return readEmbeddedThumbnail(data, jpegData, orientation);
+    }
+
+    bool readEmbeddedThumbnail(const QByteArray &data, QByteArray &jpegData, int &orientation) {
+        bool found = false;
+        orientation = ORIENTATION_NORMAL;
+
+        if (isJpegData(data)) {
+            found = findJpegThumbnail(data, jpegData, orientation);
+        } else {
+            TiffView tiff(data, 0, data.size());
+            found = findExifThumbnail(tiff, jpegData) ||
+                    findTiffXmpThumbnail(tiff, jpegData);
+            if (found) {
+                orientation = readExifOrientation(tiff);
+            }
+        }
+
+        return found;
+    }
+
+    QImage applyExifOrientation(const QImage &image, int orientation) {
+        QImage result;
+
+        switch (orientation) {
+        case 2: result = image.mirrored(true, false); break;
+        case 3: result = image.mirrored(true, true); break;
+        case 4: result = image.mirrored(false, true); break;
+        // transpose
+        case 5: result = image.transformed(QTransform().rotate(90)).mirrored(true, false); break;
+        case 6: result = image.transformed(QTransform().rotate(90)); break;
+        // transverse
+        case 7: result = image.transformed(QTransform().rotate(90)).mirrored(false, true); break;
+        case 8: result = image.transformed(QTransform().rotate(270)); break;
+        default: result = image; break;
+        }
+
+        return result;
+    }
+
+    bool isTransposingOrientation(int orientation) {
+        return (5 <= orientation) && (orientation <= 8);
+    }
+
+    bool isEmbeddedThumbnailEnough(const QSize &thumbnailSize, const QSize &targetSize) {
+        if (!thumbnailSize.isValid() || !targetSize.isValid()) { return false; }
+
+        const int thumbnailSide = qMax(thumbnailSize.width(), thumbnailSize.height());
+        const int targetSide = qMax(targetSize.width(), targetSize.height());
+
+        return thumbnailSide * MAX_THUMBNAIL_UPSCALE >= targetSide;
+    }
+}
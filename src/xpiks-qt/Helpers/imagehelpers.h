@@ -0,0 +1,41 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef IMAGEHELPERS_H
+#define IMAGEHELPERS_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QByteArray>
+
+class QImageReader;
+
+namespace Helpers {
+    // size the decoder will produce for targetSize, original size if it cannot downscale
+    QSize getDecodeSize(QImageReader &reader, const QSize &targetSize);
+    // decoder downscales itself when the format allows (e.g. jpeg DCT scaling),
+    // result always fits into targetSize keeping aspect ratio
+    QImage readScaledImage(QImageReader &reader, const QSize &targetSize);
+    QImage readScaledImage(const QString &filepath, const QSize &targetSize, QSize *originalSize = nullptr);
+    // jpeg data of the EXIF thumbnail or XMP preview (xmpGImg) found
+    // in the beginning of a jpeg or tiff file, without decoding the image;
+    // thumbnail has to be rotated with EXIF orientation of the main image
+    bool readEmbeddedThumbnail(const QString &filepath, QByteArray &jpegData, int &orientation);
+    // same for the first bytes of the file already in memory
+    bool readEmbeddedThumbnail(const QByteArray &data, QByteArray &jpegData, int &orientation);
+    // EXIF orientation values from 1 (as is) to 8
+    QImage applyExifOrientation(const QImage &image, int orientation);
+    bool isTransposingOrientation(int orientation);
+    // embedded thumbnail is worth showing if it is not upscaled too much
+    bool isEmbeddedThumbnailEnough(const QSize &thumbnailSize, const QSize &targetSize);
+}
+
+#endif // IMAGEHELPERS_H
@@ -0,0 +1,82 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "jsonobjectstream.h"
+
+namespace Helpers {
+    JsonObjectStream::JsonObjectStream():
+        m_Depth(0),
+        m_InString(false),
+        m_IsEscaped(false)
+    {
+    }
+
+    int JsonObjectStream::feed(const QByteArray &data, std::vector<QByteArray> &objects) {
+        int objectsCount = 0;
+        const int size = data.size();
+        const char *text = data.constData();
+        // start of the current object in the data or -1 if it started in a previous chunk
+        int objectStart = (m_Depth > 0) ? 0 : -1;
+
+        for (int i = 0; i < size; ++i) {
+            const char c = text[i];
+
+            if (m_Depth == 0) {
+                if (c == '{') {
+                    m_Depth = 1;
+                    objectStart = i;
+                }
+
+                continue;
+            }
+
+            if (m_InString) {
+                if (m_IsEscaped) {
+                    m_IsEscaped = false;
+                } else if (c == '\\') {
+                    m_IsEscaped = true;
+                } else if (c == '"') {
+                    m_InString = false;
+                }
+
+                continue;
+            }
+
+            if (c == '"') {
+                m_InString = true;
+            } else if (c == '{') {
+                m_Depth++;
+            } else if (c == '}') {
+                m_Depth--;
+
+                if (m_Depth == 0) {
+                    m_CurrentObject.append(text + objectStart, i + 1 - objectStart);
+                    objects.emplace_back();
+                    objects.back().swap(m_CurrentObject);
+                    objectsCount++;
+                    objectStart = -1;
+                }
+            }
+        }
+
+        if ((m_Depth > 0) && (objectStart != -1)) {
+            m_CurrentObject.append(text + objectStart, size - objectStart);
+        }
+
+        return objectsCount;
+    }
+
+    void JsonObjectStream::reset() {
+        m_CurrentObject.clear();
+        m_Depth = 0;
+        m_InString = false;
+        m_IsEscaped = false;
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef JSONOBJECTSTREAM_H
+#define JSONOBJECTSTREAM_H
+
+#include <QByteArray>
+#include <vector>
+
+namespace Helpers {
+    // splits a stream of json text into top level objects as soon as
+    // each of them is complete, e.g. elements of a huge json array;
+    // anything outside of objects (brackets, commas, whitespace) is skipped
+    class JsonObjectStream
+    {
+    public:
+        JsonObjectStream();
+
+    public:
+        // returns number of objects appended to the output
+        int feed(const QByteArray &data, std::vector<QByteArray> &objects);
+        bool hasIncompleteObject() const { return m_Depth > 0; }
+        void reset();
+
+    private:
+        QByteArray m_CurrentObject;
+        int m_Depth;
+        bool m_InString;
+        bool m_IsEscaped;
+    };
+}
+
+#endif // JSONOBJECTSTREAM_H
@@ -0,0 +1,128 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "loadmonitor.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include "../Common/defines.h"
+
+#define HEARTBEAT_INTERVAL 100
+// UI is considered busy when events are delayed for more than this
+#define UI_LAG_THRESHOLD 50
+#define YIELD_STEP_MS 10
+// every that many items pending above add one more step
+#define PENDING_ITEMS_PER_YIELD_STEP 50
+
+namespace Helpers {
+    LoadMonitor::LoadMonitor():
+        m_LastHeartbeat(0),
+        m_UILag(0),
+        m_IsMonitoring(false)
+    {
+        for (auto &pending: m_PendingWork) {
+            pending.store(0);
+        }
+    }
+
+    void LoadMonitor::startMonitoring() {
+        if (m_IsMonitoring) { return; }
+
+        QCoreApplication *app = QCoreApplication::instance();
+        if (app == nullptr) {
+            LOG_WARNING << "Application is not created yet";
+            return;
+        }
+
+        Q_ASSERT(QThread::currentThread() == app->thread());
+        LOG_DEBUG << "#";
+
+        m_Clock.start();
+        m_LastHeartbeat.store(0);
+
+        // timer is deleted together with application
+        QTimer *heartbeatTimer = new QTimer(app);
+        QObject::connect(heartbeatTimer, &QTimer::timeout, [this]() { heartbeat(); });
+        heartbeatTimer->start(HEARTBEAT_INTERVAL);
+
+        m_IsMonitoring = true;
+    }
+
+    bool LoadMonitor::isUIBusy() const {
+        if (!m_IsMonitoring) { return false; }
+        return isUIBusyAt(m_Clock.elapsed());
+    }
+
+    bool LoadMonitor::isUIBusyAt(qint64 now) const {
+        if (m_UILag.load() > UI_LAG_THRESHOLD) { return true; }
+
+        // heartbeat itself can be stuck behind a long operation
+        const qint64 sinceHeartbeat = now - m_LastHeartbeat.load();
+        const bool isStuck = sinceHeartbeat > (HEARTBEAT_INTERVAL + UI_LAG_THRESHOLD);
+        return isStuck;
+    }
+
+    bool LoadMonitor::hasPendingWorkAbove(LoadPriority priority) const {
+        bool anyPending = false;
+
+        for (int i = 0; i < (int)priority; ++i) {
+            if (m_PendingWork[i].load() > 0) {
+                anyPending = true;
+                break;
+            }
+        }
+
+        return anyPending;
+    }
+
+    int LoadMonitor::getPendingWorkAbove(LoadPriority priority) const {
+        int pendingCount = 0;
+
+        for (int i = 0; i < (int)priority; ++i) {
+            pendingCount += qMax(m_PendingWork[i].load(), 0);
+        }
+
+        return pendingCount;
+    }
+
+    bool LoadMonitor::shouldYield(LoadPriority priority) const {
+        return isUIBusy() || hasPendingWorkAbove(priority);
+    }
+
+    void LoadMonitor::addPendingWork(LoadPriority priority, int delta) {
+        Q_ASSERT((0 <= (int)priority) && (priority < LoadPriority::PrioritiesCount));
+        m_PendingWork[(int)priority].fetchAndAddOrdered(delta);
+    }
+
+    int LoadMonitor::getPendingWork(LoadPriority priority) const {
+        return m_PendingWork[(int)priority].load();
+    }
+
+    int LoadMonitor::getYieldBudgetMs(LoadPriority priority) const {
+        return calculateYieldBudgetMs(isUIBusy(), getPendingWorkAbove(priority));
+    }
+
+    int LoadMonitor::calculateYieldBudgetMs(bool isUIBusy, int pendingWorkAbove) {
+        if (isUIBusy) { return LOAD_MONITOR_MAX_YIELD_MS; }
+        if (pendingWorkAbove <= 0) { return 0; }
+
+        const int steps = 1 + pendingWorkAbove / PENDING_ITEMS_PER_YIELD_STEP;
+        return qMin(steps * YIELD_STEP_MS, LOAD_MONITOR_MAX_YIELD_MS);
+    }
+
+    void LoadMonitor::heartbeat() {
+        onHeartbeat(m_Clock.elapsed());
+    }
+
+    void LoadMonitor::onHeartbeat(qint64 now) {
+        const qint64 previous = m_LastHeartbeat.fetchAndStoreOrdered(now);
+        const qint64 lag = now - previous - HEARTBEAT_INTERVAL;
+        m_UILag.store((int)qMax<qint64>(lag, 0));
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef LOADMONITOR_H
+#define LOADMONITOR_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+// the longest a worker steps aside after one item or batch
+#define LOAD_MONITOR_MAX_YIELD_MS 50
+
+namespace Helpers {
+    enum struct ThrottlingPolicy {
+        // process items at full speed
+        NoThrottling = 0,
+        // legacy behavior: sleep after every "delayed" item
+        FixedDelay = 1,
+        // yield only while UI or more important queues are busy
+        Adaptive = 2
+    };
+
+    // settings keep the policy as a number
+    inline ThrottlingPolicy toThrottlingPolicy(int value) {
+        switch (value) {
+        case (int)ThrottlingPolicy::NoThrottling: return ThrottlingPolicy::NoThrottling;
+        case (int)ThrottlingPolicy::FixedDelay: return ThrottlingPolicy::FixedDelay;
+        default: return ThrottlingPolicy::Adaptive;
+        }
+    }
+
+    enum struct LoadPriority {
+        Interactive = 0,
+        Normal = 1,
+        Background = 2,
+        PrioritiesCount = 3
+    };
+
+    // tracks responsiveness of the UI thread and backlog of background
+    // queues so workers can decide whether they should step aside
+    class LoadMonitor
+    {
+    public:
+        static LoadMonitor& getInstance()
+        {
+            static LoadMonitor instance; // Guaranteed to be destroyed.
+            // Instantiated on first use.
+            return instance;
+        }
+
+    public:
+        // should be called from the UI thread
+        void startMonitoring();
+        bool isUIBusy() const;
+        bool hasPendingWorkAbove(LoadPriority priority) const;
+        int getPendingWorkAbove(LoadPriority priority) const;
+        bool shouldYield(LoadPriority priority) const;
+        void addPendingWork(LoadPriority priority, int delta);
+        int getPendingWork(LoadPriority priority) const;
+
+    public:
+        // how long worker of the priority should step aside right now, 0 if it should not
+        int getYieldBudgetMs(LoadPriority priority) const;
+        // grows with the backlog of more important queues, busy UI gets the maximum
+        static int calculateYieldBudgetMs(bool isUIBusy, int pendingWorkAbove);
+
+    public:
+        // time dependent part with explicit time in ms of the monitor clock
+        void onHeartbeat(qint64 now);
+        bool isUIBusyAt(qint64 now) const;
+
+    private:
+        void heartbeat();
+
+    private:
+        LoadMonitor();
+
+        LoadMonitor(LoadMonitor const&);
+        void operator=(LoadMonitor const&);
+
+    private:
+        QElapsedTimer m_Clock;
+        QAtomicInteger<qint64> m_LastHeartbeat;
+        QAtomicInt m_UILag;
+        QAtomicInt m_PendingWork[(int)LoadPriority::PrioritiesCount];
+        volatile bool m_IsMonitoring;
+    };
+}
+
+#endif // LOADMONITOR_H
@@ -0,0 +1,249 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "queuetelemetry.h"
+#include <QStringList>
+#include "../Common/defines.h"
+
+namespace Helpers {
+    int getBucketIndex(qint64 microseconds) {
+        int index = 0;
+        while ((microseconds > 1) && (index < LatencyHistogram::BucketsCount - 1)) {
+            microseconds >>= 1;
+            index++;
+        }
+
+        return index;
+    }
+
+    QString formatMicroseconds(qint64 microseconds) {
+        QString result;
+
+        if (microseconds < 1000) {
+            result = QString("%1us").arg(microseconds);
+        } else if (microseconds < 1000000) {
+            result = QString("%1ms").arg(microseconds / 1000.0, 0, 'f', 1);
+        } else {
+            result = QString("%1s").arg(microseconds / 1000000.0, 0, 'f', 2);
+        }
+
+        return result;
+    }
+
+    LatencyHistogram::LatencyHistogram() {
+        reset();
+    }
+
+    void LatencyHistogram::add(qint64 microseconds, qint64 count) {
+        if (microseconds < 0) { microseconds = 0; }
+
+        m_Buckets[getBucketIndex(microseconds)] += count;
+        m_Count += count;
+        m_Sum += microseconds * count;
+
+        if (microseconds > m_Max) {
+            m_Max = microseconds;
+        }
+    }
+
+    void LatencyHistogram::reset() {
+        for (auto &bucket: m_Buckets) {
+            bucket = 0;
+        }
+
+        m_Count = 0;
+        m_Sum = 0;
+        m_Max = 0;
+    }
+
+    qint64 LatencyHistogram::getAverage() const {
+        if (m_Count == 0) { return 0; }
+        return m_Sum / m_Count;
+    }
+
+    qint64 LatencyHistogram::getPercentile(int percent) const {
+        if (m_Count == 0) { return 0; }
+
+        const qint64 threshold = (m_Count * percent + 99) / 100;
+        qint64 accumulated = 0;
+
+        for (int i = 0; i < BucketsCount; ++i) {
+            accumulated += m_Buckets[i];
+            if (accumulated >= threshold) {
+                return qMin(((qint64)1) << (i + 1), m_Max);
+            }
+        }
+
+        return m_Max;
+    }
+
+    QString LatencyHistogram::toString() const {
+        return QString("avg %1 p50 %2 p90 %3 p99 %4 max %5")
+                .arg(formatMicroseconds(getAverage()))
+                .arg(formatMicroseconds(getPercentile(50)))
+                .arg(formatMicroseconds(getPercentile(90)))
+                .arg(formatMicroseconds(getPercentile(99)))
+                .arg(formatMicroseconds(m_Max));
+    }
+
+    QueueTelemetry::QueueTelemetry(const QString &name):
+        m_Name(name),
+        m_EnqueuedCount(0),
+        m_DequeuedCount(0),
+        m_ProcessedCount(0),
+        m_LoggedProcessedCount(0),
+        m_FirstDequeuedAt(-1),
+        m_LastDequeuedAt(0),
+        m_CurrentDepth(0),
+        m_MaxDepth(0)
+    {
+        m_Clock.start();
+    }
+
+    void QueueTelemetry::setName(const QString &name) {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        m_Name = name;
+    }
+
+    void QueueTelemetry::recordEnqueued(int count) {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        m_EnqueuedCount += count;
+    }
+
+    void QueueTelemetry::recordDepth(int depth) {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        m_CurrentDepth = depth;
+        if (depth > m_MaxDepth) {
+            m_MaxDepth = depth;
+        }
+    }
+
+    void QueueTelemetry::recordDequeued(qint64 enqueuedAt) {
+        const qint64 now = getTimestamp();
+
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        m_WaitTime.add(now - enqueuedAt);
+        m_DequeuedCount++;
+        m_LastDequeuedAt = now;
+
+        if (m_FirstDequeuedAt < 0) {
+            m_FirstDequeuedAt = now;
+        }
+    }
+
+    void QueueTelemetry::recordProcessed(qint64 startedAt, int count) {
+        if (count <= 0) { return; }
+        const qint64 now = getTimestamp();
+
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        // items of a batch share its service time
+        m_ServiceTime.add((now - startedAt) / count, count);
+        m_ProcessedCount += count;
+    }
+
+    void QueueTelemetry::reset() {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        m_WaitTime.reset();
+        m_ServiceTime.reset();
+        m_EnqueuedCount = 0;
+        m_DequeuedCount = 0;
+        m_ProcessedCount = 0;
+        m_LoggedProcessedCount = 0;
+        m_FirstDequeuedAt = -1;
+        m_LastDequeuedAt = 0;
+        m_MaxDepth = m_CurrentDepth;
+    }
+
+    qint64 QueueTelemetry::getDequeuedCount() const {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        return m_DequeuedCount;
+    }
+
+    qint64 QueueTelemetry::getProcessedCount() const {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        return m_ProcessedCount;
+    }
+
+    int QueueTelemetry::getMaxDepth() const {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        return m_MaxDepth;
+    }
+
+    double QueueTelemetry::getItemsPerSecond() const {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        return getItemsPerSecondUnsafe();
+    }
+
+    QString QueueTelemetry::getSummary() const {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        return getSummaryUnsafe();
+    }
+
+    void QueueTelemetry::logSummary() const {
+        const QString summary = getSummary();
+        LOG_INFO << summary;
+    }
+
+    void QueueTelemetry::logSummaryIfNeeded(int processedThreshold) {
+        QString summary;
+
+        {
+            QMutexLocker locker(&m_Mutex);
+            Q_UNUSED(locker);
+
+            if (m_ProcessedCount - m_LoggedProcessedCount < processedThreshold) { return; }
+
+            m_LoggedProcessedCount = m_ProcessedCount;
+            summary = getSummaryUnsafe();
+        }
+
+        LOG_INFO << summary;
+    }
+
+    double QueueTelemetry::getItemsPerSecondUnsafe() const {
+        if ((m_FirstDequeuedAt < 0) || (m_LastDequeuedAt <= m_FirstDequeuedAt)) { return 0.0; }
+
+        // rate at which items leave the queue
+        const double seconds = (m_LastDequeuedAt - m_FirstDequeuedAt) / 1000000.0;
+        return m_DequeuedCount / seconds;
+    }
+
+    QString QueueTelemetry::getSummaryUnsafe() const {
+        QStringList lines;
+        lines << QString("[%1] enqueued: %2 dequeued: %3 (%4 items/s) depth: %5 max depth: %6")
+                 .arg(m_Name)
+                 .arg(m_EnqueuedCount)
+                 .arg(m_DequeuedCount)
+                 .arg(getItemsPerSecondUnsafe(), 0, 'f', 1)
+                 .arg(m_CurrentDepth)
+                 .arg(m_MaxDepth);
+        lines << QString("[%1] wait: %2").arg(m_Name).arg(m_WaitTime.toString());
+
+        if (m_ServiceTime.getCount() > 0) {
+            lines << QString("[%1] service: %2 processed: %3").arg(m_Name).arg(m_ServiceTime.toString()).arg(m_ProcessedCount);
+        }
+        return lines.join('\n');
+    }
+}
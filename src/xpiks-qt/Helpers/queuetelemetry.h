@@ -0,0 +1,95 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QUEUETELEMETRY_H
+#define QUEUETELEMETRY_H
+
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QString>
+
+namespace Helpers {
+    // latencies in microseconds grouped into power-of-two buckets
+    class LatencyHistogram
+    {
+    public:
+        enum { BucketsCount = 25 };
+
+    public:
+        LatencyHistogram();
+
+    public:
+        void add(qint64 microseconds, qint64 count = 1);
+        void reset();
+        qint64 getCount() const { return m_Count; }
+        qint64 getMax() const { return m_Max; }
+        qint64 getAverage() const;
+        // upper bound of the bucket where the percentile falls
+        qint64 getPercentile(int percent) const;
+        QString toString() const;
+
+    private:
+        qint64 m_Buckets[BucketsCount];
+        qint64 m_Count;
+        qint64 m_Sum;
+        qint64 m_Max;
+    };
+
+    // instrumentation for a work queue: depth, time items spend
+    // waiting in the queue and time spent processing them
+    class QueueTelemetry
+    {
+    public:
+        QueueTelemetry(const QString &name = QString());
+
+    public:
+        void setName(const QString &name);
+        // monotonic timestamp in microseconds to store with enqueued items
+        qint64 getTimestamp() const { return m_Clock.nsecsElapsed() / 1000; }
+
+    public:
+        void recordEnqueued(int count);
+        void recordDepth(int depth);
+        void recordDequeued(qint64 enqueuedAt);
+        void recordProcessed(qint64 startedAt, int count = 1);
+        void reset();
+
+    public:
+        qint64 getDequeuedCount() const;
+        qint64 getProcessedCount() const;
+        int getMaxDepth() const;
+        double getItemsPerSecond() const;
+        QString getSummary() const;
+        void logSummary() const;
+        // logs summary once enough items were processed since last log
+        void logSummaryIfNeeded(int processedThreshold);
+
+    private:
+        double getItemsPerSecondUnsafe() const;
+        QString getSummaryUnsafe() const;
+
+    private:
+        mutable QMutex m_Mutex;
+        QElapsedTimer m_Clock;
+        QString m_Name;
+        LatencyHistogram m_WaitTime;
+        LatencyHistogram m_ServiceTime;
+        qint64 m_EnqueuedCount;
+        qint64 m_DequeuedCount;
+        qint64 m_ProcessedCount;
+        qint64 m_LoggedProcessedCount;
+        qint64 m_FirstDequeuedAt;
+        qint64 m_LastDequeuedAt;
+        int m_CurrentDepth;
+        int m_MaxDepth;
+    };
+}
+
+#endif // QUEUETELEMETRY_H
@@ -321,6 +321,20 @@ namespace Helpers {
         return !anyFault;
     }
 
+    QByteArray truncateUtf8(const QString &text, int maxBytes) {
+        QByteArray utf8 = text.toUtf8();
+        if (utf8.size() <= maxBytes) { return utf8; }
+
+        int size = qMax(maxBytes, 0);
+        // continuation bytes look like 10xxxxxx
+        while ((size > 0) && ((utf8.at(size) & 0xC0) == 0x80)) {
+            size--;
+        }
+
+        utf8.truncate(size);
+        return utf8;
+    }
+
     bool isPunctuation(const QChar &c) {
         return c.isPunct() && c != QChar('/');
     }
@@ -39,6 +39,8 @@ namespace Helpers {
     unsigned int levensteinDistance(const QString &a, const QString &b);
     int levensteinPercentage(const QString &s1, const QString &s2);
     bool is7BitAscii(const QByteArray &s);
+    // cuts the text on the character boundary same as exiftool does for IPTC
+    QByteArray truncateUtf8(const QString &text, int maxBytes);
     bool isPunctuation(const QChar &);
     std::string string_format(const std::string fmt, ...);
     QString getUnitedHitsString(const QString &text, const std::vector<int> &hits, int radius);
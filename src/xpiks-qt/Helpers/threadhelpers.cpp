@@ -9,6 +9,8 @@
  */
 
 #include "threadhelpers.h"
+#include <QThread>
+#include <QtGlobal>
 
 namespace Helpers {
     ManualResetEvent::ManualResetEvent():
@@ -78,4 +80,13 @@ namespace Helpers {
 
         m_Turnstile2.acquire();
     }
+
+    int getOptimalWorkersCount(int maxWorkersCount) {
+        int idealCount = QThread::idealThreadCount();
+        // idealThreadCount() returns -1 if it cannot be detected
+        if (idealCount <= 0) { idealCount = 1; }
+
+        const int workersCount = qBound(1, idealCount - 1, qMax(maxWorkersCount, 1));
+        return workersCount;
+    }
 }
@@ -50,6 +50,9 @@ namespace Helpers {
         volatile int m_ThreadsNumber;
         volatile int m_Count;
     };
+
+    // number of background consumers leaving one core for the UI thread
+    int getOptimalWorkersCount(int maxWorkersCount);
 }
 
 #endif // THREADHELPERS_H
@@ -0,0 +1,30 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "compactmetadatacachejobitem.h"
+#include "../MetadataIO/metadataioservice.h"
+#include "../Common/defines.h"
+
+namespace Maintenance {
+    CompactMetadataCacheJobItem::CompactMetadataCacheJobItem(MetadataIO::MetadataIOService *metadataIOService, qint64 maxSizeBytes):
+        m_MetadataIOService(metadataIOService),
+        m_MaxSizeBytes(maxSizeBytes)
+    {
+        Q_ASSERT(metadataIOService != nullptr);
+        Q_ASSERT(maxSizeBytes > 0);
+    }
+
+    void CompactMetadataCacheJobItem::processJob() {
+        LOG_DEBUG << "#";
+#ifndef CORE_TESTS
+        m_MetadataIOService->compactCache(m_MaxSizeBytes);
+#endif
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef COMPACTMETADATACACHEJOBITEM_H
+#define COMPACTMETADATACACHEJOBITEM_H
+
+#include <QtGlobal>
+#include "imaintenanceitem.h"
+
+namespace MetadataIO {
+    class MetadataIOService;
+}
+
+namespace Maintenance {
+    class CompactMetadataCacheJobItem: public IMaintenanceItem
+    {
+    public:
+        CompactMetadataCacheJobItem(MetadataIO::MetadataIOService *metadataIOService, qint64 maxSizeBytes);
+
+    public:
+        virtual void processJob() override;
+
+    private:
+        MetadataIO::MetadataIOService *m_MetadataIOService;
+        qint64 m_MaxSizeBytes;
+    };
+}
+
+#endif // COMPACTMETADATACACHEJOBITEM_H
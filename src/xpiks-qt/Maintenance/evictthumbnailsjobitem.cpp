@@ -0,0 +1,41 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "evictthumbnailsjobitem.h"
+#include "../QMLExtensions/imagecachingservice.h"
+#include "../QMLExtensions/videocachingservice.h"
+#include "../Common/defines.h"
+
+namespace Maintenance {
+    EvictThumbnailsJobItem::EvictThumbnailsJobItem(QMLExtensions::ImageCachingService *imageCachingService,
+                                                   QMLExtensions::VideoCachingService *videoCachingService,
+                                                   qint64 imagesMaxSizeBytes, qint64 videosMaxSizeBytes):
+        m_ImageCachingService(imageCachingService),
+        m_VideoCachingService(videoCachingService),
+        m_ImagesMaxSizeBytes(imagesMaxSizeBytes),
+        m_VideosMaxSizeBytes(videosMaxSizeBytes)
+    {
+        Q_ASSERT(imageCachingService != nullptr);
+        Q_ASSERT(videoCachingService != nullptr);
+    }
+
+    void EvictThumbnailsJobItem::processJob() {
+        LOG_DEBUG << "#";
+#ifndef CORE_TESTS
+        if (m_ImagesMaxSizeBytes > 0) {
+            m_ImageCachingService->evictCacheStorage(m_ImagesMaxSizeBytes);
+        }
+
+        if (m_VideosMaxSizeBytes > 0) {
+            m_VideoCachingService->evictCacheStorage(m_VideosMaxSizeBytes);
+        }
+#endif
+    }
+}
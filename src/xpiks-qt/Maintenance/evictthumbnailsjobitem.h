@@ -0,0 +1,41 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef EVICTTHUMBNAILSJOBITEM_H
+#define EVICTTHUMBNAILSJOBITEM_H
+
+#include <QtGlobal>
+#include "imaintenanceitem.h"
+
+namespace QMLExtensions {
+    class ImageCachingService;
+    class VideoCachingService;
+}
+
+namespace Maintenance {
+    class EvictThumbnailsJobItem: public IMaintenanceItem
+    {
+    public:
+        EvictThumbnailsJobItem(QMLExtensions::ImageCachingService *imageCachingService,
+                               QMLExtensions::VideoCachingService *videoCachingService,
+                               qint64 imagesMaxSizeBytes, qint64 videosMaxSizeBytes);
+
+    public:
+        virtual void processJob() override;
+
+    private:
+        QMLExtensions::ImageCachingService *m_ImageCachingService;
+        QMLExtensions::VideoCachingService *m_VideoCachingService;
+        qint64 m_ImagesMaxSizeBytes;
+        qint64 m_VideosMaxSizeBytes;
+    };
+}
+
+#endif // EVICTTHUMBNAILSJOBITEM_H
@@ -16,6 +16,7 @@
 #include <QStandardPaths>
 #include "../MetadataIO/metadataiocoordinator.h"
 #include "launchexiftooljobitem.h"
+#include <exiftoolpool.h>
 
 #define EXIFTOOL_VERSION_TIMEOUT 3000
 
@@ -106,5 +107,7 @@ namespace Maintenance {
         LOG_DEBUG << "#";
         QString recommendedPath = discoverExiftool(m_SettingsExiftoolPath);
         m_MetadataIOCoordinator->setRecommendedExiftoolPath(recommendedPath);
+        // first import or save will not wait for perl to start
+        libxpks::io::warmUpExiftoolPool(recommendedPath);
     }
 }
@@ -19,6 +19,9 @@
 #include "movesettingsjobitem.h"
 #include "savesessionjobitem.h"
 #include "moveimagecachejobitem.h"
+#include "compactimagecachejobitem.h"
+#include "compactmetadatacachejobitem.h"
+#include "evictthumbnailsjobitem.h"
 #include "xpkscleanupjob.h"
 
 namespace Maintenance {
@@ -102,6 +105,31 @@ namespace Maintenance {
         m_MaintenanceWorker->submitItem(jobItem);
     }
 
+    void MaintenanceService::compactImagesCache(QMLExtensions::ImageCachingService *imageCachingService) {
+        std::shared_ptr<IMaintenanceItem> jobItem(new CompactImageCacheJobItem(imageCachingService));
+        m_MaintenanceWorker->submitItem(jobItem);
+    }
+
+    void MaintenanceService::evictThumbnails(QMLExtensions::ImageCachingService *imageCachingService,
+                                             QMLExtensions::VideoCachingService *videoCachingService,
+                                             int imagesMaxSizeMB, int videosMaxSizeMB) {
+        LOG_DEBUG << imagesMaxSizeMB << videosMaxSizeMB;
+        if ((imagesMaxSizeMB <= 0) && (videosMaxSizeMB <= 0)) { return; }
+
+        std::shared_ptr<IMaintenanceItem> jobItem(new EvictThumbnailsJobItem(imageCachingService, videoCachingService,
+                                                                             (qint64)imagesMaxSizeMB * 1024 * 1024,
+                                                                             (qint64)videosMaxSizeMB * 1024 * 1024));
+        m_MaintenanceWorker->submitItem(jobItem);
+    }
+
+    void MaintenanceService::compactMetadataCache(MetadataIO::MetadataIOService *metadataIOService, int maxSizeMB) {
+        LOG_DEBUG << maxSizeMB;
+        if (maxSizeMB <= 0) { return; }
+
+        std::shared_ptr<IMaintenanceItem> jobItem(new CompactMetadataCacheJobItem(metadataIOService, (qint64)maxSizeMB * 1024 * 1024));
+        m_MaintenanceWorker->submitItem(jobItem);
+    }
+
     void MaintenanceService::saveSession(std::unique_ptr<MetadataIO::SessionSnapshot> &sessionSnapshot, Models::SessionManager *sessionManager) {
         LOG_DEBUG << "#";
 
@@ -20,6 +20,7 @@ namespace Models {
 
 namespace MetadataIO {
     class MetadataIOCoordinator;
+    class MetadataIOService;
 }
 
 namespace Translation {
@@ -37,6 +38,7 @@ namespace Helpers {
 
 namespace QMLExtensions {
     class ImageCachingService;
+    class VideoCachingService;
 }
 
 namespace Maintenance {
@@ -59,6 +61,11 @@ namespace Maintenance {
         void cleanupLogs();
         void moveSettings(Models::SettingsModel *settingsModel);
         void upgradeImagesCache(QMLExtensions::ImageCachingService *imageCachingService);
+        void compactImagesCache(QMLExtensions::ImageCachingService *imageCachingService);
+        void evictThumbnails(QMLExtensions::ImageCachingService *imageCachingService,
+                             QMLExtensions::VideoCachingService *videoCachingService,
+                             int imagesMaxSizeMB, int videosMaxSizeMB);
+        void compactMetadataCache(MetadataIO::MetadataIOService *metadataIOService, int maxSizeMB);
         void saveSession(std::unique_ptr<MetadataIO::SessionSnapshot> &sessionSnapshot, Models::SessionManager *sessionManager);
         void cleanupOldXpksBackups(const QString &directory);
 
@@ -9,6 +9,7 @@
  */
 
 #include "cachedartwork.h"
+#include <QFileInfo>
 #include "../Models/artworkmetadata.h"
 #include "../Models/imageartwork.h"
 #include "../Models/videoartwork.h"
@@ -22,7 +23,10 @@ namespace MetadataIO {
         m_Flags(0),
         m_FilesizeBytes(0),
         m_CategoryID_1(0),
-        m_CategoryID_2(0)
+        m_CategoryID_2(0),
+        m_VideoDuration(0.0),
+        m_VideoFrameRate(0.0),
+        m_VideoBitRate(0)
     {
         initSerializationVersion();
     }
@@ -31,7 +35,10 @@ namespace MetadataIO {
         m_Version(0),
         m_Flags(0),
         m_CategoryID_1(0),
-        m_CategoryID_2(0)
+        m_CategoryID_2(0),
+        m_VideoDuration(0.0),
+        m_VideoFrameRate(0.0),
+        m_VideoBitRate(0)
     {
         initSerializationVersion();
 
@@ -54,6 +61,18 @@ namespace MetadataIO {
             Q_ASSERT(video != nullptr);
             m_ArtworkType = Video;
             m_CodecName = video->getCodecName();
+
+            if (video->hasVideoProperties()) {
+                QFileInfo fi(m_Filepath);
+                if (fi.exists()) {
+                    m_FilesizeBytes = (quint64)fi.size();
+                    m_FileModifiedTime = fi.lastModified();
+                    m_VideoDuration = video->getDuration();
+                    m_VideoFrameRate = video->getFrameRate();
+                    m_VideoBitRate = video->getBitRateBps();
+                    m_VideoSize = video->getImageSize();
+                }
+            }
         }
     }
 
@@ -73,7 +92,12 @@ namespace MetadataIO {
         m_CreationTime(from.m_CreationTime),
         m_Keywords(from.m_Keywords),
         m_ModelReleaseIDs(from.m_ModelReleaseIDs),
-        m_PropertyReleaseIDs(from.m_PropertyReleaseIDs)
+        m_PropertyReleaseIDs(from.m_PropertyReleaseIDs),
+        m_FileModifiedTime(from.m_FileModifiedTime),
+        m_VideoDuration(from.m_VideoDuration),
+        m_VideoFrameRate(from.m_VideoFrameRate),
+        m_VideoBitRate(from.m_VideoBitRate),
+        m_VideoSize(from.m_VideoSize)
     {
     }
 
@@ -94,6 +118,11 @@ namespace MetadataIO {
         m_Keywords = other.m_Keywords;
         m_ModelReleaseIDs = other.m_ModelReleaseIDs;
         m_PropertyReleaseIDs = other.m_PropertyReleaseIDs;
+        m_FileModifiedTime = other.m_FileModifiedTime;
+        m_VideoDuration = other.m_VideoDuration;
+        m_VideoFrameRate = other.m_VideoFrameRate;
+        m_VideoBitRate = other.m_VideoBitRate;
+        m_VideoSize = other.m_VideoSize;
 
         return *this;
     }
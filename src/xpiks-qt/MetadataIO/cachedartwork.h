@@ -16,6 +16,7 @@
 #include <QString>
 #include <QDateTime>
 #include <QVector>
+#include <QSize>
 #include "../Common/flags.h"
 
 namespace Models {
@@ -57,6 +58,14 @@ namespace MetadataIO {
         QVector<quint16> m_ModelReleaseIDs;
         QVector<quint16> m_PropertyReleaseIDs;
         // END of version 1 data
+        // BEGIN of flat record version 2 data
+        // probed video properties are valid while file size and modification time match
+        /*VIDEO*/QDateTime m_FileModifiedTime;
+        /*VIDEO*/double m_VideoDuration;
+        /*VIDEO*/double m_VideoFrameRate;
+        /*VIDEO*/qint64 m_VideoBitRate;
+        /*VIDEO*/QSize m_VideoSize;
+        // END of flat record version 2 data
     };
 
     QDataStream &operator<<(QDataStream &out, const CachedArtwork &v);
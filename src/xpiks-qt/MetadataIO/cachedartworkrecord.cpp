@@ -0,0 +1,318 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "cachedartworkrecord.h"
+#include <QDataStream>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+#include "../Common/defines.h"
+
+// "XPCA" in little endian
+#define RECORD_MAGIC 0x41435058
+#define RECORD_FORMAT_VERSION 2
+
+#define MAGIC_OFFSET 0
+#define VERSION_OFFSET 4
+#define TYPE_OFFSET 6
+#define FLAGS_OFFSET 8
+#define CATEGORY1_OFFSET 12
+#define CATEGORY2_OFFSET 14
+#define FILESIZE_OFFSET 16
+#define CREATION_TIME_OFFSET 24
+#define KEYWORDS_COUNT_OFFSET 32
+#define FIELDS_TABLE_OFFSET 36
+#define FIELD_ENTRY_SIZE 8
+#define HEADER_SIZE(fieldsCount) (FIELDS_TABLE_OFFSET + (fieldsCount) * FIELD_ENTRY_SIZE)
+#define RECORD_HEADER_SIZE HEADER_SIZE(CachedArtworkRecord::FieldsCount)
+// version 1 did not have video properties
+#define V1_FIELDS_COUNT (CachedArtworkRecord::FieldVideoProperties)
+#define MIN_HEADER_SIZE HEADER_SIZE(V1_FIELDS_COUNT)
+
+// modification time, duration, frame rate, bit rate, width, height
+#define VIDEO_PROPERTIES_SIZE 40
+
+#define KEYWORDS_SEPARATOR QLatin1Char('\n')
+#define INVALID_CREATION_TIME std::numeric_limits<qint64>::min()
+
+namespace MetadataIO {
+    template<typename T>
+    T readLE(const QByteArray &data, int offset) {
+        return qFromLittleEndian<T>((const uchar *)data.constData() + offset);
+    }
+
+    template<typename T>
+    void writeLE(QByteArray &data, int offset, T value) {
+        qToLittleEndian<T>(value, (uchar *)data.data() + offset);
+    }
+
+    void appendField(QByteArray &data, int field, const QByteArray &value) {
+        const int entryOffset = FIELDS_TABLE_OFFSET + field * FIELD_ENTRY_SIZE;
+        writeLE<quint32>(data, entryOffset, (quint32)data.size());
+        writeLE<quint32>(data, entryOffset + 4, (quint32)value.size());
+        data.append(value);
+    }
+
+    // doubles are stored as their bit pattern
+    quint64 doubleToBits(double value) {
+        quint64 bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    double bitsToDouble(quint64 bits) {
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    QByteArray videoPropertiesToBytes(const CachedArtwork &cachedArtwork) {
+        QByteArray bytes;
+        // properties are only valid for the file they were probed from
+        if (!cachedArtwork.m_FileModifiedTime.isValid()) { return bytes; }
+
+        bytes.fill('\0', VIDEO_PROPERTIES_SIZE);
+        writeLE<qint64>(bytes, 0, cachedArtwork.m_FileModifiedTime.toMSecsSinceEpoch());
+        writeLE<quint64>(bytes, 8, doubleToBits(cachedArtwork.m_VideoDuration));
+        writeLE<quint64>(bytes, 16, doubleToBits(cachedArtwork.m_VideoFrameRate));
+        writeLE<qint64>(bytes, 24, cachedArtwork.m_VideoBitRate);
+        writeLE<quint32>(bytes, 32, (quint32)qMax(cachedArtwork.m_VideoSize.width(), 0));
+        writeLE<quint32>(bytes, 36, (quint32)qMax(cachedArtwork.m_VideoSize.height(), 0));
+
+        return bytes;
+    }
+
+    QByteArray releasesToBytes(const QVector<quint16> &ids) {
+        QByteArray bytes(ids.size() * (int)sizeof(quint16), '\0');
+        for (int i = 0; i < ids.size(); ++i) {
+            writeLE<quint16>(bytes, i * (int)sizeof(quint16), ids.at(i));
+        }
+
+        return bytes;
+    }
+
+    CachedArtworkRecord::CachedArtworkRecord(const QByteArray &data):
+        m_Data(data),
+        m_IsValid(false)
+    {
+        m_IsValid = validate();
+    }
+
+    bool CachedArtworkRecord::isRecord(const QByteArray &data) {
+        return (data.size() >= MIN_HEADER_SIZE) &&
+                (readLE<quint32>(data, MAGIC_OFFSET) == RECORD_MAGIC);
+    }
+
+    QByteArray CachedArtworkRecord::serialize(const CachedArtwork &cachedArtwork) {
+        QStringList keywords = cachedArtwork.m_Keywords;
+        // separator cannot be a part of a keyword
+        keywords.replaceInStrings(QString(KEYWORDS_SEPARATOR), QLatin1String(" "));
+
+        const QByteArray filepath = cachedArtwork.m_Filepath.toUtf8();
+        const QByteArray title = cachedArtwork.m_Title.toUtf8();
+        const QByteArray description = cachedArtwork.m_Description.toUtf8();
+        const QByteArray keywordsText = keywords.join(KEYWORDS_SEPARATOR).toUtf8();
+
+        QByteArray data(RECORD_HEADER_SIZE, '\0');
+        data.reserve(RECORD_HEADER_SIZE + filepath.size() + title.size() + description.size() + keywordsText.size());
+
+        writeLE<quint32>(data, MAGIC_OFFSET, RECORD_MAGIC);
+        writeLE<quint16>(data, VERSION_OFFSET, RECORD_FORMAT_VERSION);
+        writeLE<quint16>(data, TYPE_OFFSET, cachedArtwork.m_ArtworkType);
+        writeLE<quint32>(data, FLAGS_OFFSET, cachedArtwork.m_Flags);
+        writeLE<quint16>(data, CATEGORY1_OFFSET, cachedArtwork.m_CategoryID_1);
+        writeLE<quint16>(data, CATEGORY2_OFFSET, cachedArtwork.m_CategoryID_2);
+        writeLE<quint64>(data, FILESIZE_OFFSET, cachedArtwork.m_FilesizeBytes);
+        writeLE<qint64>(data, CREATION_TIME_OFFSET, cachedArtwork.m_CreationTime.isValid() ?
+                            cachedArtwork.m_CreationTime.toMSecsSinceEpoch() : INVALID_CREATION_TIME);
+        writeLE<quint32>(data, KEYWORDS_COUNT_OFFSET, (quint32)keywords.size());
+
+        appendField(data, FieldFilepath, filepath);
+        appendField(data, FieldTitle, title);
+        appendField(data, FieldDescription, description);
+        appendField(data, FieldThumbnailPath, cachedArtwork.m_ThumbnailPath.toUtf8());
+        appendField(data, FieldCodecName, cachedArtwork.m_CodecName.toUtf8());
+        appendField(data, FieldAttachedVector, cachedArtwork.m_AttachedVector.toUtf8());
+        appendField(data, FieldKeywords, keywordsText);
+        appendField(data, FieldModelReleases, releasesToBytes(cachedArtwork.m_ModelReleaseIDs));
+        appendField(data, FieldPropertyReleases, releasesToBytes(cachedArtwork.m_PropertyReleaseIDs));
+        appendField(data, FieldVideoProperties, videoPropertiesToBytes(cachedArtwork));
+
+        return data;
+    }
+
+    quint16 CachedArtworkRecord::getFormatVersion() const {
+        Q_ASSERT(m_IsValid);
+        return readLE<quint16>(m_Data, VERSION_OFFSET);
+    }
+
+    quint16 CachedArtworkRecord::getArtworkType() const {
+        Q_ASSERT(m_IsValid);
+        return readLE<quint16>(m_Data, TYPE_OFFSET);
+    }
+
+    Common::flag_t CachedArtworkRecord::getFlags() const {
+        Q_ASSERT(m_IsValid);
+        return readLE<quint32>(m_Data, FLAGS_OFFSET);
+    }
+
+    quint64 CachedArtworkRecord::getFilesizeBytes() const {
+        Q_ASSERT(m_IsValid);
+        return readLE<quint64>(m_Data, FILESIZE_OFFSET);
+    }
+
+    int CachedArtworkRecord::getKeywordsCount() const {
+        Q_ASSERT(m_IsValid);
+        return (int)readLE<quint32>(m_Data, KEYWORDS_COUNT_OFFSET);
+    }
+
+    QStringList CachedArtworkRecord::getKeywords() const {
+        QStringList keywords;
+        if (getKeywordsCount() == 0) { return keywords; }
+
+        keywords = getKeywordsText().split(KEYWORDS_SEPARATOR);
+        Q_ASSERT(keywords.size() == getKeywordsCount());
+
+        return keywords;
+    }
+
+    bool CachedArtworkRecord::materialize(CachedArtwork &cachedArtwork) const {
+        if (!m_IsValid) { return false; }
+
+        cachedArtwork.m_ArtworkType = getArtworkType();
+        cachedArtwork.m_Flags = getFlags();
+        cachedArtwork.m_FilesizeBytes = getFilesizeBytes();
+        cachedArtwork.m_CategoryID_1 = readLE<quint16>(m_Data, CATEGORY1_OFFSET);
+        cachedArtwork.m_CategoryID_2 = readLE<quint16>(m_Data, CATEGORY2_OFFSET);
+        cachedArtwork.m_Filepath = getFilepath();
+        cachedArtwork.m_Title = getTitle();
+        cachedArtwork.m_Description = getDescription();
+        cachedArtwork.m_ThumbnailPath = getString(FieldThumbnailPath);
+        cachedArtwork.m_CodecName = getString(FieldCodecName);
+        cachedArtwork.m_AttachedVector = getString(FieldAttachedVector);
+
+        const qint64 creationTime = readLE<qint64>(m_Data, CREATION_TIME_OFFSET);
+        cachedArtwork.m_CreationTime = (creationTime != INVALID_CREATION_TIME) ?
+                    QDateTime::fromMSecsSinceEpoch(creationTime) : QDateTime();
+
+        cachedArtwork.m_Keywords = getKeywords();
+        getReleaseIDs(FieldModelReleases, cachedArtwork.m_ModelReleaseIDs);
+        getReleaseIDs(FieldPropertyReleases, cachedArtwork.m_PropertyReleaseIDs);
+        getVideoProperties(cachedArtwork);
+
+        return true;
+    }
+
+    int CachedArtworkRecord::getFieldsCount() const {
+        return (readLE<quint16>(m_Data, VERSION_OFFSET) == 1) ? V1_FIELDS_COUNT : FieldsCount;
+    }
+
+    QString CachedArtworkRecord::getString(RecordField field) const {
+        const char *data = nullptr;
+        int size = 0;
+
+        QString result;
+        if (getField(field, data, size) && (size > 0)) {
+            result = QString::fromUtf8(data, size);
+        }
+
+        return result;
+    }
+
+    bool CachedArtworkRecord::getField(RecordField field, const char *&data, int &size) const {
+        Q_ASSERT(m_IsValid);
+        if (!m_IsValid) { return false; }
+        // field is missing in the older versions
+        if (field >= getFieldsCount()) { return false; }
+
+        const int entryOffset = FIELDS_TABLE_OFFSET + field * FIELD_ENTRY_SIZE;
+        const quint32 offset = readLE<quint32>(m_Data, entryOffset);
+        const quint32 fieldSize = readLE<quint32>(m_Data, entryOffset + 4);
+
+        data = m_Data.constData() + offset;
+        size = (int)fieldSize;
+        return true;
+    }
+
+    void CachedArtworkRecord::getReleaseIDs(RecordField field, QVector<quint16> &ids) const {
+        const char *data = nullptr;
+        int size = 0;
+
+        ids.clear();
+        if (!getField(field, data, size)) { return; }
+
+        const int count = size / (int)sizeof(quint16);
+        ids.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            ids.append(qFromLittleEndian<quint16>((const uchar *)data + i * sizeof(quint16)));
+        }
+    }
+
+    void CachedArtworkRecord::getVideoProperties(CachedArtwork &cachedArtwork) const {
+        const char *data = nullptr;
+        int size = 0;
+
+        cachedArtwork.m_FileModifiedTime = QDateTime();
+        if (!getField(FieldVideoProperties, data, size) || (size != VIDEO_PROPERTIES_SIZE)) { return; }
+
+        const uchar *bytes = (const uchar *)data;
+        cachedArtwork.m_FileModifiedTime = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(bytes));
+        cachedArtwork.m_VideoDuration = bitsToDouble(qFromLittleEndian<quint64>(bytes + 8));
+        cachedArtwork.m_VideoFrameRate = bitsToDouble(qFromLittleEndian<quint64>(bytes + 16));
+        cachedArtwork.m_VideoBitRate = qFromLittleEndian<qint64>(bytes + 24);
+        cachedArtwork.m_VideoSize = QSize((int)qFromLittleEndian<quint32>(bytes + 32),
+                                          (int)qFromLittleEndian<quint32>(bytes + 36));
+    }
+
+    bool CachedArtworkRecord::validate() const {
+        if (!isRecord(m_Data)) { return false; }
+
+        const quint16 version = readLE<quint16>(m_Data, VERSION_OFFSET);
+        if ((version < 1) || (version > RECORD_FORMAT_VERSION)) {
+            LOG_WARNING << "Unsupported record version" << version;
+            return false;
+        }
+
+        const int fieldsCount = getFieldsCount();
+        const quint64 headerSize = (quint64)HEADER_SIZE(fieldsCount);
+        const quint64 dataSize = (quint64)m_Data.size();
+        if (dataSize < headerSize) { return false; }
+
+        for (int field = 0; field < fieldsCount; ++field) {
+            const int entryOffset = FIELDS_TABLE_OFFSET + field * FIELD_ENTRY_SIZE;
+            const quint64 offset = readLE<quint32>(m_Data, entryOffset);
+            const quint64 size = readLE<quint32>(m_Data, entryOffset + 4);
+
+            if ((offset < headerSize) || (offset + size > dataSize)) {
+                LOG_WARNING << "Record field" << field << "is out of bounds";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool deserializeCachedArtwork(const QByteArray &data, CachedArtwork &cachedArtwork, bool &isLegacy) {
+        bool success = false;
+
+        if (CachedArtworkRecord::isRecord(data)) {
+            isLegacy = false;
+            CachedArtworkRecord record(data);
+            success = record.materialize(cachedArtwork);
+        } else {
+            isLegacy = true;
+            QDataStream ds(data);
+            ds >> cachedArtwork;
+            success = (ds.status() == QDataStream::Ok);
+        }
+
+        return success;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CACHEDARTWORKRECORD_H
+#define CACHEDARTWORKRECORD_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include "cachedartwork.h"
+
+namespace MetadataIO {
+    // Flat layout of CachedArtwork stored in the metadata cache:
+    //   fixed header (little endian)
+    //   fields table: (offset, size) pair for every variable field
+    //   pool: utf-8 strings and arrays of release ids
+    // Keywords are stored as one utf-8 string separated by '\n'.
+    // Version 2 appends probed video properties to the fields table.
+    // Rows written by older versions with QDataStream start with
+    // a big endian version number and never match the magic.
+    class CachedArtworkRecord
+    {
+    public:
+        enum RecordField {
+            FieldFilepath = 0,
+            FieldTitle,
+            FieldDescription,
+            FieldThumbnailPath,
+            FieldCodecName,
+            FieldAttachedVector,
+            FieldKeywords,
+            FieldModelReleases,
+            FieldPropertyReleases,
+            // BEGIN of version 2 fields
+            FieldVideoProperties,
+            FieldsCount
+        };
+
+    public:
+        // keeps a shallow copy of data, nothing is decoded until asked
+        CachedArtworkRecord(const QByteArray &data);
+
+    public:
+        static bool isRecord(const QByteArray &data);
+        static QByteArray serialize(const CachedArtwork &cachedArtwork);
+
+    public:
+        bool isValid() const { return m_IsValid; }
+        quint16 getFormatVersion() const;
+        quint16 getArtworkType() const;
+        Common::flag_t getFlags() const;
+        quint64 getFilesizeBytes() const;
+        int getKeywordsCount() const;
+
+    public:
+        QString getFilepath() const { return getString(FieldFilepath); }
+        QString getTitle() const { return getString(FieldTitle); }
+        QString getDescription() const { return getString(FieldDescription); }
+        // all keywords separated by '\n' with a single allocation
+        QString getKeywordsText() const { return getString(FieldKeywords); }
+        QStringList getKeywords() const;
+        bool materialize(CachedArtwork &cachedArtwork) const;
+
+    private:
+        int getFieldsCount() const;
+        QString getString(RecordField field) const;
+        bool getField(RecordField field, const char *&data, int &size) const;
+        void getReleaseIDs(RecordField field, QVector<quint16> &ids) const;
+        void getVideoProperties(CachedArtwork &cachedArtwork) const;
+        bool validate() const;
+
+    private:
+        QByteArray m_Data;
+        bool m_IsValid;
+    };
+
+    // accepts both the flat record and the legacy QDataStream rows
+    // isLegacy is set for rows that should be rewritten
+    bool deserializeCachedArtwork(const QByteArray &data, CachedArtwork &cachedArtwork, bool &isLegacy);
+}
+
+#endif // CACHEDARTWORKRECORD_H
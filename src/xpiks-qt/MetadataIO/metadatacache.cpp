@@ -10,11 +10,23 @@
 
 #include "metadatacache.h"
 #include <QFileInfo>
+#include <QDateTime>
+#include <QThread>
+#include <algorithm>
+#include <vector>
+#include "cachedartworkrecord.h"
 #include <functional>
 #include "../Models/artworkmetadata.h"
 #include "../Helpers/constants.h"
 #include "../Common/defines.h"
 
+#define SEARCH_INDEX_REBUILD_CHUNK 1000
+#define COMPACTION_PAGE_SIZE 500
+#define COMPACTION_PAGE_PAUSE_MS 20
+#define VACUUM_STEP_PAGES 1024
+// access times are only needed for eviction so they are written rarely
+#define ACCESS_TIMES_FLUSH_SIZE 2000
+
 namespace MetadataIO {
     CachedArtwork::CachedArtworkType queryFlagToCachedType(Common::flag_t queryFlag) {
         CachedArtwork::CachedArtworkType searchType = CachedArtwork::Unknown;
@@ -30,8 +42,83 @@ namespace MetadataIO {
         return searchType;
     }
 
+    Helpers::Database::FullTextRecord toSearchRecord(const QByteArray &key, int category, const QString &title, const QString &description, const QString &keywordsText) {
+        Helpers::Database::FullTextRecord record;
+        record.m_Key = key;
+        record.m_Category = category;
+        // order has to match columns of the search index
+        record.m_Values << title << description << keywordsText;
+        return record;
+    }
+
+    Helpers::Database::FullTextRecord toSearchRecord(const QString &filepath, const CachedArtwork &cachedArtwork) {
+        return toSearchRecord(filepath.toUtf8(), cachedArtwork.m_ArtworkType,
+                              cachedArtwork.m_Title, cachedArtwork.m_Description,
+                              cachedArtwork.m_Keywords.join(QLatin1Char('\n')));
+    }
+
+    bool containsAnyTerm(const QString &text, const QStringList &searchTerms) {
+        foreach (const QString &searchTerm, searchTerms) {
+            if (text.contains(searchTerm, Qt::CaseInsensitive)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    QVector<Helpers::Database::FullTextRecord> toSearchRecords(const QHash<QString, CachedArtwork> &items) {
+        QVector<Helpers::Database::FullTextRecord> records;
+        records.reserve(items.size());
+
+        auto it = items.begin();
+        auto itEnd = items.end();
+        for (; it != itEnd; ++it) {
+            records.append(toSearchRecord(it.key(), it.value()));
+        }
+
+        return records;
+    }
+
+    // any of the terms matches as a prefix of a word
+    QString buildMatchExpression(const QStringList &searchTerms) {
+        QStringList parts;
+
+        foreach (const QString &searchTerm, searchTerms) {
+            QString term = searchTerm.trimmed();
+            if (term.isEmpty()) { continue; }
+
+            term.replace(QLatin1Char('"'), QLatin1String("\"\""));
+            parts.append(QString("\"%1\"*").arg(term));
+        }
+
+        return parts.join(" OR ");
+    }
+
+    bool ArtworkWAL::valueToByteArray(const CachedArtwork &value, QByteArray &rawValue) const {
+        rawValue = CachedArtworkRecord::serialize(value);
+        return true;
+    }
+
+    bool ArtworkWAL::byteArrayToValue(const QByteArray &rawValue, CachedArtwork &value) const {
+        bool isLegacy = false;
+        return deserializeCachedArtwork(rawValue, value, isLegacy);
+    }
+
+    void ArtworkSetWAL::onFlushed(const QHash<QString, CachedArtwork> &flushedItems) {
+        if (!m_SearchIndex) { return; }
+        m_SearchIndex->trySetMany(toSearchRecords(flushedItems));
+    }
+
+    void ArtworkAddWAL::onFlushed(const QHash<QString, CachedArtwork> &flushedItems) {
+        if (!m_SearchIndex) { return; }
+        m_SearchIndex->tryAddMany(toSearchRecords(flushedItems));
+    }
+
     MetadataCache::MetadataCache(Helpers::DatabaseManager *dbManager):
-        m_DatabaseManager(dbManager)
+        m_DatabaseManager(dbManager),
+        m_IsAvailable(0),
+        m_VacuumRequested(0)
     {
         Q_ASSERT(dbManager != nullptr);
     }
@@ -48,7 +135,8 @@ namespace MetadataIO {
                 break;
             }
 
-            if (!m_Database->initialize()) {
+            // space of evicted records is returned incrementally
+            if (!m_Database->initialize(true)) {
                 LOG_WARNING << "Failed to initialize metadata cache";
                 break;
             }
@@ -59,7 +147,28 @@ namespace MetadataIO {
                 break;
             }
 
+            m_AccessIndex = m_Database->getTable(Constants::METADATA_ACCESS_TABLE);
+            if (!m_AccessIndex) {
+                LOG_WARNING << "Failed to get table" << Constants::METADATA_ACCESS_TABLE;
+                break;
+            }
+
+            m_SearchIndex = m_Database->getFullTextTable(Constants::METADATA_SEARCH_TABLE,
+                                                         QStringList() << "title" << "description" << "keywords",
+                                                         QVector<double>() << 10.0 << 2.0 << 5.0);
+            if (m_SearchIndex) {
+                m_SetWAL.setSearchIndex(m_SearchIndex);
+                m_AddWal.setSearchIndex(m_SearchIndex);
+
+                if (m_SearchIndex->isEmpty()) {
+                    rebuildSearchIndex();
+                }
+            } else {
+                LOG_WARNING << "Failed to get search index. Search will scan the whole cache";
+            }
+
             success = true;
+            m_IsAvailable.storeRelease(1);
             LOG_INFO << "Metadata cache initialized";
         } while (false);
 
@@ -69,6 +178,16 @@ namespace MetadataIO {
     void MetadataCache::finalize() {
         LOG_DEBUG << "#";
 
+        if (m_IsAvailable.loadAcquire()) {
+            // postponed access times would be lost otherwise
+            flushWAL(true);
+        }
+
+        m_IsAvailable.storeRelease(0);
+        // wait for the current eviction pass
+        QMutexLocker locker(&m_CompactionMutex);
+        Q_UNUSED(locker);
+
         if (m_Database) {
             m_Database->close();
         }
@@ -77,7 +196,7 @@ namespace MetadataIO {
     void MetadataCache::sync() {
         LOG_DEBUG << "#";
 
-        flushWAL();
+        flushWAL(false);
 
         if (m_Database) {
             m_Database->sync();
@@ -88,8 +207,8 @@ namespace MetadataIO {
     void MetadataCache::dumpToLog() {
         m_DbCacheIndex->foreachRow([&](QByteArray &, QByteArray &rawValue) {
             CachedArtwork value;
-            QDataStream ds(&rawValue, QIODevice::ReadOnly);
-            ds >> value;
+            bool isLegacy = false;
+            deserializeCachedArtwork(rawValue, value, isLegacy);
 
             LOG_DEBUG << value.m_Filepath << "|" << value.m_Title << "|" << value.m_Description << "|" << value.m_Keywords;
             return true; // just continue
@@ -99,8 +218,8 @@ namespace MetadataIO {
     void MetadataCache::dumpToArray(QVector<MetadataIO::CachedArtwork> &cachedArtworks) {
         m_DbCacheIndex->foreachRow([&](QByteArray &, QByteArray &rawValue) {
             CachedArtwork value;
-            QDataStream ds(&rawValue, QIODevice::ReadOnly);
-            ds >> value;
+            bool isLegacy = false;
+            deserializeCachedArtwork(rawValue, value, isLegacy);
 
             cachedArtworks.push_back(value);
             return true; // just continue
@@ -129,29 +248,80 @@ namespace MetadataIO {
 
         const QString &filepath = artwork->getFilepath();
         QByteArray rawValue;
-        bool found = false;
+        const QByteArray key = filepath.toUtf8();
+        const bool found = m_DbCacheIndex->tryGetValue(key, rawValue);
+        bool success = false;
 
-        {
-            const QByteArray key = filepath.toUtf8();
+        if (found) {
+            bool isLegacy = false;
+            success = deserializeCachedArtwork(rawValue, cachedArtwork, isLegacy);
+            Q_ASSERT(success);
+
+            if (success) {
+                touch(filepath);
+                if (isLegacy) {
+                    migrateLegacyRecord(filepath, cachedArtwork);
+                }
+            }
+        }
 
-            QMutexLocker locker(&m_ReadMutex);
-            Q_UNUSED(locker);
+        return success;
+    }
+
+    int MetadataCache::readMany(const WeakArtworksSnapshot &artworks, QVector<QPair<int, CachedArtwork> > &cachedArtworks) {
+        const int size = (int)artworks.size();
+        LOG_DEBUG << size << "item(s)";
 
-            found = m_DbCacheIndex->tryGetValue(key, rawValue);
+        QVector<QByteArray> keys;
+        keys.reserve(size);
+        QHash<QByteArray, int> keyToIndexMap;
+        keyToIndexMap.reserve(size);
+
+        for (int i = 0; i < size; ++i) {
+            Models::ArtworkMetadata *artwork = artworks.at(i);
+            Q_ASSERT(artwork != nullptr);
+            if (artwork == nullptr) { continue; }
+
+            QByteArray key = artwork->getFilepath().toUtf8();
+            keyToIndexMap.insert(key, i);
+            keys.append(key);
         }
 
-        if (found) {
-            CachedArtwork value;
-            QDataStream ds(&rawValue, QIODevice::ReadOnly);
-            ds >> value;
-            Q_ASSERT(ds.status() == QDataStream::Ok);
+        QVector<QPair<QByteArray, QByteArray> > keyValueList;
+        keyValueList.reserve(size);
+        m_DbCacheIndex->tryGetMany(keys, keyValueList);
 
-            if (ds.status() == QDataStream::Ok) {
-                cachedArtwork = value;
+        int foundCount = 0;
+        cachedArtworks.reserve(cachedArtworks.size() + keyValueList.size());
+
+        for (auto &keyValue: keyValueList) {
+            const int index = keyToIndexMap.value(keyValue.first, -1);
+            Q_ASSERT(index != -1);
+            if (index == -1) { continue; }
+
+            // decode in place to avoid copying the artwork once more
+            cachedArtworks.append(qMakePair(index, CachedArtwork()));
+            CachedArtwork &cachedArtwork = cachedArtworks.last().second;
+
+            bool isLegacy = false;
+            const bool success = deserializeCachedArtwork(keyValue.second, cachedArtwork, isLegacy);
+            Q_ASSERT(success);
+
+            if (success) {
+                const QString filepath = QString::fromUtf8(keyValue.first);
+                touch(filepath);
+                if (isLegacy) {
+                    migrateLegacyRecord(filepath, cachedArtwork);
+                }
+
+                foundCount++;
+            } else {
+                cachedArtworks.removeLast();
             }
         }
 
-        return found;
+        LOG_DEBUG << "Found" << foundCount << "item(s)";
+        return foundCount;
     }
 
     void MetadataCache::save(Models::ArtworkMetadata *metadata, bool overwrite) {
@@ -166,47 +336,105 @@ namespace MetadataIO {
         } else {
             m_AddWal.set(key, value);
         }
+
+        touch(key);
     }
 
     void MetadataCache::search(const Suggestion::SearchQuery &query, QVector<CachedArtwork> &results) {
         Q_ASSERT(results.empty());
         LOG_INTEGR_TESTS_OR_DEBUG << query.m_SearchTerms;
-        CachedArtwork::CachedArtworkType searchType = queryFlagToCachedType(query.m_Flags);
 
-        m_DbCacheIndex->foreachRow([&](QByteArray &rawKey, QByteArray &rawValue) {
-            CachedArtwork value;
-            QDataStream ds(&rawValue, QIODevice::ReadOnly);
-            ds >> value;
+        if (m_SearchIndex) {
+            searchIndexed(query, results);
+        } else {
+            searchFullScan(query, results);
+        }
+
+        LOG_DEBUG << "Found" << results.size() << "matches";
+    }
 
-            LOG_INTEGRATION_TESTS << value.m_Filepath << "|" << value.m_Title << "|" << value.m_Description << "|" << value.m_Keywords;
+    void MetadataCache::searchIndexed(const Suggestion::SearchQuery &query, QVector<CachedArtwork> &results) {
+        const QString matchExpression = buildMatchExpression(query.m_SearchTerms);
+        if (matchExpression.isEmpty()) { return; }
+
+        const int category = (int)queryFlagToCachedType(query.m_Flags);
+        const int pageSize = qMax(query.m_MaxResults, 1);
+        int offset = 0;
+
+        // keys come best match first; pages are repeated only
+        // if some of the artworks do not exist on disk anymore
+        while (results.size() < query.m_MaxResults) {
+            QVector<QByteArray> keys;
+            const int foundCount = m_SearchIndex->search(matchExpression, category, pageSize, offset, keys);
+            if (foundCount == 0) { break; }
+            offset += foundCount;
+
+            QVector<QPair<QByteArray, QByteArray> > keyValueList;
+            keyValueList.reserve(foundCount);
+            m_DbCacheIndex->tryGetMany(keys, keyValueList);
+
+            QHash<QByteArray, int> keyToValueIndex;
+            keyToValueIndex.reserve(keyValueList.size());
+            for (int i = 0; i < keyValueList.size(); ++i) {
+                keyToValueIndex.insert(keyValueList[i].first, i);
+            }
 
-            if (ds.status() != QDataStream::Ok) { /*continue;*/ return true; }
-            if ((searchType != CachedArtwork::Unknown) && (value.m_ArtworkType != searchType)) { /*continue;*/ return true; }
+            for (auto &key: keys) {
+                const int index = keyToValueIndex.value(key, -1);
+                if (index == -1) { continue; }
 
-            bool hasMatch = false;
+                if (!QFileInfo(QString::fromUtf8(key)).exists()) { continue; }
 
-            foreach (const QString &searchTerm, query.m_SearchTerms) {
-                if (value.m_Title.contains(searchTerm, Qt::CaseInsensitive)) {
-                    hasMatch = true;
-                    break;
+                results.append(CachedArtwork());
+                bool isLegacy = false;
+                if (!deserializeCachedArtwork(keyValueList[index].second, results.last(), isLegacy)) {
+                    results.removeLast();
+                    continue;
                 }
 
-                if (value.m_Description.contains(searchTerm, Qt::CaseInsensitive)) {
-                    hasMatch = true;
-                    break;
-                }
+                const CachedArtwork &value = results.last();
+                LOG_INTEGRATION_TESTS << value.m_Filepath << "|" << value.m_Title << "|" << value.m_Description << "|" << value.m_Keywords;
 
-                foreach (const QString &keyword, value.m_Keywords) {
-                    if (keyword.contains(searchTerm, Qt::CaseInsensitive)) {
-                        hasMatch = true;
-                        break;
-                    }
-                }
+                if (results.size() >= query.m_MaxResults) { break; }
+            }
+
+            if (foundCount < pageSize) { break; }
+        }
+    }
+
+    void MetadataCache::searchFullScan(const Suggestion::SearchQuery &query, QVector<CachedArtwork> &results) {
+        CachedArtwork::CachedArtworkType searchType = queryFlagToCachedType(query.m_Flags);
 
-                if (hasMatch) { break; }
+        m_DbCacheIndex->foreachRow([&](QByteArray &rawKey, QByteArray &rawValue) {
+            bool hasMatch = false;
+            CachedArtwork value;
+
+            if (CachedArtworkRecord::isRecord(rawValue)) {
+                // only fields that are needed for the match are decoded
+                CachedArtworkRecord record(rawValue);
+                if (!record.isValid()) { /*continue;*/ return true; }
+                if ((searchType != CachedArtwork::Unknown) && (record.getArtworkType() != searchType)) { /*continue;*/ return true; }
+
+                hasMatch = containsAnyTerm(record.getTitle(), query.m_SearchTerms) ||
+                        containsAnyTerm(record.getDescription(), query.m_SearchTerms) ||
+                        containsAnyTerm(record.getKeywordsText(), query.m_SearchTerms);
+
+                if (hasMatch) {
+                    record.materialize(value);
+                }
+            } else {
+                bool isLegacy = false;
+                if (!deserializeCachedArtwork(rawValue, value, isLegacy)) { /*continue;*/ return true; }
+                if ((searchType != CachedArtwork::Unknown) && (value.m_ArtworkType != searchType)) { /*continue;*/ return true; }
+
+                hasMatch = containsAnyTerm(value.m_Title, query.m_SearchTerms) ||
+                        containsAnyTerm(value.m_Description, query.m_SearchTerms) ||
+                        containsAnyTerm(value.m_Keywords.join(QLatin1Char('\n')), query.m_SearchTerms);
             }
 
             if (hasMatch) {
+                LOG_INTEGRATION_TESTS << value.m_Filepath << "|" << value.m_Title << "|" << value.m_Description << "|" << value.m_Keywords;
+
                 if (QFileInfo(QString::fromUtf8(rawKey)).exists()) {
                     results.push_back(value);
                 }
@@ -215,18 +443,285 @@ namespace MetadataIO {
             const bool canContinue = results.size() < query.m_MaxResults;
             return canContinue;
         });
-
-        LOG_DEBUG << "Found" << results.size() << "matches";
     }
 
-    void MetadataCache::flushWAL() {
+    void MetadataCache::rebuildSearchIndex() {
         LOG_DEBUG << "#";
+        Q_ASSERT(m_SearchIndex);
+
+        Helpers::Database::Transaction transaction(m_Database.get());
+        Q_UNUSED(transaction);
+
+        QVector<Helpers::Database::FullTextRecord> records;
+        records.reserve(SEARCH_INDEX_REBUILD_CHUNK);
+        int count = 0;
+
+        m_DbCacheIndex->foreachRow([&](QByteArray &rawKey, QByteArray &rawValue) {
+            if (CachedArtworkRecord::isRecord(rawValue)) {
+                CachedArtworkRecord record(rawValue);
+                if (record.isValid()) {
+                    records.append(toSearchRecord(rawKey, record.getArtworkType(), record.getTitle(),
+                                                  record.getDescription(), record.getKeywordsText()));
+                }
+            } else {
+                CachedArtwork value;
+                bool isLegacy = false;
+                if (deserializeCachedArtwork(rawValue, value, isLegacy)) {
+                    records.append(toSearchRecord(QString::fromUtf8(rawKey), value));
+                }
+            }
+
+            if (records.size() >= SEARCH_INDEX_REBUILD_CHUNK) {
+                count += m_SearchIndex->tryAddMany(records);
+                records.clear();
+            }
+
+            return true; // just continue
+        });
+
+        if (!records.isEmpty()) {
+            count += m_SearchIndex->tryAddMany(records);
+        }
+
+        LOG_INFO << "Indexed" << count << "artwork(s) for search";
+    }
+
+    void MetadataCache::migrateLegacyRecord(const QString &filepath, const CachedArtwork &cachedArtwork) {
+        // pending saves are newer than anything in the database
+        if (m_SetWAL.setIfAbsent(filepath, cachedArtwork)) {
+            LOG_INTEGR_TESTS_OR_DEBUG << "Scheduled migration of" << filepath;
+        }
+    }
+
+    void MetadataCache::flushWAL(bool flushAccessTimes) {
+        LOG_DEBUG << flushAccessTimes;
         if (!m_DbCacheIndex) { return; }
 
         LOG_DEBUG << "Add WAL size:" << m_AddWal.size();
         LOG_DEBUG << "Set WAL size:" << m_SetWAL.size();
 
-        m_AddWal.flush(m_DbCacheIndex);
-        m_SetWAL.flush(m_DbCacheIndex);
+        {
+            // all logs are written in one transaction
+            Helpers::Database::Transaction transaction(m_Database.get());
+            Q_UNUSED(transaction);
+
+            // removals go first so records saved after eviction survive
+            flushRemovals();
+            m_AddWal.flush(m_DbCacheIndex, true);
+            m_SetWAL.flush(m_DbCacheIndex, true);
+
+            // every read touches the record so writing access times
+            // on each sync would add a write to every import
+            if (flushAccessTimes || (m_AccessWAL.size() >= ACCESS_TIMES_FLUSH_SIZE)) {
+                m_AccessWAL.flush(m_AccessIndex, true);
+            }
+        }
+
+        m_AddWal.releaseFlushed();
+        m_SetWAL.releaseFlushed();
+        m_AccessWAL.releaseFlushed();
+    }
+
+    int MetadataCache::scheduleEviction(qint64 maxSizeBytes) {
+        LOG_DEBUG << maxSizeBytes;
+        QMutexLocker locker(&m_CompactionMutex);
+        Q_UNUSED(locker);
+
+        if (!m_IsAvailable.loadAcquire()) {
+            LOG_WARNING << "Metadata cache is not available";
+            return 0;
+        }
+
+        qint64 totalBytes = 0, freeBytes = 0;
+        if (!m_Database->getSizeBytes(totalBytes, freeBytes)) { return 0; }
+
+        const qint64 usedBytes = totalBytes - freeBytes;
+        LOG_INFO << "Metadata cache uses" << usedBytes << "bytes of" << maxSizeBytes;
+        if ((usedBytes <= maxSizeBytes) || (usedBytes <= 0)) { return 0; }
+
+        // first pass: records of missing files are dropped right away,
+        // others are remembered by last access time to find the LRU cutoff
+        std::vector<std::pair<qint64, qint64> > accessAndBytes;
+        QVector<QByteArray> deadKeys;
+        qint64 rowsBytes = 0, deadBytes = 0;
+        QByteArray afterKey;
+
+        while (m_IsAvailable.loadAcquire()) {
+            QVector<QPair<QByteArray, QByteArray> > keyValueList;
+            if (m_DbCacheIndex->getPage(afterKey, COMPACTION_PAGE_SIZE, keyValueList) == 0) { break; }
+            afterKey = keyValueList.last().first;
+
+            QHash<QByteArray, qint64> accessTimes;
+            collectAccessTimes(keyValueList, accessTimes);
+
+            for (auto &keyValue: keyValueList) {
+                const qint64 bytes = keyValue.first.size() + keyValue.second.size();
+                rowsBytes += bytes;
+
+                if (!QFileInfo(QString::fromUtf8(keyValue.first)).exists()) {
+                    deadKeys.append(keyValue.first);
+                    deadBytes += bytes;
+                } else {
+                    // records from before access tracking are the oldest
+                    accessAndBytes.push_back(std::make_pair(accessTimes.value(keyValue.first, 0), bytes));
+                }
+            }
+
+            QThread::msleep(COMPACTION_PAGE_PAUSE_MS);
+        }
+
+        if (!m_IsAvailable.loadAcquire()) { return 0; }
+
+        int evictedCount = deadKeys.size();
+        LOG_INFO << "Dropping" << evictedCount << "record(s) of missing files";
+        scheduleRemovals(deadKeys);
+
+        // rows are only a part of the file so the excess is scaled
+        const qint64 bytesToFree = (qint64)((double)(usedBytes - maxSizeBytes) / usedBytes * rowsBytes) - deadBytes;
+        if ((bytesToFree <= 0) || accessAndBytes.empty()) { return evictedCount; }
+
+        std::sort(accessAndBytes.begin(), accessAndBytes.end());
+        qint64 freedBytes = 0;
+        qint64 cutoffTime = 0;
+        for (auto &item: accessAndBytes) {
+            cutoffTime = item.first;
+            freedBytes += item.second;
+            if (freedBytes >= bytesToFree) { break; }
+        }
+
+        accessAndBytes.clear();
+        LOG_INFO << "Evicting records accessed before" << cutoffTime;
+
+        // second pass: everything not accessed since cutoff goes away
+        afterKey.clear();
+        while (m_IsAvailable.loadAcquire()) {
+            QVector<QPair<QByteArray, QByteArray> > keyValueList;
+            if (m_DbCacheIndex->getPage(afterKey, COMPACTION_PAGE_SIZE, keyValueList) == 0) { break; }
+            afterKey = keyValueList.last().first;
+
+            QHash<QByteArray, qint64> accessTimes;
+            collectAccessTimes(keyValueList, accessTimes);
+
+            QVector<QByteArray> oldKeys;
+            for (auto &keyValue: keyValueList) {
+                if (accessTimes.value(keyValue.first, 0) > cutoffTime) { continue; }
+
+                // touched after the first pass
+                qint64 pendingAccess = 0;
+                if (m_AccessWAL.tryGet(QString::fromUtf8(keyValue.first), pendingAccess)) { continue; }
+
+                oldKeys.append(keyValue.first);
+            }
+
+            evictedCount += oldKeys.size();
+            scheduleRemovals(oldKeys);
+
+            QThread::msleep(COMPACTION_PAGE_PAUSE_MS);
+        }
+
+        LOG_INFO << "Scheduled eviction of" << evictedCount << "record(s)";
+        return evictedCount;
+    }
+
+    bool MetadataCache::waitRemovalsFlushed(int timeoutMs) {
+        QMutexLocker locker(&m_RemovalsMutex);
+        Q_UNUSED(locker);
+
+        if (m_PendingRemovals.isEmpty()) { return true; }
+        return m_RemovalsFlushed.wait(&m_RemovalsMutex, timeoutMs);
+    }
+
+    void MetadataCache::requestVacuum() {
+        LOG_DEBUG << "#";
+        m_VacuumRequested.storeRelease(1);
+    }
+
+    bool MetadataCache::vacuumStep() {
+        if (!m_VacuumRequested.loadAcquire()) { return false; }
+        if (!m_IsAvailable.loadAcquire()) { return false; }
+
+        bool anyFreePagesLeft = false;
+
+        do {
+            if (!m_Database->getIsIncrementalVacuum()) {
+                // switching an existing database to incremental mode needs
+                // a full VACUUM which is too long to run while xpiks works
+                LOG_INFO << "Database was created without incremental vacuum. Free pages are kept";
+                break;
+            }
+
+            qint64 totalBytes = 0, freeBytes = 0;
+            if (!m_Database->getSizeBytes(totalBytes, freeBytes)) { break; }
+            if (freeBytes <= 0) { break; }
+
+            if (!m_Database->vacuumIncrementally(VACUUM_STEP_PAGES)) { break; }
+
+            const qint64 previousFreeBytes = freeBytes;
+            if (!m_Database->getSizeBytes(totalBytes, freeBytes)) { break; }
+            LOG_DEBUG << freeBytes << "bytes are free out of" << totalBytes;
+
+            anyFreePagesLeft = (freeBytes > 0) && (freeBytes < previousFreeBytes);
+        } while (false);
+
+        if (!anyFreePagesLeft) {
+            m_VacuumRequested.storeRelease(0);
+        }
+
+        return anyFreePagesLeft;
+    }
+
+    void MetadataCache::touch(const QString &filepath) {
+        m_AccessWAL.set(filepath, QDateTime::currentMSecsSinceEpoch() / 1000);
+    }
+
+    bool MetadataCache::collectAccessTimes(const QVector<QPair<QByteArray, QByteArray> > &keyValueList, QHash<QByteArray, qint64> &accessTimes) {
+        QVector<QByteArray> keys;
+        keys.reserve(keyValueList.size());
+        for (auto &keyValue: keyValueList) { keys.append(keyValue.first); }
+
+        QVector<QPair<QByteArray, QByteArray> > accessList;
+        m_AccessIndex->tryGetMany(keys, accessList);
+
+        accessTimes.reserve(accessList.size());
+        for (auto &keyAccess: accessList) {
+            QDataStream ds(keyAccess.second);
+            qint64 accessTime = 0;
+            ds >> accessTime;
+
+            if (ds.status() == QDataStream::Ok) {
+                accessTimes.insert(keyAccess.first, accessTime);
+            }
+        }
+
+        return !accessTimes.isEmpty();
+    }
+
+    void MetadataCache::scheduleRemovals(const QVector<QByteArray> &keys) {
+        if (keys.isEmpty()) { return; }
+
+        QMutexLocker locker(&m_RemovalsMutex);
+        Q_UNUSED(locker);
+        m_PendingRemovals += keys;
+    }
+
+    void MetadataCache::flushRemovals() {
+        QVector<QByteArray> removals;
+        {
+            QMutexLocker locker(&m_RemovalsMutex);
+            Q_UNUSED(locker);
+            removals.swap(m_PendingRemovals);
+        }
+
+        if (!removals.isEmpty()) {
+            LOG_INFO << "Removing" << removals.size() << "record(s)";
+
+            m_DbCacheIndex->tryDeleteMany(removals);
+            m_AccessIndex->tryDeleteMany(removals);
+            if (m_SearchIndex) {
+                m_SearchIndex->tryDeleteMany(removals);
+            }
+        }
+
+        m_RemovalsFlushed.wakeAll();
     }
 }
@@ -12,9 +12,12 @@
 #define METADATACACHE_H
 
 #include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
 #include <QReadWriteLock>
 #include "../Helpers/database.h"
 #include "cachedartwork.h"
+#include "artworkssnapshot.h"
 #include "../Suggestion/searchquery.h"
 
 namespace Models {
@@ -22,22 +25,44 @@ namespace Models {
 }
 
 namespace MetadataIO {
-    class ArtworkSetWAL: public Helpers::WriteAheadLog<QString, CachedArtwork> {
+    class ArtworkWAL: public Helpers::WriteAheadLog<QString, CachedArtwork> {
+    public:
+        void setSearchIndex(const std::shared_ptr<Helpers::Database::FullTextTable> &searchIndex) { m_SearchIndex = searchIndex; }
+
     protected:
         virtual QByteArray keyToByteArray(const QString &key) const override { return key.toUtf8(); }
+        virtual bool valueToByteArray(const CachedArtwork &value, QByteArray &rawValue) const override;
+        virtual bool byteArrayToValue(const QByteArray &rawValue, CachedArtwork &value) const override;
+
+    protected:
+        std::shared_ptr<Helpers::Database::FullTextTable> m_SearchIndex;
+    };
+
+    class ArtworkSetWAL: public ArtworkWAL {
+    protected:
         virtual bool doFlush(std::shared_ptr<Helpers::Database::Table> &dbTable, const QVector<QPair<QByteArray, QByteArray> > &keyValuesList, QVector<int> &failedIndices) override {
             return dbTable->trySetMany(keyValuesList, failedIndices);
         }
+        virtual void onFlushed(const QHash<QString, CachedArtwork> &flushedItems) override;
     };
 
-    class ArtworkAddWAL: public Helpers::WriteAheadLog<QString, CachedArtwork> {
+    class ArtworkAddWAL: public ArtworkWAL {
     protected:
-        virtual QByteArray keyToByteArray(const QString &key) const override { return key.toUtf8(); }
         virtual bool doFlush(std::shared_ptr<Helpers::Database::Table> &dbTable, const QVector<QPair<QByteArray, QByteArray> > &keyValuesList, QVector<int> &failedIndices) override {
             Q_UNUSED(failedIndices);
             int count = dbTable->tryAddMany(keyValuesList);
             return count > 0;
         }
+        virtual void onFlushed(const QHash<QString, CachedArtwork> &flushedItems) override;
+    };
+
+    // last access time in seconds since epoch
+    class ArtworkAccessWAL: public Helpers::WriteAheadLog<QString, qint64> {
+    protected:
+        virtual QByteArray keyToByteArray(const QString &key) const override { return key.toUtf8(); }
+        virtual bool doFlush(std::shared_ptr<Helpers::Database::Table> &dbTable, const QVector<QPair<QByteArray, QByteArray> > &keyValuesList, QVector<int> &failedIndices) override {
+            return dbTable->trySetMany(keyValuesList, failedIndices);
+        }
     };
 
     class MetadataCache
@@ -59,21 +84,51 @@ namespace MetadataIO {
 
     public:
         bool read(Models::ArtworkMetadata *artwork, CachedArtwork &cachedArtwork);
+        // found items are returned together with their index in artworks
+        int readMany(const WeakArtworksSnapshot &artworks, QVector<QPair<int, CachedArtwork> > &cachedArtworks);
         void save(Models::ArtworkMetadata *metadata, bool overwrite = true);
 
     public:
         void search(const Suggestion::SearchQuery &query, QVector<CachedArtwork> &results);
 
+    public:
+        // can be called from any thread, removals are written on the next sync()
+        int scheduleEviction(qint64 maxSizeBytes);
+        bool waitRemovalsFlushed(int timeoutMs);
+        // can be called from any thread, free pages are returned by vacuumStep()
+        void requestVacuum();
+        // has to be called between transactions of the IO worker
+        // returns true if there are more free pages to return
+        bool vacuumStep();
+
     private:
-        void flushWAL();
+        void searchIndexed(const Suggestion::SearchQuery &query, QVector<CachedArtwork> &results);
+        void searchFullScan(const Suggestion::SearchQuery &query, QVector<CachedArtwork> &results);
+        void rebuildSearchIndex();
+        void migrateLegacyRecord(const QString &filepath, const CachedArtwork &cachedArtwork);
+        void touch(const QString &filepath);
+        bool collectAccessTimes(const QVector<QPair<QByteArray, QByteArray> > &keyValueList, QHash<QByteArray, qint64> &accessTimes);
+        void scheduleRemovals(const QVector<QByteArray> &keys);
+        void flushRemovals();
+        void flushWAL(bool flushAccessTimes);
 
     private:
-        QMutex m_ReadMutex;
         Helpers::DatabaseManager *m_DatabaseManager;
         std::shared_ptr<Helpers::Database::Table> m_DbCacheIndex;
+        // optional: without it search falls back to the full scan
+        std::shared_ptr<Helpers::Database::FullTextTable> m_SearchIndex;
         std::shared_ptr<Helpers::Database> m_Database;
+        std::shared_ptr<Helpers::Database::Table> m_AccessIndex;
         ArtworkSetWAL m_SetWAL;
         ArtworkAddWAL m_AddWal;
+        ArtworkAccessWAL m_AccessWAL;
+        // guards finalization against running eviction
+        QMutex m_CompactionMutex;
+        QMutex m_RemovalsMutex;
+        QWaitCondition m_RemovalsFlushed;
+        QVector<QByteArray> m_PendingRemovals;
+        QAtomicInt m_IsAvailable;
+        QAtomicInt m_VacuumRequested;
     };
 }
 
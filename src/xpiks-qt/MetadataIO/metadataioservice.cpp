@@ -18,6 +18,7 @@
 
 #define SAVER_TIMER_TIMEOUT 2000
 #define SAVER_TIMER_MAX_RESTARTS 5
+#define REMOVALS_FLUSH_TIMEOUT_MS 30000
 
 namespace MetadataIO {
     MetadataIOService::MetadataIOService(QObject *parent):
@@ -76,6 +77,12 @@ namespace MetadataIO {
         return m_MetadataIOWorker->hasPendingJobs();
     }
 
+    void MetadataIOService::logStatistics() const {
+        if (m_MetadataIOWorker != nullptr) {
+            m_MetadataIOWorker->logStatistics();
+        }
+    }
+
     void MetadataIOService::waitWorkerIdle() {
         LOG_DEBUG << "#";
         Q_ASSERT(m_MetadataIOWorker != nullptr);
@@ -153,6 +160,26 @@ namespace MetadataIO {
         m_MetadataIOWorker->submitFirst(jobItem);
     }
 
+    void MetadataIOService::compactCache(qint64 maxSizeBytes) {
+        LOG_DEBUG << maxSizeBytes;
+        if (m_IsStopped) { return; }
+
+        const int evictedCount = m_MetadataIOWorker->scheduleEviction(maxSizeBytes);
+        if (evictedCount == 0) { return; }
+
+        // removals are written by the worker together with the rest of the WAL
+        emit cacheSyncRequest();
+        if (!m_MetadataIOWorker->waitRemovalsFlushed(REMOVALS_FLUSH_TIMEOUT_MS)) {
+            LOG_WARNING << "Timeout while waiting for evicted records to be removed";
+            return;
+        }
+
+        if (m_IsStopped) { return; }
+        // free pages are returned by the worker between its batches
+        m_MetadataIOWorker->requestVacuum();
+        m_MetadataIOWorker->submitSeparator();
+    }
+
     void MetadataIOService::workerFinished() {
         LOG_INFO << "#";
     }
@@ -40,6 +40,7 @@ namespace MetadataIO {
     public:
         void cancelBatch(quint32 batchID) const;
         bool isBusy() const;
+        void logStatistics() const;
         void waitWorkerIdle();
 
     public:
@@ -51,6 +52,10 @@ namespace MetadataIO {
     public:
         void searchArtworks(Suggestion::LocalLibraryQuery *query);
 
+    public:
+        // blocking, supposed to be called from maintenance thread
+        void compactCache(qint64 maxSizeBytes);
+
     signals:
         void cacheSyncRequest();
 
@@ -14,17 +14,21 @@
 
 #define METADATA_CACHE_SYNC_INTERVAL 29
 #define STORAGE_IMPORT_INTERVAL 29
+#define METADATA_IO_BATCH_SIZE 50
 
 namespace MetadataIO {
     MetadataIOWorker::MetadataIOWorker(Helpers::DatabaseManager *dbManager,
                                        QMLExtensions::ArtworksUpdateHub *artworksUpdateHub,
                                        QObject *parent):
         QObject(parent),
+        m_StorageReadQueue("MetadataStorageRead"),
         m_ArtworksUpdateHub(artworksUpdateHub),
         m_MetadataCache(dbManager),
         m_ProcessedItemsCount(0)
     {
         Q_ASSERT(artworksUpdateHub != nullptr);
+        setMaxBatchSize(METADATA_IO_BATCH_SIZE);
+        getTelemetry().setName("MetadataIO");
     }
 
     bool MetadataIOWorker::initWorker() {
@@ -44,6 +48,11 @@ namespace MetadataIO {
             LOG_DEBUG << "Processing separator";
             m_MetadataCache.sync();
             emit readyToImportFromStorage();
+
+            // one compaction step per separator lets other batches in between
+            if (m_MetadataCache.vacuumStep()) {
+                submitSeparator();
+            }
         } else {
             ItemProcessingWorker::processOneItemEx(item, batchID, flags);
         }
@@ -68,7 +77,78 @@ namespace MetadataIO {
         } while(false);
     }
 
+    void MetadataIOWorker::processBatch(std::vector<ItemType> &batch) {
+        LOG_DEBUG << batch.size() << "item(s)";
+        int readWriteCount = 0;
+        bool anyWrite = false;
+        WeakArtworksSnapshot artworksToRead;
+
+        for (auto &batchItem: batch) {
+            if (isCancelled()) { break; }
+
+            std::shared_ptr<MetadataIOTaskBase> &item = std::get<0>(batchItem);
+            std::shared_ptr<MetadataReadWriteTask> readWriteItem = std::dynamic_pointer_cast<MetadataReadWriteTask>(item);
+            if (readWriteItem) {
+                if (readWriteItem->getReadWriteAction() == MetadataReadWriteTask::Read) {
+                    Models::ArtworkMetadata *artworkMetadata = readWriteItem->getArtworkMetadata();
+                    Q_ASSERT(artworkMetadata != nullptr);
+                    if (artworkMetadata != nullptr) {
+                        artworksToRead.push_back(artworkMetadata);
+                    }
+                } else {
+                    processReadWriteAction(readWriteItem);
+                    anyWrite = true;
+                }
+
+                readWriteCount++;
+            } else {
+                processOneItem(item);
+            }
+        }
+
+        if (!artworksToRead.empty()) {
+            readArtworks(artworksToRead);
+        }
+
+        m_ProcessedItemsCount += readWriteCount;
+
+        if (anyWrite) {
+            // all writes of the batch go to the database in one transaction
+            m_MetadataCache.sync();
+        }
+
+        if (m_StorageReadQueue.size() > STORAGE_IMPORT_INTERVAL) {
+            emit readyToImportFromStorage();
+        }
+    }
+
+    void MetadataIOWorker::readArtworks(const WeakArtworksSnapshot &artworks) {
+        QVector<QPair<int, CachedArtwork> > cachedArtworks;
+        m_MetadataCache.readMany(artworks, cachedArtworks);
+
+        for (auto &pair: cachedArtworks) {
+            std::shared_ptr<StorageReadRequest> readRequest(new StorageReadRequest());
+            readRequest->m_CachedArtwork = pair.second;
+            readRequest->m_Artwork = artworks.at(pair.first);
+            m_StorageReadQueue.push(readRequest);
+        }
+    }
+
     void MetadataIOWorker::processReadWriteItem(std::shared_ptr<MetadataReadWriteTask> &item) {
+        processReadWriteAction(item);
+
+        m_ProcessedItemsCount++;
+
+        if (m_ProcessedItemsCount % METADATA_CACHE_SYNC_INTERVAL == 0) {
+            m_MetadataCache.sync();
+        }
+
+        if (m_StorageReadQueue.size() > STORAGE_IMPORT_INTERVAL) {
+            emit readyToImportFromStorage();
+        }
+    }
+
+    void MetadataIOWorker::processReadWriteAction(std::shared_ptr<MetadataReadWriteTask> &item) {
         Models::ArtworkMetadata *artworkMetadata = item->getArtworkMetadata();
         Q_ASSERT(artworkMetadata != nullptr);
         if (artworkMetadata == nullptr) { return; }
@@ -85,16 +165,6 @@ namespace MetadataIO {
         } else if (action == MetadataReadWriteTask::Add) {
             m_MetadataCache.save(artworkMetadata, false);
         }
-
-        m_ProcessedItemsCount++;
-
-        if (m_ProcessedItemsCount % METADATA_CACHE_SYNC_INTERVAL == 0) {
-            m_MetadataCache.sync();
-        }
-
-        if (m_StorageReadQueue.size() > STORAGE_IMPORT_INTERVAL) {
-            emit readyToImportFromStorage();
-        }
     }
 
     void MetadataIOWorker::processSearchItem(std::shared_ptr<MetadataSearchTask> &item) {
@@ -118,6 +188,11 @@ namespace MetadataIO {
         }
     }
 
+    void MetadataIOWorker::logStatistics() const {
+        logTelemetry();
+        m_StorageReadQueue.logTelemetry();
+    }
+
     void MetadataIOWorker::workerStopped() {
         m_MetadataCache.finalize();
         emit stopped();
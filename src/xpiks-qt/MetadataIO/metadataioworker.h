@@ -49,13 +49,23 @@ namespace MetadataIO {
         virtual bool initWorker() override;
         virtual void processOneItemEx(std::shared_ptr<MetadataIOTaskBase> &item, batch_id_t batchID, Common::flag_t flags) override;
         virtual void processOneItem(std::shared_ptr<MetadataIOTaskBase> &item) override;
+        virtual void processBatch(std::vector<ItemType> &batch) override;
 
     private:
         void processReadWriteItem(std::shared_ptr<MetadataReadWriteTask> &item);
+        void processReadWriteAction(std::shared_ptr<MetadataReadWriteTask> &item);
+        void readArtworks(const WeakArtworksSnapshot &artworks);
         void processSearchItem(std::shared_ptr<MetadataSearchTask> &item);
 
     public:
         void importArtworksFromStorage();
+        void logStatistics() const;
+
+    public:
+        // cache eviction is requested from the service thread
+        int scheduleEviction(qint64 maxSizeBytes) { return m_MetadataCache.scheduleEviction(maxSizeBytes); }
+        bool waitRemovalsFlushed(int timeoutMs) { return m_MetadataCache.waitRemovalsFlushed(timeoutMs); }
+        void requestVacuum() { m_MetadataCache.requestVacuum(); }
 
     protected:
         virtual void onQueueIsEmpty() override { emit queueIsEmpty(); }
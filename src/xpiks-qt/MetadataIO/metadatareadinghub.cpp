@@ -14,8 +14,11 @@
 #include "../Commands/commandmanager.h"
 #include "../Common/defines.h"
 
+#define APPLY_CHUNK_INTERVAL 500
+
 namespace MetadataIO {
     MetadataReadingHub::MetadataReadingHub():
+        m_ImportQueue("MetadataImport"),
         m_ImportID(0),
         m_StorageReadBatchID(0),
         m_IgnoreBackupsAtImport(false),
@@ -23,11 +26,31 @@ namespace MetadataIO {
     {
         QObject::connect(&m_AsyncCoordinator, &Helpers::AsyncCoordinator::statusReported,
                          this, &MetadataReadingHub::onCanInitialize);
+
+        m_ApplyTimer.setInterval(APPLY_CHUNK_INTERVAL);
+        QObject::connect(&m_ApplyTimer, &QTimer::timeout,
+                         this, &MetadataReadingHub::onApplyTimer);
     }
 
     void MetadataReadingHub::initializeImport(const ArtworksSnapshot &artworksToRead, int importID, quint32 storageReadBatchID) {
         m_ArtworksToRead = artworksToRead;
         m_ImportQueue.reservePush(artworksToRead.size());
+
+        const size_t size = m_ArtworksToRead.size();
+        m_FilepathToIndexMap.clear();
+        m_FilepathToIndexMap.reserve((int)size);
+        for (size_t i = 0; i < size; i++) {
+            m_FilepathToIndexMap.insert(m_ArtworksToRead.get(i)->getFilepath(), i);
+        }
+
+        m_InitializedFlags.assign(size, false);
+
+        {
+            QMutexLocker locker(&m_ShardsProgressMutex);
+            Q_UNUSED(locker);
+            m_ShardsProgress.clear();
+        }
+
         m_ImportID = importID;
         m_StorageReadBatchID = storageReadBatchID;
         m_IgnoreBackupsAtImport = false;
@@ -39,14 +62,26 @@ namespace MetadataIO {
     }
 
     void MetadataReadingHub::finalizeImport() {
+        m_ApplyTimer.stop();
         m_ArtworksToRead.clear();
         m_ImportQueue.clear();
+        m_FilepathToIndexMap.clear();
+        m_InitializedFlags.clear();
     }
 
     void MetadataReadingHub::proceedImport(bool ignoreBackups) {
         LOG_DEBUG << "ignore backups =" << ignoreBackups;
         m_IgnoreBackupsAtImport = ignoreBackups;
         m_IsCancelled = false;
+
+        if (ignoreBackups) {
+            // backups should not be applied on top of already initialized artworks
+            MetadataIOService *metadataIOService = m_CommandManager->getMetadataIOService();
+            metadataIOService->cancelBatch(m_StorageReadBatchID);
+        }
+
+        // the rest of results is applied when reading is finished
+        m_ApplyTimer.start();
         m_AsyncCoordinator.justEnded();
     }
 
@@ -69,8 +104,29 @@ namespace MetadataIO {
         m_ImportQueue.push(item);
     }
 
+    void MetadataReadingHub::reportShardProgress(int shardIndex, int readCount, int shardSize) {
+        int totalRead = 0, totalCount = 0;
+
+        {
+            QMutexLocker locker(&m_ShardsProgressMutex);
+            Q_UNUSED(locker);
+
+            m_ShardsProgress.insert(shardIndex, qMakePair(readCount, shardSize));
+
+            for (auto &progress: m_ShardsProgress) {
+                totalRead += progress.first;
+                totalCount += progress.second;
+            }
+        }
+
+        LOG_DEBUG << "Shard" << (shardIndex + 1) << ":" << readCount << "of" << shardSize << "| total" << totalRead << "of" << totalCount;
+        emit readingProgressChanged(totalRead, totalCount);
+    }
+
     void MetadataReadingHub::onCanInitialize(int status) {
         LOG_DEBUG << "status:" << status;
+        m_ApplyTimer.stop();
+
         const bool ignoreBackups = m_IgnoreBackupsAtImport;
         const bool isCancelled = m_IsCancelled;
 
@@ -96,46 +152,64 @@ namespace MetadataIO {
         finalizeImport();
     }
 
+    void MetadataReadingHub::onApplyTimer() {
+        std::vector<std::shared_ptr<MetadataIO::OriginalMetadata> > metadataToImport;
+        if (!m_ImportQueue.popAll(metadataToImport)) { return; }
+
+        WeakArtworksSnapshot initializedArtworks;
+        applyMetadata(metadataToImport, m_IgnoreBackupsAtImport, false, initializedArtworks);
+        LOG_DEBUG << "Initialized chunk of" << initializedArtworks.size() << "artwork(s)";
+
+        if (!initializedArtworks.empty()) {
+            xpiks()->updateArtworks(initializedArtworks);
+        }
+    }
+
     void MetadataReadingHub::initializeArtworks(bool ignoreBackups, bool isCancelled) {
         LOG_DEBUG << "ignore backups =" << ignoreBackups << "| cancelled =" << isCancelled;
-        QHash<QString, size_t> filepathToIndexMap;
 
         std::vector<std::shared_ptr<MetadataIO::OriginalMetadata> > metadataToImport;
         // popAll() returns queue in reversed order for performance reasons
         m_ImportQueue.popAll(metadataToImport);
+        m_ImportQueue.logTelemetry();
 
-        const size_t size = metadataToImport.size();
-        filepathToIndexMap.reserve((int)size);
+        WeakArtworksSnapshot initializedArtworks;
+        applyMetadata(metadataToImport, ignoreBackups, isCancelled, initializedArtworks);
 
-        // reverse order to simulate pop() for each element
-        // instead of calling popAll() above
-        // more recent ones will overwrite more old ones
-        // because of retrying in reading workers
+        const size_t size = m_InitializedFlags.size();
         for (size_t i = 0; i < size; i++) {
-            const size_t j = size - 1 - i;
-            auto &originalMetadata = metadataToImport[j];
-            filepathToIndexMap.insert(originalMetadata->m_FilePath, j);
+            if (!m_InitializedFlags[i]) {
+                m_ArtworksToRead.get(i)->initAsEmpty();
+            }
         }
+    }
 
-        const bool shouldOverwrite = ignoreBackups;
+    void MetadataReadingHub::applyMetadata(const std::vector<std::shared_ptr<OriginalMetadata> > &metadataToImport,
+                                           bool shouldOverwrite, bool isCancelled,
+                                           WeakArtworksSnapshot &initializedArtworks) {
+        const size_t artworksCount = m_InitializedFlags.size();
         MetadataIO::OriginalMetadata emptyOriginalMetadata;
 
-        auto &items = m_ArtworksToRead.getRawData();
-        for (auto &item: items) {
-            Models::ArtworkMetadata *artwork = item->getArtworkMetadata();
-            const QString &filepath = artwork->getFilepath();
-
-            const size_t index = filepathToIndexMap.value(filepath, size);
-            if (index < size) {
-                MetadataIO::OriginalMetadata *originalMetadata = metadataToImport[index].get();
-                if (!isCancelled) {
-                    artwork->initFromOrigin(*originalMetadata, shouldOverwrite);
-                } else {
-                    artwork->initFromOrigin(emptyOriginalMetadata, shouldOverwrite);
-                }
+        // readers push every file once, so the first applied result is final:
+        // artwork could be already edited by user after a chunk was applied
+        // and initializing it again would overwrite the edits
+        for (auto &originalMetadata: metadataToImport) {
+            const size_t index = m_FilepathToIndexMap.value(originalMetadata->m_FilePath, artworksCount);
+            if (index >= artworksCount) { continue; }
+            if (m_InitializedFlags[index]) {
+                LOG_WARNING << "Duplicate result for" << originalMetadata->m_FilePath;
+                continue;
+            }
+
+            Models::ArtworkMetadata *artwork = m_ArtworksToRead.get(index);
+            if (!isCancelled) {
+                artwork->initFromOrigin(*originalMetadata, shouldOverwrite);
             } else {
-                artwork->initAsEmpty();
+                artwork->initFromOrigin(emptyOriginalMetadata, shouldOverwrite);
             }
+
+            m_InitializedFlags[index] = true;
+            initializedArtworks.push_back(artwork);
         }
     }
 }
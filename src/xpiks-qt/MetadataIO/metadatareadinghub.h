@@ -13,6 +13,11 @@
 
 #include <QObject>
 #include <QAtomicInt>
+#include <QTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <vector>
 #include "../Common/readerwriterqueue.h"
 #include "artworkssnapshot.h"
 #include "originalmetadata.h"
@@ -40,21 +45,38 @@ namespace MetadataIO {
         void skipImport();
 
     public:
+        // each file should be pushed at most once, duplicates are ignored
         void push(std::shared_ptr<OriginalMetadata> &item);
+        // readers working in parallel report how many of their files are read
+        void reportShardProgress(int shardIndex, int readCount, int shardSize);
 
     private slots:
         void onCanInitialize(int status);
+        void onApplyTimer();
 
     signals:
         void readingFinished(int importID);
+        // emitted from the reading threads
+        void readingProgressChanged(int readCount, int totalCount);
 
     private:
         void initializeArtworks(bool ignoreBackups, bool isCancelled);
+        // items are expected in the reversed order of popAll()
+        void applyMetadata(const std::vector<std::shared_ptr<OriginalMetadata> > &metadataToImport,
+                           bool shouldOverwrite, bool isCancelled,
+                           WeakArtworksSnapshot &initializedArtworks);
 
     private:
         ArtworksSnapshot m_ArtworksToRead;
+        QHash<QString, size_t> m_FilepathToIndexMap;
+        std::vector<bool> m_InitializedFlags;
+        // applies results of reading in chunks while exiftool is still working
+        QTimer m_ApplyTimer;
         Helpers::AsyncCoordinator m_AsyncCoordinator;
         Common::ReaderWriterQueue<OriginalMetadata> m_ImportQueue;
+        QMutex m_ShardsProgressMutex;
+        // shard index to the read count and size of the shard
+        QHash<int, QPair<int, int> > m_ShardsProgress;
         int m_ImportID;
         quint32 m_StorageReadBatchID;
         volatile bool m_IgnoreBackupsAtImport;
@@ -10,6 +10,7 @@
 
 #include "filteredartitemsproxymodel.h"
 #include <QDir>
+#include <algorithm>
 #include "artitemsmodel.h"
 #include "artworkmetadata.h"
 #include "artworksrepository.h"
@@ -25,6 +26,9 @@
 #include "../QuickBuffer/quickbuffer.h"
 #include "videoartwork.h"
 
+// how many screens ahead of the viewport get previews with priority
+#define PREFETCH_SCREENS_COUNT 2
+
 namespace Models {
     FilteredArtItemsProxyModel::FilteredArtItemsProxyModel(QObject *parent):
         QSortFilterProxyModel(parent),
@@ -537,6 +541,28 @@ namespace Models {
         xpiks()->setupDuplicatesModel(itemsForSuggestions);
     }
 
+    void FilteredArtItemsProxyModel::updateViewport(int firstIndex, int lastIndex, bool scrollingForward) const {
+        const int count = rowCount();
+        if ((count == 0) || (firstIndex > lastIndex)) { return; }
+
+        firstIndex = qBound(0, firstIndex, count - 1);
+        lastIndex = qBound(0, lastIndex, count - 1);
+        LOG_FOR_DEBUG << firstIndex << "-" << lastIndex << "forward:" << scrollingForward;
+
+        const int prefetchCount = (lastIndex - firstIndex + 1) * PREFETCH_SCREENS_COUNT;
+        MetadataIO::WeakArtworksSnapshot visibleArtworks = getFilteredItemsRange(firstIndex, lastIndex);
+        MetadataIO::WeakArtworksSnapshot nextArtworks = scrollingForward ?
+                    getFilteredItemsRange(lastIndex + 1, lastIndex + prefetchCount) :
+                    getFilteredItemsRange(firstIndex - prefetchCount, firstIndex - 1);
+
+        // closest to the viewport go first
+        if (!scrollingForward) {
+            std::reverse(nextArtworks.begin(), nextArtworks.end());
+        }
+
+        xpiks()->prioritizePreviews(visibleArtworks, nextArtworks);
+    }
+
     void FilteredArtItemsProxyModel::itemSelectedChanged(bool value) {
         int plus = value ? +1 : -1;
 
@@ -697,6 +723,27 @@ namespace Models {
         return items;
     }
 
+    MetadataIO::WeakArtworksSnapshot FilteredArtItemsProxyModel::getFilteredItemsRange(int firstIndex, int lastIndex) const {
+        MetadataIO::WeakArtworksSnapshot items;
+
+        firstIndex = qMax(firstIndex, 0);
+        lastIndex = qMin(lastIndex, rowCount() - 1);
+        if (firstIndex > lastIndex) { return items; }
+
+        ArtItemsModel *artItemsModel = getArtItemsModel();
+        items.reserve(lastIndex - firstIndex + 1);
+
+        for (int index = firstIndex; index <= lastIndex; ++index) {
+            int originalIndex = getOriginalIndex(index);
+            ArtworkMetadata *artwork = artItemsModel->getArtwork(originalIndex);
+            if (artwork != NULL) {
+                items.push_back(artwork);
+            }
+        }
+
+        return items;
+    }
+
     QVector<int> FilteredArtItemsProxyModel::getSelectedOriginalIndices() const {
         std::vector<int> items = getFilteredOriginalItems<int>(
             [](ArtworkMetadata *artwork) { return artwork->isSelected(); },
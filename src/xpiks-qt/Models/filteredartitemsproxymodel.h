@@ -102,6 +102,7 @@ namespace Models {
         Q_INVOKABLE void suggestCorrectionsForSelected() const;
         Q_INVOKABLE void generateCompletions(const QString &prefix, int index);
         Q_INVOKABLE void reviewDuplicatesInSelected() const;
+        Q_INVOKABLE void updateViewport(int firstIndex, int lastIndex, bool scrollingForward) const;
 
     public slots:
         void itemSelectedChanged(bool value);
@@ -130,6 +131,7 @@ namespace Models {
                                                 std::function<T(ArtworkMetadata *, int, int)> mapper) const;
 
         MetadataIO::WeakArtworksSnapshot getAllOriginalItems() const;
+        MetadataIO::WeakArtworksSnapshot getFilteredItemsRange(int firstIndex, int lastIndex) const;
 
         QVector<int> getSelectedOriginalIndices() const;
         QVector<int> getSelectedIndices() const;
@@ -15,6 +15,7 @@
 #include "../Maintenance/maintenanceservice.h"
 #include "../MetadataIO/metadataiocoordinator.h"
 #include "../Commands/commandmanager.h"
+#include "../Helpers/loadmonitor.h"
 #include "filteredartitemsproxymodel.h"
 
 #ifdef Q_OS_MAC
@@ -67,6 +68,14 @@
 #define DEFAULT_PROXY_HOST ""
 #define DEFAULT_USE_PROGRESSIVE_SUGGESTION_PREVIEWS false
 #define DEFAULT_PROGRESSIVE_SUGGESTION_INCREMENT 10
+#define DEFAULT_VIDEOS_CACHE_MAX_SIZE_MB 512
+#define DEFAULT_IMAGES_CACHE_MAX_SIZE_MB 1024
+#define DEFAULT_METADATA_CACHE_MAX_SIZE_MB 512
+// exiftool is still used for other formats and as a fallback
+#define DEFAULT_USE_EXIV2 true
+// values of Helpers::ThrottlingPolicy: background workers yield to
+// the UI and more important queues
+#define DEFAULT_WORKER_THROTTLING ((int)Helpers::ThrottlingPolicy::Adaptive)
 
 #ifdef QT_NO_DEBUG
     #define DEFAULT_USE_AUTOIMPORT true
@@ -165,9 +174,18 @@ namespace Models {
         m_VerboseUpload(DEFAULT_VERBOSE_UPLOAD),
         m_UseProgressiveSuggestionPreviews(DEFAULT_USE_PROGRESSIVE_SUGGESTION_PREVIEWS),
         m_ProgressiveSuggestionIncrement(DEFAULT_PROGRESSIVE_SUGGESTION_INCREMENT),
+        m_VideosCacheMaxSizeMB(DEFAULT_VIDEOS_CACHE_MAX_SIZE_MB),
+        m_ImagesCacheMaxSizeMB(DEFAULT_IMAGES_CACHE_MAX_SIZE_MB),
+        m_MetadataCacheMaxSizeMB(DEFAULT_METADATA_CACHE_MAX_SIZE_MB),
         m_UseDirectExiftoolExport(DEFAULT_USE_DIRECT_EXIFTOOL_EXPORT),
+        m_UseExiv2(DEFAULT_USE_EXIV2),
+        m_ImageCachingThrottling(DEFAULT_WORKER_THROTTLING),
+        m_VideoCachingThrottling(DEFAULT_WORKER_THROTTLING),
+        m_SpellCheckThrottling(DEFAULT_WORKER_THROTTLING),
+        m_WarningsThrottling(DEFAULT_WORKER_THROTTLING),
         m_UseAutoImport(DEFAULT_USE_AUTOIMPORT),
-        m_ExiftoolPathChanged(false)
+        m_ExiftoolPathChanged(false),
+        m_ThrottlingChanged(false)
     {
     }
 
@@ -463,7 +481,15 @@ namespace Models {
 
         setUseProgressiveSuggestionPreviews(expBoolValue(useProgressiveSuggestionPreviews, DEFAULT_USE_PROGRESSIVE_SUGGESTION_PREVIEWS));
         setProgressiveSuggestionIncrement(expIntValue(progressiveSuggestionIncrement, DEFAULT_PROGRESSIVE_SUGGESTION_INCREMENT));
+        setVideosCacheMaxSizeMB(expIntValue(videosCacheMaxSizeMB, DEFAULT_VIDEOS_CACHE_MAX_SIZE_MB));
+        setImagesCacheMaxSizeMB(expIntValue(imagesCacheMaxSizeMB, DEFAULT_IMAGES_CACHE_MAX_SIZE_MB));
+        setMetadataCacheMaxSizeMB(expIntValue(metadataCacheMaxSizeMB, DEFAULT_METADATA_CACHE_MAX_SIZE_MB));
         setUseDirectExiftoolExport(expBoolValue(useDirectExiftoolExport, DEFAULT_USE_DIRECT_EXIFTOOL_EXPORT));
+        setUseExiv2(expBoolValue(useExiv2, DEFAULT_USE_EXIV2));
+        setImageCachingThrottling(expIntValue(imageCachingThrottling, DEFAULT_WORKER_THROTTLING));
+        setVideoCachingThrottling(expIntValue(videoCachingThrottling, DEFAULT_WORKER_THROTTLING));
+        setSpellCheckThrottling(expIntValue(spellCheckThrottling, DEFAULT_WORKER_THROTTLING));
+        setWarningsThrottling(expIntValue(warningsThrottling, DEFAULT_WORKER_THROTTLING));
         setUseAutoImport(expBoolValue(useAutoImport, DEFAULT_USE_AUTOIMPORT));
 
         deserializeProxyFromSettings(stringValue(proxyHost, DEFAULT_PROXY_HOST));
@@ -567,7 +593,15 @@ namespace Models {
 
         setUseProgressiveSuggestionPreviews(DEFAULT_USE_PROGRESSIVE_SUGGESTION_PREVIEWS);
         setProgressiveSuggestionIncrement(DEFAULT_PROGRESSIVE_SUGGESTION_INCREMENT);
+        setVideosCacheMaxSizeMB(DEFAULT_VIDEOS_CACHE_MAX_SIZE_MB);
+        setImagesCacheMaxSizeMB(DEFAULT_IMAGES_CACHE_MAX_SIZE_MB);
+        setMetadataCacheMaxSizeMB(DEFAULT_METADATA_CACHE_MAX_SIZE_MB);
         setUseDirectExiftoolExport(DEFAULT_USE_DIRECT_EXIFTOOL_EXPORT);
+        setUseExiv2(DEFAULT_USE_EXIV2);
+        setImageCachingThrottling(DEFAULT_WORKER_THROTTLING);
+        setVideoCachingThrottling(DEFAULT_WORKER_THROTTLING);
+        setSpellCheckThrottling(DEFAULT_WORKER_THROTTLING);
+        setWarningsThrottling(DEFAULT_WORKER_THROTTLING);
         setUseAutoImport(DEFAULT_USE_AUTOIMPORT);
 
 #if defined(QT_DEBUG)
@@ -614,7 +648,15 @@ namespace Models {
 
         setExperimentalValue(useProgressiveSuggestionPreviews, m_UseProgressiveSuggestionPreviews);
         setExperimentalValue(progressiveSuggestionIncrement, m_ProgressiveSuggestionIncrement);
+        setExperimentalValue(videosCacheMaxSizeMB, m_VideosCacheMaxSizeMB);
+        setExperimentalValue(imagesCacheMaxSizeMB, m_ImagesCacheMaxSizeMB);
+        setExperimentalValue(metadataCacheMaxSizeMB, m_MetadataCacheMaxSizeMB);
         setExperimentalValue(useDirectExiftoolExport, m_UseDirectExiftoolExport);
+        setExperimentalValue(useExiv2, m_UseExiv2);
+        setExperimentalValue(imageCachingThrottling, m_ImageCachingThrottling);
+        setExperimentalValue(videoCachingThrottling, m_VideoCachingThrottling);
+        setExperimentalValue(spellCheckThrottling, m_SpellCheckThrottling);
+        setExperimentalValue(warningsThrottling, m_WarningsThrottling);
         setExperimentalValue(useAutoImport, m_UseAutoImport);
 
         if (!m_MustUseMasterPassword) {
@@ -662,6 +704,11 @@ namespace Models {
             xpiks()->autoDiscoverExiftool();
         }
 
+        if (m_ThrottlingChanged) {
+            // running workers pick it up with the next item
+            xpiks()->updateThrottlingPolicies();
+        }
+
         resetChangeStates();
 
         emit keywordSizeScaleChanged(m_KeywordSizeScale);
@@ -673,6 +720,7 @@ namespace Models {
         m_UseSpellCheckChanged = false;
         m_ExiftoolPathChanged = false;
         m_DetectDuplicatesChanged = false;
+        m_ThrottlingChanged = false;
     }
 
     QString SettingsModel::getWhatsNewText() const {
@@ -1006,6 +1054,36 @@ namespace Models {
         justChanged();
     }
 
+    void SettingsModel::setMetadataCacheMaxSizeMB(int metadataCacheMaxSizeMB)
+    {
+        if (m_MetadataCacheMaxSizeMB == metadataCacheMaxSizeMB)
+            return;
+
+        m_MetadataCacheMaxSizeMB = metadataCacheMaxSizeMB;
+        emit metadataCacheMaxSizeMBChanged(metadataCacheMaxSizeMB);
+        justChanged();
+    }
+
+    void SettingsModel::setImagesCacheMaxSizeMB(int imagesCacheMaxSizeMB)
+    {
+        if (m_ImagesCacheMaxSizeMB == imagesCacheMaxSizeMB)
+            return;
+
+        m_ImagesCacheMaxSizeMB = imagesCacheMaxSizeMB;
+        emit imagesCacheMaxSizeMBChanged(imagesCacheMaxSizeMB);
+        justChanged();
+    }
+
+    void SettingsModel::setVideosCacheMaxSizeMB(int videosCacheMaxSizeMB)
+    {
+        if (m_VideosCacheMaxSizeMB == videosCacheMaxSizeMB)
+            return;
+
+        m_VideosCacheMaxSizeMB = videosCacheMaxSizeMB;
+        emit videosCacheMaxSizeMBChanged(videosCacheMaxSizeMB);
+        justChanged();
+    }
+
     void SettingsModel::setUseDirectExiftoolExport(bool value) {
         if (m_UseDirectExiftoolExport == value)
             return;
@@ -1014,6 +1092,50 @@ namespace Models {
         justChanged();
     }
 
+    void SettingsModel::setUseExiv2(bool value) {
+        if (m_UseExiv2 == value)
+            return;
+
+        m_UseExiv2 = value;
+        justChanged();
+    }
+
+    void SettingsModel::setImageCachingThrottling(int value) {
+        if (m_ImageCachingThrottling == value)
+            return;
+
+        m_ImageCachingThrottling = value;
+        m_ThrottlingChanged = true;
+        justChanged();
+    }
+
+    void SettingsModel::setVideoCachingThrottling(int value) {
+        if (m_VideoCachingThrottling == value)
+            return;
+
+        m_VideoCachingThrottling = value;
+        m_ThrottlingChanged = true;
+        justChanged();
+    }
+
+    void SettingsModel::setSpellCheckThrottling(int value) {
+        if (m_SpellCheckThrottling == value)
+            return;
+
+        m_SpellCheckThrottling = value;
+        m_ThrottlingChanged = true;
+        justChanged();
+    }
+
+    void SettingsModel::setWarningsThrottling(int value) {
+        if (m_WarningsThrottling == value)
+            return;
+
+        m_WarningsThrottling = value;
+        m_ThrottlingChanged = true;
+        justChanged();
+    }
+
     void SettingsModel::setUseAutoImport(bool value) {
         if (m_UseAutoImport == value)
             return;
@@ -77,6 +77,9 @@ namespace Models {
         Q_PROPERTY(bool verboseUpload READ getVerboseUpload WRITE setVerboseUpload NOTIFY verboseUploadChanged)
         Q_PROPERTY(bool useProgressiveSuggestionPreviews READ getUseProgressiveSuggestionPreviews WRITE setUseProgressiveSuggestionPreviews NOTIFY useProgressiveSuggestionPreviewsChanged)
         Q_PROPERTY(int progressiveSuggestionIncrement READ getProgressiveSuggestionIncrement WRITE setProgressiveSuggestionIncrement NOTIFY progressiveSuggestionIncrementChanged)
+        Q_PROPERTY(int videosCacheMaxSizeMB READ getVideosCacheMaxSizeMB WRITE setVideosCacheMaxSizeMB NOTIFY videosCacheMaxSizeMBChanged)
+        Q_PROPERTY(int imagesCacheMaxSizeMB READ getImagesCacheMaxSizeMB WRITE setImagesCacheMaxSizeMB NOTIFY imagesCacheMaxSizeMBChanged)
+        Q_PROPERTY(int metadataCacheMaxSizeMB READ getMetadataCacheMaxSizeMB WRITE setMetadataCacheMaxSizeMB NOTIFY metadataCacheMaxSizeMBChanged)
         Q_PROPERTY(bool useAutoImport READ getUseAutoImport WRITE setUseAutoImport NOTIFY useAutoImportChanged)
 
         Q_PROPERTY(QString appVersion READ getAppVersion CONSTANT)
@@ -319,7 +322,15 @@ namespace Models {
         bool getVerboseUpload() const { return m_VerboseUpload; }
         bool getUseProgressiveSuggestionPreviews() const { return m_UseProgressiveSuggestionPreviews; }
         int getProgressiveSuggestionIncrement() const { return m_ProgressiveSuggestionIncrement; }
+        int getVideosCacheMaxSizeMB() const { return m_VideosCacheMaxSizeMB; }
+        int getImagesCacheMaxSizeMB() const { return m_ImagesCacheMaxSizeMB; }
+        int getMetadataCacheMaxSizeMB() const { return m_MetadataCacheMaxSizeMB; }
         int getUseDirectExiftoolExport() const { return m_UseDirectExiftoolExport; }
+        bool getUseExiv2() const { return m_UseExiv2; }
+        int getImageCachingThrottling() const { return m_ImageCachingThrottling; }
+        int getVideoCachingThrottling() const { return m_VideoCachingThrottling; }
+        int getSpellCheckThrottling() const { return m_SpellCheckThrottling; }
+        int getWarningsThrottling() const { return m_WarningsThrottling; }
         bool getUseAutoImport() const { return m_UseAutoImport; }
 
     signals:
@@ -360,6 +371,9 @@ namespace Models {
         void verboseUploadChanged(bool verboseUpload);
         void useProgressiveSuggestionPreviewsChanged(bool progressiveSuggestionPreviews);
         void progressiveSuggestionIncrementChanged(int progressiveSuggestionIncrement);
+        void videosCacheMaxSizeMBChanged(int videosCacheMaxSizeMB);
+        void imagesCacheMaxSizeMBChanged(int imagesCacheMaxSizeMB);
+        void metadataCacheMaxSizeMBChanged(int metadataCacheMaxSizeMB);
         void useAutoImportChanged(bool value);
 
     public:
@@ -392,7 +406,15 @@ namespace Models {
         void setVerboseUpload(bool verboseUpload);
         void setUseProgressiveSuggestionPreviews(bool useProgressiveSuggestionPreviews);
         void setProgressiveSuggestionIncrement(int progressiveSuggestionIncrement);
+        void setVideosCacheMaxSizeMB(int videosCacheMaxSizeMB);
+        void setImagesCacheMaxSizeMB(int imagesCacheMaxSizeMB);
+        void setMetadataCacheMaxSizeMB(int metadataCacheMaxSizeMB);
         void setUseDirectExiftoolExport(bool value);
+        void setUseExiv2(bool value);
+        void setImageCachingThrottling(int value);
+        void setVideoCachingThrottling(int value);
+        void setSpellCheckThrottling(int value);
+        void setWarningsThrottling(int value);
         void setUseAutoImport(bool value);
 
     public slots:
@@ -459,9 +481,18 @@ namespace Models {
         bool m_VerboseUpload;
         bool m_UseProgressiveSuggestionPreviews;
         int m_ProgressiveSuggestionIncrement;
+        int m_VideosCacheMaxSizeMB;
+        int m_ImagesCacheMaxSizeMB;
+        int m_MetadataCacheMaxSizeMB;
         bool m_UseDirectExiftoolExport;
+        bool m_UseExiv2;
+        int m_ImageCachingThrottling;
+        int m_VideoCachingThrottling;
+        int m_SpellCheckThrottling;
+        int m_WarningsThrottling;
         bool m_UseAutoImport;
         bool m_ExiftoolPathChanged;
+        bool m_ThrottlingChanged;
     };
 }
 
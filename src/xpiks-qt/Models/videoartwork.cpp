@@ -84,6 +84,22 @@ namespace Models {
             m_CodecName = cachedArtwork.m_CodecName;
         }
 
+        if (cachedArtwork.m_FileModifiedTime.isValid()) {
+            // no decoding needed as long as the file was not changed since it was probed
+            QFileInfo fi(getFilepath());
+            if ((fi.size() == (qint64)cachedArtwork.m_FilesizeBytes) &&
+                    (fi.lastModified() == cachedArtwork.m_FileModifiedTime)) {
+                m_Duration = cachedArtwork.m_VideoDuration;
+                m_FrameRate = cachedArtwork.m_VideoFrameRate;
+                m_BitRate = cachedArtwork.m_VideoBitRate;
+                if (cachedArtwork.m_VideoSize.isValid()) {
+                    m_ImageSize = cachedArtwork.m_VideoSize;
+                }
+            } else {
+                LOG_DEBUG << "Cached video properties are outdated for" << getFilepath();
+            }
+        }
+
         initializeThumbnailPath(cachedArtwork.m_ThumbnailPath);
 
         return false;
@@ -51,6 +51,9 @@ namespace Models {
         double getBitRate() const { return m_BitRate / 1000000.0; }
         double getFrameRate() const { return m_FrameRate; }
         const double &getDuration() const { return m_Duration; }
+        qint64 getBitRateBps() const { return m_BitRate; }
+        // duration is known either from exiftool or from the thumbnail creator
+        bool hasVideoProperties() const { return m_Duration > 0.0; }
 
     public:
         void setThumbnailPath(const QString &filepath);
@@ -11,14 +11,21 @@
 #include "cachedimage.h"
 #include "../Common/version.h"
 
+// thumbnails are stored in 1x, 2x and 4x of the base size
+#define PYRAMID_LEVELS_COUNT 3
+
 namespace QMLExtensions {
     CachedImage::CachedImage():
         m_Version(0),
-        m_RequestsServed(0)
+        m_RequestsServed(0),
+        m_IsQuickThumbnail(false),
+        m_PackSegmentID(-1),
+        m_PackOffset(0),
+        m_PackSize(0)
     {
         if (XPIKS_MAJOR_VERSION_CHECK(1, 5) ||
                 XPIKS_MAJOR_VERSION_CHECK(1, 4)) {
-            m_Version = 1;
+            m_Version = 4;
         }
     }
 
@@ -27,7 +34,12 @@ namespace QMLExtensions {
         m_LastModified(from.m_LastModified),
         m_Filename(from.m_Filename),
         m_Size(from.m_Size),
-        m_RequestsServed(from.m_RequestsServed)
+        m_RequestsServed(from.m_RequestsServed),
+        m_IsQuickThumbnail(from.m_IsQuickThumbnail),
+        m_PackSegmentID(from.m_PackSegmentID),
+        m_PackOffset(from.m_PackOffset),
+        m_PackSize(from.m_PackSize),
+        m_ExtraLevels(from.m_ExtraLevels)
     {
     }
 
@@ -37,10 +49,99 @@ namespace QMLExtensions {
         m_Filename = other.m_Filename;
         m_Size = other.m_Size;
         m_RequestsServed = other.m_RequestsServed;
+        m_IsQuickThumbnail = other.m_IsQuickThumbnail;
+        m_PackSegmentID = other.m_PackSegmentID;
+        m_PackOffset = other.m_PackOffset;
+        m_PackSize = other.m_PackSize;
+        m_ExtraLevels = other.m_ExtraLevels;
 
         return *this;
     }
 
+    QVector<CachedImageLevel> CachedImage::getLevels() const {
+        QVector<CachedImageLevel> levels;
+        levels.reserve(1 + m_ExtraLevels.size());
+
+        CachedImageLevel primary;
+        primary.m_Size = m_Size;
+        primary.m_PackSegmentID = m_PackSegmentID;
+        primary.m_PackOffset = m_PackOffset;
+        primary.m_PackSize = m_PackSize;
+
+        levels.append(primary);
+        levels.append(m_ExtraLevels);
+
+        return levels;
+    }
+
+    void CachedImage::setLevels(const QVector<CachedImageLevel> &levels) {
+        Q_ASSERT(!levels.isEmpty());
+        if (levels.isEmpty()) { return; }
+
+        const CachedImageLevel &primary = levels.first();
+        m_Size = primary.m_Size;
+        m_PackSegmentID = primary.m_PackSegmentID;
+        m_PackOffset = primary.m_PackOffset;
+        m_PackSize = primary.m_PackSize;
+        m_ExtraLevels = levels.mid(1);
+    }
+
+    bool CachedImage::findLevel(const QSize &requestedSize, CachedImageLevel &level) const {
+        bool found = false;
+
+        for (auto &candidate: getLevels()) {
+            const QSize &size = candidate.m_Size;
+            if ((size.width() < requestedSize.width()) ||
+                    (size.height() < requestedSize.height())) { continue; }
+
+            if (!found || (size.width() * size.height() < level.m_Size.width() * level.m_Size.height())) {
+                level = candidate;
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+    bool isCovering(const QSize &size, const QSize &requestedSize) {
+        return (size.width() >= requestedSize.width()) &&
+                (size.height() >= requestedSize.height());
+    }
+
+    QVector<QSize> getPyramidSizes(const QSize &baseSize, const QSize &requestedSize) {
+        QVector<QSize> sizes;
+        sizes.reserve(PYRAMID_LEVELS_COUNT + 1);
+
+        QSize levelSize = baseSize;
+        for (int i = 0; i < PYRAMID_LEVELS_COUNT; ++i) {
+            sizes.append(levelSize);
+            if (isCovering(levelSize, requestedSize)) { break; }
+            levelSize *= 2;
+        }
+
+        if (!isCovering(sizes.last(), requestedSize)) {
+            sizes.append(requestedSize);
+        }
+
+        return sizes;
+    }
+
+    QDataStream &operator<<(QDataStream &out, const CachedImageLevel &v) {
+        out << v.m_Size;
+        out << v.m_PackSegmentID;
+        out << v.m_PackOffset;
+        out << v.m_PackSize;
+        return out;
+    }
+
+    QDataStream &operator>>(QDataStream &in, CachedImageLevel &v) {
+        in >> v.m_Size;
+        in >> v.m_PackSegmentID;
+        in >> v.m_PackOffset;
+        in >> v.m_PackSize;
+        return in;
+    }
+
     QDataStream &operator<<(QDataStream &out, const CachedImage &v) {
         // TODO: update before release to Qt 5.9
         Q_ASSERT(!XPIKS_VERSION_CHECK(1, 5, 0));
@@ -54,6 +155,20 @@ namespace QMLExtensions {
         out << v.m_Size;
         out << v.m_RequestsServed;
 
+        if (v.m_Version >= 2) {
+            out << v.m_IsQuickThumbnail;
+        }
+
+        if (v.m_Version >= 3) {
+            out << v.m_PackSegmentID;
+            out << v.m_PackOffset;
+            out << v.m_PackSize;
+        }
+
+        if (v.m_Version >= 4) {
+            out << v.m_ExtraLevels;
+        }
+
         Q_ASSERT(out.status() == QDataStream::Ok);
 
         return out;
@@ -72,6 +187,28 @@ namespace QMLExtensions {
         in >> v.m_Size;
         in >> v.m_RequestsServed;
 
+        if (v.m_Version >= 2) {
+            in >> v.m_IsQuickThumbnail;
+        } else {
+            v.m_IsQuickThumbnail = false;
+        }
+
+        if (v.m_Version >= 3) {
+            in >> v.m_PackSegmentID;
+            in >> v.m_PackOffset;
+            in >> v.m_PackSize;
+        } else {
+            v.m_PackSegmentID = -1;
+            v.m_PackOffset = 0;
+            v.m_PackSize = 0;
+        }
+
+        if (v.m_Version >= 4) {
+            in >> v.m_ExtraLevels;
+        } else {
+            v.m_ExtraLevels.clear();
+        }
+
         Q_ASSERT(in.status() == QDataStream::Ok);
 
         return in;
@@ -16,8 +16,23 @@
 #include <QSize>
 #include <QDateTime>
 #include <QDataStream>
+#include <QVector>
 
 namespace QMLExtensions {
+    // one size of the thumbnail in the pack
+    struct CachedImageLevel {
+        CachedImageLevel():
+            m_PackSegmentID(-1),
+            m_PackOffset(0),
+            m_PackSize(0)
+        { }
+
+        QSize m_Size;
+        qint32 m_PackSegmentID;
+        quint32 m_PackOffset;
+        quint32 m_PackSize;
+    };
+
     struct CachedImage {
         CachedImage();
         CachedImage(const CachedImage &from);
@@ -30,8 +45,37 @@ namespace QMLExtensions {
         QSize m_Size;
         quint64 m_RequestsServed;
         // END of data version 1
+        // BEGIN of data version 2
+        // embedded thumbnail vs scaled from the original
+        bool m_IsQuickThumbnail;
+        // END of data version 2
+        // BEGIN of data version 3
+        // thumbnail is in the pack if segment is not negative,
+        // otherwise it is a separate file m_Filename
+        qint32 m_PackSegmentID;
+        quint32 m_PackOffset;
+        quint32 m_PackSize;
+        // END of data version 3
+        // BEGIN of data version 4
+        // bigger copies of the same thumbnail, primary one above is the smallest
+        QVector<CachedImageLevel> m_ExtraLevels;
+        // END of data version 4
+
+        // all sizes ordered from the smallest
+        QVector<CachedImageLevel> getLevels() const;
+        void setLevels(const QVector<CachedImageLevel> &levels);
+        // smallest level that is not less than requested size in both dimensions
+        bool findLevel(const QSize &requestedSize, CachedImageLevel &level) const;
     };
 
+    // sizes of levels from the base one up to the first one covering requested size
+    // (or requested size itself when it is bigger than all levels), bigger levels
+    // are generated later only if they are requested (e.g. zoom or DPI change)
+    QVector<QSize> getPyramidSizes(const QSize &baseSize, const QSize &requestedSize);
+
+    QDataStream &operator<<(QDataStream &out, const CachedImageLevel &v);
+    QDataStream &operator>>(QDataStream &in, CachedImageLevel &v);
+
     QDataStream &operator<<(QDataStream &out, const CachedImage &v);
     QDataStream &operator>>(QDataStream &in, CachedImage &v);
 }
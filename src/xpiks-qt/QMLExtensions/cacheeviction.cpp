@@ -0,0 +1,50 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "cacheeviction.h"
+#include <algorithm>
+
+#define EVICTION_TARGET_PERCENT 90
+
+namespace QMLExtensions {
+    qint64 selectEvictionVictims(std::vector<EvictionCandidate> &candidates,
+                                 qint64 maxSizeBytes,
+                                 std::vector<EvictionCandidate> &victims) {
+        victims.clear();
+
+        qint64 totalBytes = 0;
+        for (auto &candidate: candidates) {
+            totalBytes += candidate.m_SizeBytes;
+        }
+
+        if ((maxSizeBytes <= 0) || (totalBytes <= maxSizeBytes)) { return totalBytes; }
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const EvictionCandidate &left, const EvictionCandidate &right) {
+            if (left.m_LastAccessTime != right.m_LastAccessTime) {
+                return left.m_LastAccessTime < right.m_LastAccessTime;
+            }
+
+            return left.m_RequestsServed < right.m_RequestsServed;
+        });
+
+        const qint64 targetBytes = maxSizeBytes * EVICTION_TARGET_PERCENT / 100;
+        qint64 remainingBytes = totalBytes;
+
+        for (auto &candidate: candidates) {
+            if (remainingBytes <= targetBytes) { break; }
+
+            remainingBytes -= candidate.m_SizeBytes;
+            victims.push_back(candidate);
+        }
+
+        return totalBytes;
+    }
+}
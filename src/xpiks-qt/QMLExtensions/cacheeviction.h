@@ -0,0 +1,35 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CACHEEVICTION_H
+#define CACHEEVICTION_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+namespace QMLExtensions {
+    struct EvictionCandidate {
+        QString m_Key;
+        qint64 m_SizeBytes;
+        // seconds since epoch, 0 if never served since access times are tracked
+        qint64 m_LastAccessTime;
+        quint64 m_RequestsServed;
+    };
+
+    // least recently served items go first, ties are broken by requests count;
+    // cache is trimmed below the budget so that eviction does not run every time
+    // returns total size of all candidates
+    qint64 selectEvictionVictims(std::vector<EvictionCandidate> &candidates,
+                                 qint64 maxSizeBytes,
+                                 std::vector<EvictionCandidate> &victims);
+}
+
+#endif // CACHEEVICTION_H
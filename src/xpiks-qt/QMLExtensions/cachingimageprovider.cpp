@@ -11,6 +11,7 @@
 #include "cachingimageprovider.h"
 #include "../Common/defines.h"
 #include "../QMLExtensions/imagecachingservice.h"
+#include "../Helpers/imagehelpers.h"
 
 #define RECACHE true
 
@@ -34,11 +35,10 @@ namespace QMLExtensions {
 
         const QString id = prepareUrl(url);
 
-        QString cachedPath;
+        QImage cachedImage;
         bool needsUpdate = false;
 
-        if (m_ImageCachingService->tryGetCachedImage(id, requestedSize, cachedPath, needsUpdate)) {
-            QImage cachedImage(cachedPath);
+        if (m_ImageCachingService->tryGetCachedImage(id, requestedSize, cachedImage, needsUpdate)) {
             *size = cachedImage.size();
 
             if (needsUpdate) {
@@ -53,20 +53,30 @@ namespace QMLExtensions {
 
         LOG_INTEGR_TESTS_OR_DEBUG << "Not found properly cached:" << id;
 
-        QImage originalImage(id);
-        *size = originalImage.size();
-
-        QImage result;
+        QSize targetSize = requestedSize;
 
         if (requestedSize.isValid()) {
             m_ImageCachingService->cacheImage(id, requestedSize);
-            result = originalImage.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         } else {
             LOG_WARNING << "Size is invalid:" << requestedSize.width() << "x" << requestedSize.height();
             m_ImageCachingService->cacheImage(id);
-            result = originalImage.scaled(m_ImageCachingService->getDefaultSize(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            targetSize = m_ImageCachingService->getDefaultSize();
+        }
+
+        // embedded thumbnail is shown until the good one is cached
+        QByteArray thumbnailData;
+        int orientation = 1;
+        if (Helpers::readEmbeddedThumbnail(id, thumbnailData, orientation)) {
+            QImage thumbnail = QImage::fromData(thumbnailData, "JPG");
+            if (Helpers::isEmbeddedThumbnailEnough(thumbnail.size(), targetSize)) {
+                LOG_INTEGR_TESTS_OR_DEBUG << "Using embedded thumbnail of" << id;
+                thumbnail = Helpers::applyExifOrientation(thumbnail, orientation);
+                *size = thumbnail.size();
+                return thumbnail.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            }
         }
 
+        QImage result = Helpers::readScaledImage(id, targetSize, size);
         return result;
     }
 }
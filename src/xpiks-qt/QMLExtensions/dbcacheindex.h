@@ -15,6 +15,10 @@
 #include <QHash>
 #include <QReadWriteLock>
 #include <QMutex>
+#include <QVector>
+#include <QPair>
+#include <QDateTime>
+#include <QtEndian>
 #include <memory>
 #include <functional>
 #include "previewstorage.h"
@@ -55,6 +59,7 @@ namespace QMLExtensions {
             LOG_DEBUG << "#";
 
             flushWAL();
+            flushAccesses();
 
             if (m_Database) {
                 m_Database->sync();
@@ -85,6 +90,109 @@ namespace QMLExtensions {
             return found;
         }
 
+    public:
+        // remembers when item was served last time, written to DB in sync()
+        void touch(const QString &key) {
+            const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+
+            QMutexLocker locker(&m_AccessMutex);
+            Q_UNUSED(locker);
+            m_PendingAccesses.insert(key, now);
+        }
+
+        // reads synced items ordered by key, moves afterKey to the last row read
+        // returns count of rows read including the ones that failed to deserialize
+        int readPage(QString &afterKey, int limit, QVector<QPair<QString, TValue> > &items) {
+            items.clear();
+            if (!m_DbCacheIndex) { return 0; }
+
+            QVector<QPair<QByteArray, QByteArray> > keyValueList;
+            m_DbCacheIndex->getPage(afterKey.toUtf8(), limit, keyValueList);
+
+            items.reserve(keyValueList.size());
+            for (auto &keyValue: keyValueList) {
+                TValue value;
+                QDataStream ds(&keyValue.second, QIODevice::ReadOnly);
+                ds >> value;
+
+                if (ds.status() == QDataStream::Ok) {
+                    items.append(qMakePair(QString::fromUtf8(keyValue.first), value));
+                }
+            }
+
+            if (!keyValueList.isEmpty()) {
+                afterKey = QString::fromUtf8(keyValueList.last().first);
+            }
+
+            return keyValueList.size();
+        }
+
+        // seconds since epoch or 0 if item was not served since access tracking exists
+        void readLastAccessTimes(const QVector<QString> &keys, QHash<QString, qint64> &accessTimes) {
+            accessTimes.clear();
+
+            if (m_DbAccessIndex) {
+                QVector<QByteArray> keysList;
+                keysList.reserve(keys.size());
+                for (auto &key: keys) { keysList.append(key.toUtf8()); }
+
+                QVector<QPair<QByteArray, QByteArray> > keyValueList;
+                m_DbAccessIndex->tryGetMany(keysList, keyValueList);
+
+                for (auto &keyValue: keyValueList) {
+                    if (keyValue.second.size() != (int)sizeof(qint64)) { continue; }
+                    const qint64 accessTime = qFromLittleEndian<qint64>((const uchar *)keyValue.second.constData());
+                    accessTimes.insert(QString::fromUtf8(keyValue.first), accessTime);
+                }
+            }
+
+            QMutexLocker locker(&m_AccessMutex);
+            Q_UNUSED(locker);
+
+            for (auto &key: keys) {
+                auto it = m_PendingAccesses.constFind(key);
+                if (it != m_PendingAccesses.constEnd()) {
+                    accessTimes.insert(key, it.value());
+                }
+            }
+        }
+
+        // caller is responsible that items are not updated concurrently
+        int remove(const QVector<QString> &keys) {
+            if (keys.isEmpty() || !m_DbCacheIndex) { return 0; }
+            LOG_DEBUG << keys.size() << "item(s)";
+
+            // removed items might still wait in WAL
+            flushWAL();
+
+            QVector<QByteArray> keysList;
+            keysList.reserve(keys.size());
+            for (auto &key: keys) { keysList.append(key.toUtf8()); }
+
+            if (!m_DbCacheIndex->tryDeleteMany(keysList)) {
+                LOG_WARNING << "Failed to delete" << keys.size() << "item(s)";
+                return 0;
+            }
+
+            if (m_DbAccessIndex) {
+                m_DbAccessIndex->tryDeleteMany(keysList);
+            }
+
+            {
+                QWriteLocker locker(&m_CacheLock);
+                Q_UNUSED(locker);
+                for (auto &key: keys) { m_CacheIndex.remove(key); }
+            }
+
+            {
+                QMutexLocker locker(&m_AccessMutex);
+                Q_UNUSED(locker);
+                for (auto &key: keys) { m_PendingAccesses.remove(key); }
+            }
+
+            return keys.size();
+        }
+
     protected:
         virtual int getMaxCacheMemorySize() const = 0;
 
@@ -117,15 +225,10 @@ namespace QMLExtensions {
             bool success = false;
 
             QByteArray rawValue;
-            bool found = false;
-
-            {
-                QMutexLocker locker(&m_ReadMutex);
-                Q_UNUSED(locker);
-
-                const QByteArray utf8Key = key.toUtf8();
-                found = m_DbCacheIndex->tryGetValue(utf8Key, rawValue);
-            }
+            // table leases a read-only connection so UI thread
+            // and ImageCachingWorker thread can read in parallel
+            const QByteArray utf8Key = key.toUtf8();
+            const bool found = m_DbCacheIndex->tryGetValue(utf8Key, rawValue);
 
             if (found) {
                 QDataStream ds(&rawValue, QIODevice::ReadOnly);
@@ -161,6 +264,33 @@ namespace QMLExtensions {
             m_WAL.flush(m_DbCacheIndex);
         }
 
+        void flushAccesses() {
+            if (!m_DbAccessIndex) { return; }
+
+            QHash<QString, qint64> accesses;
+            {
+                QMutexLocker locker(&m_AccessMutex);
+                Q_UNUSED(locker);
+                accesses.swap(m_PendingAccesses);
+            }
+
+            if (accesses.isEmpty()) { return; }
+
+            QVector<QPair<QByteArray, QByteArray> > keyValuesList;
+            keyValuesList.reserve(accesses.size());
+            for (auto it = accesses.constBegin(); it != accesses.constEnd(); ++it) {
+                QByteArray value((int)sizeof(qint64), '\0');
+                qToLittleEndian<qint64>(it.value(), (uchar *)value.data());
+                keyValuesList.append(qMakePair(it.key().toUtf8(), value));
+            }
+
+            // access times are only a hint for eviction so failures are not retried
+            QVector<int> failedIndices;
+            if (!m_DbAccessIndex->trySetMany(keyValuesList, failedIndices)) {
+                LOG_WARNING << "Failed to save" << failedIndices.size() << "access time(s)";
+            }
+        }
+
         void compactCache()  {
             LOG_DEBUG << "#";
             // if db is not available, operate only in memory
@@ -232,15 +362,15 @@ namespace QMLExtensions {
         }
 
     protected:
-        // guard for get statement accessed from UI thread
-        // and from ImageCachingWorker thread
-        QMutex m_ReadMutex;
         Helpers::DatabaseManager *m_DatabaseManager;
         std::shared_ptr<Helpers::Database::Table> m_DbCacheIndex;
+        std::shared_ptr<Helpers::Database::Table> m_DbAccessIndex;
         std::shared_ptr<Helpers::Database> m_Database;
         IndexWriteAheadLog<TValue> m_WAL;
         QReadWriteLock m_CacheLock;
         QHash<QString, TValue> m_CacheIndex;
+        QMutex m_AccessMutex;
+        QHash<QString, qint64> m_PendingAccesses;
         quint64 m_MaxCacheTag;
     };
 }
@@ -41,6 +41,12 @@ namespace QMLExtensions {
                 break;
             }
 
+            m_DbAccessIndex = m_Database->getTable(Constants::VIDEO_ACCESS_TABLE);
+            if (!m_DbAccessIndex) {
+                // eviction will fall back to the requests count
+                LOG_WARNING << "Failed to get table" << Constants::VIDEO_ACCESS_TABLE;
+            }
+
             success = true;
         } while (false);
 
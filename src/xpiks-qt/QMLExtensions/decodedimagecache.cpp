@@ -0,0 +1,118 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "decodedimagecache.h"
+#include "../Common/defines.h"
+
+#define COST_UNIT_BYTES 1024
+
+namespace QMLExtensions {
+    int getImageCost(const QImage &image) {
+        return qMax(1, image.byteCount() / COST_UNIT_BYTES);
+    }
+
+    DecodedImageCache::DecodedImageCache(int maxSizeBytes):
+        m_Cache(qMax(1, maxSizeBytes / COST_UNIT_BYTES)),
+        m_ClearsCount(0)
+    {
+    }
+
+    bool DecodedImageCache::tryGet(const QString &path, const QSize &size, QImage &image) {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        // object() also makes the item most recently used
+        QImage *cachedImage = m_Cache.object(makeKey(path, size));
+        if (cachedImage == nullptr) { return false; }
+
+        // implicitly shared, no pixels are copied
+        image = *cachedImage;
+        return true;
+    }
+
+    quint64 DecodedImageCache::getGeneration(const QString &path) {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        // both counters only grow so their sum changes with any of them
+        return m_ClearsCount + m_InvalidationsByPath.value(path, 0);
+    }
+
+    bool DecodedImageCache::insert(const QString &path, const QSize &size, const QImage &image, quint64 generation) {
+        if (image.isNull()) { return false; }
+
+        const int cost = getImageCost(image);
+
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        if (cost > m_Cache.maxCost()) { return false; }
+
+        // thumbnail was replaced while this image was being read
+        if (generation != m_ClearsCount + m_InvalidationsByPath.value(path, 0)) {
+            LOG_FOR_DEBUG << "Skipping outdated image of" << path;
+            return false;
+        }
+
+        m_Cache.insert(makeKey(path, size), new QImage(image), cost);
+
+        QVector<QSize> &sizes = m_SizesByPath[path];
+        if (!sizes.contains(size)) {
+            sizes.append(size);
+        }
+
+        return true;
+    }
+
+    void DecodedImageCache::invalidate(const QString &path) {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        m_InvalidationsByPath[path]++;
+
+        // sizes of already evicted items are removed here as well
+        const QVector<QSize> sizes = m_SizesByPath.take(path);
+        for (auto &size: sizes) {
+            m_Cache.remove(makeKey(path, size));
+        }
+    }
+
+    void DecodedImageCache::clear() {
+        LOG_DEBUG << "#";
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+
+        m_Cache.clear();
+        m_SizesByPath.clear();
+        // per path counters are dropped, the new base is above any generation given out
+        quint64 maxInvalidations = 0;
+        for (auto invalidations: m_InvalidationsByPath) {
+            maxInvalidations = qMax(maxInvalidations, invalidations);
+        }
+
+        m_ClearsCount += maxInvalidations + 1;
+        m_InvalidationsByPath.clear();
+    }
+
+    int DecodedImageCache::getSizeBytes() {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        return m_Cache.totalCost() * COST_UNIT_BYTES;
+    }
+
+    int DecodedImageCache::getItemsCount() {
+        QMutexLocker locker(&m_Mutex);
+        Q_UNUSED(locker);
+        return m_Cache.count();
+    }
+
+    QString DecodedImageCache::makeKey(const QString &path, const QSize &size) const {
+        return QString::number(size.width()) + QLatin1Char('x') + QString::number(size.height()) + QLatin1Char(':') + path;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef DECODEDIMAGECACHE_H
+#define DECODEDIMAGECACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+namespace QMLExtensions {
+    // least recently used decoded thumbnails limited by size in bytes,
+    // image provider is called from several QML loader threads
+    class DecodedImageCache
+    {
+    public:
+        DecodedImageCache(int maxSizeBytes);
+
+    public:
+        bool tryGet(const QString &path, const QSize &size, QImage &image);
+        // has to be taken before the image is read from the storage
+        quint64 getGeneration(const QString &path);
+        // image read before the path was invalidated is not inserted
+        bool insert(const QString &path, const QSize &size, const QImage &image, quint64 generation);
+        // all sizes of the path
+        void invalidate(const QString &path);
+        void clear();
+
+    public:
+        int getSizeBytes();
+        int getItemsCount();
+
+    private:
+        QString makeKey(const QString &path, const QSize &size) const;
+
+    private:
+        QMutex m_Mutex;
+        // cost is in kilobytes to stay in int range
+        QCache<QString, QImage> m_Cache;
+        QHash<QString, QVector<QSize> > m_SizesByPath;
+        QHash<QString, quint64> m_InvalidationsByPath;
+        quint64 m_ClearsCount;
+    };
+}
+
+#endif // DECODEDIMAGECACHE_H
@@ -13,6 +13,7 @@
 
 #include <QString>
 #include <QSize>
+#include "../Common/flags.h"
 
 namespace QMLExtensions {
 
@@ -20,22 +21,41 @@ namespace QMLExtensions {
 #define DEFAULT_THUMB_WIDTH 150
 
     class ImageCacheRequest {
+    private:
+        enum RequestFlags {
+            RecacheFlag = 1 << 0,
+            QuickThumbnailFlag = 1 << 1
+        };
+
     public:
-        ImageCacheRequest(const QString &filepath, const QSize &requestedSize, bool recache):
+        ImageCacheRequest(const QString &filepath, const QSize &requestedSize, bool recache, bool quickThumbnail=false):
             m_Filepath(filepath),
             m_RequestedSize(requestedSize),
-            m_Recache(recache)
-        { }
+            m_Flags(0),
+            m_QueueKey(0)
+        {
+            Common::ApplyFlag(m_Flags, recache, RecacheFlag);
+            Common::ApplyFlag(m_Flags, quickThumbnail, QuickThumbnailFlag);
+        }
 
     public:
         const QString &getFilepath() const { return m_Filepath; }
         const QSize &getRequestedSize() const { return m_RequestedSize; }
-        bool getNeedRecache() const { return m_Recache; }
+        bool getNeedRecache() const { return Common::HasFlag(m_Flags, RecacheFlag); }
+        // embedded thumbnail is enough, good quality one is requested afterwards
+        bool getIsQuickThumbnail() const { return Common::HasFlag(m_Flags, QuickThumbnailFlag); }
+        // key of the artwork in the caching queue, 0 for requests not bound to an artwork
+        quint64 getQueueKey() const { return m_QueueKey; }
+
+    public:
+        void setGoodQualityRequest() { Common::ApplyFlag(m_Flags, false, QuickThumbnailFlag); }
+        void setQueueKey(quint64 key) { m_QueueKey = key; }
 
     private:
         QString m_Filepath;
         QSize m_RequestedSize;
-        bool m_Recache;
+        Common::flag_t m_Flags;
+        quint64 m_QueueKey;
     };
 }
 
@@ -18,12 +18,42 @@
 #include "../Helpers/asynccoordinator.h"
 #include "../Commands/commandmanager.h"
 #include "../MetadataIO/artworkssnapshot.h"
+#include "../Helpers/threadhelpers.h"
+#include <algorithm>
+#include <iterator>
+
+#define IMAGE_CACHING_MAX_WORKERS_COUNT 4
+#define DECODED_IMAGES_MAX_SIZE_BYTES (128*1024*1024)
 
 namespace QMLExtensions {
+    void createPreviewRequests(const MetadataIO::WeakArtworksSnapshot &artworks,
+                               const QSize &size, bool quickThumbnail,
+                               std::vector<std::shared_ptr<ImageCacheRequest> > &requests,
+                               std::vector<Common::item_key_t> &keys) {
+        const bool recache = false;
+        requests.reserve(requests.size() + artworks.size());
+        keys.reserve(keys.size() + artworks.size());
+
+        for (auto *artwork: artworks) {
+            Models::ImageArtwork *imageArtwork = dynamic_cast<Models::ImageArtwork*>(artwork);
+            if (imageArtwork == nullptr) { continue; }
+
+            const Common::item_key_t key = Common::makeItemKey(artwork->getItemID(), 0);
+            std::shared_ptr<ImageCacheRequest> request(new ImageCacheRequest(artwork->getThumbnailPath(),
+                                                                             size,
+                                                                             recache,
+                                                                             quickThumbnail));
+            request->setQueueKey(key);
+            requests.push_back(request);
+            keys.push_back(key);
+        }
+    }
+
     ImageCachingService::ImageCachingService(QObject *parent) :
         QObject(parent),
         Common::BaseEntity(),
         m_CachingWorker(NULL),
+        m_DecodedImages(DECODED_IMAGES_MAX_SIZE_BYTES),
         m_IsCancelled(false),
         m_Scale(1.0)
     {
@@ -40,7 +70,8 @@ namespace QMLExtensions {
         Q_UNUSED(locker);
 
         auto *dbManager = m_CommandManager->getDatabaseManager();
-        m_CachingWorker = new ImageCachingWorker(coordinator, dbManager);
+        const int workersCount = Helpers::getOptimalWorkersCount(IMAGE_CACHING_MAX_WORKERS_COUNT);
+        m_CachingWorker = new ImageCachingWorker(coordinator, dbManager, &m_DecodedImages, workersCount);
 
         QThread *thread = new QThread();
         m_CachingWorker->moveToThread(thread);
@@ -66,6 +97,22 @@ namespace QMLExtensions {
         }
     }
 
+    void ImageCachingService::setThrottlingPolicy(Helpers::ThrottlingPolicy policy) {
+        LOG_INFO << (int)policy;
+
+        if (m_CachingWorker != NULL) {
+            m_CachingWorker->setThrottlingPolicy(policy);
+        }
+    }
+
+    void ImageCachingService::logStatistics() const {
+        if (m_CachingWorker != NULL) {
+            m_CachingWorker->logTelemetry();
+        }
+
+        LOG_INFO << m_DecodedImages.getItemsCount() << "decoded image(s) use" << m_DecodedImages.getSizeBytes() << "bytes";
+    }
+
     void ImageCachingService::upgradeCacheStorage() {
         LOG_DEBUG << "#";
 
@@ -77,9 +124,30 @@ namespace QMLExtensions {
         }
     }
 
+    void ImageCachingService::compactCacheStorage() {
+        LOG_DEBUG << "#";
+
+        if ((m_CachingWorker != NULL) && !m_IsCancelled) {
+            m_CachingWorker->compactCacheStorage();
+        }
+    }
+
+    void ImageCachingService::evictCacheStorage(qint64 maxSizeBytes) {
+        LOG_DEBUG << maxSizeBytes;
+
+        if ((m_CachingWorker != NULL) && !m_IsCancelled) {
+            m_CachingWorker->evictCacheStorage(maxSizeBytes);
+        }
+    }
+
     void ImageCachingService::setScale(qreal scale) {
         LOG_INFO << scale;
         if ((0.99f < scale) && (scale < 5.0f)) {
+            if (!qFuzzyCompare(m_Scale, scale)) {
+                // previews of all sizes are requested again
+                m_DecodedImages.clear();
+            }
+
             m_Scale = scale;
             if (m_CachingWorker != nullptr) {
                 m_CachingWorker->setScale(scale);
@@ -93,6 +161,10 @@ namespace QMLExtensions {
         if (m_IsCancelled) { return; }
 
         Q_ASSERT(m_CachingWorker != NULL);
+        if (recache) {
+            m_DecodedImages.invalidate(key);
+        }
+
         std::shared_ptr<ImageCacheRequest> request(new ImageCacheRequest(key, requestedSize, recache));
         m_CachingWorker->submitFirst(request);
     }
@@ -107,34 +179,80 @@ namespace QMLExtensions {
         Q_ASSERT(m_CachingWorker != NULL);
         LOG_INFO << "generating for" << snapshot.size() << "items";
 
-        std::vector<std::shared_ptr<ImageCacheRequest> > requests;
-        const size_t size = snapshot.size();
-        requests.reserve(size);
-        const bool recache = false;
+        // embedded thumbnails first for the whole snapshot
+        const bool quickThumbnail = true;
 
         updateDefaultSize();
 
-        for (size_t i = 0; i < size; i++) {
-            auto *artwork = snapshot.get(i);
-            Models::ImageArtwork *imageArtwork = dynamic_cast<Models::ImageArtwork*>(artwork);
-            if (imageArtwork != nullptr) {
-                requests.emplace_back(new ImageCacheRequest(artwork->getThumbnailPath(),
-                                                            m_DefaultSize,
-                                                            recache));
-            }
-        }
+        std::vector<std::shared_ptr<ImageCacheRequest> > requests;
+        std::vector<Common::item_key_t> keys;
+        createPreviewRequests(snapshot.getWeakSnapshot(), m_DefaultSize, quickThumbnail, requests, keys);
 
-        m_CachingWorker->submitItems(requests);
+        // keys allow to move the requests up when artworks are scrolled into view
+        m_CachingWorker->submitItems(requests, keys, Common::LaneBulk);
         m_CachingWorker->submitSeparator();
     }
 
+    void ImageCachingService::prioritizePreviews(const MetadataIO::WeakArtworksSnapshot &visibleArtworks,
+                                                 const MetadataIO::WeakArtworksSnapshot &nextArtworks) {
+        if (m_IsCancelled || (m_CachingWorker == NULL)) { return; }
+
+        LOG_FOR_DEBUG << visibleArtworks.size() << "visible and" << nextArtworks.size() << "next item(s)";
+        // user is looking at them so no need for the quick pass
+        const bool quickThumbnail = false;
+
+        std::vector<std::shared_ptr<ImageCacheRequest> > visibleRequests, nextRequests;
+        std::vector<Common::item_key_t> visibleKeys, nextKeys;
+        createPreviewRequests(visibleArtworks, m_DefaultSize, quickThumbnail, visibleRequests, visibleKeys);
+        createPreviewRequests(nextArtworks, m_DefaultSize, quickThumbnail, nextRequests, nextKeys);
+
+        std::vector<Common::item_key_t> prioritizedKeys;
+        prioritizedKeys.reserve(visibleKeys.size() + nextKeys.size());
+        prioritizedKeys.insert(prioritizedKeys.end(), visibleKeys.begin(), visibleKeys.end());
+        prioritizedKeys.insert(prioritizedKeys.end(), nextKeys.begin(), nextKeys.end());
+        std::sort(prioritizedKeys.begin(), prioritizedKeys.end());
+
+        std::vector<Common::item_key_t> staleKeys;
+        std::set_difference(m_PrioritizedKeys.begin(), m_PrioritizedKeys.end(),
+                            prioritizedKeys.begin(), prioritizedKeys.end(),
+                            std::back_inserter(staleKeys));
+
+        // scrolled past items still get previews but after everything else
+        if (!staleKeys.empty()) {
+            int demotedCount = m_CachingWorker->demoteItems(staleKeys, Common::LaneBulk);
+            LOG_FOR_DEBUG << demotedCount << "request(s) moved to the bulk queue";
+        }
+
+        // items already processed are skipped by the worker
+        if (!visibleRequests.empty()) {
+            m_CachingWorker->submitItems(visibleRequests, visibleKeys, Common::LaneInteractive);
+        }
+
+        if (!nextRequests.empty()) {
+            m_CachingWorker->submitItems(nextRequests, nextKeys, Common::LaneVisible);
+        }
+
+        m_PrioritizedKeys.swap(prioritizedKeys);
+    }
+
     bool ImageCachingService::tryGetCachedImage(const QString &key, const QSize &requestedSize,
-                                                QString &cached, bool &needsUpdate) {
-        if (!m_IsCancelled && m_CachingWorker != NULL) {
-            return m_CachingWorker->tryGetCachedImage(key, requestedSize, cached, needsUpdate);
-        } else {
-            return false;
+                                                QImage &image, bool &needsUpdate) {
+        if (m_IsCancelled || (m_CachingWorker == NULL)) { return false; }
+
+        if (m_DecodedImages.tryGet(key, requestedSize, image)) {
+            needsUpdate = false;
+            return true;
         }
+
+        // worker can replace the thumbnail while it is being read
+        const quint64 generation = m_DecodedImages.getGeneration(key);
+        const bool found = m_CachingWorker->tryGetCachedImage(key, requestedSize, image, needsUpdate);
+        // outdated and quick thumbnails are about to be replaced
+        if (found && !needsUpdate) {
+            m_DecodedImages.insert(key, requestedSize, image, generation);
+        }
+
+        return found;
     }
 
     void ImageCachingService::updateDefaultSize() {
@@ -152,6 +270,7 @@ namespace QMLExtensions {
     void ImageCachingService::dpiChanged(qreal someDPI) {
         LOG_DEBUG << "#";
         Q_UNUSED(someDPI);
+        m_DecodedImages.clear();
         QScreen *screen = qobject_cast<QScreen*>(sender());
         if (screen != nullptr) {
             setScale(screen->devicePixelRatio());
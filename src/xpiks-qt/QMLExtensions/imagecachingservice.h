@@ -15,20 +15,20 @@
 #include <QString>
 #include <QVector>
 #include <QSize>
+#include <QImage>
 #include <vector>
 #include <memory>
 #include "../Common/baseentity.h"
 #include "../Common/iservicebase.h"
+#include "../MetadataIO/artworkssnapshot.h"
+#include "decodedimagecache.h"
+#include "../Helpers/loadmonitor.h"
 
 namespace Models {
     class ArtworkMetadata;
     class ArtworkMetadataLocker;
 }
 
-namespace MetadataIO {
-    class ArtworksSnapshot;
-}
-
 class QScreen;
 
 namespace QMLExtensions {
@@ -44,6 +44,10 @@ namespace QMLExtensions {
         void startService(const std::shared_ptr<Common::ServiceStartParams> &params);
         void stopService();
         void upgradeCacheStorage();
+        void compactCacheStorage();
+        void evictCacheStorage(qint64 maxSizeBytes);
+        void logStatistics() const;
+        void setThrottlingPolicy(Helpers::ThrottlingPolicy policy);
 
     public:
         const QSize &getDefaultSize() const { return m_DefaultSize; }
@@ -53,7 +57,11 @@ namespace QMLExtensions {
         void cacheImage(const QString &key, const QSize &requestedSize, bool recache=false);
         void cacheImage(const QString &key);
         void generatePreviews(const MetadataIO::ArtworksSnapshot &snapshot);
-        bool tryGetCachedImage(const QString &key, const QSize &requestedSize, QString &cached, bool &needsUpdate);
+        // visible artworks go first, then the ones about to be scrolled into view;
+        // previously prioritized artworks that are neither go back to the bulk queue
+        void prioritizePreviews(const MetadataIO::WeakArtworksSnapshot &visibleArtworks,
+                                const MetadataIO::WeakArtworksSnapshot &nextArtworks);
+        bool tryGetCachedImage(const QString &key, const QSize &requestedSize, QImage &image, bool &needsUpdate);
 
     private:
         void updateDefaultSize();
@@ -64,6 +72,10 @@ namespace QMLExtensions {
 
     private:
         ImageCachingWorker *m_CachingWorker;
+        // shared by image provider threads and the caching worker
+        DecodedImageCache m_DecodedImages;
+        // queue keys of the last viewport, accessed only from the UI thread
+        std::vector<quint64> m_PrioritizedKeys;
         QSize m_DefaultSize;
         volatile bool m_IsCancelled;
         qreal m_Scale;
@@ -14,34 +14,87 @@
 #include <QImage>
 #include <QString>
 #include <QFileInfo>
+#include <QImageReader>
+#include <QBuffer>
 #include <QByteArray>
 #include <QDataStream>
 #include <QReadLocker>
 #include <QWriteLocker>
-#include <QCryptographicHash>
+#include <QThread>
+#include <QStringList>
+#include <algorithm>
 #include "../Common/defines.h"
 #include "../Helpers/constants.h"
 #include "imagecacherequest.h"
 #include "../Helpers/asynccoordinator.h"
+#include "../Helpers/imagehelpers.h"
 #include "dbimagecacheindex.h"
+#include "decodedimagecache.h"
+#include "cacheeviction.h"
 
-#define IMAGE_CACHING_WORKER_SLEEP_DELAY 500
 #define IMAGES_INDEX_BACKUP_STEP 50
+#define THUMBNAILS_PACK_DIR "pack"
+// modification of originals is not checked on every request
+#define ORIGINAL_CHECK_INTERVAL_MS 30000
+// segments with less live data are rewritten
+#define COMPACTION_LIVE_PERCENT 50
+// segment with any evicted record is rewritten when pack is over the budget
+#define FORCED_COMPACTION_LIVE_PERCENT 100
+#define COMPACTION_PAGE_SIZE 500
+#define EVICTION_BATCH_SIZE 50
+#define EVICTION_BATCH_DELAY_MS 20
 #define PREVIEW_JPG_QUALITY 70
+// ~1 GB of decoded 32-bit pixels
+#define DECODE_BUDGET_MEGAPIXELS 256
+// used when image header cannot be read
+#define DEFAULT_DECODE_MEGAPIXELS 24
 
 namespace QMLExtensions {
-    QString getImagePathHash(const QString &path) {
-        return QString::fromLatin1(QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha256).toHex());
+    PackLocation getPackLocation(const CachedImage &cachedImage) {
+        PackLocation location;
+        location.m_SegmentID = cachedImage.m_PackSegmentID;
+        location.m_Offset = cachedImage.m_PackOffset;
+        location.m_Size = cachedImage.m_PackSize;
+        return location;
     }
 
-    ImageCachingWorker::ImageCachingWorker(Helpers::AsyncCoordinator *initCoordinator, Helpers::DatabaseManager *dbManager, QObject *parent):
+    PackLocation getPackLocation(const CachedImageLevel &level) {
+        PackLocation location;
+        location.m_SegmentID = level.m_PackSegmentID;
+        location.m_Offset = level.m_PackOffset;
+        location.m_Size = level.m_PackSize;
+        return location;
+    }
+
+    bool containsLevel(const QVector<CachedImageLevel> &levels, const QSize &size) {
+        return std::any_of(levels.begin(), levels.end(),
+                           [&size](const CachedImageLevel &level) { return level.m_Size == size; });
+    }
+
+    bool encodeThumbnail(const QImage &image, QByteArray &payload) {
+        QBuffer buffer(&payload);
+        buffer.open(QIODevice::WriteOnly);
+        // transparency of png and similar is preserved
+        const char *format = image.hasAlphaChannel() ? "PNG" : "JPG";
+        return image.save(&buffer, format, PREVIEW_JPG_QUALITY);
+    }
+
+    ImageCachingWorker::ImageCachingWorker(Helpers::AsyncCoordinator *initCoordinator, Helpers::DatabaseManager *dbManager,
+                                           DecodedImageCache *decodedImages, int workersCount, QObject *parent):
         QObject(parent),
-        ItemProcessingWorker(2),
+        ItemProcessingWorker(2, workersCount),
         m_InitCoordinator(initCoordinator),
+        m_DecodedImages(decodedImages),
         m_ProcessedItemsCount(0),
+        m_DecodeBudget(DECODE_BUDGET_MEGAPIXELS),
         m_Cache(dbManager),
         m_Scale(1.0)
     {
+        Q_ASSERT(decodedImages != nullptr);
+        // visible thumbnails use the interactive lane, so priority stays normal
+        // and only the UI lag slows caching down (default of imageCachingThrottling setting)
+        setThrottlingPolicy(Helpers::ThrottlingPolicy::Adaptive);
+        getTelemetry().setName("ImageCaching");
     }
 
     bool ImageCachingWorker::initWorker() {
@@ -50,7 +103,7 @@ namespace QMLExtensions {
         Helpers::AsyncCoordinatorUnlocker unlocker(m_InitCoordinator);
         Q_UNUSED(unlocker);
 
-        m_ProcessedItemsCount = 0;
+        m_ProcessedItemsCount.store(0);
         QString appDataPath = XPIKS_USERDATA_PATH;
 
         if (!appDataPath.isEmpty()) {
@@ -68,6 +121,7 @@ namespace QMLExtensions {
         LOG_INFO << "Using" << m_ImagesCacheDir << "for images cache";
 
         m_Cache.initialize();
+        m_Pack.initialize(QDir::cleanPath(m_ImagesCacheDir + QDir::separator() + THUMBNAILS_PACK_DIR));
 
         return true;
     }
@@ -76,14 +130,10 @@ namespace QMLExtensions {
         Q_UNUSED(batchID);
 
         if (getIsSeparatorFlag(flags)) {
+            // separator is processed only after all consumers are done with previous items
             saveIndex();
         } else {
             ItemProcessingWorker::processOneItemEx(item, batchID, flags);
-
-            if (getWithDelayFlag(flags)) {
-                // force context switch for more imporant tasks
-                QThread::msleep(IMAGE_CACHING_WORKER_SLEEP_DELAY);
-            }
         }
     }
 
@@ -96,6 +146,12 @@ namespace QMLExtensions {
         const QString &originalPath = item->getFilepath();
         QSize requestedSize = item->getRequestedSize();
 
+        // the same image is often requested by the grid and by generatePreviews()
+        if (!tryStartProcessing(originalPath)) {
+            LOG_FOR_DEBUG << originalPath << "is being processed by another consumer";
+            return;
+        }
+
         LOG_INFO << (item->getNeedRecache() ? "Recaching" : "Caching") << originalPath << "with size" << requestedSize;
 
         if (!requestedSize.isValid()) {
@@ -104,64 +160,95 @@ namespace QMLExtensions {
             requestedSize.setWidth(DEFAULT_THUMB_WIDTH * m_Scale);
         }
 
-        const bool isInResources = originalPath.startsWith(":/");
-
-        QImage img(originalPath);
-        if (img.isNull()) {
-            LOG_WARNING << "Image" << originalPath << "is null image";
-            return;
+        if (item->getIsQuickThumbnail()) {
+            if (cacheEmbeddedThumbnail(originalPath, requestedSize)) {
+                finishProcessing(originalPath);
+                // good quality thumbnail follows after all quick ones
+                item->setGoodQualityRequest();
+                // keyed so that it can still be moved up when the artwork scrolls into view
+                this->submitItem(item, Common::LaneBulk, item->getQueueKey());
+                return;
+            }
         }
 
-        QImage resizedImage = img.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        do {
+            const QVector<QSize> sizes = getPyramidSizes(QSize(DEFAULT_THUMB_WIDTH, DEFAULT_THUMB_HEIGHT), requestedSize);
+            // only bigger levels are added when the image is zoomed
+            QVector<CachedImageLevel> keptLevels;
+            getKeptLevels(originalPath, keptLevels);
 
-        QFileInfo fi(originalPath);
-        const QString suffix = isInResources ? "jpg" : fi.suffix();
-        QString pathHash = getImagePathHash(originalPath) + "." + suffix;
-        QString cachedFilepath = QDir::cleanPath(m_ImagesCacheDir + QDir::separator() + pathHash);
+            if (std::all_of(sizes.begin(), sizes.end(),
+                            [&keptLevels](const QSize &size) { return containsLevel(keptLevels, size); })) {
+                LOG_DEBUG << "All levels are cached already for" << originalPath;
+                break;
+            }
 
-        if (resizedImage.save(cachedFilepath, nullptr, PREVIEW_JPG_QUALITY)) {
-            CachedImage cachedImage;
-            cachedImage.m_Filename = pathHash;
-            cachedImage.m_LastModified = isInResources ? QDateTime::currentDateTime() : fi.lastModified();
-            cachedImage.m_Size = requestedSize;
+            // original is decoded only once for the largest level
+            QImage resizedImage = decodeAndScale(originalPath, sizes.last());
+            if (resizedImage.isNull()) {
+                LOG_WARNING << "Image" << originalPath << "is null image";
+                break;
+            }
 
-            m_Cache.update(originalPath, cachedImage);
+            QVector<QPair<QSize, QByteArray> > thumbnails;
+            thumbnails.reserve(sizes.size());
+            bool anyFault = false;
 
-            m_ProcessedItemsCount++;
-        } else {
-            LOG_WARNING << "Failed to save image. Path:" << cachedFilepath << "size" << requestedSize;
-        }
+            for (int i = sizes.size() - 1; i >= 0; --i) {
+                const QSize &size = sizes.at(i);
+                if (containsLevel(keptLevels, size)) { continue; }
 
-        if (m_ProcessedItemsCount % IMAGES_INDEX_BACKUP_STEP == 0) {
-            saveIndex();
-        }
+                // every level is scaled from the previous bigger one
+                resizedImage = resizedImage.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+                QByteArray payload;
+                if (!encodeThumbnail(resizedImage, payload)) {
+                    LOG_WARNING << "Failed to encode image" << originalPath << "size" << size;
+                    anyFault = true;
+                    break;
+                }
+
+                thumbnails.prepend(qMakePair(size, payload));
+            }
+
+            if (anyFault) { break; }
+
+            const bool isQuickThumbnail = false;
+            storeThumbnails(originalPath, thumbnails, isQuickThumbnail, keptLevels);
+        } while (false);
+
+        finishProcessing(originalPath);
     }
 
     void ImageCachingWorker::workerStopped() {
         LOG_DEBUG << "#";
+        m_Pack.finalize();
         m_Cache.finalize();
         emit stopped();
     }
 
     bool ImageCachingWorker::tryGetCachedImage(const QString &key, const QSize &requestedSize,
-                                               QString &cachedPath, bool &needsUpdate) {
-        bool found = false;
+                                               QImage &image, bool &needsUpdate) {
         CachedImage cachedImage;
+        CachedImageLevel level;
+        bool isUpToDate = false;
+        bool found = findCachedImage(key, requestedSize, cachedImage, level, isUpToDate);
 
-        if (m_Cache.tryGet(key, cachedImage)) {
-            QString cachedValue = QDir::cleanPath(m_ImagesCacheDir + QDir::separator() + cachedImage.m_Filename);
-
-            QFileInfo fi(cachedValue);
+        if (found) {
+            if (level.m_PackSegmentID >= 0) {
+                found = m_Pack.readImage(getPackLocation(level), image);
+            } else {
+                found = image.load(getLegacyFilepath(cachedImage));
+            }
+        }
 
-            if (fi.exists()) {
-                cachedImage.m_RequestsServed++;
-                cachedPath = cachedValue;
-                const bool isInResources = key.startsWith(":/");
-                const bool isOutdated = (!isInResources) && (QFileInfo(key).lastModified() > cachedImage.m_LastModified);
-                needsUpdate = isOutdated || (cachedImage.m_Size != requestedSize);
+        if (found && isUpToDate && (level.m_Size != requestedSize)) {
+            // downscaling in memory is much cheaper than decoding the original again
+            image = image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
 
-                found = true;
-            }
+        if (found) {
+            needsUpdate = !isUpToDate || cachedImage.m_IsQuickThumbnail;
         }
 
         return found;
@@ -211,7 +298,227 @@ namespace QMLExtensions {
         return migrated;
     }
 
+    bool ImageCachingWorker::compactCacheStorage() {
+        return compactSegments(COMPACTION_LIVE_PERCENT);
+    }
+
+    bool ImageCachingWorker::compactSegments(int livePercent) {
+        LOG_DEBUG << livePercent;
+        if (isCancelled()) { return false; }
+
+        // mappings that blocked removal before could be released by now
+        m_Pack.retryPendingRemovals();
+
+        // all locations have to be in the database for the scan
+        saveIndex();
+
+        const qint32 activeSegmentID = m_Pack.getActiveSegmentID();
+        QHash<qint32, qint64> liveBytes;
+
+        QString afterKey;
+        QVector<QPair<QString, CachedImage> > items;
+        while (!isCancelled() && (m_Cache.readPage(afterKey, COMPACTION_PAGE_SIZE, items) > 0)) {
+            for (auto &item: items) {
+                for (auto &level: item.second.getLevels()) {
+                    if (level.m_PackSegmentID >= 0) {
+                        liveBytes[level.m_PackSegmentID] += ThumbnailPack::getRecordSize(getPackLocation(level));
+                    }
+                }
+            }
+        }
+
+        QSet<qint32> sparseSegments;
+        for (qint32 segmentID: m_Pack.getSegmentIDs()) {
+            if (segmentID == activeSegmentID) { continue; }
+
+            const qint64 segmentSize = m_Pack.getSegmentSize(segmentID);
+            const qint64 segmentLiveBytes = liveBytes.value(segmentID, 0);
+            if (segmentLiveBytes * 100 < segmentSize * livePercent) {
+                LOG_INFO << "Segment" << segmentID << "has" << segmentLiveBytes << "live bytes of" << segmentSize;
+                sparseSegments.insert(segmentID);
+            }
+        }
+
+        if (sparseSegments.isEmpty() || isCancelled()) { return false; }
+
+        // live thumbnails are moved to the active segment
+        QSet<qint32> failedSegments;
+        int movedCount = 0;
+        afterKey.clear();
+        while (!isCancelled() && (m_Cache.readPage(afterKey, COMPACTION_PAGE_SIZE, items) > 0)) {
+            for (auto &item: items) {
+                QVector<CachedImageLevel> oldLevels = item.second.getLevels();
+                QVector<CachedImageLevel> newLevels = oldLevels;
+                bool anyMoved = false;
+
+                for (int i = 0; i < oldLevels.size(); ++i) {
+                    const PackLocation oldLocation = getPackLocation(oldLevels.at(i));
+                    if (!sparseSegments.contains(oldLocation.m_SegmentID)) { continue; }
+
+                    PackLocation newLocation;
+                    if (!m_Pack.relocate(oldLocation, newLocation)) {
+                        failedSegments.insert(oldLocation.m_SegmentID);
+                        continue;
+                    }
+
+                    CachedImageLevel &level = newLevels[i];
+                    level.m_PackSegmentID = newLocation.m_SegmentID;
+                    level.m_PackOffset = newLocation.m_Offset;
+                    level.m_PackSize = newLocation.m_Size;
+                    anyMoved = true;
+                }
+
+                if (!anyMoved) { continue; }
+
+                QMutexLocker locker(&m_IndexMutex);
+                Q_UNUSED(locker);
+
+                CachedImage cachedImage;
+                // thumbnail could have been regenerated meanwhile
+                if (m_Cache.tryGet(item.first, cachedImage) &&
+                        (cachedImage.m_PackSegmentID == oldLevels.first().m_PackSegmentID) &&
+                        (cachedImage.m_PackOffset == oldLevels.first().m_PackOffset)) {
+                    cachedImage.setLevels(newLevels);
+                    m_Cache.update(item.first, cachedImage);
+                    movedCount++;
+                }
+            }
+        }
+
+        if (isCancelled()) { return false; }
+
+        saveIndex();
+        LOG_INFO << "Moved" << movedCount << "thumbnail(s) from" << sparseSegments.size() << "segment(s)";
+
+        for (qint32 segmentID: sparseSegments) {
+            // thumbnails that failed to move are still referenced
+            if (failedSegments.contains(segmentID)) {
+                LOG_WARNING << "Keeping segment" << segmentID << "with thumbnails that were not moved";
+                continue;
+            }
+
+            m_Pack.removeSegment(segmentID);
+        }
+
+        return true;
+    }
+
+    bool ImageCachingWorker::evictCacheStorage(qint64 maxSizeBytes) {
+        LOG_DEBUG << maxSizeBytes;
+        if (isCancelled() || !isRunning()) { return false; }
+
+        // all locations and access times have to be in the database for the scan
+        saveIndex();
+
+        std::vector<EvictionCandidate> candidates;
+        QHash<QString, PackLocation> scannedLocations;
+        qint64 legacyBytes = 0;
+
+        QString afterKey;
+        QVector<QPair<QString, CachedImage> > items;
+        QVector<QString> keys;
+        QHash<QString, qint64> accessTimes;
+        while (!isCancelled() && (m_Cache.readPage(afterKey, COMPACTION_PAGE_SIZE, items) > 0)) {
+            keys.clear();
+            for (auto &item: items) { keys.append(item.first); }
+            m_Cache.readLastAccessTimes(keys, accessTimes);
+
+            for (auto &item: items) {
+                const CachedImage &cachedImage = item.second;
+                const PackLocation location = getPackLocation(cachedImage);
+                qint64 sizeBytes = 0;
+                if (location.isValid()) {
+                    for (auto &level: cachedImage.getLevels()) {
+                        sizeBytes += ThumbnailPack::getRecordSize(getPackLocation(level));
+                    }
+                } else {
+                    sizeBytes = QFileInfo(getLegacyFilepath(cachedImage)).size();
+                    legacyBytes += sizeBytes;
+                }
+
+                candidates.push_back(EvictionCandidate{item.first, sizeBytes,
+                                                       accessTimes.value(item.first, 0),
+                                                       cachedImage.m_RequestsServed});
+                scannedLocations.insert(item.first, location);
+            }
+        }
+
+        if (isCancelled()) { return false; }
+
+        std::vector<EvictionCandidate> victims;
+        const qint64 totalBytes = selectEvictionVictims(candidates, maxSizeBytes, victims);
+        LOG_INFO << candidates.size() << "thumbnail(s) use" << totalBytes << "bytes of" << maxSizeBytes;
+
+        int removedCount = 0;
+        const size_t size = victims.size();
+        for (size_t chunkStart = 0; (chunkStart < size) && !isCancelled(); chunkStart += EVICTION_BATCH_SIZE) {
+            const size_t chunkEnd = std::min(chunkStart + EVICTION_BATCH_SIZE, size);
+            QVector<QString> keysToRemove;
+            QStringList filesToRemove;
+
+            {
+                QMutexLocker locker(&m_IndexMutex);
+                Q_UNUSED(locker);
+
+                for (size_t i = chunkStart; i < chunkEnd; ++i) {
+                    const QString &key = victims[i].m_Key;
+                    const PackLocation scannedLocation = scannedLocations.value(key);
+
+                    CachedImage cachedImage;
+                    if (!m_Cache.tryGet(key, cachedImage)) { continue; }
+
+                    // thumbnail could have been regenerated meanwhile
+                    const PackLocation location = getPackLocation(cachedImage);
+                    if ((location.m_SegmentID != scannedLocation.m_SegmentID) ||
+                            (location.m_Offset != scannedLocation.m_Offset)) { continue; }
+
+                    keysToRemove.append(key);
+                    if (!location.isValid()) {
+                        filesToRemove.append(getLegacyFilepath(cachedImage));
+                        legacyBytes -= victims[i].m_SizeBytes;
+                    }
+                }
+
+                removedCount += m_Cache.remove(keysToRemove);
+            }
+
+            for (auto &key: keysToRemove) {
+                m_DecodedImages->invalidate(key);
+            }
+
+            // packed thumbnails are reclaimed by the compaction
+            for (auto &filepath: filesToRemove) {
+                if (!QFile::remove(filepath)) {
+                    LOG_WARNING << "Failed to remove" << filepath;
+                }
+            }
+
+            // do not compete with the UI for the disk
+            QThread::msleep(EVICTION_BATCH_DELAY_MS);
+        }
+
+        LOG_INFO << "Evicted" << removedCount << "thumbnail(s)";
+        if (isCancelled()) { return removedCount > 0; }
+
+        // removed records keep their space in segments until these are rewritten,
+        // so the budget is checked against the size of the files on disk
+        bool compacted = false;
+        const qint64 diskBytes = m_Pack.getTotalSize() + legacyBytes;
+        if (diskBytes > maxSizeBytes) {
+            LOG_INFO << "Thumbnails take" << diskBytes << "bytes on disk, compacting";
+            compacted = compactSegments(FORCED_COMPACTION_LIVE_PERCENT);
+        }
+
+        return (removedCount > 0) || compacted;
+    }
+
+    QString ImageCachingWorker::getLegacyFilepath(const CachedImage &cachedImage) const {
+        return QDir::cleanPath(m_ImagesCacheDir + QDir::separator() + cachedImage.m_Filename);
+    }
+
     void ImageCachingWorker::saveIndex() {
+        QMutexLocker locker(&m_IndexMutex);
+        Q_UNUSED(locker);
         m_Cache.sync();
     }
 
@@ -223,12 +530,249 @@ namespace QMLExtensions {
 
         bool isAlreadyProcessed = false;
 
-        QString cachedPath;
-        bool needsUpdate = false;
-        if (this->tryGetCachedImage(originalPath, requestedSize, cachedPath, needsUpdate)) {
-            isAlreadyProcessed = !needsUpdate;
+        CachedImage cachedImage;
+        CachedImageLevel level;
+        bool isUpToDate = false;
+        if (findCachedImage(originalPath, requestedSize, cachedImage, level, isUpToDate)) {
+            if (cachedImage.m_IsQuickThumbnail && item->getIsQuickThumbnail() &&
+                    !isOriginalModified(originalPath, cachedImage.m_LastModified)) {
+                // quick pass was done before, only good quality is missing
+                // (embedded thumbnail can be smaller than the requested size)
+                item->setGoodQualityRequest();
+            } else {
+                isAlreadyProcessed = isUpToDate && !cachedImage.m_IsQuickThumbnail;
+            }
         }
 
         return isAlreadyProcessed;
     }
+
+    bool ImageCachingWorker::findCachedImage(const QString &key, const QSize &requestedSize,
+                                             CachedImage &cachedImage, CachedImageLevel &level, bool &isUpToDate) {
+        bool found = false;
+
+        if (m_Cache.tryGet(key, cachedImage)) {
+            if (cachedImage.m_PackSegmentID >= 0) {
+                // no filesystem access for packed thumbnails
+                found = m_Pack.contains(getPackLocation(cachedImage));
+            } else {
+                found = QFileInfo(getLegacyFilepath(cachedImage)).exists();
+            }
+
+            if (found) {
+                m_Cache.touch(key);
+                cachedImage.m_RequestsServed++;
+                const bool isOutdated = isOriginalModified(key, cachedImage.m_LastModified);
+                const bool hasLevel = cachedImage.findLevel(requestedSize, level);
+                if (!hasLevel) {
+                    // smaller one is still better than nothing
+                    level = cachedImage.getLevels().last();
+                }
+
+                isUpToDate = !isOutdated && hasLevel;
+            }
+        }
+
+        return found;
+    }
+
+    bool ImageCachingWorker::isOriginalModified(const QString &key, const QDateTime &cachedLastModified) {
+        const bool isInResources = key.startsWith(":/");
+        if (isInResources) { return false; }
+
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        QDateTime lastModified;
+
+        {
+            QMutexLocker locker(&m_ModificationChecksMutex);
+            Q_UNUSED(locker);
+
+            auto it = m_ModificationChecks.constFind(key);
+            if ((it != m_ModificationChecks.constEnd()) &&
+                    (now - it->m_CheckedAt < ORIGINAL_CHECK_INTERVAL_MS)) {
+                lastModified = it->m_LastModified;
+            }
+        }
+
+        if (!lastModified.isValid()) {
+            lastModified = QFileInfo(key).lastModified();
+
+            QMutexLocker locker(&m_ModificationChecksMutex);
+            Q_UNUSED(locker);
+            m_ModificationChecks.insert(key, ModificationCheck{now, lastModified});
+        }
+
+        return lastModified > cachedLastModified;
+    }
+
+    bool ImageCachingWorker::cacheEmbeddedThumbnail(const QString &originalPath, const QSize &requestedSize) {
+        QByteArray jpegData;
+        int orientation = 1;
+        if (!Helpers::readEmbeddedThumbnail(originalPath, jpegData, orientation)) { return false; }
+
+        QSize thumbnailSize;
+        {
+            QBuffer buffer(&jpegData);
+            QImageReader reader(&buffer, "jpg");
+            thumbnailSize = reader.size();
+        }
+
+        if (!Helpers::isEmbeddedThumbnailEnough(thumbnailSize, requestedSize)) {
+            LOG_DEBUG << "Embedded thumbnail is too small in" << originalPath;
+            return false;
+        }
+
+        if (orientation != 1) {
+            // thumbnail is stored unrotated same as the main image
+            QImage thumbnail = Helpers::applyExifOrientation(QImage::fromData(jpegData, "JPG"), orientation);
+            QByteArray orientedData;
+            if (thumbnail.isNull() || !encodeThumbnail(thumbnail, orientedData)) {
+                LOG_WARNING << "Failed to rotate embedded thumbnail of" << originalPath;
+                return false;
+            }
+
+            thumbnailSize = thumbnail.size();
+            jpegData.swap(orientedData);
+        }
+
+        // actual size so that the level is never used for bigger requests
+        const bool isQuickThumbnail = true;
+        QVector<QPair<QSize, QByteArray> > thumbnails;
+        thumbnails.append(qMakePair(thumbnailSize, jpegData));
+        const bool success = storeThumbnails(originalPath, thumbnails, isQuickThumbnail, QVector<CachedImageLevel>());
+        if (success) {
+            LOG_INFO << "Cached embedded thumbnail of" << originalPath;
+        }
+
+        return success;
+    }
+
+    void ImageCachingWorker::getKeptLevels(const QString &originalPath, QVector<CachedImageLevel> &levels) {
+        CachedImage cachedImage;
+        if (!m_Cache.tryGet(originalPath, cachedImage)) { return; }
+        if (cachedImage.m_IsQuickThumbnail) { return; }
+        if (cachedImage.m_PackSegmentID < 0) { return; }
+
+        // not using the throttled check since the original is decoded anyway
+        const bool isInResources = originalPath.startsWith(":/");
+        if (!isInResources && (QFileInfo(originalPath).lastModified() > cachedImage.m_LastModified)) { return; }
+
+        for (auto &level: cachedImage.getLevels()) {
+            if (m_Pack.contains(getPackLocation(level))) {
+                levels.append(level);
+            }
+        }
+    }
+
+    bool ImageCachingWorker::storeThumbnails(const QString &originalPath, const QVector<QPair<QSize, QByteArray> > &thumbnails,
+                                             bool isQuickThumbnail, const QVector<CachedImageLevel> &keptLevels) {
+        Q_ASSERT(!thumbnails.isEmpty());
+        QVector<CachedImageLevel> levels = keptLevels;
+        levels.reserve(keptLevels.size() + thumbnails.size());
+
+        for (auto &thumbnail: thumbnails) {
+            PackLocation location;
+            if (!m_Pack.append(thumbnail.second, location)) {
+                LOG_WARNING << "Failed to store thumbnail of" << originalPath << "size" << thumbnail.first;
+                return false;
+            }
+
+            CachedImageLevel level;
+            level.m_Size = thumbnail.first;
+            level.m_PackSegmentID = location.m_SegmentID;
+            level.m_PackOffset = location.m_Offset;
+            level.m_PackSize = location.m_Size;
+            levels.append(level);
+        }
+
+        std::sort(levels.begin(), levels.end(),
+                  [](const CachedImageLevel &a, const CachedImageLevel &b) {
+            return a.m_Size.width() * a.m_Size.height() < b.m_Size.width() * b.m_Size.height();
+        });
+
+        const bool isInResources = originalPath.startsWith(":/");
+
+        CachedImage cachedImage;
+        cachedImage.m_LastModified = isInResources ? QDateTime::currentDateTime() : QFileInfo(originalPath).lastModified();
+        cachedImage.m_IsQuickThumbnail = isQuickThumbnail;
+        cachedImage.setLevels(levels);
+
+        {
+            QMutexLocker locker(&m_ModificationChecksMutex);
+            Q_UNUSED(locker);
+            m_ModificationChecks.remove(originalPath);
+        }
+
+        updateIndex(originalPath, cachedImage);
+        m_Cache.touch(originalPath);
+        // previous thumbnail could have been decoded already
+        m_DecodedImages->invalidate(originalPath);
+
+        return true;
+    }
+
+    void ImageCachingWorker::updateIndex(const QString &originalPath, CachedImage &cachedImage) {
+        QString legacyFilepath;
+
+        {
+            QMutexLocker locker(&m_IndexMutex);
+            Q_UNUSED(locker);
+
+            CachedImage previousImage;
+            if (m_Cache.tryGet(originalPath, previousImage) &&
+                    !getPackLocation(previousImage).isValid() &&
+                    !previousImage.m_Filename.isEmpty()) {
+                legacyFilepath = getLegacyFilepath(previousImage);
+            }
+
+            m_Cache.update(originalPath, cachedImage);
+        }
+
+        // thumbnail from before the pack is not referenced anymore
+        if (!legacyFilepath.isEmpty() && QFileInfo(legacyFilepath).exists()) {
+            if (!QFile::remove(legacyFilepath)) {
+                LOG_WARNING << "Failed to remove" << legacyFilepath;
+            }
+        }
+
+        const int processedCount = m_ProcessedItemsCount.fetchAndAddOrdered(1) + 1;
+        if (processedCount % IMAGES_INDEX_BACKUP_STEP == 0) {
+            saveIndex();
+        }
+    }
+
+    bool ImageCachingWorker::tryStartProcessing(const QString &originalPath) {
+        QMutexLocker locker(&m_InProgressMutex);
+        Q_UNUSED(locker);
+
+        if (m_InProgress.contains(originalPath)) { return false; }
+
+        m_InProgress.insert(originalPath);
+        return true;
+    }
+
+    void ImageCachingWorker::finishProcessing(const QString &originalPath) {
+        QMutexLocker locker(&m_InProgressMutex);
+        Q_UNUSED(locker);
+        m_InProgress.remove(originalPath);
+    }
+
+    QImage ImageCachingWorker::decodeAndScale(const QString &originalPath, const QSize &requestedSize) {
+        QImageReader reader(originalPath);
+
+        // only the header is read here
+        const QSize decodeSize = Helpers::getDecodeSize(reader, requestedSize);
+        const int megapixels = decodeSize.isValid() ?
+                    (int)(((qint64)decodeSize.width() * decodeSize.height() + 999999) / 1000000) :
+                    DEFAULT_DECODE_MEGAPIXELS;
+        const int decodeCost = qBound(1, megapixels, DECODE_BUDGET_MEGAPIXELS);
+
+        // formats without downscaled decoding are still read in full size
+        // and there should not be one such image per consumer in memory
+        m_DecodeBudget.acquire(decodeCost);
+        QImage resizedImage = Helpers::readScaledImage(reader, requestedSize);
+        m_DecodeBudget.release(decodeCost);
+
+        return resizedImage;
+    }
 }
@@ -13,9 +13,19 @@
 
 #include "../Common/itemprocessingworker.h"
 #include <QString>
+#include <QMutex>
+#include <QSemaphore>
+#include <QSet>
+#include <QAtomicInt>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QByteArray>
+#include <QDateTime>
 #include "imagecacherequest.h"
 #include "cachedimage.h"
 #include "dbimagecacheindex.h"
+#include "thumbnailpack.h"
 
 namespace Helpers {
     class AsyncCoordinator;
@@ -23,11 +33,14 @@ namespace Helpers {
 }
 
 namespace QMLExtensions {
+    class DecodedImageCache;
+
     class ImageCachingWorker : public QObject, public Common::ItemProcessingWorker<ImageCacheRequest>
     {
         Q_OBJECT
     public:
-        ImageCachingWorker(Helpers::AsyncCoordinator *initCoordinator, Helpers::DatabaseManager *dbManager, QObject *parent=0);
+        ImageCachingWorker(Helpers::AsyncCoordinator *initCoordinator, Helpers::DatabaseManager *dbManager,
+                           DecodedImageCache *decodedImages, int workersCount, QObject *parent=0);
 
     protected:
         virtual bool initWorker() override;
@@ -49,17 +62,53 @@ namespace QMLExtensions {
     public:
         void setScale(qreal scale) { m_Scale = scale; }
         bool tryGetCachedImage(const QString &key, const QSize &requestedSize,
-                               QString &cached, bool &needsUpdate);
+                               QImage &image, bool &needsUpdate);
         bool upgradeCacheStorage();
+        // moves live thumbnails out of mostly overwritten segments
+        bool compactCacheStorage();
+        // removes least recently served thumbnails until they fit the budget
+        bool evictCacheStorage(qint64 maxSizeBytes);
 
     private:
+        // segments with less than livePercent of live records are rewritten
+        bool compactSegments(int livePercent);
         void saveIndex();
         bool isProcessed(std::shared_ptr<ImageCacheRequest> &item);
+        bool findCachedImage(const QString &key, const QSize &requestedSize,
+                             CachedImage &cachedImage, CachedImageLevel &level, bool &isUpToDate);
+        bool isOriginalModified(const QString &key, const QDateTime &cachedLastModified);
+        bool cacheEmbeddedThumbnail(const QString &originalPath, const QSize &requestedSize);
+        // levels of up to date thumbnail that do not have to be generated again
+        void getKeptLevels(const QString &originalPath, QVector<CachedImageLevel> &levels);
+        // sizes with encoded thumbnails ordered from the smallest
+        bool storeThumbnails(const QString &originalPath, const QVector<QPair<QSize, QByteArray> > &thumbnails,
+                             bool isQuickThumbnail, const QVector<CachedImageLevel> &keptLevels);
+        QString getLegacyFilepath(const CachedImage &cachedImage) const;
+        void updateIndex(const QString &originalPath, CachedImage &cachedImage);
+        bool tryStartProcessing(const QString &originalPath);
+        void finishProcessing(const QString &originalPath);
+        QImage decodeAndScale(const QString &originalPath, const QSize &requestedSize);
+
+    private:
+        struct ModificationCheck {
+            qint64 m_CheckedAt;
+            QDateTime m_LastModified;
+        };
 
     private:
         Helpers::AsyncCoordinator *m_InitCoordinator;
-        volatile int m_ProcessedItemsCount;
+        DecodedImageCache *m_DecodedImages;
+        QAtomicInt m_ProcessedItemsCount;
+        // all consumers share the index, updates and syncs go one at a time
+        QMutex m_IndexMutex;
+        QMutex m_InProgressMutex;
+        QSet<QString> m_InProgress;
+        // megapixels of full size images decoded at the same time
+        QSemaphore m_DecodeBudget;
+        QMutex m_ModificationChecksMutex;
+        QHash<QString, ModificationCheck> m_ModificationChecks;
         DbImageCacheIndex m_Cache;
+        ThumbnailPack m_Pack;
         qreal m_Scale;
         QString m_ImagesCacheDir;
     };
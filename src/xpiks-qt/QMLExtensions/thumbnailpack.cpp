@@ -0,0 +1,370 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "thumbnailpack.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+#include <cstring>
+#include "../Common/defines.h"
+
+// "XPTH" in little endian
+#define RECORD_MAGIC 0x48545058
+#define RECORD_HEADER_SIZE 8
+#define SEGMENT_PREFIX "segment_"
+#define SEGMENT_EXTENSION ".xpt"
+
+namespace QMLExtensions {
+    ThumbnailPack::SegmentMapping::~SegmentMapping() {
+        if (m_Data != nullptr) {
+            m_File.unmap(m_Data);
+        }
+
+        m_File.close();
+    }
+
+    ThumbnailPack::ThumbnailPack(qint64 maxSegmentSize):
+        m_MaxSegmentSize(maxSegmentSize),
+        m_ActiveSegmentID(-1)
+    {
+        Q_ASSERT(maxSegmentSize > RECORD_HEADER_SIZE);
+    }
+
+    bool ThumbnailPack::initialize(const QString &packDirPath) {
+        LOG_DEBUG << packDirPath;
+
+        m_PackDirPath = packDirPath;
+        QDir packDir(packDirPath);
+        if (!packDir.exists()) {
+            LOG_INFO << "Creating pack dir" << packDirPath;
+            QDir().mkpath(packDirPath);
+        }
+
+        const QString pattern = QLatin1String(SEGMENT_PREFIX "*" SEGMENT_EXTENSION);
+        QFileInfoList segmentFiles = packDir.entryInfoList(QStringList() << pattern, QDir::Files);
+
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+
+        qint32 lastSegmentID = -1;
+        for (auto &fi: segmentFiles) {
+            bool ok = false;
+            const qint32 segmentID = fi.completeBaseName().mid((int)strlen(SEGMENT_PREFIX)).toInt(&ok);
+            if (!ok || (segmentID < 0)) {
+                LOG_WARNING << "Unexpected file in pack dir:" << fi.fileName();
+                continue;
+            }
+
+            Segment segment;
+            segment.m_ID = segmentID;
+            segment.m_Size = fi.size();
+            segment.m_Filepath = fi.absoluteFilePath();
+            m_Segments.insert(segmentID, segment);
+
+            lastSegmentID = qMax(lastSegmentID, segmentID);
+        }
+
+        LOG_INFO << "Found" << m_Segments.size() << "thumbnail segment(s)";
+
+        qint32 activeSegmentID = lastSegmentID;
+        if ((activeSegmentID == -1) || (m_Segments[activeSegmentID].m_Size >= m_MaxSegmentSize)) {
+            activeSegmentID++;
+        }
+
+        return openActiveSegmentUnsafe(activeSegmentID);
+    }
+
+    void ThumbnailPack::finalize() {
+        LOG_DEBUG << "#";
+
+        QMutexLocker appendLocker(&m_AppendMutex);
+        Q_UNUSED(appendLocker);
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+
+        m_ActiveFile.close();
+        m_ActiveSegmentID = -1;
+        m_Segments.clear();
+
+        // files are found again by the next initialize() and compacted
+        m_PendingRemovals.clear();
+    }
+
+    bool ThumbnailPack::append(const QByteArray &payload, PackLocation &location) {
+        Q_ASSERT(!payload.isEmpty());
+
+        QMutexLocker appendLocker(&m_AppendMutex);
+        Q_UNUSED(appendLocker);
+
+        if (!m_ActiveFile.isOpen()) { return false; }
+
+        const qint64 recordSize = RECORD_HEADER_SIZE + payload.size();
+        qint64 offset = m_ActiveFile.size();
+
+        // record bigger than a segment still gets an empty one
+        if ((offset > 0) && (offset + recordSize > m_MaxSegmentSize)) {
+            QMutexLocker locker(&m_SegmentsMutex);
+            Q_UNUSED(locker);
+
+            m_ActiveFile.close();
+            if (!openActiveSegmentUnsafe(m_ActiveSegmentID + 1)) { return false; }
+            offset = 0;
+        }
+
+        uchar header[RECORD_HEADER_SIZE];
+        qToLittleEndian<quint32>(RECORD_MAGIC, header);
+        qToLittleEndian<quint32>((quint32)payload.size(), header + 4);
+
+        const bool success = (m_ActiveFile.write((const char *)header, RECORD_HEADER_SIZE) == RECORD_HEADER_SIZE) &&
+                (m_ActiveFile.write(payload) == payload.size()) &&
+                m_ActiveFile.flush();
+
+        if (!success) {
+            LOG_WARNING << "Failed to append to" << m_ActiveFile.fileName() << m_ActiveFile.errorString();
+            // partial record is skipped by offsets of the following ones
+            return false;
+        }
+
+        location.m_SegmentID = m_ActiveSegmentID;
+        location.m_Offset = (quint32)(offset + RECORD_HEADER_SIZE);
+        location.m_Size = (quint32)payload.size();
+
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+        m_Segments[m_ActiveSegmentID].m_Size = m_ActiveFile.size();
+
+        return true;
+    }
+
+    bool ThumbnailPack::readImage(const PackLocation &location, QImage &image) {
+        std::shared_ptr<SegmentMapping> mapping = getMapping(location);
+        if (!mapping) { return false; }
+
+        // decoded straight from the mapped memory, format is detected from data
+        const uchar *payload = mapping->m_Data + location.m_Offset;
+        return image.loadFromData(payload, (int)location.m_Size);
+    }
+
+    bool ThumbnailPack::readPayload(const PackLocation &location, QByteArray &payload) {
+        std::shared_ptr<SegmentMapping> mapping = getMapping(location);
+        if (!mapping) { return false; }
+
+        payload = QByteArray((const char *)mapping->m_Data + location.m_Offset, (int)location.m_Size);
+        return true;
+    }
+
+    bool ThumbnailPack::relocate(const PackLocation &from, PackLocation &to) {
+        QByteArray payload;
+        if (!readPayload(from, payload)) {
+            LOG_WARNING << "Failed to read record from segment" << from.m_SegmentID << "at" << from.m_Offset;
+            return false;
+        }
+
+        return append(payload, to);
+    }
+
+    bool ThumbnailPack::contains(const PackLocation &location) {
+        if (!location.isValid()) { return false; }
+
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+
+        auto it = m_Segments.constFind(location.m_SegmentID);
+        if (it == m_Segments.constEnd()) { return false; }
+
+        return ((qint64)location.m_Offset + location.m_Size) <= it->m_Size;
+    }
+
+    qint64 ThumbnailPack::getRecordSize(const PackLocation &location) {
+        return RECORD_HEADER_SIZE + (qint64)location.m_Size;
+    }
+
+    std::vector<qint32> ThumbnailPack::getSegmentIDs() {
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+
+        std::vector<qint32> segmentIDs;
+        segmentIDs.reserve(m_Segments.size());
+        for (auto it = m_Segments.constBegin(); it != m_Segments.constEnd(); ++it) {
+            segmentIDs.push_back(it.key());
+        }
+
+        return segmentIDs;
+    }
+
+    qint64 ThumbnailPack::getSegmentSize(qint32 segmentID) {
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+
+        auto it = m_Segments.constFind(segmentID);
+        return (it != m_Segments.constEnd()) ? it->m_Size : 0;
+    }
+
+    qint64 ThumbnailPack::getTotalSize() {
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+
+        qint64 totalSize = 0;
+        for (auto it = m_Segments.constBegin(); it != m_Segments.constEnd(); ++it) {
+            totalSize += it->m_Size;
+        }
+
+        return totalSize;
+    }
+
+    qint32 ThumbnailPack::getActiveSegmentID() {
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+        return m_ActiveSegmentID;
+    }
+
+    bool ThumbnailPack::removeSegment(qint32 segmentID) {
+        LOG_INFO << segmentID;
+        QString filepath;
+
+        {
+            QMutexLocker locker(&m_SegmentsMutex);
+            Q_UNUSED(locker);
+
+            if (segmentID == m_ActiveSegmentID) { return false; }
+
+            auto it = m_Segments.find(segmentID);
+            if (it == m_Segments.end()) { return false; }
+
+            filepath = it->m_Filepath;
+            // readers in progress keep their own mapping
+            m_Segments.erase(it);
+        }
+
+        const bool removed = QFile::remove(filepath);
+        if (!removed) {
+            // mapped files cannot be removed on some platforms, next compaction will retry
+            LOG_WARNING << "Failed to remove segment" << filepath;
+
+            QMutexLocker locker(&m_SegmentsMutex);
+            Q_UNUSED(locker);
+            m_PendingRemovals.insert(segmentID, filepath);
+        }
+
+        return removed;
+    }
+
+    int ThumbnailPack::retryPendingRemovals() {
+        QHash<qint32, QString> pendingRemovals;
+
+        {
+            QMutexLocker locker(&m_SegmentsMutex);
+            Q_UNUSED(locker);
+            pendingRemovals.swap(m_PendingRemovals);
+        }
+
+        if (pendingRemovals.isEmpty()) { return 0; }
+        LOG_INFO << pendingRemovals.size() << "segment(s) to remove";
+
+        int removedCount = 0;
+        QHash<qint32, QString> failedRemovals;
+        for (auto it = pendingRemovals.constBegin(); it != pendingRemovals.constEnd(); ++it) {
+            // could have been deleted by somebody else
+            if (QFile::remove(it.value()) || !QFile::exists(it.value())) {
+                removedCount++;
+            } else {
+                LOG_WARNING << "Failed to remove segment" << it.value();
+                failedRemovals.insert(it.key(), it.value());
+            }
+        }
+
+        if (!failedRemovals.isEmpty()) {
+            QMutexLocker locker(&m_SegmentsMutex);
+            Q_UNUSED(locker);
+            m_PendingRemovals.unite(failedRemovals);
+        }
+
+        return removedCount;
+    }
+
+    int ThumbnailPack::getPendingRemovalsCount() {
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+        return m_PendingRemovals.size();
+    }
+
+    bool ThumbnailPack::openActiveSegmentUnsafe(qint32 segmentID) {
+        Q_ASSERT(!m_ActiveFile.isOpen());
+
+        const QString filepath = getSegmentPath(segmentID);
+        m_ActiveFile.setFileName(filepath);
+        if (!m_ActiveFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            LOG_WARNING << "Failed to open segment" << filepath << m_ActiveFile.errorString();
+            return false;
+        }
+
+        Segment &segment = m_Segments[segmentID];
+        segment.m_ID = segmentID;
+        segment.m_Filepath = filepath;
+        segment.m_Size = m_ActiveFile.size();
+
+        m_ActiveSegmentID = segmentID;
+        LOG_INFO << "Appending thumbnails to" << filepath;
+
+        return true;
+    }
+
+    std::shared_ptr<ThumbnailPack::SegmentMapping> ThumbnailPack::getMapping(const PackLocation &location) {
+        if (!location.isValid()) { return std::shared_ptr<SegmentMapping>(); }
+
+        QMutexLocker locker(&m_SegmentsMutex);
+        Q_UNUSED(locker);
+
+        auto it = m_Segments.find(location.m_SegmentID);
+        if (it == m_Segments.end()) { return std::shared_ptr<SegmentMapping>(); }
+
+        Segment &segment = it.value();
+        const qint64 recordEnd = (qint64)location.m_Offset + location.m_Size;
+        if ((location.m_Offset < RECORD_HEADER_SIZE) || (recordEnd > segment.m_Size)) {
+            LOG_WARNING << "Location is out of segment" << location.m_SegmentID;
+            return std::shared_ptr<SegmentMapping>();
+        }
+
+        // segment grew since it was mapped
+        if (!segment.m_Mapping || (segment.m_Mapping->m_Size < recordEnd)) {
+            std::shared_ptr<SegmentMapping> mapping(new SegmentMapping());
+            mapping->m_File.setFileName(segment.m_Filepath);
+
+            if (!mapping->m_File.open(QIODevice::ReadOnly)) {
+                LOG_WARNING << "Failed to open segment" << segment.m_Filepath;
+                return std::shared_ptr<SegmentMapping>();
+            }
+
+            mapping->m_Size = segment.m_Size;
+            mapping->m_Data = mapping->m_File.map(0, mapping->m_Size);
+            if (mapping->m_Data == nullptr) {
+                LOG_WARNING << "Failed to map segment" << segment.m_Filepath << mapping->m_File.errorString();
+                return std::shared_ptr<SegmentMapping>();
+            }
+
+            segment.m_Mapping = mapping;
+        }
+
+        std::shared_ptr<SegmentMapping> mapping = segment.m_Mapping;
+        const uchar *header = mapping->m_Data + location.m_Offset - RECORD_HEADER_SIZE;
+        if ((qFromLittleEndian<quint32>(header) != RECORD_MAGIC) ||
+                (qFromLittleEndian<quint32>(header + 4) != location.m_Size)) {
+            LOG_WARNING << "Corrupted record in segment" << location.m_SegmentID << "at" << location.m_Offset;
+            return std::shared_ptr<SegmentMapping>();
+        }
+
+        return mapping;
+    }
+
+    QString ThumbnailPack::getSegmentPath(qint32 segmentID) const {
+        const QString filename = QString(QLatin1String(SEGMENT_PREFIX "%1" SEGMENT_EXTENSION)).arg(segmentID, 6, 10, QLatin1Char('0'));
+        return QDir::cleanPath(m_PackDirPath + QDir::separator() + filename);
+    }
+}
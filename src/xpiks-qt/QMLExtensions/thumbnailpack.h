@@ -0,0 +1,111 @@
+/*
+ * This file is a part of Xpiks - cross platform application for
+ * keywording and uploading images for microstocks
+ * Copyright (C) 2014-2017 Taras Kushnir <kushnirTV@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef THUMBNAILPACK_H
+#define THUMBNAILPACK_H
+
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+#include <QHash>
+#include <QFile>
+#include <QMutex>
+#include <memory>
+#include <vector>
+
+#define THUMBNAIL_PACK_SEGMENT_SIZE (64*1024*1024)
+
+namespace QMLExtensions {
+    struct PackLocation {
+        PackLocation():
+            m_SegmentID(-1),
+            m_Offset(0),
+            m_Size(0)
+        { }
+
+        bool isValid() const { return m_SegmentID >= 0; }
+
+        qint32 m_SegmentID;
+        quint32 m_Offset;
+        quint32 m_Size;
+    };
+
+    // Thumbnails are appended to segment files of limited size
+    // and read back from memory mapped segments.
+    // Every record is a small header followed by jpeg payload.
+    // Location of every record is kept in the images cache index.
+    class ThumbnailPack
+    {
+    private:
+        // read-only view of a segment, replaced when segment grows
+        struct SegmentMapping {
+            SegmentMapping(): m_Data(nullptr), m_Size(0) { }
+            ~SegmentMapping();
+
+            QFile m_File;
+            uchar *m_Data;
+            qint64 m_Size;
+        };
+
+        struct Segment {
+            Segment(): m_ID(-1), m_Size(0) { }
+
+            qint32 m_ID;
+            qint64 m_Size;
+            QString m_Filepath;
+            std::shared_ptr<SegmentMapping> m_Mapping;
+        };
+
+    public:
+        ThumbnailPack(qint64 maxSegmentSize = THUMBNAIL_PACK_SEGMENT_SIZE);
+
+    public:
+        bool initialize(const QString &packDirPath);
+        void finalize();
+
+    public:
+        bool append(const QByteArray &payload, PackLocation &location);
+        bool readImage(const PackLocation &location, QImage &image);
+        bool readPayload(const PackLocation &location, QByteArray &payload);
+        // copies the record to the active segment
+        bool relocate(const PackLocation &from, PackLocation &to);
+        bool contains(const PackLocation &location);
+        static qint64 getRecordSize(const PackLocation &location);
+
+    public:
+        std::vector<qint32> getSegmentIDs();
+        qint64 getSegmentSize(qint32 segmentID);
+        // disk space used by all segments including overwritten records
+        qint64 getTotalSize();
+        qint32 getActiveSegmentID();
+        bool removeSegment(qint32 segmentID);
+        // segments that could not be deleted before (e.g. still mapped elsewhere)
+        int retryPendingRemovals();
+        int getPendingRemovalsCount();
+
+    private:
+        bool openActiveSegmentUnsafe(qint32 segmentID);
+        std::shared_ptr<SegmentMapping> getMapping(const PackLocation &location);
+        QString getSegmentPath(qint32 segmentID) const;
+
+    private:
+        QMutex m_SegmentsMutex;
+        QMutex m_AppendMutex;
+        QHash<qint32, Segment> m_Segments;
+        // segments removed from the pack which files are still on disk
+        QHash<qint32, QString> m_PendingRemovals;
+        QFile m_ActiveFile;
+        QString m_PackDirPath;
+        qint64 m_MaxSegmentSize;
+        qint32 m_ActiveSegmentID;
+    };
+}
+
+#endif // THUMBNAILPACK_H
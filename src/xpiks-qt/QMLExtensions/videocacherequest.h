@@ -66,6 +66,7 @@ namespace QMLExtensions {
         void repeatRequestOnce() { if (!isRepeated()) { setRepeatRequest(); } }
         void setRepeatRequest() { Common::ApplyFlag(m_Flags, true, RepeatRequestFlag); }
         void setGoodQualityRequest() { Common::ApplyFlag(m_Flags, false, QuickThumbnailFlag); }
+        void setWithDelay(bool value) { Common::ApplyFlag(m_Flags, value, WithDelayFlag); }
         void setThumbnailPath(const QString &path) { m_VideoArtwork->setThumbnailPath(path); }
         void setVideoMetadata(const libthmbnlr::VideoFileMetadata &metadata) { m_VideoArtwork->setVideoMetadata(metadata); }
         Models::VideoArtwork *getArtwork() { return m_VideoArtwork; }
@@ -17,6 +17,10 @@
 #include "../Commands/commandmanager.h"
 #include "../Models/switchermodel.h"
 #include "../Common/defines.h"
+#include "../Helpers/threadhelpers.h"
+
+// every consumer decodes a whole video frame
+#define VIDEO_CACHING_MAX_WORKERS_COUNT 3
 
 namespace QMLExtensions {
     VideoCachingService::VideoCachingService(QObject *parent) :
@@ -30,7 +34,8 @@ namespace QMLExtensions {
     void VideoCachingService::startService() {
         Helpers::DatabaseManager *dbManager = m_CommandManager->getDatabaseManager();
 
-        m_CachingWorker = new VideoCachingWorker(dbManager);
+        const int workersCount = Helpers::getOptimalWorkersCount(VIDEO_CACHING_MAX_WORKERS_COUNT);
+        m_CachingWorker = new VideoCachingWorker(dbManager, workersCount);
         m_CachingWorker->setCommandManager(m_CommandManager);
 
         QThread *thread = new QThread();
@@ -57,6 +62,22 @@ namespace QMLExtensions {
         }
     }
 
+    void VideoCachingService::setThrottlingPolicy(Helpers::ThrottlingPolicy policy) {
+        LOG_INFO << (int)policy;
+
+        if (m_CachingWorker != NULL) {
+            m_CachingWorker->setThrottlingPolicy(policy);
+        }
+    }
+
+    void VideoCachingService::evictCacheStorage(qint64 maxSizeBytes) {
+        LOG_DEBUG << maxSizeBytes;
+
+        if ((m_CachingWorker != nullptr) && !m_IsCancelled) {
+            m_CachingWorker->evictCacheStorage(maxSizeBytes);
+        }
+    }
+
     void VideoCachingService::generateThumbnails(const MetadataIO::ArtworksSnapshot &snapshot) {
         Q_ASSERT(m_CachingWorker != nullptr);
         LOG_INFO << snapshot.size() << "artworks";
@@ -70,21 +91,30 @@ namespace QMLExtensions {
 
         const size_t size = snapshot.size();
         std::vector<std::shared_ptr<VideoCacheRequest> > requests;
+        std::vector<Common::item_key_t> keys;
+        QVector<Common::ID_t> artworkIDs;
         requests.reserve(size);
+        keys.reserve(size);
+        artworkIDs.reserve((int)size);
 
         for (size_t i = 0; i < size; i++) {
             auto *artwork = snapshot.get(i);
             Models::VideoArtwork *videoArtwork = dynamic_cast<Models::VideoArtwork *>(artwork);
             if (videoArtwork != nullptr) {
-                const bool quickThumbnail = true, dontRecache = false;
+                const bool quickThumbnail = true, dontRecache = false, withDelay = false;
                 requests.emplace_back(new VideoCacheRequest(videoArtwork,
                                                             dontRecache,
                                                             quickThumbnail,
+                                                            withDelay,
                                                             goodQualityAllowed));
+                keys.push_back(getVideoRequestKey(videoArtwork->getItemID()));
+                artworkIDs.append(videoArtwork->getItemID());
             }
         }
 
-        m_CachingWorker->submitItems(requests);
+        m_CachingWorker->clearCancelled(artworkIDs);
+        // good quality requests are queued to the bulk lane after quick ones are done
+        m_CachingWorker->submitItems(requests, keys, Common::LaneVisible);
         m_CachingWorker->submitSeparator();
     }
 
@@ -99,13 +129,22 @@ namespace QMLExtensions {
 #else
         const bool goodQualityAllowed = false;
 #endif
-        const bool quickThumbnail = true, dontRecache = false;
+        const bool quickThumbnail = true, dontRecache = false, withDelay = false;
 
         std::shared_ptr<VideoCacheRequest> request(new VideoCacheRequest(videoArtwork,
                                                                          dontRecache,
                                                                          quickThumbnail,
+                                                                         withDelay,
                                                                          goodQualityAllowed));
-        m_CachingWorker->submitItem(request);
+        m_CachingWorker->clearCancelled(QVector<Common::ID_t>() << videoArtwork->getItemID());
+        m_CachingWorker->submitFirst(request, getVideoRequestKey(videoArtwork->getItemID()));
+    }
+
+    void VideoCachingService::cancelThumbnails(const QVector<Common::ID_t> &artworkIDs) {
+        if (m_IsCancelled || (m_CachingWorker == nullptr) || artworkIDs.isEmpty()) { return; }
+
+        const int cancelledCount = m_CachingWorker->cancelThumbnails(artworkIDs);
+        LOG_INFO << "Cancelled" << cancelledCount << "request(s) of" << artworkIDs.size() << "removed artwork(s)";
     }
 
     void VideoCachingService::waitWorkerIdle() {
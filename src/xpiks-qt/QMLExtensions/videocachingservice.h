@@ -16,6 +16,8 @@
 #include <memory>
 #include <vector>
 #include "../Common/baseentity.h"
+#include "../Common/ibasicartwork.h"
+#include "../Helpers/loadmonitor.h"
 
 namespace Models {
     class ArtworkMetadata;
@@ -43,7 +45,11 @@ namespace QMLExtensions {
     public:
         void generateThumbnails(const MetadataIO::ArtworksSnapshot &snapshot);
         void generateThumbnail(Models::VideoArtwork *videoArtwork);
+        // pending requests of removed artworks are dropped to release them sooner
+        void cancelThumbnails(const QVector<Common::ID_t> &artworkIDs);
         void waitWorkerIdle();
+        void evictCacheStorage(qint64 maxSizeBytes);
+        void setThrottlingPolicy(Helpers::ThrottlingPolicy policy);
 
     private:
         VideoCachingWorker *m_CachingWorker;
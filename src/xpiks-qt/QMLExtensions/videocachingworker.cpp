@@ -12,6 +12,10 @@
 #include <QDir>
 #include <QImage>
 #include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <algorithm>
 #include <vector>
 #include <cstdint>
 #include "../Helpers/constants.h"
@@ -20,11 +24,15 @@
 #include "../MetadataIO/metadataioservice.h"
 #include "../Models/artitemsmodel.h"
 #include "../Commands/commandmanager.h"
+#include "cacheeviction.h"
 #include <thumbnailcreator.h>
 
-#define VIDEO_WORKER_SLEEP_DELAY 500
 #define VIDEO_INDEX_BACKUP_STEP 50
 #define THUMBNAIL_JPG_QUALITY 80
+#define EVICTION_PAGE_SIZE 500
+#define EVICTION_BATCH_SIZE 50
+#define EVICTION_BATCH_DELAY_MS 20
+#define LOCKED_IO_RETRY_DELAY_MS 200
 
 namespace QMLExtensions {
     QString getVideoPathHash(const QString &path, bool isQuickThumbnail) {
@@ -34,19 +42,24 @@ namespace QMLExtensions {
         return hash;
     }
 
-    VideoCachingWorker::VideoCachingWorker(Helpers::DatabaseManager *dbManager, QObject *parent) :
+    VideoCachingWorker::VideoCachingWorker(Helpers::DatabaseManager *dbManager, int workersCount, QObject *parent) :
         QObject(parent),
-        ItemProcessingWorker(2),
+        ItemProcessingWorker(2, workersCount),
         m_ProcessedItemsCount(0),
         m_Cache(dbManager)
     {
         m_RolesToUpdate << Models::ArtItemsModel::ArtworkThumbnailRole;
+        // decoding of videos is the most expensive work and it should never
+        // slow down images or spellcheck (default of videoCachingThrottling setting)
+        setThrottlingPolicy(Helpers::ThrottlingPolicy::Adaptive);
+        setLoadPriority(Helpers::LoadPriority::Background);
+        getTelemetry().setName("VideoCaching");
     }
 
     bool VideoCachingWorker::initWorker() {
         LOG_DEBUG << "#";
 
-        m_ProcessedItemsCount = 0;
+        m_ProcessedItemsCount.store(0);
         QString appDataPath = XPIKS_USERDATA_PATH;
 
         if (!appDataPath.isEmpty()) {
@@ -73,15 +86,16 @@ namespace QMLExtensions {
             saveIndex();
         } else {
             ItemProcessingWorker::processOneItemEx(item, batchID, flags);
-
-            if (getWithDelayFlag(flags)) {
-                // force context switch for more imporant tasks
-                QThread::msleep(VIDEO_WORKER_SLEEP_DELAY);
-            }
         }
     }
 
     void VideoCachingWorker::processOneItem(std::shared_ptr<VideoCacheRequest> &item) {
+        if (item->getWithDelay()) {
+            // give metadata IO some time to unlock the video
+            item->setWithDelay(false);
+            QThread::msleep(LOCKED_IO_RETRY_DELAY_MS);
+        }
+
         if (checkLockedIO(item)) { return; }
         if (checkProcessed(item)) { return; }
 
@@ -92,7 +106,7 @@ namespace QMLExtensions {
 
         std::vector<uint8_t> buffer;
         int width = 0, height = 0;
-        bool needsRefresh = false, success = false;
+        bool success = false;
 
         if (createThumbnail(item, buffer, width, height)) {
             QString thumbnailPath;
@@ -102,27 +116,24 @@ namespace QMLExtensions {
                 cacheImage(thumbnailPath);
                 applyThumbnail(item, thumbnailPath, true);
 
-                if (m_ProcessedItemsCount % VIDEO_INDEX_BACKUP_STEP == 0) {
+                if (m_ProcessedItemsCount.loadAcquire() % VIDEO_INDEX_BACKUP_STEP == 0) {
                     saveIndex();
                 }
 
+                // good quality pass starts only when no quick thumbnail is pending
                 if (isQuickThumbnail && item->getGoodQualityAllowed()) {
                     LOG_INTEGR_TESTS_OR_DEBUG << "Regenerating good quality thumb for" << originalPath;
                     item->setGoodQualityRequest();
-                    needsRefresh = true;
+                    resubmitItem(item, Common::LaneBulk);
                 }
 
                 success = true;
             } else { /* // TODO: change global retry to smth smarter */ }
         }
 
-        if (!success) {
-            item->repeatRequestOnce();
-            needsRefresh = true;
-        }
-
-        if (needsRefresh) {
-            this->submitItem(item);
+        if (!success && !item->isRepeated()) {
+            item->setRepeatRequest();
+            resubmitItem(item, Common::LaneBulk);
         }
     }
 
@@ -158,7 +169,7 @@ namespace QMLExtensions {
         emit stopped();
     }
 
-    bool VideoCachingWorker::tryGetVideoThumbnail(const QString &key, QString &cachedPath, bool &needsUpdate) {
+    bool VideoCachingWorker::tryGetVideoThumbnail(const QString &key, QString &cachedPath, bool &needsUpdate, bool &isQuickThumbnail) {
         bool found = false;
         CachedVideo cachedVideo;
 
@@ -168,9 +179,11 @@ namespace QMLExtensions {
             QFileInfo fi(cachedValue);
 
             if (fi.exists()) {
+                m_Cache.touch(key);
                 cachedVideo.m_RequestsServed++;
                 cachedPath = cachedValue;
                 needsUpdate = QFileInfo(key).lastModified() > cachedVideo.m_LastModified;
+                isQuickThumbnail = cachedVideo.m_IsQuickThumbnail;
 
                 found = true;
             }
@@ -192,9 +205,14 @@ namespace QMLExtensions {
             cachedVideo.m_LastModified = fi.lastModified();
             cachedVideo.m_IsQuickThumbnail = isQuickThumbnail;
 
-            m_Cache.update(originalPath, cachedVideo);
+            {
+                QMutexLocker locker(&m_IndexMutex);
+                Q_UNUSED(locker);
+                m_Cache.update(originalPath, cachedVideo);
+            }
 
-            m_ProcessedItemsCount++;
+            m_Cache.touch(originalPath);
+            m_ProcessedItemsCount.fetchAndAddOrdered(1);
             thumbnailPath = cachedFilepath;
             success = true;
         } else {
@@ -222,8 +240,87 @@ namespace QMLExtensions {
         }
     }
 
+    bool VideoCachingWorker::evictCacheStorage(qint64 maxSizeBytes) {
+        LOG_DEBUG << maxSizeBytes;
+        if (isCancelled() || !isRunning()) { return false; }
+
+        // all items and access times have to be in the database for the scan
+        saveIndex();
+
+        std::vector<EvictionCandidate> candidates;
+        QHash<QString, QDateTime> scannedVersions;
+
+        QString afterKey;
+        QVector<QPair<QString, CachedVideo> > items;
+        QVector<QString> keys;
+        QHash<QString, qint64> accessTimes;
+        while (!isCancelled() && (m_Cache.readPage(afterKey, EVICTION_PAGE_SIZE, items) > 0)) {
+            keys.clear();
+            for (auto &item: items) { keys.append(item.first); }
+            m_Cache.readLastAccessTimes(keys, accessTimes);
+
+            for (auto &item: items) {
+                const CachedVideo &cachedVideo = item.second;
+                const QString filepath = QDir::cleanPath(m_VideosCacheDir + QDir::separator() + cachedVideo.m_Filename);
+
+                candidates.push_back(EvictionCandidate{item.first, QFileInfo(filepath).size(),
+                                                       accessTimes.value(item.first, 0),
+                                                       cachedVideo.m_RequestsServed});
+                scannedVersions.insert(item.first, cachedVideo.m_LastModified);
+            }
+        }
+
+        if (isCancelled()) { return false; }
+
+        std::vector<EvictionCandidate> victims;
+        const qint64 totalBytes = selectEvictionVictims(candidates, maxSizeBytes, victims);
+        LOG_INFO << candidates.size() << "video thumbnail(s) use" << totalBytes << "bytes of" << maxSizeBytes;
+        if (victims.empty()) { return false; }
+
+        int removedCount = 0;
+        const size_t size = victims.size();
+        for (size_t chunkStart = 0; (chunkStart < size) && !isCancelled(); chunkStart += EVICTION_BATCH_SIZE) {
+            const size_t chunkEnd = std::min(chunkStart + EVICTION_BATCH_SIZE, size);
+            QVector<QString> keysToRemove;
+
+            {
+                QMutexLocker locker(&m_IndexMutex);
+                Q_UNUSED(locker);
+
+                for (size_t i = chunkStart; i < chunkEnd; ++i) {
+                    const QString &key = victims[i].m_Key;
+
+                    CachedVideo cachedVideo;
+                    if (!m_Cache.tryGet(key, cachedVideo)) { continue; }
+                    // thumbnail could have been regenerated meanwhile
+                    if (cachedVideo.m_LastModified != scannedVersions.value(key)) { continue; }
+
+                    keysToRemove.append(key);
+                }
+
+                removedCount += m_Cache.remove(keysToRemove);
+            }
+
+            for (auto &key: keysToRemove) {
+                // quick thumbnails are left behind when good quality ones are generated
+                for (bool isQuickThumbnail: {true, false}) {
+                    const QString filename = getVideoPathHash(key, isQuickThumbnail) + ".jpg";
+                    QFile::remove(QDir::cleanPath(m_VideosCacheDir + QDir::separator() + filename));
+                }
+            }
+
+            // do not compete with the UI for the disk
+            QThread::msleep(EVICTION_BATCH_DELAY_MS);
+        }
+
+        LOG_INFO << "Evicted" << removedCount << "video thumbnail(s)";
+        return removedCount > 0;
+    }
+
     void VideoCachingWorker::saveIndex() {
         LOG_DEBUG << "#";
+        QMutexLocker locker(&m_IndexMutex);
+        Q_UNUSED(locker);
         m_Cache.sync();
     }
 
@@ -234,7 +331,9 @@ namespace QMLExtensions {
         Q_ASSERT(video != nullptr);
         if (video->isLockedIO()) {
             LOG_DEBUG << "video is locked for IO";
-            this->submitItem(item);
+            // retried after other requests so consumers do not spin on it
+            item->setWithDelay(true);
+            resubmitItem(item, Common::LaneBulk);
             isLocked = true;
         }
 
@@ -248,9 +347,10 @@ namespace QMLExtensions {
         bool isAlreadyProcessed = false;
 
         QString cachedPath;
-        bool needsUpdate = false;
-        if (this->tryGetVideoThumbnail(originalPath, cachedPath, needsUpdate)) {
-            isAlreadyProcessed = !needsUpdate;
+        bool needsUpdate = false, isQuickCached = false;
+        if (this->tryGetVideoThumbnail(originalPath, cachedPath, needsUpdate, isQuickCached)) {
+            // quick thumbnail does not satisfy the good quality request
+            isAlreadyProcessed = !needsUpdate && (item->getIsQuickThumbnail() || !isQuickCached);
 
             if (item->getThumbnailPath() != cachedPath) {
                 LOG_DEBUG << "Updating outdated thumbnail of artwork #" << item->getArtworkID();
@@ -258,6 +358,55 @@ namespace QMLExtensions {
             }
         }
 
+        if (isAlreadyProcessed && item->getIsQuickThumbnail() && item->getGoodQualityAllowed() && isQuickCached) {
+            item->setGoodQualityRequest();
+            resubmitItem(item, Common::LaneBulk);
+        }
+
         return isAlreadyProcessed;
     }
+
+    int VideoCachingWorker::cancelThumbnails(const QVector<Common::ID_t> &artworkIDs) {
+        std::vector<Common::item_key_t> keys;
+        keys.reserve(artworkIDs.size());
+
+        {
+            QMutexLocker locker(&m_CancelledMutex);
+            Q_UNUSED(locker);
+
+            for (auto id: artworkIDs) {
+                m_CancelledIDs.insert(id);
+                keys.push_back(getVideoRequestKey(id));
+            }
+        }
+
+        return cancelItems(keys);
+    }
+
+    void VideoCachingWorker::clearCancelled(const QVector<Common::ID_t> &artworkIDs) {
+        QMutexLocker locker(&m_CancelledMutex);
+        Q_UNUSED(locker);
+
+        if (m_CancelledIDs.isEmpty()) { return; }
+
+        for (auto id: artworkIDs) {
+            m_CancelledIDs.remove(id);
+        }
+    }
+
+    void VideoCachingWorker::resubmitItem(std::shared_ptr<VideoCacheRequest> &item, Common::ProcessingLane lane) {
+        const Common::ID_t artworkID = item->getArtworkID();
+
+        {
+            QMutexLocker locker(&m_CancelledMutex);
+            Q_UNUSED(locker);
+            // only the request that was in progress during cancellation gets here
+            if (m_CancelledIDs.remove(artworkID)) {
+                LOG_DEBUG << "Artwork #" << artworkID << "was removed";
+                return;
+            }
+        }
+
+        this->submitItem(item, lane, getVideoRequestKey(artworkID));
+    }
 }
@@ -15,6 +15,9 @@
 #include <QString>
 #include <QImage>
 #include <QSet>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
 #include <vector>
 #include "../Common/itemprocessingworker.h"
 #include "../Common/baseentity.h"
@@ -23,11 +26,16 @@
 #include "dbvideocacheindex.h"
 
 namespace QMLExtensions {
+    // quick and good quality requests of the same video share the key
+    inline Common::item_key_t getVideoRequestKey(Common::ID_t artworkID) {
+        return Common::makeItemKey((quint64)artworkID, 0);
+    }
+
     class VideoCachingWorker : public QObject, public Common::BaseEntity, public Common::ItemProcessingWorker<VideoCacheRequest>
     {
         Q_OBJECT
     public:
-        explicit VideoCachingWorker(Helpers::DatabaseManager *dbManager, QObject *parent = 0);
+        VideoCachingWorker(Helpers::DatabaseManager *dbManager, int workersCount, QObject *parent = 0);
 
     protected:
         virtual bool initWorker() override;
@@ -50,7 +58,13 @@ namespace QMLExtensions {
         void queueIsEmpty();
 
     public:
-        bool tryGetVideoThumbnail(const QString &key, QString &cachedPath, bool &needsUpdate);
+        bool tryGetVideoThumbnail(const QString &key, QString &cachedPath, bool &needsUpdate, bool &isQuickThumbnail);
+        // removes least recently served thumbnails until they fit the budget
+        bool evictCacheStorage(qint64 maxSizeBytes);
+        // thumbnail that is being created right now is still applied but not requeued
+        int cancelThumbnails(const QVector<Common::ID_t> &artworkIDs);
+        // has to be called before artworks are submitted again after cancellation
+        void clearCancelled(const QVector<Common::ID_t> &artworkIDs);
 
     private:
         bool saveThumbnail(QImage &image, const QString &originalPath, bool isQuickThumbnail, QString &thumbnailPath);
@@ -59,11 +73,16 @@ namespace QMLExtensions {
         void saveIndex();
         bool checkLockedIO(std::shared_ptr<VideoCacheRequest> &item);
         bool checkProcessed(std::shared_ptr<VideoCacheRequest> &item);
+        void resubmitItem(std::shared_ptr<VideoCacheRequest> &item, Common::ProcessingLane lane);
 
     private:
-        volatile int m_ProcessedItemsCount;
+        QAtomicInt m_ProcessedItemsCount;
         qreal m_Scale;
         QString m_VideosCacheDir;
+        // eviction runs in the maintenance thread
+        QMutex m_IndexMutex;
+        QMutex m_CancelledMutex;
+        QSet<Common::ID_t> m_CancelledIDs;
         DbVideoCacheIndex m_Cache;
         QSet<int> m_RolesToUpdate;
     };
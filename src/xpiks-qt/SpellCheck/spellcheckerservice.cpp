@@ -38,6 +38,8 @@ namespace SpellCheck {
         if (coordinatorParams) { coordinator = coordinatorParams->m_Coordinator; }
 
         m_SpellCheckWorker = new SpellCheckWorker(coordinator, m_SettingsModel);
+        // restarted worker keeps the policy from the settings
+        m_SpellCheckWorker->setThrottlingPolicy(Helpers::toThrottlingPolicy(m_SettingsModel->getSpellCheckThrottling()));
         Helpers::AsyncCoordinatorLocker locker(coordinator);
         Q_UNUSED(locker);
 
@@ -93,6 +95,20 @@ namespace SpellCheck {
         return isBusy;
     }
 
+    void SpellCheckerService::logStatistics() const {
+        if (m_SpellCheckWorker != NULL) {
+            m_SpellCheckWorker->logTelemetry();
+        }
+    }
+
+    void SpellCheckerService::setThrottlingPolicy(Helpers::ThrottlingPolicy policy) {
+        LOG_INFO << (int)policy;
+
+        if (m_SpellCheckWorker != NULL) {
+            m_SpellCheckWorker->setThrottlingPolicy(policy);
+        }
+    }
+
     void SpellCheckerService::submitItem(Common::BasicKeywordsModel *itemToCheck) {
         this->submitItem(itemToCheck, Common::SpellCheckFlags::All);
     }
@@ -111,7 +127,10 @@ namespace SpellCheck {
             spi->deleteLater();
         });
         itemToCheck->connectSignals(item.get());
-        m_SpellCheckWorker->submitItem(item);
+        // repeated edits of the same item only need the latest check;
+        // address of a deleted model can be reused by a new one so it is not a key
+        const Common::item_key_t key = Common::makeItemKey(itemToCheck->getModelID(), (Common::flag_t)flags);
+        m_SpellCheckWorker->submitItem(item, Common::LaneVisible, key);
     }
 
     void SpellCheckerService::submitItems(const std::vector<Common::BasicKeywordsModel *> &itemsToCheck) {
@@ -18,6 +18,7 @@
 #include "../Common/iservicebase.h"
 #include "../Common/flags.h"
 #include "../Models/settingsmodel.h"
+#include "../Helpers/loadmonitor.h"
 
 namespace Models {
     class ArtworkMetadata;
@@ -44,6 +45,8 @@ namespace SpellCheck {
 
         virtual bool isAvailable() const override { return true; }
         virtual bool isBusy() const override;
+        void logStatistics() const;
+        void setThrottlingPolicy(Helpers::ThrottlingPolicy policy);
 
         virtual void submitItem(Common::BasicKeywordsModel *itemToCheck) override;
         virtual void submitItem(Common::BasicKeywordsModel *itemToCheck, Common::SpellCheckFlags flags) override;
@@ -28,7 +28,6 @@
 #define EN_HUNSPELL_AFF "en_US.aff"
 
 #define MINIMUM_LENGTH_FOR_STEMMING 3
-#define SPELLCHECK_WORKER_SLEEP_DELAY 500
 #define SPELLCHECK_DELAY_PERIOD 50
 
 namespace SpellCheck {
@@ -42,6 +41,10 @@ namespace SpellCheck {
         m_UserDictionaryPath("")
     {
         Q_ASSERT(settingsModel);
+        // user waits for spelling errors of the edited artwork,
+        // so it only steps aside for the UI (default of spellCheckThrottling setting)
+        setThrottlingPolicy(Helpers::ThrottlingPolicy::Adaptive);
+        getTelemetry().setName("SpellCheck");
     }
 
     SpellCheckWorker::~SpellCheckWorker() {
@@ -109,10 +112,6 @@ namespace SpellCheck {
             emit queueIsEmpty();
         } else {
             ItemProcessingWorker::processOneItemEx(item, batchID, flags);
-
-            if (getWithDelayFlag(flags)) {
-                QThread::msleep(SPELLCHECK_WORKER_SLEEP_DELAY);
-            }
         }
     }
 
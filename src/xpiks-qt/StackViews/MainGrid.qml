@@ -880,7 +880,38 @@ Item {
                         NumberAnimation { properties: "x,y"; duration: 230 }
                     }
 
-                    onContentYChanged: closeAutoComplete()
+                    property real reportedContentY: 0
+
+                    function reportViewport() {
+                        if (count === 0) { return }
+
+                        var columnsCount = Math.max(1, Math.floor(width / cellWidth))
+                        var topY = contentY - originY
+                        var firstRow = Math.max(0, Math.floor(topY / cellHeight))
+                        var lastRow = Math.max(firstRow, Math.ceil((topY + height) / cellHeight) - 1)
+                        var firstIndex = firstRow * columnsCount
+                        var lastIndex = Math.min(count - 1, (lastRow + 1) * columnsCount - 1)
+                        var scrollingForward = contentY >= reportedContentY
+
+                        reportedContentY = contentY
+                        filteredArtItemsModel.updateViewport(firstIndex, lastIndex, scrollingForward)
+                    }
+
+                    Timer {
+                        id: viewportReportTimer
+                        interval: 150
+                        repeat: false
+                        running: false
+                        onTriggered: artworksHost.reportViewport()
+                    }
+
+                    onContentYChanged: {
+                        closeAutoComplete()
+                        viewportReportTimer.restart()
+                    }
+
+                    onCountChanged: viewportReportTimer.restart()
+                    onHeightChanged: viewportReportTimer.restart()
 
                     delegate: FocusScope {
                         id: wrappersScope
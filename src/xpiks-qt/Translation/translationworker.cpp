@@ -19,6 +19,8 @@ namespace Translation {
         QObject(parent),
         m_InitCoordinator(initCoordinator)
     {
+        setLoadPriority(Helpers::LoadPriority::Interactive);
+        getTelemetry().setName("Translation");
     }
 
     TranslationWorker::~TranslationWorker() {
@@ -20,8 +20,8 @@
 #include "warningssettingsmodel.h"
 #include "warningsitem.h"
 
-#define WARNINGS_WORKER_SLEEP_INTERVAL 500
 #define WARNINGS_DELAY_PERIOD 50
+#define WARNINGS_BATCH_SIZE 20
 
 namespace Warnings {
     QSet<QString> toLowerSet(const QStringList &from) {
@@ -34,12 +34,18 @@ namespace Warnings {
     }
 
     WarningsCheckingWorker::WarningsCheckingWorker(WarningsSettingsModel *warningsSettingsModel,
+                                                   int workersCount,
                                                    QObject *parent):
         QObject(parent),
-        ItemProcessingWorker(WARNINGS_DELAY_PERIOD),
+        ItemProcessingWorker(WARNINGS_DELAY_PERIOD, workersCount),
         m_WarningsSettingsModel(warningsSettingsModel)
     {
         Q_ASSERT(warningsSettingsModel != nullptr);
+        // warnings are recalculated after the spellcheck anyway (default of warningsThrottling setting)
+        setThrottlingPolicy(Helpers::ThrottlingPolicy::Adaptive);
+        setLoadPriority(Helpers::LoadPriority::Background);
+        setMaxBatchSize(WARNINGS_BATCH_SIZE);
+        getTelemetry().setName("Warnings");
     }
 
     bool WarningsCheckingWorker::initWorker() {
@@ -52,10 +58,6 @@ namespace Warnings {
             emit queueIsEmpty();
         } else {
             ItemProcessingWorker::processOneItemEx(item, batchID, flags);
-
-            if (getWithDelayFlag(flags)) {
-                QThread::msleep(WARNINGS_WORKER_SLEEP_INTERVAL);
-            }
         }
     }
 
@@ -64,30 +66,61 @@ namespace Warnings {
         Q_ASSERT(warningItem);
 
         if (warningItem) {
-            processWarningsItem(warningItem);
+            WarningsSettingsSnapshot settings{};
+            initValuesFromSettings(settings);
+            processWarningsItem(warningItem, settings);
         }
     }
 
-    void WarningsCheckingWorker::processWarningsItem(std::shared_ptr<WarningsItem> &item) {
+    void WarningsCheckingWorker::processBatch(std::vector<ItemType> &batch) {
+        WarningsSettingsSnapshot settings{};
+        initValuesFromSettings(settings);
+
+        for (auto &batchItem: batch) {
+            if (isCancelled()) { break; }
+
+            std::shared_ptr<WarningsItem> warningItem = std::dynamic_pointer_cast<WarningsItem>(std::get<0>(batchItem));
+            Q_ASSERT(warningItem);
+
+            if (warningItem) {
+                processWarningsItem(warningItem, settings);
+            }
+        }
+    }
+
+    void WarningsCheckingWorker::initValuesFromSettings(WarningsSettingsSnapshot &settings) const {
+        settings.m_AllowedFilenameCharacters = m_WarningsSettingsModel->getAllowedFilenameCharacters();
+        settings.m_MinMegapixels = m_WarningsSettingsModel->getMinMegapixels();
+        settings.m_MaxImageFilesizeMB = m_WarningsSettingsModel->getMaxImageFilesizeMB();
+        settings.m_MaxVideoFilesizeMB = m_WarningsSettingsModel->getMaxVideoFilesizeMB();
+        settings.m_MinVideoDurationSeconds = m_WarningsSettingsModel->getMinVideoDurationSeconds();
+        settings.m_MaxVideoDurationSeconds = m_WarningsSettingsModel->getMaxVideoDurationSeconds();
+        settings.m_MinKeywordsCount = m_WarningsSettingsModel->getMinKeywordsCount();
+        settings.m_MaxKeywordsCount = m_WarningsSettingsModel->getMaxKeywordsCount();
+        settings.m_MinWordsCount = m_WarningsSettingsModel->getMinWordsCount();
+        settings.m_MaxDescriptionLength = m_WarningsSettingsModel->getMaxDescriptionLength();
+    }
+
+    void WarningsCheckingWorker::processWarningsItem(std::shared_ptr<WarningsItem> &item, const WarningsSettingsSnapshot &settings) {
         Common::flag_t warningsFlags = 0;
 
         if (item->needCheckAll()) {
-            warningsFlags |= checkDimensions(item);
-            warningsFlags |= checkDescription(item);
-            warningsFlags |= checkTitle(item);
-            warningsFlags |= checkKeywords(item);
+            warningsFlags |= checkDimensions(item, settings);
+            warningsFlags |= checkDescription(item, settings);
+            warningsFlags |= checkTitle(item, settings);
+            warningsFlags |= checkKeywords(item, settings);
         } else {
             auto checkingFlags = item->getCheckingFlags();
             switch (checkingFlags) {
                 case Common::WarningsCheckFlags::Description:
-                    warningsFlags |= checkDescription(item);
+                    warningsFlags |= checkDescription(item, settings);
                     break;
                 case Common::WarningsCheckFlags::Keywords:
-                    warningsFlags |= checkKeywords(item);
+                    warningsFlags |= checkKeywords(item, settings);
                     warningsFlags |= checkDuplicates(item);
                     break;
                 case Common::WarningsCheckFlags::Title:
-                    warningsFlags |= checkTitle(item);
+                    warningsFlags |= checkTitle(item, settings);
                     break;
                 case Common::WarningsCheckFlags::Spelling:
                     warningsFlags |= checkSpelling(item);
@@ -101,10 +134,10 @@ namespace Warnings {
         item->submitWarnings(warningsFlags);
     }
 
-    Common::flag_t WarningsCheckingWorker::checkDimensions(std::shared_ptr<WarningsItem> &wi) const {
+    Common::flag_t WarningsCheckingWorker::checkDimensions(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const {
         LOG_INTEGRATION_TESTS << "#";
-        const QString &allowedFilenameCharacters = m_WarningsSettingsModel->getAllowedFilenameCharacters();
-        double minimumMegapixels = m_WarningsSettingsModel->getMinMegapixels();
+        const QString &allowedFilenameCharacters = settings.m_AllowedFilenameCharacters;
+        double minimumMegapixels = settings.m_MinMegapixels;
 
         Models::ArtworkMetadata *item = wi->getCheckableItem();
         Common::flag_t warningsInfo = 0;
@@ -125,12 +158,12 @@ namespace Warnings {
         double filesizeMB = (double)filesize;
         filesizeMB /= (1024.0*1024.0);
         if (image != NULL) {
-            double maxImageFileSizeMB = m_WarningsSettingsModel->getMaxImageFilesizeMB();
+            double maxImageFileSizeMB = settings.m_MaxImageFilesizeMB;
             if (filesizeMB >= maxImageFileSizeMB) {
                 Common::SetFlag(warningsInfo, Common::WarningFlags::ImageFileIsTooBig);
             }
         } else if (video != NULL) {
-            double maxVideoFileSizeMB = m_WarningsSettingsModel->getMaxVideoFilesizeMB();
+            double maxVideoFileSizeMB = settings.m_MaxVideoFilesizeMB;
             if (filesizeMB >= maxVideoFileSizeMB) {
                 Common::SetFlag(warningsInfo, Common::WarningFlags::VideoFileIsTooBig);
             }
@@ -138,8 +171,8 @@ namespace Warnings {
 
         if (video != nullptr) {
             const double duration = video->getDuration();
-            const double maxDuration = m_WarningsSettingsModel->getMaxVideoDurationSeconds();
-            const double minDuration = m_WarningsSettingsModel->getMinVideoDurationSeconds();
+            const double maxDuration = settings.m_MaxVideoDurationSeconds;
+            const double minDuration = settings.m_MinVideoDurationSeconds;
 
             if (duration > maxDuration) {
                 Common::SetFlag(warningsInfo, Common::WarningFlags::VideoIsTooLong);
@@ -166,10 +199,10 @@ namespace Warnings {
         return warningsInfo;
     }
 
-    Common::flag_t WarningsCheckingWorker::checkKeywords(std::shared_ptr<WarningsItem> &wi) const {
+    Common::flag_t WarningsCheckingWorker::checkKeywords(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const {
         LOG_INTEGRATION_TESTS << "#";
-        int minimumKeywordsCount = m_WarningsSettingsModel->getMinKeywordsCount();
-        int maximumKeywordsCount = m_WarningsSettingsModel->getMaxKeywordsCount();
+        int minimumKeywordsCount = settings.m_MinKeywordsCount;
+        int maximumKeywordsCount = settings.m_MaxKeywordsCount;
         Common::flag_t warningsInfo = 0;
         Models::ArtworkMetadata *item = wi->getCheckableItem();
         Common::BasicKeywordsModel *keywordsModel = item->getBasicModel();
@@ -195,9 +228,9 @@ namespace Warnings {
         return warningsInfo;
     }
 
-    Common::flag_t WarningsCheckingWorker::checkDescription(std::shared_ptr<WarningsItem> &wi) const {
+    Common::flag_t WarningsCheckingWorker::checkDescription(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const {
         LOG_INTEGRATION_TESTS << "#";
-        int maximumDescriptionLength = m_WarningsSettingsModel->getMaxDescriptionLength();
+        int maximumDescriptionLength = settings.m_MaxDescriptionLength;
         Common::flag_t warningsInfo = 0;
         Models::ArtworkMetadata *item = wi->getCheckableItem();
 
@@ -215,7 +248,7 @@ namespace Warnings {
             QStringList descriptionWords = wi->getDescriptionWords();
 
             int wordsLength = descriptionWords.length();
-            int minWordsCount = m_WarningsSettingsModel->getMinWordsCount();
+            int minWordsCount = settings.m_MinWordsCount;
             if (wordsLength < minWordsCount) {
                 Common::SetFlag(warningsInfo, Common::WarningFlags::DescriptionNotEnoughWords);
             }
@@ -235,7 +268,7 @@ namespace Warnings {
         return warningsInfo;
     }
 
-    Common::flag_t WarningsCheckingWorker::checkTitle(std::shared_ptr<WarningsItem> &wi) const {
+    Common::flag_t WarningsCheckingWorker::checkTitle(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const {
         LOG_INTEGRATION_TESTS << "#";
 
         Common::flag_t warningsInfo = 0;
@@ -251,7 +284,7 @@ namespace Warnings {
             QStringList titleWords = wi->getTitleWords();
             int partsLength = titleWords.length();
 
-            int minWordsCount = m_WarningsSettingsModel->getMinWordsCount();
+            int minWordsCount = settings.m_MinWordsCount;
             if (partsLength < minWordsCount) {
                 Common::SetFlag(warningsInfo, Common::WarningFlags::TitleNotEnoughWords);
             }
@@ -12,6 +12,7 @@
 #define WARNINGSCHECKINGWORKER_H
 
 #include <QObject>
+#include <QString>
 #include "../Common/itemprocessingworker.h"
 #include "iwarningsitem.h"
 #include "../Common/flags.h"
@@ -20,22 +21,37 @@ namespace Warnings {
     class WarningsSettingsModel;
     class WarningsItem;
 
+    // values of settings model read once per processed batch
+    struct WarningsSettingsSnapshot {
+        QString m_AllowedFilenameCharacters;
+        double m_MinMegapixels = 0.0;
+        double m_MaxImageFilesizeMB = 0.0;
+        double m_MaxVideoFilesizeMB = 0.0;
+        double m_MinVideoDurationSeconds = 0.0;
+        double m_MaxVideoDurationSeconds = 0.0;
+        int m_MinKeywordsCount = 0;
+        int m_MaxKeywordsCount = 0;
+        int m_MinWordsCount = 0;
+        int m_MaxDescriptionLength = 0;
+    };
+
     class WarningsCheckingWorker:
         public QObject, public Common::ItemProcessingWorker<IWarningsItem>
     {
     Q_OBJECT
 
     public:
-        WarningsCheckingWorker(WarningsSettingsModel *warningsSettingsModel, QObject *parent=0);
+        WarningsCheckingWorker(WarningsSettingsModel *warningsSettingsModel, int workersCount=1, QObject *parent=0);
 
     protected:
         virtual bool initWorker() override;
         virtual void processOneItemEx(std::shared_ptr<IWarningsItem> &item, batch_id_t batchID, Common::flag_t flags) override;
         virtual void processOneItem(std::shared_ptr<IWarningsItem> &item) override;
+        virtual void processBatch(std::vector<ItemType> &batch) override;
 
     private:
-        void processWarningsItem(std::shared_ptr<WarningsItem> &item);
-        void initValuesFromSettings();
+        void processWarningsItem(std::shared_ptr<WarningsItem> &item, const WarningsSettingsSnapshot &settings);
+        void initValuesFromSettings(WarningsSettingsSnapshot &settings) const;
 
     protected:
         virtual void onQueueIsEmpty() override { /* Notify only on batches */ /* emit queueIsEmpty(); */ }
@@ -50,10 +66,10 @@ namespace Warnings {
         void queueIsEmpty();
 
     private:
-        Common::flag_t checkDimensions(std::shared_ptr<WarningsItem> &wi) const;
-        Common::flag_t checkKeywords(std::shared_ptr<WarningsItem> &wi) const;
-        Common::flag_t checkDescription(std::shared_ptr<WarningsItem> &wi) const;
-        Common::flag_t checkTitle(std::shared_ptr<WarningsItem> &wi) const;
+        Common::flag_t checkDimensions(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const;
+        Common::flag_t checkKeywords(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const;
+        Common::flag_t checkDescription(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const;
+        Common::flag_t checkTitle(std::shared_ptr<WarningsItem> &wi, const WarningsSettingsSnapshot &settings) const;
         Common::flag_t checkSpelling(std::shared_ptr<WarningsItem> &wi) const;
         Common::flag_t checkDuplicates(std::shared_ptr<WarningsItem> &wi) const;
 
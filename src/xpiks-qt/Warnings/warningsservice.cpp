@@ -15,6 +15,10 @@
 #include "../Commands/commandmanager.h"
 #include "warningsitem.h"
 #include "../Common/flags.h"
+#include "../Helpers/threadhelpers.h"
+
+// warnings items do not depend on each other
+#define WARNINGS_MAX_WORKERS_COUNT 4
 
 namespace Warnings {
     WarningsService::WarningsService(QObject *parent):
@@ -37,7 +41,8 @@ namespace Warnings {
 
     void WarningsService::startService(const std::shared_ptr<Common::ServiceStartParams> &params) {
         Q_UNUSED(params);
-        m_WarningsWorker = new WarningsCheckingWorker(&m_WarningsSettingsModel);
+        const int workersCount = Helpers::getOptimalWorkersCount(WARNINGS_MAX_WORKERS_COUNT);
+        m_WarningsWorker = new WarningsCheckingWorker(&m_WarningsSettingsModel, workersCount);
 
         QThread *thread = new QThread();
         m_WarningsWorker->moveToThread(thread);
@@ -81,6 +86,20 @@ namespace Warnings {
         return isBusy;
     }
 
+    void WarningsService::logStatistics() const {
+        if (m_WarningsWorker != NULL) {
+            m_WarningsWorker->logTelemetry();
+        }
+    }
+
+    void WarningsService::setThrottlingPolicy(Helpers::ThrottlingPolicy policy) {
+        LOG_INFO << (int)policy;
+
+        if (m_WarningsWorker != NULL) {
+            m_WarningsWorker->setThrottlingPolicy(policy);
+        }
+    }
+
     void WarningsService::submitItem(Models::ArtworkMetadata *item) {
         if (m_WarningsWorker == NULL) { return; }
         if (m_IsStopped) { return; }
@@ -88,7 +107,8 @@ namespace Warnings {
         LOG_INFO << "Submitting one item";
 
         std::shared_ptr<IWarningsItem> wItem(new WarningsItem(item));
-        m_WarningsWorker->submitItem(wItem);
+        const Common::item_key_t key = Common::makeItemKey(item->getItemID(), (Common::flag_t)Common::WarningsCheckFlags::All);
+        m_WarningsWorker->submitItem(wItem, Common::LaneVisible, key);
     }
 
     void WarningsService::submitItem(Models::ArtworkMetadata *item, Common::WarningsCheckFlags flags) {
@@ -98,7 +118,9 @@ namespace Warnings {
         LOG_INFO << "Submitting one item with flags" << Common::warningsFlagToString(flags);
 
         std::shared_ptr<IWarningsItem> wItem(new WarningsItem(item, flags));
-        m_WarningsWorker->submitItem(wItem);
+        // item snapshots artwork, so only the latest pending check matters
+        const Common::item_key_t key = Common::makeItemKey(item->getItemID(), (Common::flag_t)flags);
+        m_WarningsWorker->submitItem(wItem, Common::LaneVisible, key);
     }
 
     void WarningsService::submitItems(const MetadataIO::WeakArtworksSnapshot &items) {
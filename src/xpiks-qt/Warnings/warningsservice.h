@@ -18,6 +18,7 @@
 #include "../Common/flags.h"
 #include "warningssettingsmodel.h"
 #include "../MetadataIO/artworkssnapshot.h"
+#include "../Helpers/loadmonitor.h"
 
 namespace Warnings {
     class WarningsCheckingWorker;
@@ -44,6 +45,8 @@ namespace Warnings {
 
         virtual bool isAvailable() const override { return true; }
         virtual bool isBusy() const override;
+        void logStatistics() const;
+        void setThrottlingPolicy(Helpers::ThrottlingPolicy policy);
 
         virtual void submitItem(Models::ArtworkMetadata *item) override;
         virtual void submitItem(Models::ArtworkMetadata *item, Common::WarningsCheckFlags flags) override;
@@ -144,6 +144,7 @@ SOURCES += main.cpp \
     QMLExtensions/artworksupdatehub.cpp \
     Models/keyvaluelist.cpp \
     Helpers/filehelpers.cpp \
+    Helpers/imagehelpers.cpp \
     Helpers/artworkshelpers.cpp \
     Models/sessionmanager.cpp \
     Maintenance/savesessionjobitem.cpp \
@@ -155,10 +156,17 @@ SOURCES += main.cpp \
     Common/statefulentity.cpp \
     QMLExtensions/cachedimage.cpp \
     QMLExtensions/dbimagecacheindex.cpp \
+    QMLExtensions/thumbnailpack.cpp \
+    QMLExtensions/decodedimagecache.cpp \
+    QMLExtensions/cacheeviction.cpp \
     Maintenance/moveimagecachejobitem.cpp \
+    Maintenance/compactimagecachejobitem.cpp \
+    Maintenance/evictthumbnailsjobitem.cpp \
+    Maintenance/compactmetadatacachejobitem.cpp \
     QMLExtensions/cachedvideo.cpp \
     QMLExtensions/dbvideocacheindex.cpp \
     MetadataIO/cachedartwork.cpp \
+    MetadataIO/cachedartworkrecord.cpp \
     MetadataIO/metadatacache.cpp \
     MetadataIO/metadataioworker.cpp \
     MetadataIO/metadataioservice.cpp \
@@ -177,6 +185,11 @@ SOURCES += main.cpp \
     MetadataIO/csvexportproperties.cpp \
     MetadataIO/csvexportmodel.cpp \
     Helpers/threadhelpers.cpp \
+    Helpers/jsonobjectstream.cpp \
+    Helpers/exiftoolframing.cpp \
+    Helpers/exiftoolwriting.cpp \
+    Helpers/loadmonitor.cpp \
+    Helpers/queuetelemetry.cpp \
     KeywordsPresets/presetgroupsmodel.cpp \
     UndoRedo/removedirectoryitem.cpp \
     Common/basickeywordsmodelimpl.cpp \
@@ -190,6 +203,7 @@ DEFINES += QT_NO_CAST_TO_ASCII \
            QT_RESTRICTED_CAST_FROM_ASCII \
            QT_NO_CAST_FROM_BYTEARRAY
 DEFINES += HUNSPELL_STATIC
+DEFINES += SQLITE_ENABLE_FTS5
 DEFINES += QT_MESSAGELOGCONTEXT
 
 # Additional import path used to resolve QML modules in Qt Creator's code model
@@ -367,6 +381,7 @@ HEADERS += \
     QMLExtensions/artworkupdaterequest.h \
     Models/keyvaluelist.h \
     Helpers/filehelpers.h \
+    Helpers/imagehelpers.h \
     Helpers/artworkshelpers.h \
     Models/sessionmanager.h \
     Maintenance/savesessionjobitem.h \
@@ -382,11 +397,18 @@ HEADERS += \
     QMLExtensions/previewstorage.h \
     QMLExtensions/cachedimage.h \
     QMLExtensions/dbimagecacheindex.h \
+    QMLExtensions/thumbnailpack.h \
+    QMLExtensions/decodedimagecache.h \
+    QMLExtensions/cacheeviction.h \
     Maintenance/moveimagecachejobitem.h \
+    Maintenance/compactimagecachejobitem.h \
+    Maintenance/evictthumbnailsjobitem.h \
+    Maintenance/compactmetadatacachejobitem.h \
     QMLExtensions/dbcacheindex.h \
     QMLExtensions/cachedvideo.h \
     QMLExtensions/dbvideocacheindex.h \
     MetadataIO/cachedartwork.h \
+    MetadataIO/cachedartworkrecord.h \
     MetadataIO/metadatacache.h \
     Common/readerwriterqueue.h \
     MetadataIO/metadataioworker.h \
@@ -416,6 +438,11 @@ HEADERS += \
     Models/artworkelement.h \
     Models/previewartworkelement.h \
     Helpers/threadhelpers.h \
+    Helpers/jsonobjectstream.h \
+    Helpers/exiftoolframing.h \
+    Helpers/exiftoolwriting.h \
+    Helpers/loadmonitor.h \
+    Helpers/queuetelemetry.h \
     KeywordsPresets/presetgroupsmodel.h \
     UndoRedo/removedirectoryitem.h \
     Common/basickeywordsmodelimpl.h \
@@ -608,6 +635,12 @@ macx {
     INCLUDEPATH += "../../vendors/quazip"
     INCLUDEPATH += "../../vendors/libcurl/include"
 
+    LIBS += -liconv
+    LIBS += -lexpat
+
+    LIBS += -lxmpsdk
+    LIBS += -lexiv2
+
     LIBS += -lavcodec.57
     LIBS += -lavfilter.6
     LIBS += -lavformat.57
@@ -647,6 +680,9 @@ win32 {
 
     LIBS -= -lcurl
 
+    LIBS += -llibexpat
+    LIBS += -llibexiv2
+
     LIBS += -lavcodec
     LIBS += -lavfilter
     LIBS += -lavformat
@@ -672,6 +708,8 @@ linux {
     LIBS += -L"$$PWD/../../libs"
     BUILDNO = $$system($$PWD/buildno.sh)
 
+    LIBS += -lexiv2
+
     LIBS += -ldl
 
     LIBS += -lavcodec
@@ -695,6 +733,7 @@ travis-ci {
     LIBS -= -lz
     LIBS += /usr/lib/x86_64-linux-gnu/libz.so
     LIBS += -ldl
+    LIBS += -lexiv2
     DEFINES += TRAVIS_CI
     INCLUDEPATH += "../../vendors/quazip"
 
@@ -0,0 +1,166 @@
+#include "cachedartworkrecord_tests.h"
+#include <QtEndian>
+#include "../../xpiks-qt/MetadataIO/cachedartwork.h"
+#include "../../xpiks-qt/MetadataIO/cachedartworkrecord.h"
+
+MetadataIO::CachedArtwork createCachedArtwork() {
+    MetadataIO::CachedArtwork cachedArtwork;
+    cachedArtwork.m_ArtworkType = MetadataIO::CachedArtwork::Vector;
+    cachedArtwork.m_Flags = 5;
+    cachedArtwork.m_FilesizeBytes = 1234567890123ULL;
+    cachedArtwork.m_CategoryID_1 = 11;
+    cachedArtwork.m_CategoryID_2 = 22;
+    cachedArtwork.m_Filepath = "/path/to/file.jpg";
+    cachedArtwork.m_Title = QString::fromUtf8("Тайтл with unicode");
+    cachedArtwork.m_Description = "some description";
+    cachedArtwork.m_AttachedVector = "/path/to/file.eps";
+    cachedArtwork.m_CreationTime = QDateTime::fromMSecsSinceEpoch(1500000000000LL);
+    cachedArtwork.m_Keywords << "keyword1" << QString::fromUtf8("ключове слово") << "keyword 3";
+    cachedArtwork.m_ModelReleaseIDs << 1 << 2 << 65535;
+    cachedArtwork.m_PropertyReleaseIDs << 7;
+    return cachedArtwork;
+}
+
+void CachedArtworkRecordTests::roundTripTest() {
+    MetadataIO::CachedArtwork original = createCachedArtwork();
+    QByteArray data = MetadataIO::CachedArtworkRecord::serialize(original);
+    QVERIFY(MetadataIO::CachedArtworkRecord::isRecord(data));
+
+    MetadataIO::CachedArtwork restored;
+    bool isLegacy = true;
+    QVERIFY(MetadataIO::deserializeCachedArtwork(data, restored, isLegacy));
+    QVERIFY(!isLegacy);
+
+    QCOMPARE(restored.m_ArtworkType, original.m_ArtworkType);
+    QCOMPARE(restored.m_Flags, original.m_Flags);
+    QCOMPARE(restored.m_FilesizeBytes, original.m_FilesizeBytes);
+    QCOMPARE(restored.m_CategoryID_1, original.m_CategoryID_1);
+    QCOMPARE(restored.m_CategoryID_2, original.m_CategoryID_2);
+    QCOMPARE(restored.m_Filepath, original.m_Filepath);
+    QCOMPARE(restored.m_Title, original.m_Title);
+    QCOMPARE(restored.m_Description, original.m_Description);
+    QCOMPARE(restored.m_AttachedVector, original.m_AttachedVector);
+    QCOMPARE(restored.m_CreationTime.toMSecsSinceEpoch(), original.m_CreationTime.toMSecsSinceEpoch());
+    QCOMPARE(restored.m_Keywords, original.m_Keywords);
+    QCOMPARE(restored.m_ModelReleaseIDs, original.m_ModelReleaseIDs);
+    QCOMPARE(restored.m_PropertyReleaseIDs, original.m_PropertyReleaseIDs);
+}
+
+void CachedArtworkRecordTests::emptyFieldsRoundTripTest() {
+    MetadataIO::CachedArtwork original;
+    QByteArray data = MetadataIO::CachedArtworkRecord::serialize(original);
+
+    MetadataIO::CachedArtworkRecord record(data);
+    QVERIFY(record.isValid());
+    QCOMPARE(record.getKeywordsCount(), 0);
+
+    MetadataIO::CachedArtwork restored;
+    QVERIFY(record.materialize(restored));
+    QVERIFY(restored.m_Title.isEmpty());
+    QVERIFY(restored.m_Keywords.isEmpty());
+    QVERIFY(!restored.m_CreationTime.isValid());
+    QVERIFY(restored.m_ModelReleaseIDs.isEmpty());
+}
+
+void CachedArtworkRecordTests::lazyFieldsTest() {
+    MetadataIO::CachedArtwork original = createCachedArtwork();
+    MetadataIO::CachedArtworkRecord record(MetadataIO::CachedArtworkRecord::serialize(original));
+    QVERIFY(record.isValid());
+
+    QCOMPARE((int)record.getArtworkType(), (int)MetadataIO::CachedArtwork::Vector);
+    QCOMPARE(record.getTitle(), original.m_Title);
+    QCOMPARE(record.getKeywordsCount(), 3);
+    QCOMPARE(record.getKeywordsText(), original.m_Keywords.join(QLatin1Char('\n')));
+}
+
+void CachedArtworkRecordTests::legacyFormatIsReadTest() {
+    MetadataIO::CachedArtwork original = createCachedArtwork();
+
+    QByteArray data;
+    {
+        QDataStream ds(&data, QIODevice::WriteOnly);
+        ds << original;
+    }
+
+    QVERIFY(!MetadataIO::CachedArtworkRecord::isRecord(data));
+
+    MetadataIO::CachedArtwork restored;
+    bool isLegacy = false;
+    QVERIFY(MetadataIO::deserializeCachedArtwork(data, restored, isLegacy));
+    QVERIFY(isLegacy);
+    QCOMPARE(restored.m_Title, original.m_Title);
+    QCOMPARE(restored.m_Keywords, original.m_Keywords);
+}
+
+void CachedArtworkRecordTests::newlineInKeywordIsReplacedTest() {
+    MetadataIO::CachedArtwork original;
+    original.m_Keywords << "first\nsecond" << "third";
+
+    MetadataIO::CachedArtworkRecord record(MetadataIO::CachedArtworkRecord::serialize(original));
+    QVERIFY(record.isValid());
+    QCOMPARE(record.getKeywords(), QStringList() << "first second" << "third");
+}
+
+void CachedArtworkRecordTests::truncatedRecordIsInvalidTest() {
+    QByteArray data = MetadataIO::CachedArtworkRecord::serialize(createCachedArtwork());
+    data.chop(5);
+
+    MetadataIO::CachedArtworkRecord record(data);
+    QVERIFY(!record.isValid());
+
+    MetadataIO::CachedArtwork restored;
+    QVERIFY(!record.materialize(restored));
+}
+
+void CachedArtworkRecordTests::videoPropertiesRoundTripTest() {
+    MetadataIO::CachedArtwork original;
+    original.m_ArtworkType = MetadataIO::CachedArtwork::Video;
+    original.m_FilesizeBytes = 987654321ULL;
+    original.m_CodecName = "h264";
+    original.m_FileModifiedTime = QDateTime::fromMSecsSinceEpoch(1500000000123LL);
+    original.m_VideoDuration = 12.345;
+    original.m_VideoFrameRate = 29.97;
+    original.m_VideoBitRate = 45000000;
+    original.m_VideoSize = QSize(3840, 2160);
+
+    MetadataIO::CachedArtworkRecord record(MetadataIO::CachedArtworkRecord::serialize(original));
+    QVERIFY(record.isValid());
+
+    MetadataIO::CachedArtwork restored;
+    QVERIFY(record.materialize(restored));
+    QCOMPARE(restored.m_CodecName, original.m_CodecName);
+    QCOMPARE(restored.m_FileModifiedTime.toMSecsSinceEpoch(), original.m_FileModifiedTime.toMSecsSinceEpoch());
+    QCOMPARE(restored.m_VideoDuration, original.m_VideoDuration);
+    QCOMPARE(restored.m_VideoFrameRate, original.m_VideoFrameRate);
+    QCOMPARE(restored.m_VideoBitRate, original.m_VideoBitRate);
+    QCOMPARE(restored.m_VideoSize, original.m_VideoSize);
+}
+
+void CachedArtworkRecordTests::version1RecordIsReadTest() {
+    // layout of version 1: same header without the last fields table entry
+    const int fieldsTableOffset = 36, entrySize = 8;
+    const int v1FieldsCount = MetadataIO::CachedArtworkRecord::FieldVideoProperties;
+    const int v1HeaderSize = fieldsTableOffset + v1FieldsCount * entrySize;
+
+    MetadataIO::CachedArtwork original = createCachedArtwork();
+    QByteArray data = MetadataIO::CachedArtworkRecord::serialize(original);
+
+    QByteArray v1Data = data;
+    v1Data.remove(v1HeaderSize, entrySize);
+    qToLittleEndian<quint16>(1, (uchar *)v1Data.data() + 4);
+    for (int field = 0; field < v1FieldsCount; ++field) {
+        uchar *entry = (uchar *)v1Data.data() + fieldsTableOffset + field * entrySize;
+        qToLittleEndian<quint32>(qFromLittleEndian<quint32>(entry) - entrySize, entry);
+    }
+
+    MetadataIO::CachedArtworkRecord record(v1Data);
+    QVERIFY(record.isValid());
+    QCOMPARE((int)record.getFormatVersion(), 1);
+
+    MetadataIO::CachedArtwork restored;
+    QVERIFY(record.materialize(restored));
+    QCOMPARE(restored.m_Title, original.m_Title);
+    QCOMPARE(restored.m_Keywords, original.m_Keywords);
+    QCOMPARE(restored.m_PropertyReleaseIDs, original.m_PropertyReleaseIDs);
+    QVERIFY(!restored.m_FileModifiedTime.isValid());
+}
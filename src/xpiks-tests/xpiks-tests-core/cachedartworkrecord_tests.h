@@ -0,0 +1,21 @@
+#ifndef CACHEDARTWORKRECORD_TESTS_H
+#define CACHEDARTWORKRECORD_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class CachedArtworkRecordTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void roundTripTest();
+    void emptyFieldsRoundTripTest();
+    void lazyFieldsTest();
+    void legacyFormatIsReadTest();
+    void newlineInKeywordIsReplacedTest();
+    void truncatedRecordIsInvalidTest();
+    void videoPropertiesRoundTripTest();
+    void version1RecordIsReadTest();
+};
+
+#endif // CACHEDARTWORKRECORD_TESTS_H
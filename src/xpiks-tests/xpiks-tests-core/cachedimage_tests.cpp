@@ -0,0 +1,140 @@
+#include "cachedimage_tests.h"
+#include <QByteArray>
+#include <QDataStream>
+#include "../../xpiks-qt/QMLExtensions/cachedimage.h"
+
+using namespace QMLExtensions;
+
+#define BASE_SIZE QSize(150, 100)
+
+CachedImageLevel makeLevel(const QSize &size, qint32 segmentID, quint32 offset) {
+    CachedImageLevel level;
+    level.m_Size = size;
+    level.m_PackSegmentID = segmentID;
+    level.m_PackOffset = offset;
+    level.m_PackSize = 1000 + offset;
+    return level;
+}
+
+CachedImage makeCachedImage() {
+    CachedImage cachedImage;
+    cachedImage.m_Version = 4;
+    cachedImage.m_LastModified = QDateTime(QDate(2017, 5, 1), QTime(12, 30));
+    cachedImage.m_RequestsServed = 42;
+    cachedImage.m_IsQuickThumbnail = false;
+
+    QVector<CachedImageLevel> levels;
+    levels << makeLevel(QSize(150, 100), 1, 0)
+           << makeLevel(QSize(300, 200), 1, 2000)
+           << makeLevel(QSize(600, 400), 2, 100);
+    cachedImage.setLevels(levels);
+    return cachedImage;
+}
+
+void CachedImageTests::levelsRoundTripTest() {
+    const CachedImage original = makeCachedImage();
+
+    QByteArray data;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << original;
+    }
+
+    CachedImage restored;
+    {
+        QDataStream in(&data, QIODevice::ReadOnly);
+        in >> restored;
+        QCOMPARE(in.status(), QDataStream::Ok);
+        QVERIFY(in.atEnd());
+    }
+
+    QCOMPARE(restored.m_Version, original.m_Version);
+    QCOMPARE(restored.m_LastModified, original.m_LastModified);
+    QCOMPARE(restored.m_RequestsServed, original.m_RequestsServed);
+    QCOMPARE(restored.m_IsQuickThumbnail, original.m_IsQuickThumbnail);
+
+    const QVector<CachedImageLevel> expected = original.getLevels();
+    const QVector<CachedImageLevel> actual = restored.getLevels();
+    QCOMPARE(actual.size(), 3);
+    for (int i = 0; i < expected.size(); ++i) {
+        QCOMPARE(actual[i].m_Size, expected[i].m_Size);
+        QCOMPARE(actual[i].m_PackSegmentID, expected[i].m_PackSegmentID);
+        QCOMPARE(actual[i].m_PackOffset, expected[i].m_PackOffset);
+        QCOMPARE(actual[i].m_PackSize, expected[i].m_PackSize);
+    }
+}
+
+void CachedImageTests::version3HasNoExtraLevelsTest() {
+    CachedImage original = makeCachedImage();
+    original.m_Version = 3;
+
+    QByteArray data;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << original;
+    }
+
+    CachedImage restored;
+    restored.m_ExtraLevels << makeLevel(QSize(10, 10), 5, 5);
+    {
+        QDataStream in(&data, QIODevice::ReadOnly);
+        in >> restored;
+        QVERIFY(in.atEnd());
+    }
+
+    QCOMPARE(restored.m_Version, (quint32)3);
+    QCOMPARE(restored.getLevels().size(), 1);
+    QCOMPARE(restored.m_Size, QSize(150, 100));
+    QCOMPARE(restored.m_PackOffset, (quint32)0);
+}
+
+void CachedImageTests::smallestCoveringLevelIsFoundTest() {
+    const CachedImage cachedImage = makeCachedImage();
+    CachedImageLevel level;
+
+    QVERIFY(cachedImage.findLevel(QSize(100, 100), level));
+    QCOMPARE(level.m_Size, QSize(150, 100));
+
+    QVERIFY(cachedImage.findLevel(QSize(150, 101), level));
+    QCOMPARE(level.m_Size, QSize(300, 200));
+
+    QVERIFY(cachedImage.findLevel(QSize(300, 200), level));
+    QCOMPARE(level.m_Size, QSize(300, 200));
+    QCOMPARE(level.m_PackOffset, (quint32)2000);
+
+    QVERIFY(cachedImage.findLevel(QSize(301, 10), level));
+    QCOMPARE(level.m_Size, QSize(600, 400));
+    QCOMPARE(level.m_PackSegmentID, 2);
+}
+
+void CachedImageTests::biggerRequestHasNoLevelTest() {
+    const CachedImage cachedImage = makeCachedImage();
+    CachedImageLevel level;
+
+    QVERIFY(!cachedImage.findLevel(QSize(601, 400), level));
+    QVERIFY(!cachedImage.findLevel(QSize(100, 401), level));
+}
+
+void CachedImageTests::baseRequestHasOneLevelTest() {
+    QVector<QSize> sizes = getPyramidSizes(BASE_SIZE, BASE_SIZE);
+    QCOMPARE(sizes, QVector<QSize>() << BASE_SIZE);
+
+    sizes = getPyramidSizes(BASE_SIZE, QSize(100, 50));
+    QCOMPARE(sizes, QVector<QSize>() << BASE_SIZE);
+}
+
+void CachedImageTests::biggerLevelsAreAddedWhenRequestedTest() {
+    QVector<QSize> sizes = getPyramidSizes(BASE_SIZE, QSize(300, 200));
+    QCOMPARE(sizes, QVector<QSize>() << BASE_SIZE << QSize(300, 200));
+
+    sizes = getPyramidSizes(BASE_SIZE, QSize(151, 100));
+    QCOMPARE(sizes, QVector<QSize>() << BASE_SIZE << QSize(300, 200));
+
+    sizes = getPyramidSizes(BASE_SIZE, QSize(100, 300));
+    QCOMPARE(sizes, QVector<QSize>() << BASE_SIZE << QSize(300, 200) << QSize(600, 400));
+}
+
+void CachedImageTests::requestBiggerThanPyramidIsAddedTest() {
+    const QVector<QSize> sizes = getPyramidSizes(BASE_SIZE, QSize(1000, 400));
+    QCOMPARE(sizes, QVector<QSize>() << BASE_SIZE << QSize(300, 200) << QSize(600, 400) << QSize(1000, 400));
+}
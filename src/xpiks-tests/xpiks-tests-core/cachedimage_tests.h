@@ -0,0 +1,20 @@
+#ifndef CACHEDIMAGE_TESTS_H
+#define CACHEDIMAGE_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class CachedImageTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void levelsRoundTripTest();
+    void version3HasNoExtraLevelsTest();
+    void smallestCoveringLevelIsFoundTest();
+    void biggerRequestHasNoLevelTest();
+    void baseRequestHasOneLevelTest();
+    void biggerLevelsAreAddedWhenRequestedTest();
+    void requestBiggerThanPyramidIsAddedTest();
+};
+
+#endif // CACHEDIMAGE_TESTS_H
@@ -0,0 +1,66 @@
+#include "cacheeviction_tests.h"
+#include "../../xpiks-qt/QMLExtensions/cacheeviction.h"
+
+using namespace QMLExtensions;
+
+EvictionCandidate makeCandidate(const QString &key, qint64 size, qint64 lastAccessTime, quint64 requestsServed) {
+    return EvictionCandidate{key, size, lastAccessTime, requestsServed};
+}
+
+void CacheEvictionTests::nothingIsEvictedWithinBudgetTest() {
+    std::vector<EvictionCandidate> candidates = {
+        makeCandidate("a", 100, 10, 1),
+        makeCandidate("b", 100, 20, 1)
+    };
+
+    std::vector<EvictionCandidate> victims;
+    qint64 totalBytes = selectEvictionVictims(candidates, 200, victims);
+
+    QCOMPARE(totalBytes, (qint64)200);
+    QVERIFY(victims.empty());
+}
+
+void CacheEvictionTests::leastRecentlyServedAreEvictedFirstTest() {
+    std::vector<EvictionCandidate> candidates = {
+        makeCandidate("recent", 100, 300, 1),
+        makeCandidate("old", 100, 100, 50),
+        makeCandidate("middle", 100, 200, 1)
+    };
+
+    std::vector<EvictionCandidate> victims;
+    selectEvictionVictims(candidates, 250, victims);
+
+    QCOMPARE((int)victims.size(), 1);
+    QCOMPARE(victims[0].m_Key, QString("old"));
+}
+
+void CacheEvictionTests::neverServedAreEvictedByRequestsCountTest() {
+    std::vector<EvictionCandidate> candidates = {
+        makeCandidate("served", 100, 100, 1),
+        makeCandidate("frequent", 100, 0, 10),
+        makeCandidate("rare", 100, 0, 2)
+    };
+
+    std::vector<EvictionCandidate> victims;
+    selectEvictionVictims(candidates, 200, victims);
+
+    QCOMPARE((int)victims.size(), 2);
+    QCOMPARE(victims[0].m_Key, QString("rare"));
+    QCOMPARE(victims[1].m_Key, QString("frequent"));
+}
+
+void CacheEvictionTests::cacheIsTrimmedBelowBudgetTest() {
+    std::vector<EvictionCandidate> candidates;
+    for (int i = 0; i < 100; ++i) {
+        candidates.push_back(makeCandidate(QString::number(i), 10, i + 1, 1));
+    }
+
+    std::vector<EvictionCandidate> victims;
+    qint64 totalBytes = selectEvictionVictims(candidates, 500, victims);
+
+    QCOMPARE(totalBytes, (qint64)1000);
+    qint64 evictedBytes = 0;
+    for (auto &victim: victims) { evictedBytes += victim.m_SizeBytes; }
+    QVERIFY(totalBytes - evictedBytes < 500);
+    QCOMPARE(victims.front().m_Key, QString("0"));
+}
@@ -0,0 +1,17 @@
+#ifndef CACHEEVICTION_TESTS_H
+#define CACHEEVICTION_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class CacheEvictionTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void nothingIsEvictedWithinBudgetTest();
+    void leastRecentlyServedAreEvictedFirstTest();
+    void neverServedAreEvictedByRequestsCountTest();
+    void cacheIsTrimmedBelowBudgetTest();
+};
+
+#endif // CACHEEVICTION_TESTS_H
@@ -0,0 +1,125 @@
+#include "decodedimagecache_tests.h"
+#include <QImage>
+#include "../../xpiks-qt/QMLExtensions/decodedimagecache.h"
+
+using namespace QMLExtensions;
+
+// 32 bits per pixel
+#define IMAGE_BYTES(side) ((side) * (side) * 4)
+
+QImage makeImage(int side, QRgb color) {
+    QImage image(side, side, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+
+void DecodedImageCacheTests::insertedImageIsFoundBySizeTest() {
+    DecodedImageCache cache(IMAGE_BYTES(100) * 10);
+    const QString path = "/path/to/image.jpg";
+
+    QVERIFY(cache.insert(path, QSize(50, 50), makeImage(50, Qt::red), cache.getGeneration(path)));
+    QVERIFY(cache.insert(path, QSize(100, 100), makeImage(100, Qt::green), cache.getGeneration(path)));
+
+    QImage image;
+    QVERIFY(cache.tryGet(path, QSize(50, 50), image));
+    QCOMPARE(image.size(), QSize(50, 50));
+    QCOMPARE(image.pixel(0, 0), QColor(Qt::red).rgb());
+
+    QVERIFY(cache.tryGet(path, QSize(100, 100), image));
+    QCOMPARE(image.pixel(0, 0), QColor(Qt::green).rgb());
+
+    QVERIFY(!cache.tryGet(path, QSize(200, 200), image));
+    QVERIFY(!cache.tryGet("/path/to/other.jpg", QSize(50, 50), image));
+    QCOMPARE(cache.getItemsCount(), 2);
+}
+
+void DecodedImageCacheTests::invalidateRemovesAllSizesTest() {
+    DecodedImageCache cache(IMAGE_BYTES(100) * 10);
+    const QString path = "/path/to/image.jpg";
+    const QString otherPath = "/path/to/other.jpg";
+
+    cache.insert(path, QSize(50, 50), makeImage(50, Qt::red), cache.getGeneration(path));
+    cache.insert(path, QSize(100, 100), makeImage(100, Qt::red), cache.getGeneration(path));
+    cache.insert(otherPath, QSize(50, 50), makeImage(50, Qt::blue), cache.getGeneration(otherPath));
+
+    cache.invalidate(path);
+
+    QImage image;
+    QVERIFY(!cache.tryGet(path, QSize(50, 50), image));
+    QVERIFY(!cache.tryGet(path, QSize(100, 100), image));
+    QVERIFY(cache.tryGet(otherPath, QSize(50, 50), image));
+    QCOMPARE(cache.getItemsCount(), 1);
+}
+
+void DecodedImageCacheTests::leastRecentlyUsedIsEvictedTest() {
+    // room for three images
+    DecodedImageCache cache(IMAGE_BYTES(64) * 3);
+    const QSize size(64, 64);
+
+    for (int i = 0; i < 3; ++i) {
+        const QString path = QString::number(i);
+        QVERIFY(cache.insert(path, size, makeImage(64, Qt::red), cache.getGeneration(path)));
+    }
+
+    QImage image;
+    // makes the first one most recently used
+    QVERIFY(cache.tryGet("0", size, image));
+
+    QVERIFY(cache.insert("3", size, makeImage(64, Qt::red), cache.getGeneration("3")));
+
+    QVERIFY(cache.tryGet("0", size, image));
+    QVERIFY(!cache.tryGet("1", size, image));
+    QVERIFY(cache.tryGet("2", size, image));
+    QVERIFY(cache.tryGet("3", size, image));
+    QVERIFY(cache.getSizeBytes() <= IMAGE_BYTES(64) * 3);
+}
+
+void DecodedImageCacheTests::tooBigImageIsNotCachedTest() {
+    DecodedImageCache cache(IMAGE_BYTES(64));
+    const QString path = "/path/to/image.jpg";
+
+    QVERIFY(!cache.insert(path, QSize(128, 128), makeImage(128, Qt::red), cache.getGeneration(path)));
+    QVERIFY(!cache.insert(path, QSize(64, 64), QImage(), cache.getGeneration(path)));
+    QCOMPARE(cache.getItemsCount(), 0);
+}
+
+void DecodedImageCacheTests::imageReadBeforeInvalidationIsNotInsertedTest() {
+    DecodedImageCache cache(IMAGE_BYTES(100) * 10);
+    const QString path = "/path/to/image.jpg";
+    const QString otherPath = "/path/to/other.jpg";
+    const QSize size(50, 50);
+
+    // provider takes the generation and reads the old thumbnail...
+    const quint64 generation = cache.getGeneration(path);
+    const quint64 otherGeneration = cache.getGeneration(otherPath);
+    // ...while the worker stores a new one
+    cache.invalidate(path);
+
+    QVERIFY(!cache.insert(path, size, makeImage(50, Qt::red), generation));
+    QImage image;
+    QVERIFY(!cache.tryGet(path, size, image));
+
+    // other paths are not affected
+    QVERIFY(cache.insert(otherPath, size, makeImage(50, Qt::blue), otherGeneration));
+
+    QVERIFY(cache.insert(path, size, makeImage(50, Qt::green), cache.getGeneration(path)));
+    QVERIFY(cache.tryGet(path, size, image));
+    QCOMPARE(image.pixel(0, 0), QColor(Qt::green).rgb());
+}
+
+void DecodedImageCacheTests::imageReadBeforeClearIsNotInsertedTest() {
+    DecodedImageCache cache(IMAGE_BYTES(100) * 10);
+    const QString path = "/path/to/image.jpg";
+    const QSize size(50, 50);
+
+    for (int i = 0; i < 5; ++i) { cache.invalidate(path); }
+    const quint64 generation = cache.getGeneration(path);
+    const quint64 newPathGeneration = cache.getGeneration("/path/to/new.jpg");
+
+    cache.clear();
+
+    QVERIFY(cache.getGeneration(path) != generation);
+    QVERIFY(!cache.insert(path, size, makeImage(50, Qt::red), generation));
+    QVERIFY(!cache.insert("/path/to/new.jpg", size, makeImage(50, Qt::red), newPathGeneration));
+    QCOMPARE(cache.getItemsCount(), 0);
+}
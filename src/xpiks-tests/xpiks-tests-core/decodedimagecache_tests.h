@@ -0,0 +1,19 @@
+#ifndef DECODEDIMAGECACHE_TESTS_H
+#define DECODEDIMAGECACHE_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class DecodedImageCacheTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void insertedImageIsFoundBySizeTest();
+    void invalidateRemovesAllSizesTest();
+    void leastRecentlyUsedIsEvictedTest();
+    void tooBigImageIsNotCachedTest();
+    void imageReadBeforeInvalidationIsNotInsertedTest();
+    void imageReadBeforeClearIsNotInsertedTest();
+};
+
+#endif // DECODEDIMAGECACHE_TESTS_H
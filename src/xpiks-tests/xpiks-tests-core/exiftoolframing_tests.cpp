@@ -0,0 +1,81 @@
+#include "exiftoolframing_tests.h"
+#include "../../xpiks-qt/Helpers/exiftoolframing.h"
+
+#define NL EXIFTOOL_ARGUMENTS_NEWLINE
+
+void ExiftoolFramingTests::argumentsAreFramedPerLineTest() {
+    QStringList arguments;
+    arguments << "-json" << "-IPTC:Keywords=one" << "/path/to/file.jpg";
+    QByteArray commandText;
+    QString error;
+
+    bool success = Helpers::frameExiftoolCommand(arguments, 7, commandText, error);
+
+    QVERIFY(success);
+    QVERIFY(error.isEmpty());
+    QCOMPARE(commandText, QByteArray("-json" NL "-IPTC:Keywords=one" NL "/path/to/file.jpg" NL "-execute7" NL));
+}
+
+void ExiftoolFramingTests::newlinesInTagValuesAreReplacedTest() {
+    QStringList arguments;
+    arguments << "-IPTC:Keywords=first\nsecond" << "-XMP:Description=line\r\nbreak\r" << "file.jpg";
+    QByteArray commandText;
+    QString error;
+
+    bool success = Helpers::frameExiftoolCommand(arguments, 1, commandText, error);
+
+    QVERIFY(success);
+    QCOMPARE(commandText, QByteArray("-IPTC:Keywords=first second" NL "-XMP:Description=line break " NL "file.jpg" NL "-execute1" NL));
+}
+
+void ExiftoolFramingTests::newlinesInPathsAreRejectedTest() {
+    QStringList arguments;
+    arguments << "-json" << "/path/to\n-execute2/file.jpg";
+    QByteArray commandText("untouched");
+    QString error;
+
+    bool success = Helpers::frameExiftoolCommand(arguments, 1, commandText, error);
+
+    QVERIFY(!success);
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(commandText, QByteArray("untouched"));
+
+    arguments.clear();
+    arguments << "-IPTC:Key\nwords=value";
+    QVERIFY(!Helpers::frameExiftoolCommand(arguments, 1, commandText, error));
+}
+
+void ExiftoolFramingTests::readyMarkerIsFoundWithNewlineTest() {
+    const QByteArray marker = Helpers::makeExiftoolReadyMarker(12);
+    QCOMPARE(marker, QByteArray("{ready12}"));
+
+    const QByteArray buffer("output line\n{ready12}\r\n{ready13}\n");
+    int endIndex = -1;
+
+    int markerIndex = Helpers::findExiftoolReadyMarker(buffer, marker, endIndex);
+
+    QCOMPARE(markerIndex, 12);
+    QCOMPARE(buffer.mid(endIndex), QByteArray("{ready13}\n"));
+}
+
+void ExiftoolFramingTests::incompleteReadyMarkerIsNotFoundTest() {
+    const QByteArray marker = Helpers::makeExiftoolReadyMarker(3);
+    int endIndex = -1;
+
+    QCOMPARE(Helpers::findExiftoolReadyMarker(QByteArray("output\n{rea"), marker, endIndex), -1);
+    QCOMPARE(Helpers::findExiftoolReadyMarker(QByteArray(), marker, endIndex), -1);
+    QCOMPARE(endIndex, -1);
+
+    // newline did not arrive yet
+    QCOMPARE(Helpers::findExiftoolReadyMarker(QByteArray("{ready3}"), marker, endIndex), 0);
+    QCOMPARE(endIndex, 8);
+}
+
+void ExiftoolFramingTests::otherCommandMarkerIsNotFoundTest() {
+    const QByteArray marker = Helpers::makeExiftoolReadyMarker(1);
+    int endIndex = -1;
+
+    QCOMPARE(Helpers::findExiftoolReadyMarker(QByteArray("{ready11}\n{ready10}\n"), marker, endIndex), -1);
+    QCOMPARE(Helpers::findExiftoolReadyMarker(QByteArray("{ready11}\n{ready1}\n"), marker, endIndex), 10);
+    QCOMPARE(endIndex, 20);
+}
@@ -0,0 +1,19 @@
+#ifndef EXIFTOOLFRAMING_TESTS_H
+#define EXIFTOOLFRAMING_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class ExiftoolFramingTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void argumentsAreFramedPerLineTest();
+    void newlinesInTagValuesAreReplacedTest();
+    void newlinesInPathsAreRejectedTest();
+    void readyMarkerIsFoundWithNewlineTest();
+    void incompleteReadyMarkerIsNotFoundTest();
+    void otherCommandMarkerIsNotFoundTest();
+};
+
+#endif // EXIFTOOLFRAMING_TESTS_H
@@ -0,0 +1,107 @@
+#include "exiftoolwriting_tests.h"
+#include <QSet>
+#include "../../xpiks-qt/Helpers/exiftoolwriting.h"
+
+#define UPDATED_OUTPUT "    1 image files updated\n"
+#define NOT_UPDATED_OUTPUT "    0 image files updated\n    1 files weren't updated due to errors\n"
+
+void ExiftoolWritingTests::argumentsContainAllStandardsTest() {
+    QStringList arguments;
+    Helpers::makeExiftoolWriteArguments("  my   title ", "my description", QStringList() << "one" << "two", arguments);
+
+    QStringList expected;
+    expected << "-XMP:Title=my title" << "-IPTC:ObjectName=my title";
+    expected << "-XMP:Description=my description" << "-EXIF:ImageDescription=my description" << "-IPTC:Caption-Abstract=my description";
+    expected << "-IPTC:Keywords=one" << "-IPTC:Keywords=two";
+    expected << "-XMP:Subject=one" << "-XMP:Subject=two";
+
+    QCOMPARE(arguments, expected);
+}
+
+void ExiftoolWritingTests::emptyTitleIsTakenFromDescriptionTest() {
+    QStringList arguments;
+    Helpers::makeExiftoolWriteArguments(" ", "description\nwith newline", QStringList() << "keyword", arguments);
+
+    QVERIFY(arguments.contains("-XMP:Title=description with newline"));
+    QVERIFY(arguments.contains("-IPTC:ObjectName=description with newline"));
+    QVERIFY(arguments.contains("-EXIF:ImageDescription=description with newline"));
+}
+
+void ExiftoolWritingTests::emptyKeywordsClearTagsTest() {
+    QStringList arguments;
+    Helpers::makeExiftoolWriteArguments("title", "description", QStringList() << "" << QString(), arguments);
+
+    QCOMPARE(arguments.count("-IPTC:Keywords="), 1);
+    QCOMPARE(arguments.count("-XMP:Subject="), 1);
+    QCOMPARE(arguments.size(), 7);
+}
+
+void ExiftoolWritingTests::updatedFileIsSuccessTest() {
+    QVERIFY(Helpers::isExiftoolWriteSuccessful(UPDATED_OUTPUT, QByteArray()));
+}
+
+void ExiftoolWritingTests::notUpdatedFileIsFailureTest() {
+    QVERIFY(!Helpers::isExiftoolWriteSuccessful(NOT_UPDATED_OUTPUT, QByteArray()));
+}
+
+void ExiftoolWritingTests::errorInStderrIsFailureTest() {
+    QVERIFY(!Helpers::isExiftoolWriteSuccessful(QByteArray(), "Error: File not found - /path/to/file.jpg\n"));
+}
+
+void ExiftoolWritingTests::warningInStderrIsSuccessTest() {
+    QVERIFY(Helpers::isExiftoolWriteSuccessful(UPDATED_OUTPUT, "Warning: [minor] IPTC:Keywords exceeds length limit (truncated)\n"));
+}
+
+void ExiftoolWritingTests::allItemsAreWrittenOnceOnSuccessTest() {
+    int callsCount = 0;
+    std::vector<size_t> written;
+
+    const std::vector<size_t> failed = Helpers::writeWithRetries(3, 1, 0,
+                                                                 [&](const std::vector<size_t> &indices, std::vector<size_t> &) {
+        callsCount++;
+        written.insert(written.end(), indices.begin(), indices.end());
+    });
+
+    QVERIFY(failed.empty());
+    QCOMPARE(callsCount, 1);
+    QCOMPARE(written, std::vector<size_t>({0, 1, 2}));
+}
+
+void ExiftoolWritingTests::onlyFailedItemsAreRetriedTest() {
+    std::vector<std::vector<size_t> > attempts;
+
+    // item 1 is locked only during the first attempt
+    const std::vector<size_t> failed = Helpers::writeWithRetries(4, 1, 0,
+                                                                 [&](const std::vector<size_t> &indices, std::vector<size_t> &failedIndices) {
+        attempts.push_back(indices);
+        if (attempts.size() == 1) {
+            failedIndices.push_back(1);
+        }
+    });
+
+    QVERIFY(failed.empty());
+    QCOMPARE((int)attempts.size(), 2);
+    QCOMPARE(attempts[0], std::vector<size_t>({0, 1, 2, 3}));
+    QCOMPARE(attempts[1], std::vector<size_t>({1}));
+}
+
+void ExiftoolWritingTests::itemsFailedAllAttemptsAreReportedTest() {
+    std::vector<std::vector<size_t> > attempts;
+    const QSet<size_t> brokenItems = QSet<size_t>() << 0 << 3;
+
+    // items 0 and 3 always fail, item 2 fails only once
+    const std::vector<size_t> failed = Helpers::writeWithRetries(5, 2, 0,
+                                                                 [&](const std::vector<size_t> &indices, std::vector<size_t> &failedIndices) {
+        attempts.push_back(indices);
+        for (auto index: indices) {
+            if (brokenItems.contains(index) || ((index == 2) && (attempts.size() == 1))) {
+                failedIndices.push_back(index);
+            }
+        }
+    });
+
+    QCOMPARE(failed, std::vector<size_t>({0, 3}));
+    QCOMPARE((int)attempts.size(), 3);
+    QCOMPARE(attempts[1], std::vector<size_t>({0, 2, 3}));
+    QCOMPARE(attempts[2], std::vector<size_t>({0, 3}));
+}
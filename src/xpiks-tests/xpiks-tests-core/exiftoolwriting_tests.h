@@ -0,0 +1,23 @@
+#ifndef EXIFTOOLWRITING_TESTS_H
+#define EXIFTOOLWRITING_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class ExiftoolWritingTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void argumentsContainAllStandardsTest();
+    void emptyTitleIsTakenFromDescriptionTest();
+    void emptyKeywordsClearTagsTest();
+    void updatedFileIsSuccessTest();
+    void notUpdatedFileIsFailureTest();
+    void errorInStderrIsFailureTest();
+    void warningInStderrIsSuccessTest();
+    void allItemsAreWrittenOnceOnSuccessTest();
+    void onlyFailedItemsAreRetriedTest();
+    void itemsFailedAllAttemptsAreReportedTest();
+};
+
+#endif // EXIFTOOLWRITING_TESTS_H
@@ -0,0 +1,264 @@
+#include "imagehelpers_tests.h"
+#include <QBuffer>
+#include <QDataStream>
+#include <QImage>
+#include <QtEndian>
+#include "../../xpiks-qt/Helpers/imagehelpers.h"
+
+// layout of the TIFF block produced by makeTiff()
+#define TIFF_IFD0_COUNT 8
+#define TIFF_ORIENTATION_VALUE 18
+#define TIFF_IFD1_COUNT 26
+#define TIFF_THUMBNAIL_OFFSET_VALUE 36
+#define TIFF_THUMBNAIL_LENGTH_VALUE 48
+#define TIFF_THUMBNAIL_START 56
+
+QByteArray makeThumbnail() {
+    QImage image(16, 8, QImage::Format_RGB32);
+    image.fill(Qt::blue);
+
+    QByteArray jpegData;
+    QBuffer buffer(&jpegData);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPG");
+    return jpegData;
+}
+
+// IFD0 with orientation, IFD1 with the thumbnail
+QByteArray makeTiff(const QByteArray &thumbnail, quint16 orientation, QDataStream::ByteOrder byteOrder = QDataStream::LittleEndian) {
+    QByteArray tiff;
+    QDataStream stream(&tiff, QIODevice::WriteOnly);
+    stream.setByteOrder(byteOrder);
+
+    if (byteOrder == QDataStream::LittleEndian) {
+        stream.writeRawData("II", 2);
+    } else {
+        stream.writeRawData("MM", 2);
+    }
+
+    stream << (quint16)42 << (quint32)TIFF_IFD0_COUNT;
+    // IFD0
+    stream << (quint16)1;
+    stream << (quint16)0x0112 << (quint16)3 << (quint32)1 << orientation << (quint16)0;
+    stream << (quint32)TIFF_IFD1_COUNT;
+    // IFD1
+    stream << (quint16)2;
+    stream << (quint16)0x0201 << (quint16)4 << (quint32)1 << (quint32)TIFF_THUMBNAIL_START;
+    stream << (quint16)0x0202 << (quint16)4 << (quint32)1 << (quint32)thumbnail.size();
+    stream << (quint32)0;
+
+    Q_ASSERT(tiff.size() == TIFF_THUMBNAIL_START);
+    tiff.append(thumbnail);
+    return tiff;
+}
+
+void patchTiff(QByteArray &tiff, int offset, quint32 value) {
+    qToLittleEndian<quint32>(value, (uchar *)tiff.data() + offset);
+}
+
+QByteArray makeExifSegment(const QByteArray &tiff) {
+    return QByteArray("Exif\0\0", 6) + tiff;
+}
+
+QByteArray makeXmpSegment(const QByteArray &thumbnail) {
+    QByteArray base64 = thumbnail.toBase64();
+    // long lines are split with escaped line breaks
+    base64.insert(16, "&#xA;");
+
+    QByteArray xmp("http://ns.adobe.com/xap/1.0/", 29);
+    xmp.append("<x:xmpmeta><rdf:li><xmpGImg:image>");
+    xmp.append(base64);
+    xmp.append("</xmpGImg:image></rdf:li></x:xmpmeta>");
+    return xmp;
+}
+
+QByteArray makeJpeg(const QList<QByteArray> &app1Segments) {
+    QByteArray jpeg("\xFF\xD8", 2);
+
+    for (auto &segment: app1Segments) {
+        jpeg.append("\xFF\xE1", 2);
+        jpeg.append((char)(((segment.size() + 2) >> 8) & 0xFF));
+        jpeg.append((char)((segment.size() + 2) & 0xFF));
+        jpeg.append(segment);
+    }
+
+    // image data is never parsed
+    jpeg.append("\xFF\xDA\x00\x02\xFF\xD9", 6);
+    return jpeg;
+}
+
+void ImageHelpersTests::exifThumbnailIsFoundTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    const QByteArray jpeg = makeJpeg(QList<QByteArray>() << makeExifSegment(makeTiff(thumbnail, 6)));
+
+    QByteArray jpegData;
+    int orientation = 0;
+    QVERIFY(Helpers::readEmbeddedThumbnail(jpeg, jpegData, orientation));
+    QCOMPARE(jpegData, thumbnail);
+    QCOMPARE(orientation, 6);
+}
+
+void ImageHelpersTests::bigEndianExifThumbnailIsFoundTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    const QByteArray jpeg = makeJpeg(QList<QByteArray>() << makeExifSegment(makeTiff(thumbnail, 8, QDataStream::BigEndian)));
+
+    QByteArray jpegData;
+    int orientation = 0;
+    QVERIFY(Helpers::readEmbeddedThumbnail(jpeg, jpegData, orientation));
+    QCOMPARE(jpegData, thumbnail);
+    QCOMPARE(orientation, 8);
+}
+
+void ImageHelpersTests::xmpThumbnailIsFoundTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    QByteArray tiff = makeTiff(QByteArray(), 3);
+    // EXIF without IFD1 still has orientation
+    patchTiff(tiff, TIFF_IFD1_COUNT - 4, 0);
+    const QByteArray jpeg = makeJpeg(QList<QByteArray>() << makeXmpSegment(thumbnail) << makeExifSegment(tiff));
+
+    QByteArray jpegData;
+    int orientation = 0;
+    QVERIFY(Helpers::readEmbeddedThumbnail(jpeg, jpegData, orientation));
+    QCOMPARE(jpegData, thumbnail);
+    QCOMPARE(orientation, 3);
+}
+
+void ImageHelpersTests::tiffThumbnailIsFoundTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    const QByteArray tiff = makeTiff(thumbnail, 5);
+
+    QByteArray jpegData;
+    int orientation = 0;
+    QVERIFY(Helpers::readEmbeddedThumbnail(tiff, jpegData, orientation));
+    QCOMPARE(jpegData, thumbnail);
+    QCOMPARE(orientation, 5);
+}
+
+void ImageHelpersTests::truncatedJpegIsRejectedTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    const QByteArray jpeg = makeJpeg(QList<QByteArray>() << makeExifSegment(makeTiff(thumbnail, 1)));
+    // up to the end of the EXIF segment
+    const int fullSize = jpeg.size() - 6;
+
+    for (int size = 0; size < fullSize; ++size) {
+        QByteArray jpegData;
+        int orientation = 0;
+        QVERIFY2(!Helpers::readEmbeddedThumbnail(jpeg.left(size), jpegData, orientation), qPrintable(QString::number(size)));
+    }
+}
+
+void ImageHelpersTests::truncatedTiffIsRejectedTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    const QByteArray tiff = makeTiff(thumbnail, 1);
+
+    for (int size = 0; size < tiff.size(); ++size) {
+        QByteArray jpegData;
+        int orientation = 0;
+        QVERIFY2(!Helpers::readEmbeddedThumbnail(tiff.left(size), jpegData, orientation), qPrintable(QString::number(size)));
+    }
+}
+
+void ImageHelpersTests::badByteOrderIsRejectedTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    QByteArray tiff = makeTiff(thumbnail, 1);
+    tiff[0] = 'X';
+    tiff[1] = 'X';
+
+    QByteArray jpegData;
+    int orientation = 0;
+    QVERIFY(!Helpers::readEmbeddedThumbnail(makeJpeg(QList<QByteArray>() << makeExifSegment(tiff)), jpegData, orientation));
+    QVERIFY(!Helpers::readEmbeddedThumbnail(tiff, jpegData, orientation));
+}
+
+void ImageHelpersTests::thumbnailOutsideOfDataIsRejectedTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    QByteArray jpegData;
+    int orientation = 0;
+
+    QByteArray tiff = makeTiff(thumbnail, 1);
+    patchTiff(tiff, TIFF_THUMBNAIL_OFFSET_VALUE, 0xFFFFFFF0);
+    QVERIFY(!Helpers::readEmbeddedThumbnail(tiff, jpegData, orientation));
+
+    tiff = makeTiff(thumbnail, 1);
+    patchTiff(tiff, TIFF_THUMBNAIL_LENGTH_VALUE, 0xFFFFFFFF);
+    QVERIFY(!Helpers::readEmbeddedThumbnail(tiff, jpegData, orientation));
+
+    tiff = makeTiff(thumbnail, 1);
+    patchTiff(tiff, TIFF_IFD1_COUNT - 4, 0x7FFFFFFF);
+    QVERIFY(!Helpers::readEmbeddedThumbnail(tiff, jpegData, orientation));
+
+    tiff = makeTiff(thumbnail, 1);
+    patchTiff(tiff, 4, (quint32)tiff.size());
+    QVERIFY(!Helpers::readEmbeddedThumbnail(tiff, jpegData, orientation));
+}
+
+void ImageHelpersTests::hugeEntriesCountIsRejectedTest() {
+    const QByteArray thumbnail = makeThumbnail();
+    QByteArray jpegData;
+    int orientation = 0;
+
+    QByteArray tiff = makeTiff(thumbnail, 1);
+    tiff[TIFF_IFD0_COUNT] = '\xFF';
+    tiff[TIFF_IFD0_COUNT + 1] = '\xFF';
+    QVERIFY(!Helpers::readEmbeddedThumbnail(tiff, jpegData, orientation));
+
+    QVERIFY(!Helpers::readEmbeddedThumbnail(makeJpeg(QList<QByteArray>() << makeExifSegment(tiff)), jpegData, orientation));
+}
+
+void ImageHelpersTests::notJpegThumbnailIsRejectedTest() {
+    QByteArray jpegData;
+    int orientation = 0;
+
+    const QByteArray garbage(100, 'x');
+    QVERIFY(!Helpers::readEmbeddedThumbnail(makeTiff(garbage, 1), jpegData, orientation));
+    QVERIFY(!Helpers::readEmbeddedThumbnail(makeJpeg(QList<QByteArray>() << makeXmpSegment(garbage)), jpegData, orientation));
+    QVERIFY(!Helpers::readEmbeddedThumbnail(garbage, jpegData, orientation));
+    QVERIFY(!Helpers::readEmbeddedThumbnail(QByteArray(), jpegData, orientation));
+}
+
+void ImageHelpersTests::invalidOrientationIsIgnoredTest() {
+    const QByteArray thumbnail = makeThumbnail();
+
+    for (quint16 value: {(quint16)0, (quint16)9, (quint16)0xFFFF}) {
+        QByteArray jpegData;
+        int orientation = 0;
+        QVERIFY(Helpers::readEmbeddedThumbnail(makeTiff(thumbnail, value), jpegData, orientation));
+        QCOMPARE(orientation, 1);
+    }
+}
+
+void ImageHelpersTests::exifOrientationIsAppliedTest() {
+    const int width = 3, height = 2;
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+            image.setPixel(x, y, qRgb(x * 100, y * 100, 0));
+        }
+    }
+
+    // where pixel (x, y) of the stored image is displayed
+    auto displayedAt = [=](int orientation, int x, int y) {
+        switch (orientation) {
+        case 2: return QPoint(width - 1 - x, y);
+        case 3: return QPoint(width - 1 - x, height - 1 - y);
+        case 4: return QPoint(x, height - 1 - y);
+        case 5: return QPoint(y, x);
+        case 6: return QPoint(height - 1 - y, x);
+        case 7: return QPoint(height - 1 - y, width - 1 - x);
+        case 8: return QPoint(y, width - 1 - x);
+        default: return QPoint(x, y);
+        }
+    };
+
+    for (int orientation = 1; orientation <= 8; ++orientation) {
+        const QImage oriented = Helpers::applyExifOrientation(image, orientation);
+        const QSize expectedSize = Helpers::isTransposingOrientation(orientation) ? QSize(height, width) : QSize(width, height);
+        QCOMPARE(oriented.size(), expectedSize);
+
+        for (int x = 0; x < width; ++x) {
+            for (int y = 0; y < height; ++y) {
+                QCOMPARE(oriented.pixel(displayedAt(orientation, x, y)), image.pixel(x, y));
+            }
+        }
+    }
+}
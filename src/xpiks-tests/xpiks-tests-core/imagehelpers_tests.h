@@ -0,0 +1,25 @@
+#ifndef IMAGEHELPERS_TESTS_H
+#define IMAGEHELPERS_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class ImageHelpersTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void exifThumbnailIsFoundTest();
+    void bigEndianExifThumbnailIsFoundTest();
+    void xmpThumbnailIsFoundTest();
+    void tiffThumbnailIsFoundTest();
+    void truncatedJpegIsRejectedTest();
+    void truncatedTiffIsRejectedTest();
+    void badByteOrderIsRejectedTest();
+    void thumbnailOutsideOfDataIsRejectedTest();
+    void hugeEntriesCountIsRejectedTest();
+    void notJpegThumbnailIsRejectedTest();
+    void invalidOrientationIsIgnoredTest();
+    void exifOrientationIsAppliedTest();
+};
+
+#endif // IMAGEHELPERS_TESTS_H
@@ -0,0 +1,384 @@
+#include "itemprocessingworker_tests.h"
+#include <QElapsedTimer>
+#include <thread>
+#include <atomic>
+#include "../../xpiks-qt/Common/itemprocessingworker.h"
+
+#define SEPARATORS_WAIT_TIMEOUT 10000
+
+struct CountedItem {
+    CountedItem(int value): m_Value(value) {}
+    int m_Value;
+};
+
+class CountingWorker: public Common::ItemProcessingWorker<CountedItem> {
+public:
+    CountingWorker(int workersCount):
+        ItemProcessingWorker(0xffffffff, workersCount),
+        m_ProcessedCount(0),
+        m_SeparatorsCount(0),
+        m_ProcessedBeforeSeparator(-1),
+        m_FirstValue(-1),
+        m_ValuesSum(0),
+        m_BatchesCount(0),
+        m_MaxProcessedBatch(0)
+    { }
+
+public:
+    int getProcessedCount() const { return m_ProcessedCount.load(); }
+    int getSeparatorsCount() const { return m_SeparatorsCount.load(); }
+    int getProcessedBeforeSeparator() const { return m_ProcessedBeforeSeparator.load(); }
+    int getFirstValue() const { return m_FirstValue.load(); }
+    int getValuesSum() const { return m_ValuesSum.load(); }
+    int getBatchesCount() const { return m_BatchesCount.load(); }
+    int getMaxProcessedBatch() const { return m_MaxProcessedBatch.load(); }
+
+    // returns false if separators did not fire in time
+    bool waitForSeparators(int count, int timeoutMs = SEPARATORS_WAIT_TIMEOUT) {
+        QElapsedTimer timer;
+        timer.start();
+
+        while (m_SeparatorsCount.load() < count) {
+            if (timer.elapsed() > timeoutMs) { return false; }
+            QThread::msleep(1);
+        }
+
+        return true;
+    }
+
+protected:
+    virtual bool initWorker() override { return true; }
+    virtual void processOneItemEx(std::shared_ptr<CountedItem> &item, batch_id_t batchID, Common::flag_t flags) override {
+        if (getIsSeparatorFlag(flags)) {
+            m_ProcessedBeforeSeparator = m_ProcessedCount.load();
+            m_SeparatorsCount++;
+        } else {
+            ItemProcessingWorker::processOneItemEx(item, batchID, flags);
+        }
+    }
+
+    virtual void processBatch(std::vector<ItemType> &batch) override {
+        m_BatchesCount++;
+        const int size = (int)batch.size();
+        if (size > m_MaxProcessedBatch.load()) { m_MaxProcessedBatch = size; }
+        ItemProcessingWorker::processBatch(batch);
+    }
+
+    virtual void processOneItem(std::shared_ptr<CountedItem> &item) override {
+        int expected = -1;
+        m_FirstValue.compare_exchange_strong(expected, item->m_Value);
+        m_ValuesSum += item->m_Value;
+        QThread::usleep(50);
+        m_ProcessedCount++;
+    }
+
+    virtual void onQueueIsEmpty() override { }
+    virtual void workerStopped() override { }
+
+private:
+    std::atomic_int m_ProcessedCount;
+    std::atomic_int m_SeparatorsCount;
+    std::atomic_int m_ProcessedBeforeSeparator;
+    std::atomic_int m_FirstValue;
+    std::atomic_int m_ValuesSum;
+    std::atomic_int m_BatchesCount;
+    std::atomic_int m_MaxProcessedBatch;
+};
+
+std::vector<std::shared_ptr<CountedItem> > generateItems(int count) {
+    std::vector<std::shared_ptr<CountedItem> > items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        items.emplace_back(new CountedItem(i));
+    }
+    return items;
+}
+
+void ItemProcessingWorkerTests::singleWorkerProcessesAllItemsTest() {
+    const int itemsCount = 200;
+    CountingWorker worker(1);
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitItems(generateItems(itemsCount));
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getProcessedCount(), itemsCount);
+    QCOMPARE(worker.getProcessedBeforeSeparator(), itemsCount);
+}
+
+void ItemProcessingWorkerTests::poolProcessesAllItemsTest() {
+    const int itemsCount = 1000;
+    CountingWorker worker(4);
+    QCOMPARE(worker.getWorkersCount(), 4);
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitItems(generateItems(itemsCount/2));
+    for (auto &item: generateItems(itemsCount/2)) {
+        worker.submitItem(item);
+    }
+
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getProcessedCount(), itemsCount);
+}
+
+void ItemProcessingWorkerTests::separatorWaitsForPreviousItemsTest() {
+    const int itemsCount = 300;
+    CountingWorker worker(3);
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitItems(generateItems(itemsCount));
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+    QCOMPARE(worker.getProcessedBeforeSeparator(), itemsCount);
+}
+
+void ItemProcessingWorkerTests::cancelBatchRemovesItemsTest() {
+    const int itemsCount = 100;
+    CountingWorker worker(2);
+
+    auto batchID = worker.submitItems(generateItems(itemsCount));
+    worker.cancelBatch(batchID);
+    QVERIFY(!worker.hasPendingJobs());
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getProcessedCount(), 0);
+    QCOMPARE(worker.getProcessedBeforeSeparator(), 0);
+}
+
+void ItemProcessingWorkerTests::interactiveLaneIsProcessedFirstTest() {
+    const int itemsCount = 50;
+    CountingWorker worker(1);
+
+    worker.submitItems(generateItems(itemsCount));
+    worker.submitItem(std::make_shared<CountedItem>(1000), Common::LaneVisible);
+    worker.submitFirst(std::make_shared<CountedItem>(2000));
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getFirstValue(), 2000);
+    QCOMPARE(worker.getProcessedCount(), itemsCount + 2);
+}
+
+void ItemProcessingWorkerTests::supersededItemIsProcessedOnceTest() {
+    const Common::item_key_t key = 42;
+    CountingWorker worker(2);
+
+    worker.submitItem(std::make_shared<CountedItem>(1), Common::LaneBulk, key);
+    worker.submitItem(std::make_shared<CountedItem>(10), Common::LaneBulk, key);
+    // moves pending item to the higher lane
+    worker.submitItem(std::make_shared<CountedItem>(100), Common::LaneVisible, key);
+    worker.submitItem(std::make_shared<CountedItem>(1000), Common::LaneBulk);
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getProcessedCount(), 2);
+    QCOMPARE(worker.getValuesSum(), 1100);
+    QCOMPARE(worker.getProcessedBeforeSeparator(), 2);
+}
+
+void ItemProcessingWorkerTests::demotedItemIsProcessedLastTest() {
+    const int itemsCount = 20;
+    CountingWorker worker(1);
+
+    auto items = generateItems(itemsCount);
+    std::vector<Common::item_key_t> keys;
+    for (int i = 0; i < itemsCount; ++i) { keys.push_back(Common::makeItemKey(i, 0)); }
+    worker.submitItems(items, keys, Common::LaneBulk);
+
+    std::vector<Common::item_key_t> visibleKeys = { keys[5], keys[6] };
+    worker.submitItems({ std::make_shared<CountedItem>(500), std::make_shared<CountedItem>(600) },
+                       visibleKeys, Common::LaneVisible);
+    // one of them is scrolled past before processing started
+    QCOMPARE(worker.demoteItems({ keys[5], keys[10] }, Common::LaneBulk), 1);
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getFirstValue(), 600);
+    QCOMPARE(worker.getProcessedCount(), itemsCount);
+    QCOMPARE(worker.getValuesSum(), (itemsCount - 1) * itemsCount / 2 - 5 - 6 + 500 + 600);
+}
+
+void ItemProcessingWorkerTests::cancelledItemsAreReleasedTest() {
+    const int itemsCount = 10;
+    CountingWorker worker(2);
+
+    auto items = generateItems(itemsCount);
+    std::vector<Common::item_key_t> keys;
+    for (int i = 0; i < itemsCount; ++i) { keys.push_back(Common::makeItemKey(i, 0)); }
+    worker.submitItems(items, keys, Common::LaneVisible);
+
+    std::weak_ptr<CountedItem> cancelledItem = items[3];
+    items.clear();
+
+    QCOMPARE(worker.cancelItems({ keys[3], keys[7] }), 2);
+    // item is released before its queued entry is reached
+    QVERIFY(cancelledItem.expired());
+    QCOMPARE(worker.cancelItems({ keys[3] }), 0);
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getProcessedCount(), itemsCount - 2);
+    QCOMPARE(worker.getProcessedBeforeSeparator(), itemsCount - 2);
+    QCOMPARE(worker.getValuesSum(), (itemsCount - 1) * itemsCount / 2 - 3 - 7);
+}
+
+void ItemProcessingWorkerTests::cancelledItemsAreNotPendingTest() {
+    const int itemsCount = 5;
+    CountingWorker worker(2);
+    worker.setLoadPriority(Helpers::LoadPriority::Background);
+
+    Helpers::LoadMonitor &monitor = Helpers::LoadMonitor::getInstance();
+    const int pendingBefore = monitor.getPendingWork(Helpers::LoadPriority::Background);
+
+    std::vector<Common::item_key_t> keys;
+    for (int i = 0; i < itemsCount; ++i) { keys.push_back(Common::makeItemKey(i, 0)); }
+    worker.submitItems(generateItems(itemsCount), keys, Common::LaneVisible);
+    // superseded entry in the lower lane is left behind
+    worker.submitItem(std::make_shared<CountedItem>(100), Common::LaneInteractive, keys[0]);
+
+    QVERIFY(worker.hasPendingJobs());
+    QVERIFY(monitor.getPendingWork(Helpers::LoadPriority::Background) > pendingBefore);
+
+    QCOMPARE(worker.cancelItems(keys), itemsCount);
+
+    QVERIFY(!worker.hasPendingJobs());
+    QCOMPARE(monitor.getPendingWork(Helpers::LoadPriority::Background), pendingBefore);
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getProcessedCount(), 0);
+}
+
+void ItemProcessingWorkerTests::batchProcessingTest() {
+    const int itemsCount = 100;
+    const size_t batchSize = 16;
+    CountingWorker worker(1);
+    worker.setMaxBatchSize(batchSize);
+
+    worker.submitItems(generateItems(itemsCount));
+    worker.submitSeparator();
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getProcessedCount(), itemsCount);
+    QCOMPARE(worker.getProcessedBeforeSeparator(), itemsCount);
+    QCOMPARE(worker.getMaxProcessedBatch(), (int)batchSize);
+    QCOMPARE(worker.getBatchesCount(), (int)((itemsCount + batchSize - 1) / batchSize));
+}
+
+void ItemProcessingWorkerTests::telemetryCountsItemsTest() {
+    const int itemsCount = 100;
+    CountingWorker worker(2);
+
+    worker.submitItems(generateItems(itemsCount));
+    worker.submitSeparator();
+
+    QCOMPARE(worker.getTelemetry().getMaxDepth(), itemsCount);
+
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    const bool separatorFired = worker.waitForSeparators(1);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+
+    QCOMPARE(worker.getTelemetry().getDequeuedCount(), (qint64)itemsCount);
+    QCOMPARE(worker.getTelemetry().getProcessedCount(), (qint64)itemsCount);
+    QVERIFY(worker.getTelemetry().getItemsPerSecond() > 0.0);
+}
+
+void ItemProcessingWorkerTests::stopWorkingDrainsQueueTest() {
+    const int itemsCount = 200;
+    CountingWorker worker(3);
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    worker.submitItems(generateItems(itemsCount));
+    worker.submitSeparator();
+    worker.submitItem(std::make_shared<CountedItem>(1000));
+
+    worker.stopWorking(false);
+    // nothing is accepted after the stop
+    QCOMPARE(worker.submitItem(std::make_shared<CountedItem>(2000)), (quint32)INVALID_BATCH_ID);
+    thread.join();
+
+    QCOMPARE(worker.getProcessedCount(), itemsCount + 1);
+    QCOMPARE(worker.getSeparatorsCount(), 1);
+    QVERIFY(worker.getProcessedBeforeSeparator() >= itemsCount);
+    QVERIFY(!worker.hasPendingJobs());
+}
@@ -0,0 +1,25 @@
+#ifndef ITEMPROCESSINGWORKER_TESTS_H
+#define ITEMPROCESSINGWORKER_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class ItemProcessingWorkerTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void singleWorkerProcessesAllItemsTest();
+    void poolProcessesAllItemsTest();
+    void separatorWaitsForPreviousItemsTest();
+    void cancelBatchRemovesItemsTest();
+    void interactiveLaneIsProcessedFirstTest();
+    void supersededItemIsProcessedOnceTest();
+    void demotedItemIsProcessedLastTest();
+    void cancelledItemsAreReleasedTest();
+    void cancelledItemsAreNotPendingTest();
+    void batchProcessingTest();
+    void telemetryCountsItemsTest();
+    void stopWorkingDrainsQueueTest();
+};
+
+#endif // ITEMPROCESSINGWORKER_TESTS_H
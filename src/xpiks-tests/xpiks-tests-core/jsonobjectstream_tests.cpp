@@ -0,0 +1,65 @@
+#include "jsonobjectstream_tests.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "../../xpiks-qt/Helpers/jsonobjectstream.h"
+
+#define EXIFTOOL_OUTPUT "[{\n  \"SourceFile\": \"a.jpg\",\n  \"Keywords\": [\"one\",\"two\"]\n},\n{\n  \"SourceFile\": \"b.jpg\",\n  \"Title\": \"Nested {\\\"quoted\\\"} [text]\"\n}]\n"
+
+void JsonObjectStreamTests::wholeArrayIsSplitTest() {
+    Helpers::JsonObjectStream stream;
+    std::vector<QByteArray> objects;
+
+    int count = stream.feed(QByteArray(EXIFTOOL_OUTPUT), objects);
+
+    QCOMPARE(count, 2);
+    QCOMPARE((int)objects.size(), 2);
+    QCOMPARE(QJsonDocument::fromJson(objects[0]).object().value("SourceFile").toString(), QString("a.jpg"));
+    QCOMPARE(QJsonDocument::fromJson(objects[1]).object().value("SourceFile").toString(), QString("b.jpg"));
+    QVERIFY(!stream.hasIncompleteObject());
+}
+
+void JsonObjectStreamTests::objectsSplitAcrossChunksTest() {
+    const QByteArray output(EXIFTOOL_OUTPUT);
+
+    for (int chunkSize = 1; chunkSize < output.size(); ++chunkSize) {
+        Helpers::JsonObjectStream stream;
+        std::vector<QByteArray> objects;
+
+        for (int i = 0; i < output.size(); i += chunkSize) {
+            stream.feed(output.mid(i, chunkSize), objects);
+        }
+
+        QCOMPARE((int)objects.size(), 2);
+        QCOMPARE(QJsonDocument::fromJson(objects[0]).object().value("Keywords").toArray().size(), 2);
+        QCOMPARE(QJsonDocument::fromJson(objects[1]).object().value("Title").toString(), QString("Nested {\"quoted\"} [text]"));
+    }
+}
+
+void JsonObjectStreamTests::bracesInsideStringsAreIgnoredTest() {
+    Helpers::JsonObjectStream stream;
+    std::vector<QByteArray> objects;
+
+    stream.feed(QByteArray("[{\"Title\": \"}}}\\\\\"}, {\"Title\": \"{\"}]"), objects);
+
+    QCOMPARE((int)objects.size(), 2);
+    QCOMPARE(QJsonDocument::fromJson(objects[0]).object().value("Title").toString(), QString("}}}\\"));
+    QCOMPARE(QJsonDocument::fromJson(objects[1]).object().value("Title").toString(), QString("{"));
+}
+
+void JsonObjectStreamTests::incompleteObjectIsNotReturnedTest() {
+    Helpers::JsonObjectStream stream;
+    std::vector<QByteArray> objects;
+
+    int count = stream.feed(QByteArray("[{\"SourceFile\": \"a.jpg\"}, {\"SourceFile\": \"b"), objects);
+
+    QCOMPARE(count, 1);
+    QVERIFY(stream.hasIncompleteObject());
+
+    stream.reset();
+    QVERIFY(!stream.hasIncompleteObject());
+
+    count = stream.feed(QByteArray("{\"SourceFile\": \"c.jpg\"}"), objects);
+    QCOMPARE(count, 1);
+    QCOMPARE(QJsonDocument::fromJson(objects[1]).object().value("SourceFile").toString(), QString("c.jpg"));
+}
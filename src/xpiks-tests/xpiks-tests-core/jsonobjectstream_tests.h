@@ -0,0 +1,17 @@
+#ifndef JSONOBJECTSTREAM_TESTS_H
+#define JSONOBJECTSTREAM_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class JsonObjectStreamTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void wholeArrayIsSplitTest();
+    void objectsSplitAcrossChunksTest();
+    void bracesInsideStringsAreIgnoredTest();
+    void incompleteObjectIsNotReturnedTest();
+};
+
+#endif // JSONOBJECTSTREAM_TESTS_H
@@ -0,0 +1,183 @@
+#include "loadmonitor_tests.h"
+#include <QElapsedTimer>
+#include <thread>
+#include <atomic>
+#include "../../xpiks-qt/Helpers/loadmonitor.h"
+#include "../../xpiks-qt/Common/itemprocessingworker.h"
+
+#define SEPARATOR_WAIT_TIMEOUT 10000
+
+using namespace Helpers;
+
+struct ThrottledItem {
+    ThrottledItem(int value): m_Value(value) {}
+    int m_Value;
+};
+
+class ThrottledWorker: public Common::ItemProcessingWorker<ThrottledItem> {
+public:
+    ThrottledWorker():
+        ItemProcessingWorker(0xffffffff, 1),
+        m_ProcessedCount(0),
+        m_SeparatorsCount(0)
+    {
+        setThrottlingPolicy(ThrottlingPolicy::Adaptive);
+        setLoadPriority(LoadPriority::Background);
+    }
+
+public:
+    int getProcessedCount() const { return m_ProcessedCount.load(); }
+
+    // returns false if separator did not fire in time
+    bool waitForSeparator(int timeoutMs = SEPARATOR_WAIT_TIMEOUT) {
+        QElapsedTimer timer;
+        timer.start();
+
+        while (m_SeparatorsCount.load() == 0) {
+            if (timer.elapsed() > timeoutMs) { return false; }
+            QThread::msleep(1);
+        }
+
+        return true;
+    }
+
+protected:
+    virtual bool initWorker() override { return true; }
+    virtual void processOneItemEx(std::shared_ptr<ThrottledItem> &item, batch_id_t batchID, Common::flag_t flags) override {
+        if (getIsSeparatorFlag(flags)) {
+            m_SeparatorsCount++;
+        } else {
+            ItemProcessingWorker::processOneItemEx(item, batchID, flags);
+        }
+    }
+
+    virtual void processOneItem(std::shared_ptr<ThrottledItem> &) override { m_ProcessedCount++; }
+    virtual void onQueueIsEmpty() override { }
+    virtual void workerStopped() override { }
+
+private:
+    std::atomic_int m_ProcessedCount;
+    std::atomic_int m_SeparatorsCount;
+};
+
+void LoadMonitorTests::pendingWorkAboveYieldsTest() {
+    LoadMonitor &monitor = LoadMonitor::getInstance();
+
+    monitor.addPendingWork(LoadPriority::Interactive, 1);
+    QVERIFY(monitor.hasPendingWorkAbove(LoadPriority::Normal));
+    QVERIFY(monitor.hasPendingWorkAbove(LoadPriority::Background));
+    QVERIFY(monitor.shouldYield(LoadPriority::Background));
+    monitor.addPendingWork(LoadPriority::Interactive, -1);
+
+    monitor.addPendingWork(LoadPriority::Normal, 3);
+    QVERIFY(monitor.shouldYield(LoadPriority::Background));
+    QVERIFY(!monitor.shouldYield(LoadPriority::Normal));
+    monitor.addPendingWork(LoadPriority::Normal, -3);
+}
+
+void LoadMonitorTests::pendingWorkBelowDoesNotYieldTest() {
+    LoadMonitor &monitor = LoadMonitor::getInstance();
+
+    monitor.addPendingWork(LoadPriority::Background, 100);
+    QVERIFY(!monitor.hasPendingWorkAbove(LoadPriority::Interactive));
+    QVERIFY(!monitor.shouldYield(LoadPriority::Interactive));
+    QVERIFY(!monitor.shouldYield(LoadPriority::Normal));
+    QVERIFY(!monitor.shouldYield(LoadPriority::Background));
+    monitor.addPendingWork(LoadPriority::Background, -100);
+}
+
+void LoadMonitorTests::laggingHeartbeatIsBusyTest() {
+    LoadMonitor &monitor = LoadMonitor::getInstance();
+
+    monitor.onHeartbeat(1000);
+    monitor.onHeartbeat(1100);
+    QVERIFY(!monitor.isUIBusyAt(1100));
+
+    // next heartbeat came 80 ms late
+    monitor.onHeartbeat(1280);
+    QVERIFY(monitor.isUIBusyAt(1280));
+
+    monitor.onHeartbeat(1380);
+    QVERIFY(!monitor.isUIBusyAt(1400));
+}
+
+void LoadMonitorTests::stuckHeartbeatIsBusyTest() {
+    LoadMonitor &monitor = LoadMonitor::getInstance();
+
+    monitor.onHeartbeat(2000);
+    monitor.onHeartbeat(2100);
+    QVERIFY(!monitor.isUIBusyAt(2150));
+    QVERIFY(!monitor.isUIBusyAt(2250));
+    // no heartbeat while UI thread is blocked
+    QVERIFY(monitor.isUIBusyAt(2251));
+    QVERIFY(monitor.isUIBusyAt(5000));
+
+    monitor.onHeartbeat(2200);
+}
+
+void LoadMonitorTests::throttlingPolicyFromSettingsTest() {
+    QVERIFY(toThrottlingPolicy(0) == ThrottlingPolicy::NoThrottling);
+    QVERIFY(toThrottlingPolicy(1) == ThrottlingPolicy::FixedDelay);
+    QVERIFY(toThrottlingPolicy(2) == ThrottlingPolicy::Adaptive);
+    // broken settings fall back to the default
+    QVERIFY(toThrottlingPolicy(-1) == ThrottlingPolicy::Adaptive);
+    QVERIFY(toThrottlingPolicy(42) == ThrottlingPolicy::Adaptive);
+}
+
+void LoadMonitorTests::yieldBudgetScalesWithLoadTest() {
+    QCOMPARE(LoadMonitor::calculateYieldBudgetMs(false, 0), 0);
+
+    const int smallBudget = LoadMonitor::calculateYieldBudgetMs(false, 1);
+    const int mediumBudget = LoadMonitor::calculateYieldBudgetMs(false, 100);
+    const int hugeBudget = LoadMonitor::calculateYieldBudgetMs(false, 100000);
+
+    QVERIFY(smallBudget > 0);
+    QVERIFY(smallBudget < mediumBudget);
+    QVERIFY(mediumBudget <= hugeBudget);
+    QCOMPARE(hugeBudget, LOAD_MONITOR_MAX_YIELD_MS);
+
+    QCOMPARE(LoadMonitor::calculateYieldBudgetMs(true, 0), LOAD_MONITOR_MAX_YIELD_MS);
+    QCOMPARE(LoadMonitor::calculateYieldBudgetMs(true, 100000), LOAD_MONITOR_MAX_YIELD_MS);
+}
+
+void LoadMonitorTests::yieldBudgetDropsWhenWorkIsDoneTest() {
+    LoadMonitor &monitor = LoadMonitor::getInstance();
+    const int pendingBefore = monitor.getPendingWorkAbove(LoadPriority::Background);
+
+    monitor.addPendingWork(LoadPriority::Normal, 10);
+    QCOMPARE(monitor.getPendingWorkAbove(LoadPriority::Background), pendingBefore + 10);
+    QVERIFY(monitor.getYieldBudgetMs(LoadPriority::Background) > 0);
+    QCOMPARE(monitor.getYieldBudgetMs(LoadPriority::Interactive), 0);
+
+    monitor.addPendingWork(LoadPriority::Normal, -10);
+    QCOMPARE(monitor.getPendingWorkAbove(LoadPriority::Background), pendingBefore);
+    QCOMPARE(monitor.getYieldBudgetMs(LoadPriority::Background), LoadMonitor::calculateYieldBudgetMs(false, pendingBefore));
+}
+
+void LoadMonitorTests::adaptiveBackOffIsCappedTest() {
+    LoadMonitor &monitor = LoadMonitor::getInstance();
+    ThrottledWorker worker;
+    std::thread thread([&worker]() { worker.doWork(); });
+
+    // huge backlog of more important work never finishes
+    monitor.addPendingWork(LoadPriority::Normal, 100000);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    worker.submitItem(std::shared_ptr<ThrottledItem>(new ThrottledItem(1)));
+    worker.submitItem(std::shared_ptr<ThrottledItem>(new ThrottledItem(2)));
+    worker.submitSeparator();
+    const bool separatorFired = worker.waitForSeparator();
+
+    const qint64 elapsed = timer.elapsed();
+    monitor.addPendingWork(LoadPriority::Normal, -100000);
+
+    worker.stopWorking();
+    thread.join();
+
+    QVERIFY(separatorFired);
+    QCOMPARE(worker.getProcessedCount(), 2);
+    // every item yields for the max time, but not forever
+    QVERIFY2(elapsed >= 2 * LOAD_MONITOR_MAX_YIELD_MS, qPrintable(QString::number(elapsed)));
+}
@@ -0,0 +1,21 @@
+#ifndef LOADMONITOR_TESTS_H
+#define LOADMONITOR_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class LoadMonitorTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void pendingWorkAboveYieldsTest();
+    void pendingWorkBelowDoesNotYieldTest();
+    void laggingHeartbeatIsBusyTest();
+    void stuckHeartbeatIsBusyTest();
+    void throttlingPolicyFromSettingsTest();
+    void yieldBudgetScalesWithLoadTest();
+    void yieldBudgetDropsWhenWorkIsDoneTest();
+    void adaptiveBackOffIsCappedTest();
+};
+
+#endif // LOADMONITOR_TESTS_H
@@ -27,6 +27,17 @@
 #include "preset_tests.h"
 #include "quickbuffer_tests.h"
 #include "jsonmerge_tests.h"
+#include "itemprocessingworker_tests.h"
+#include "cachedartworkrecord_tests.h"
+#include "cacheeviction_tests.h"
+#include "jsonobjectstream_tests.h"
+#include "exiftoolframing_tests.h"
+#include "exiftoolwriting_tests.h"
+#include "thumbnailpack_tests.h"
+#include "decodedimagecache_tests.h"
+#include "loadmonitor_tests.h"
+#include "imagehelpers_tests.h"
+#include "cachedimage_tests.h"
 
 #define QTEST_CLASS(TestObject, vName, result) \
     TestObject vName; \
@@ -63,6 +74,17 @@ int main(int argc, char *argv[]) {
     QTEST_CLASS(PresetTests, pst, result);
     QTEST_CLASS(QuickBufferTests, qbt, result);
     QTEST_CLASS(JsonMergeTests, jmt, result);
+    QTEST_CLASS(ItemProcessingWorkerTests, ipwt, result);
+    QTEST_CLASS(CachedArtworkRecordTests, carc, result);
+    QTEST_CLASS(CacheEvictionTests, cet, result);
+    QTEST_CLASS(JsonObjectStreamTests, jost, result);
+    QTEST_CLASS(ExiftoolFramingTests, eft, result);
+    QTEST_CLASS(ExiftoolWritingTests, ewt, result);
+    QTEST_CLASS(ThumbnailPackTests, tpt, result);
+    QTEST_CLASS(DecodedImageCacheTests, dict, result);
+    QTEST_CLASS(LoadMonitorTests, lmt, result);
+    QTEST_CLASS(ImageHelpersTests, iht, result);
+    QTEST_CLASS(CachedImageTests, cit, result);
 
     QThread::sleep(1);
 
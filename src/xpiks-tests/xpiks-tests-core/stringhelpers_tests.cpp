@@ -143,3 +143,30 @@ void StringHelpersTests::switcherHashTest() {
     QCOMPARE(Helpers::switcherHash("dc16d9fe-61d6-4564-931b-650e42fcf443"), quint32(3282680053));
 
 }
+
+void StringHelpersTests::truncateUtf8ShortTextTest() {
+    QCOMPARE(Helpers::truncateUtf8("seagull", 64), QByteArray("seagull"));
+    QCOMPARE(Helpers::truncateUtf8("seagull", 7), QByteArray("seagull"));
+    QCOMPARE(Helpers::truncateUtf8("seagull", 3), QByteArray("sea"));
+    QCOMPARE(Helpers::truncateUtf8("", 0), QByteArray());
+    QCOMPARE(Helpers::truncateUtf8("seagull", 0), QByteArray());
+}
+
+void StringHelpersTests::truncateUtf8KeepsCharactersTest() {
+    // 2 bytes per letter
+    const QString greek = QString::fromUtf8("\xcf\x80\xcf\x8d\xcf\x81\xce\xb3\xce\xbf\xcf\x82");
+    QCOMPARE(Helpers::truncateUtf8(greek, 5), greek.left(2).toUtf8());
+    QCOMPARE(Helpers::truncateUtf8(greek, 4), greek.left(2).toUtf8());
+    QCOMPARE(Helpers::truncateUtf8(greek, 1), QByteArray());
+
+    // 4 bytes in a surrogate pair
+    const QString emoji = QString::fromUtf8("a\xf0\x9f\x90\xa6");
+    QCOMPARE(Helpers::truncateUtf8(emoji, 4), QByteArray("a"));
+    QCOMPARE(Helpers::truncateUtf8(emoji, 5), emoji.toUtf8());
+
+    QString keyword;
+    for (int i = 0; i < 40; ++i) { keyword.append(greek.at(0)); }
+    const QByteArray truncated = Helpers::truncateUtf8(keyword, 64);
+    QCOMPARE(truncated.size(), 64);
+    QCOMPARE(QString::fromUtf8(truncated), keyword.left(32));
+}
@@ -25,6 +25,8 @@ private slots:
     void replaceWholeNoCaseHitTest();
     void replaceWholeNoHitTest();
     void switcherHashTest();
+    void truncateUtf8ShortTextTest();
+    void truncateUtf8KeepsCharactersTest();
 };
 
 #endif // STRINGHELPERSTESTS_H
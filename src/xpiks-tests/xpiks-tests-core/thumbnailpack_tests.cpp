@@ -0,0 +1,247 @@
+#include "thumbnailpack_tests.h"
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include "../../xpiks-qt/QMLExtensions/thumbnailpack.h"
+
+using namespace QMLExtensions;
+
+#define SMALL_SEGMENT_SIZE 1024
+
+QByteArray makePayload(char fill, int size) {
+    return QByteArray(size, fill);
+}
+
+void ThumbnailPackTests::appendedPayloadIsReadBackTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    ThumbnailPack pack;
+    QVERIFY(pack.initialize(packDir.path()));
+
+    PackLocation first, second;
+    QVERIFY(pack.append(makePayload('a', 100), first));
+    QVERIFY(pack.append(makePayload('b', 200), second));
+
+    QCOMPARE(first.m_SegmentID, second.m_SegmentID);
+    QVERIFY(second.m_Offset > first.m_Offset);
+    QVERIFY(pack.contains(first));
+    QVERIFY(pack.contains(second));
+
+    QByteArray payload;
+    QVERIFY(pack.readPayload(first, payload));
+    QCOMPARE(payload, makePayload('a', 100));
+    QVERIFY(pack.readPayload(second, payload));
+    QCOMPARE(payload, makePayload('b', 200));
+
+    pack.finalize();
+}
+
+void ThumbnailPackTests::recordsSurviveReopeningTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    PackLocation location;
+    {
+        ThumbnailPack pack;
+        QVERIFY(pack.initialize(packDir.path()));
+        QVERIFY(pack.append(makePayload('c', 50), location));
+        pack.finalize();
+    }
+
+    ThumbnailPack pack;
+    QVERIFY(pack.initialize(packDir.path()));
+
+    QByteArray payload;
+    QVERIFY(pack.readPayload(location, payload));
+    QCOMPARE(payload, makePayload('c', 50));
+
+    // appends continue after existing records
+    PackLocation next;
+    QVERIFY(pack.append(makePayload('d', 50), next));
+    QCOMPARE(next.m_SegmentID, location.m_SegmentID);
+    QVERIFY(next.m_Offset > location.m_Offset);
+
+    pack.finalize();
+}
+
+void ThumbnailPackTests::fullSegmentIsRolledOverTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    ThumbnailPack pack(SMALL_SEGMENT_SIZE);
+    QVERIFY(pack.initialize(packDir.path()));
+
+    const qint32 firstSegmentID = pack.getActiveSegmentID();
+    QVector<PackLocation> locations;
+    for (int i = 0; i < 10; ++i) {
+        PackLocation location;
+        QVERIFY(pack.append(makePayload('a' + i, 300), location));
+        locations.append(location);
+    }
+
+    QVERIFY(pack.getActiveSegmentID() > firstSegmentID);
+    QVERIFY(pack.getSegmentIDs().size() > 1);
+
+    for (qint32 segmentID: pack.getSegmentIDs()) {
+        QVERIFY(pack.getSegmentSize(segmentID) <= SMALL_SEGMENT_SIZE);
+    }
+
+    for (int i = 0; i < locations.size(); ++i) {
+        QByteArray payload;
+        QVERIFY(pack.readPayload(locations[i], payload));
+        QCOMPARE(payload, makePayload('a' + i, 300));
+    }
+
+    pack.finalize();
+}
+
+void ThumbnailPackTests::corruptedLocationIsRejectedTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    ThumbnailPack pack;
+    QVERIFY(pack.initialize(packDir.path()));
+
+    PackLocation location;
+    QVERIFY(pack.append(makePayload('e', 100), location));
+
+    QByteArray payload;
+
+    PackLocation shifted = location;
+    shifted.m_Offset += 4;
+    shifted.m_Size -= 4;
+    QVERIFY(!pack.readPayload(shifted, payload));
+
+    PackLocation tooLong = location;
+    tooLong.m_Size += 1000;
+    QVERIFY(!pack.contains(tooLong));
+    QVERIFY(!pack.readPayload(tooLong, payload));
+
+    PackLocation missingSegment = location;
+    missingSegment.m_SegmentID += 100;
+    QVERIFY(!pack.readPayload(missingSegment, payload));
+
+    QVERIFY(!pack.readPayload(PackLocation(), payload));
+
+    pack.finalize();
+}
+
+void ThumbnailPackTests::relocatedRecordsSurviveSegmentRemovalTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    ThumbnailPack pack(SMALL_SEGMENT_SIZE);
+    QVERIFY(pack.initialize(packDir.path()));
+
+    PackLocation live, dead;
+    QVERIFY(pack.append(makePayload('l', 300), live));
+    QVERIFY(pack.append(makePayload('d', 300), dead));
+
+    const qint32 sparseSegmentID = live.m_SegmentID;
+    // fill the segment so that the next record starts a new one
+    PackLocation filler;
+    do {
+        QVERIFY(pack.append(makePayload('f', 300), filler));
+    } while (filler.m_SegmentID == sparseSegmentID);
+
+    PackLocation relocated;
+    QVERIFY(pack.relocate(live, relocated));
+    QVERIFY(relocated.m_SegmentID != sparseSegmentID);
+
+    QVERIFY(pack.removeSegment(sparseSegmentID));
+    QCOMPARE(pack.getSegmentSize(sparseSegmentID), (qint64)0);
+
+    QByteArray payload;
+    QVERIFY(!pack.readPayload(dead, payload));
+    QVERIFY(pack.readPayload(relocated, payload));
+    QCOMPARE(payload, makePayload('l', 300));
+
+    // nothing to move from the removed segment anymore
+    PackLocation failed;
+    QVERIFY(!pack.relocate(dead, failed));
+
+    pack.finalize();
+}
+
+void ThumbnailPackTests::activeSegmentIsNotRemovedTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    ThumbnailPack pack;
+    QVERIFY(pack.initialize(packDir.path()));
+
+    PackLocation location;
+    QVERIFY(pack.append(makePayload('g', 100), location));
+
+    QVERIFY(!pack.removeSegment(pack.getActiveSegmentID()));
+
+    QByteArray payload;
+    QVERIFY(pack.readPayload(location, payload));
+    QCOMPARE(payload, makePayload('g', 100));
+
+    pack.finalize();
+}
+
+void ThumbnailPackTests::failedSegmentRemovalIsRetriedTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    ThumbnailPack pack(SMALL_SEGMENT_SIZE);
+    QVERIFY(pack.initialize(packDir.path()));
+
+    PackLocation location;
+    do {
+        QVERIFY(pack.append(makePayload('r', 300), location));
+    } while (location.m_SegmentID == 0);
+
+    const QString segmentPath = QDir(packDir.path()).filePath(QLatin1String("segment_000000.xpt"));
+    QVERIFY(QFile::exists(segmentPath));
+
+    // directory with the same name cannot be removed as a file
+    QVERIFY(QFile::remove(segmentPath));
+    QVERIFY(QDir().mkpath(segmentPath + QLatin1String("/blocker")));
+
+    QVERIFY(!pack.removeSegment(0));
+    QCOMPARE(pack.getSegmentSize(0), (qint64)0);
+    QCOMPARE(pack.getPendingRemovalsCount(), 1);
+
+    QCOMPARE(pack.retryPendingRemovals(), 0);
+    QCOMPARE(pack.getPendingRemovalsCount(), 1);
+
+    QVERIFY(QDir(segmentPath).removeRecursively());
+    QFile segmentFile(segmentPath);
+    QVERIFY(segmentFile.open(QIODevice::WriteOnly));
+    segmentFile.close();
+
+    QCOMPARE(pack.retryPendingRemovals(), 1);
+    QCOMPARE(pack.getPendingRemovalsCount(), 0);
+    QVERIFY(!QFile::exists(segmentPath));
+
+    pack.finalize();
+}
+
+void ThumbnailPackTests::totalSizeCountsAllSegmentsTest() {
+    QTemporaryDir packDir;
+    QVERIFY(packDir.isValid());
+
+    ThumbnailPack pack(SMALL_SEGMENT_SIZE);
+    QVERIFY(pack.initialize(packDir.path()));
+    QCOMPARE(pack.getTotalSize(), (qint64)0);
+
+    PackLocation location;
+    qint64 appendedBytes = 0;
+    do {
+        QVERIFY(pack.append(makePayload('t', 300), location));
+        appendedBytes += ThumbnailPack::getRecordSize(location);
+    } while (location.m_SegmentID == 0);
+
+    // overwritten records take space until the segment is removed
+    QCOMPARE(pack.getTotalSize(), appendedBytes);
+
+    const qint64 firstSegmentSize = pack.getSegmentSize(0);
+    QVERIFY(pack.removeSegment(0));
+    QCOMPARE(pack.getTotalSize(), appendedBytes - firstSegmentSize);
+
+    pack.finalize();
+}
@@ -0,0 +1,21 @@
+#ifndef THUMBNAILPACK_TESTS_H
+#define THUMBNAILPACK_TESTS_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class ThumbnailPackTests : public QObject
+{
+    Q_OBJECT
+private slots:
+    void appendedPayloadIsReadBackTest();
+    void recordsSurviveReopeningTest();
+    void fullSegmentIsRolledOverTest();
+    void corruptedLocationIsRejectedTest();
+    void relocatedRecordsSurviveSegmentRemovalTest();
+    void activeSegmentIsNotRemovedTest();
+    void failedSegmentRemovalIsRetriedTest();
+    void totalSizeCountsAllSegmentsTest();
+};
+
+#endif // THUMBNAILPACK_TESTS_H
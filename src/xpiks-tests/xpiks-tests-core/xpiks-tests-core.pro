@@ -176,19 +176,41 @@ SOURCES += main.cpp \
     ../../xpiks-qt/Models/sessionmanager.cpp \
     ../../xpiks-qt/Warnings/warningsmodel.cpp \
     ../../xpiks-qt/QMLExtensions/tabsmodel.cpp \
+    ../../xpiks-qt/QMLExtensions/cacheeviction.cpp \
+    ../../xpiks-qt/QMLExtensions/thumbnailpack.cpp \
+    ../../xpiks-qt/QMLExtensions/decodedimagecache.cpp \
+    ../../xpiks-qt/Helpers/imagehelpers.cpp \
+    ../../xpiks-qt/QMLExtensions/cachedimage.cpp \
     ../../xpiks-qt/Helpers/asynccoordinator.cpp \
     ../../xpiks-qt/Models/videoartwork.cpp \
     ../../xpiks-qt/Helpers/artworkshelpers.cpp \
     ../../xpiks-qt/Models/keyvaluelist.cpp \
     ../../xpiks-qt/MetadataIO/cachedartwork.cpp \
+    ../../xpiks-qt/MetadataIO/cachedartworkrecord.cpp \
     ../../xpiks-qt/Maintenance/logscleanupjobitem.cpp \
     ../../xpiks-qt/MetadataIO/artworkssnapshot.cpp \
     ../../xpiks-qt/Helpers/threadhelpers.cpp \
+    ../../xpiks-qt/Helpers/jsonobjectstream.cpp \
+    ../../xpiks-qt/Helpers/exiftoolframing.cpp \
+    ../../xpiks-qt/Helpers/exiftoolwriting.cpp \
+    ../../xpiks-qt/Helpers/loadmonitor.cpp \
+    ../../xpiks-qt/Helpers/queuetelemetry.cpp \
     ../../xpiks-qt/AutoComplete/autocompletemodel.cpp \
     ../../xpiks-qt/AutoComplete/keywordsautocompletemodel.cpp \
     ../../xpiks-qt/SpellCheck/duplicatesreviewmodel.cpp \
     deleteoldlogs_tests.cpp \
     jsonmerge_tests.cpp \
+    itemprocessingworker_tests.cpp \
+    cachedartworkrecord_tests.cpp \
+    cacheeviction_tests.cpp \
+    jsonobjectstream_tests.cpp \
+    exiftoolframing_tests.cpp \
+    exiftoolwriting_tests.cpp \
+    thumbnailpack_tests.cpp \
+    decodedimagecache_tests.cpp \
+    loadmonitor_tests.cpp \
+    imagehelpers_tests.cpp \
+    cachedimage_tests.cpp \
     ../../xpiks-qt/KeywordsPresets/presetkeywordsmodelconfig.cpp \
     ../../xpiks-qt/Common/statefulentity.cpp \
     ../../xpiks-qt/KeywordsPresets/presetgroupsmodel.cpp \
@@ -311,20 +333,42 @@ HEADERS += \
     ../../xpiks-qt/Warnings/warningsmodel.h \
     ../../xpiks-qt/KeywordsPresets/ipresetsmanager.h \
     ../../xpiks-qt/QMLExtensions/tabsmodel.h \
+    ../../xpiks-qt/QMLExtensions/cacheeviction.h \
+    ../../xpiks-qt/QMLExtensions/thumbnailpack.h \
+    ../../xpiks-qt/QMLExtensions/decodedimagecache.h \
+    ../../xpiks-qt/Helpers/imagehelpers.h \
+    ../../xpiks-qt/QMLExtensions/cachedimage.h \
     ../../xpiks-qt/Models/videoartwork.h \
     ../../xpiks-qt/Helpers/asynccoordinator.h \
     ../../xpiks-qt/Helpers/artworkshelpers.h \
     ../../xpiks-qt/Models/keyvaluelist.h \
     ../../xpiks-qt/MetadataIO/cachedartwork.h \
+    ../../xpiks-qt/MetadataIO/cachedartworkrecord.h \
     ../../xpiks-qt/Maintenance/imaintenanceitem.h \
     ../../xpiks-qt/Maintenance/logscleanupjobitem.h \
     ../../xpiks-qt/Helpers/threadhelpers.h \
+    ../../xpiks-qt/Helpers/jsonobjectstream.h \
+    ../../xpiks-qt/Helpers/exiftoolframing.h \
+    ../../xpiks-qt/Helpers/exiftoolwriting.h \
+    ../../xpiks-qt/Helpers/loadmonitor.h \
+    ../../xpiks-qt/Helpers/queuetelemetry.h \
     ../../xpiks-qt/AutoComplete/autocompletemodel.h \
     ../../xpiks-qt/AutoComplete/keywordsautocompletemodel.h \
     ../../xpiks-qt/Common/keyword.h \
     ../../xpiks-qt/SpellCheck/duplicatesreviewmodel.h \
     deleteoldlogs_tests.h \
     jsonmerge_tests.h \
+    itemprocessingworker_tests.h \
+    cachedartworkrecord_tests.h \
+    cacheeviction_tests.h \
+    jsonobjectstream_tests.h \
+    exiftoolframing_tests.h \
+    exiftoolwriting_tests.h \
+    thumbnailpack_tests.h \
+    decodedimagecache_tests.h \
+    loadmonitor_tests.h \
+    imagehelpers_tests.h \
+    cachedimage_tests.h \
     ../../xpiks-qt/KeywordsPresets/presetkeywordsmodelconfig.h \
     ../../xpiks-qt/Common/statefulentity.h \
     ../../xpiks-qt/Common/delayedactionentity.h \
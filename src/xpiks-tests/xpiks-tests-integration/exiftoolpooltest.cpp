@@ -0,0 +1,57 @@
+#include "exiftoolpooltest.h"
+#include <memory>
+#include <vector>
+#include <QStringList>
+#include "integrationtestbase.h"
+#include "../../xpiks-qt/Commands/commandmanager.h"
+#include "../../xpiks-qt/Models/settingsmodel.h"
+#include "../../libxpks_stub/MetadataIO/exiftoolprocesspool.h"
+
+#define EXIFTOOL_TEST_TIMEOUT 10000
+
+QString ExiftoolPoolTest::testName() {
+    return QLatin1String("ExiftoolPoolTest");
+}
+
+void ExiftoolPoolTest::setup() {
+}
+
+int ExiftoolPoolTest::doTest() {
+    using namespace libxpks::io;
+
+    const QString exiftoolPath = m_CommandManager->getSettingsModel()->getExifToolPath();
+    ExiftoolProcessPool &pool = ExiftoolProcessPool::getInstance();
+
+    // more commands than processes so some of them are queued
+    std::vector<std::shared_ptr<ExiftoolCommand> > commands;
+    const int commandsCount = 3 * ExiftoolProcessPool::getOptimalSize();
+    for (int i = 0; i < commandsCount; ++i) {
+        std::shared_ptr<ExiftoolCommand> command(new ExiftoolCommand(QStringList() << "-ver", EXIFTOOL_TEST_TIMEOUT));
+        VERIFY(pool.submit(exiftoolPath, command), "Failed to submit a command");
+        commands.push_back(command);
+    }
+
+    for (auto &command: commands) {
+        command->m_Done.acquire();
+        VERIFY(command->m_Success, "Command failed");
+        VERIFY(!command->m_Output.trimmed().isEmpty(), "Version was not printed");
+    }
+
+    const QString imagePath = getFilePathForTest("images-for-tests/pixmap/seagull.jpg").toLocalFile();
+
+    // second line would be taken as a separate argument
+    std::shared_ptr<ExiftoolCommand> brokenCommand(new ExiftoolCommand(
+                                                       QStringList() << "-ver" << (imagePath + "\n-execute"),
+                                                       EXIFTOOL_TEST_TIMEOUT));
+    VERIFY(!pool.execute(exiftoolPath, brokenCommand), "Command with newline in path succeeded");
+    VERIFY(!brokenCommand->m_Errors.isEmpty(), "Rejected command has no errors");
+
+    for (int i = 0; i < commandsCount; ++i) {
+        std::shared_ptr<ExiftoolCommand> command(new ExiftoolCommand(QStringList() << "-json" << imagePath, EXIFTOOL_TEST_TIMEOUT));
+        VERIFY(pool.execute(exiftoolPath, command), "Command failed after a rejected one");
+        VERIFY(command->m_Output.contains("SourceFile"), "Output of the command is not complete");
+        VERIFY(!command->m_Output.contains("{ready"), "Output contains the ready marker");
+    }
+
+    return 0;
+}
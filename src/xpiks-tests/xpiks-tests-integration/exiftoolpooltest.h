@@ -0,0 +1,20 @@
+#ifndef EXIFTOOLPOOLTEST_H
+#define EXIFTOOLPOOLTEST_H
+
+#include "integrationtestbase.h"
+
+class ExiftoolPoolTest : public IntegrationTestBase
+{
+public:
+    ExiftoolPoolTest(Commands::CommandManager *commandManager):
+        IntegrationTestBase(commandManager)
+    {}
+
+    // IntegrationTestBase interface
+public:
+    virtual QString testName();
+    virtual void setup();
+    virtual int doTest();
+};
+
+#endif // EXIFTOOLPOOLTEST_H
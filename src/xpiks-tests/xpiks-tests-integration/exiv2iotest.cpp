@@ -0,0 +1,100 @@
+#include "exiv2iotest.h"
+#include <QUrl>
+#include <QStringList>
+#include "integrationtestbase.h"
+#include "signalwaiter.h"
+#include "../../xpiks-qt/Commands/commandmanager.h"
+#include "../../xpiks-qt/Models/artitemsmodel.h"
+#include "../../xpiks-qt/MetadataIO/metadataiocoordinator.h"
+#include "../../xpiks-qt/Models/artworkmetadata.h"
+#include "../../xpiks-qt/Models/settingsmodel.h"
+#include "../../xpiks-qt/Models/filteredartitemsproxymodel.h"
+#include "../../libxpks_stub/MetadataIO/exiv2iohelpers.h"
+
+#define IPTC_KEYWORD_MAX_BYTES 64
+
+QString Exiv2IOTest::testName() {
+    return QLatin1String("Exiv2IOTest");
+}
+
+void Exiv2IOTest::setup() {
+    Models::SettingsModel *settingsModel = m_CommandManager->getSettingsModel();
+    settingsModel->setUseExiv2(true);
+}
+
+void Exiv2IOTest::teardown() {
+    IntegrationTestBase::teardown();
+
+    Models::SettingsModel *settingsModel = m_CommandManager->getSettingsModel();
+    settingsModel->setUseExiv2(true);
+}
+
+int Exiv2IOTest::doTest() {
+    Models::ArtItemsModel *artItemsModel = m_CommandManager->getArtItemsModel();
+    Models::SettingsModel *settingsModel = m_CommandManager->getSettingsModel();
+    QList<QUrl> files;
+    files << getFilePathForTest("images-for-tests/pixmap/seagull.jpg");
+
+    VERIFY(libxpks::io::isExiv2SupportedFile(files[0].toLocalFile()), "Jpeg is not handled by exiv2");
+
+    MetadataIO::MetadataIOCoordinator *ioCoordinator = m_CommandManager->getMetadataIOCoordinator();
+    SignalWaiter waiter;
+    QObject::connect(ioCoordinator, SIGNAL(metadataReadingFinished()), &waiter, SIGNAL(finished()));
+    QObject::connect(ioCoordinator, SIGNAL(metadataWritingFinished()), &waiter, SIGNAL(finished()));
+
+    int addedCount = artItemsModel->addLocalArtworks(files);
+    VERIFY(addedCount == files.length(), "Failed to add file");
+    ioCoordinator->continueReading(true);
+
+    VERIFY(waiter.wait(20), "Timeout exceeded for reading metadata.");
+    VERIFY(!ioCoordinator->getHasErrors(), "Errors in IO Coordinator while reading");
+
+    // 3 bytes per character in UTF-8
+    const QString longKeyword = QString::fromUtf8("\xe5\x9f\x83\xe8\x8f\xb2\xe5\xb0\x94\xe9\x93\x81\xe5\xa1\x94").repeated(5);
+    const QString expectedIptcKeyword = longKeyword.left(IPTC_KEYWORD_MAX_BYTES / 3);
+    QStringList keywords; keywords << "seagull" << longKeyword;
+
+    Models::ArtworkMetadata *artwork = artItemsModel->getArtwork(0);
+    artwork->setTitle("Exiv2 title");
+    artwork->setDescription("Exiv2 description");
+    artwork->setKeywords(keywords);
+    artwork->setIsSelected(true);
+
+    bool doOverwrite = true, dontSaveBackups = false;
+    auto *filteredModel = m_CommandManager->getFilteredArtItemsModel();
+    filteredModel->saveSelectedArtworks(doOverwrite, dontSaveBackups);
+
+    VERIFY(waiter.wait(20), "Timeout exceeded for writing metadata.");
+    VERIFY(!ioCoordinator->getHasErrors(), "Errors in IO Coordinator while writing");
+
+    libxpks::io::Exiv2BasicMetadata xmpMetadata, exifMetadata, iptcMetadata;
+    VERIFY(libxpks::io::readStandardsWithExiv2(artwork->getFilepath(), xmpMetadata, exifMetadata, iptcMetadata),
+           "Failed to read metadata with exiv2");
+
+    VERIFY(xmpMetadata.m_Title == QLatin1String("Exiv2 title"), "XMP title does not match");
+    VERIFY(exifMetadata.m_Description == QLatin1String("Exiv2 description"), "Exif description does not match");
+    VERIFY(iptcMetadata.m_Description == QLatin1String("Exiv2 description"), "IPTC description does not match");
+    VERIFY(xmpMetadata.m_Keywords == keywords, "XMP keywords should not be truncated");
+    VERIFY(iptcMetadata.m_Keywords == (QStringList() << "seagull" << expectedIptcKeyword),
+           "IPTC keyword was not truncated on the character boundary");
+
+    // same file is written by exiftool when exiv2 is turned off
+    settingsModel->setUseExiv2(false);
+
+    artwork->setTitle("Exiftool title");
+    artwork->setIsSelected(true);
+    filteredModel->saveSelectedArtworks(doOverwrite, dontSaveBackups);
+
+    VERIFY(waiter.wait(20), "Timeout exceeded for writing metadata.");
+    VERIFY(!ioCoordinator->getHasErrors(), "Errors in IO Coordinator while writing");
+
+    libxpks::io::Exiv2BasicMetadata xmpMetadata2, exifMetadata2, iptcMetadata2;
+    VERIFY(libxpks::io::readStandardsWithExiv2(artwork->getFilepath(), xmpMetadata2, exifMetadata2, iptcMetadata2),
+           "Failed to read metadata with exiv2");
+
+    VERIFY(xmpMetadata2.m_Title == QLatin1String("Exiftool title"), "Title was not written with exiftool");
+    VERIFY(iptcMetadata2.m_Keywords == iptcMetadata.m_Keywords, "IPTC keywords differ between exiv2 and exiftool");
+    VERIFY(xmpMetadata2.m_Keywords == keywords, "XMP keywords differ between exiv2 and exiftool");
+
+    return 0;
+}
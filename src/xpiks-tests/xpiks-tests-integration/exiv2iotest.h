@@ -0,0 +1,21 @@
+#ifndef EXIV2IOTEST_H
+#define EXIV2IOTEST_H
+
+#include "integrationtestbase.h"
+
+class Exiv2IOTest : public IntegrationTestBase
+{
+public:
+    Exiv2IOTest(Commands::CommandManager *commandManager):
+        IntegrationTestBase(commandManager)
+    {}
+
+    // IntegrationTestBase interface
+public:
+    virtual QString testName();
+    virtual void setup();
+    virtual int doTest();
+    virtual void teardown();
+};
+
+#endif // EXIV2IOTEST_H
@@ -65,7 +65,7 @@
 #include "../../xpiks-qt/Models/switchermodel.h"
 #include "../../xpiks-qt/Helpers/filehelpers.h"
 
-#include "exiv2iohelpers.h"
+#include "../../libxpks_stub/MetadataIO/exiv2iohelpers.h"
 
 #ifdef Q_OS_WIN
 #include "windowscrashhandler.h"
@@ -121,6 +121,8 @@
 #include "reimporttest.h"
 #include "autoimporttest.h"
 #include "importlostmetadatatest.h"
+#include "exiftoolpooltest.h"
+#include "exiv2iotest.h"
 
 #if defined(WITH_PLUGINS)
 #undef WITH_PLUGINS
@@ -203,8 +205,7 @@ int main(int argc, char *argv[]) {
     Connectivity::CurlInitHelper curlInitHelper;
     Q_UNUSED(curlInitHelper);
 
-    Exiv2InitHelper exiv2InitHelper;
-    Q_UNUSED(exiv2InitHelper);
+    libxpks::io::initializeExiv2();
 
     QCoreApplication app(argc, argv);
 
@@ -412,6 +413,8 @@ int main(int argc, char *argv[]) {
     integrationTests.append(new ReimportTest(&commandManager));
     integrationTests.append(new AutoImportTest(&commandManager));
     integrationTests.append(new ImportLostMetadataTest(&commandManager));
+    integrationTests.append(new ExiftoolPoolTest(&commandManager));
+    integrationTests.append(new Exiv2IOTest(&commandManager));
     // always the last one. insert new tests above
     integrationTests.append(new LocalLibrarySearchTest(&commandManager));
 
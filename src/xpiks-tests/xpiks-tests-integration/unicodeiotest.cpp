@@ -11,7 +11,8 @@
 #include "../../xpiks-qt/Models/settingsmodel.h"
 #include "../../xpiks-qt/Models/filteredartitemsproxymodel.h"
 #include "../../xpiks-qt/Models/imageartwork.h"
-#include "exiv2iohelpers.h"
+#include "../../xpiks-qt/MetadataIO/originalmetadata.h"
+#include "../../libxpks_stub/MetadataIO/exiv2iohelpers.h"
 
 QString UnicodeIoTest::testName() {
     return QLatin1String("UnicodeIoTest");
@@ -41,8 +42,8 @@ int UnicodeIoTest::doTest() {
 
     Models::ArtworkMetadata *artwork = artItemsModel->getArtwork(0);
 
-    BasicMetadata basicMetadata;
-    ::readMetadata(artwork->getFilepath(), basicMetadata);
+    MetadataIO::OriginalMetadata basicMetadata;
+    VERIFY(libxpks::io::readMetadataWithExiv2(artwork->getFilepath(), basicMetadata), "Failed to read metadata with exiv2");
 
     VERIFY(basicMetadata.m_Description == artwork->getDescription(), "Description does not match for reading");
     VERIFY(basicMetadata.m_Title == artwork->getTitle(), "Title does not match for reading")
@@ -83,8 +84,9 @@ int UnicodeIoTest::doTest() {
 
     VERIFY(!ioCoordinator->getHasErrors(), "Errors in IO Coordinator while writing");
 
-    BasicMetadata exifMetadata, iptcMetadata, xmpMetadata;
-    ::readMetadataEx(artwork->getFilepath(), xmpMetadata, exifMetadata, iptcMetadata);
+    libxpks::io::Exiv2BasicMetadata exifMetadata, iptcMetadata, xmpMetadata;
+    VERIFY(libxpks::io::readStandardsWithExiv2(artwork->getFilepath(), xmpMetadata, exifMetadata, iptcMetadata),
+           "Failed to read metadata with exiv2");
 
     VERIFY(exifMetadata.m_Description == description8u, "Exif description does not match");
 
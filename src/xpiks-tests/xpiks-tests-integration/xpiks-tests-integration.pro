@@ -19,6 +19,7 @@ DEFINES += QT_NO_CAST_TO_ASCII \
            QT_NO_CAST_FROM_BYTEARRAY
 
 DEFINES += HUNSPELL_STATIC
+DEFINES += SQLITE_ENABLE_FTS5
 DEFINES += TELEMETRY_ENABLED
 DEFINES += WITH_STDOUT_LOGS
 DEFINES += WITH_LOGS
@@ -48,6 +49,7 @@ SOURCES += main.cpp \
     ../../xpiks-qt/Encryption/aes-qt.cpp \
     ../../xpiks-qt/Encryption/secretsmanager.cpp \
     ../../xpiks-qt/Helpers/filehelpers.cpp \
+    ../../xpiks-qt/Helpers/imagehelpers.cpp \
     ../../xpiks-qt/Helpers/filterhelpers.cpp \
     ../../xpiks-qt/Helpers/globalimageprovider.cpp \
     ../../xpiks-qt/Helpers/helpersqmlwrapper.cpp \
@@ -190,9 +192,16 @@ SOURCES += main.cpp \
     ../../xpiks-qt/QMLExtensions/cachedimage.cpp \
     ../../xpiks-qt/QMLExtensions/cachedvideo.cpp \
     ../../xpiks-qt/Maintenance/moveimagecachejobitem.cpp \
+    ../../xpiks-qt/Maintenance/compactimagecachejobitem.cpp \
+    ../../xpiks-qt/Maintenance/evictthumbnailsjobitem.cpp \
+    ../../xpiks-qt/Maintenance/compactmetadatacachejobitem.cpp \
     ../../xpiks-qt/QMLExtensions/dbimagecacheindex.cpp \
+    ../../xpiks-qt/QMLExtensions/thumbnailpack.cpp \
+    ../../xpiks-qt/QMLExtensions/decodedimagecache.cpp \
+    ../../xpiks-qt/QMLExtensions/cacheeviction.cpp \
     ../../xpiks-qt/QMLExtensions/dbvideocacheindex.cpp \
     ../../xpiks-qt/MetadataIO/cachedartwork.cpp \
+    ../../xpiks-qt/MetadataIO/cachedartworkrecord.cpp \
     ../../xpiks-qt/MetadataIO/artworkssnapshot.cpp \
     ../../xpiks-qt/MetadataIO/metadatacache.cpp \
     savefilelegacytest.cpp \
@@ -213,9 +222,13 @@ SOURCES += main.cpp \
     ../../xpiks-qt/MetadataIO/csvexportproperties.cpp \
     ../../xpiks-qt/MetadataIO/csvexportworker.cpp \
     csvexporttest.cpp \
-    exiv2iohelpers.cpp \
     unicodeiotest.cpp \
     ../../xpiks-qt/Helpers/threadhelpers.cpp \
+    ../../xpiks-qt/Helpers/jsonobjectstream.cpp \
+    ../../xpiks-qt/Helpers/exiftoolframing.cpp \
+    ../../xpiks-qt/Helpers/exiftoolwriting.cpp \
+    ../../xpiks-qt/Helpers/loadmonitor.cpp \
+    ../../xpiks-qt/Helpers/queuetelemetry.cpp \
     faileduploadstest.cpp \
     undoadddirectorytest.cpp \
     ../../xpiks-qt/KeywordsPresets/presetgroupsmodel.cpp \
@@ -228,7 +241,9 @@ SOURCES += main.cpp \
     ../../xpiks-qt/Maintenance/xpkscleanupjob.cpp \
     ../../xpiks-qt/Common/baseentity.cpp \
     ../../xpiks-qt/Commands/maindelegator.cpp \
-    importlostmetadatatest.cpp
+    importlostmetadatatest.cpp \
+    exiftoolpooltest.cpp \
+    exiv2iotest.cpp
 
 RESOURCES +=
 
@@ -276,6 +291,7 @@ HEADERS += \
     ../../xpiks-qt/Helpers/clipboardhelper.h \
     ../../xpiks-qt/Helpers/constants.h \
     ../../xpiks-qt/Helpers/filehelpers.h \
+    ../../xpiks-qt/Helpers/imagehelpers.h \
     ../../xpiks-qt/Helpers/filterhelpers.h \
     ../../xpiks-qt/Helpers/globalimageprovider.h \
     ../../xpiks-qt/Helpers/helpersqmlwrapper.h \
@@ -448,10 +464,17 @@ HEADERS += \
     ../../xpiks-qt/QMLExtensions/cachedvideo.h \
     ../../xpiks-qt/QMLExtensions/previewstorage.h \
     ../../xpiks-qt/Maintenance/moveimagecachejobitem.h \
+    ../../xpiks-qt/Maintenance/compactimagecachejobitem.h \
+    ../../xpiks-qt/Maintenance/evictthumbnailsjobitem.h \
+    ../../xpiks-qt/Maintenance/compactmetadatacachejobitem.h \
     ../../xpiks-qt/QMLExtensions/dbcacheindex.h \
     ../../xpiks-qt/QMLExtensions/dbimagecacheindex.h \
+    ../../xpiks-qt/QMLExtensions/thumbnailpack.h \
+    ../../xpiks-qt/QMLExtensions/decodedimagecache.h \
+    ../../xpiks-qt/QMLExtensions/cacheeviction.h \
     ../../xpiks-qt/QMLExtensions/dbvideocacheindex.h \
     ../../xpiks-qt/MetadataIO/cachedartwork.h \
+    ../../xpiks-qt/MetadataIO/cachedartworkrecord.h \
     ../../xpiks-qt/MetadataIO/metadatacache.h \
     ../../xpiks-qt/Suggestion/locallibraryquery.h \
     ../../xpiks-qt/Suggestion/searchquery.h \
@@ -477,10 +500,14 @@ HEADERS += \
     ../../xpiks-qt/MetadataIO/csvexportworker.h \
     csvexporttest.h \
     ../../../vendors/csv/csv.h \
-    exiv2iohelpers.h \
     unicodeiotest.h \
     ../../xpiks-qt/Common/delayedactionentity.h \
     ../../xpiks-qt/Helpers/threadhelpers.h \
+    ../../xpiks-qt/Helpers/jsonobjectstream.h \
+    ../../xpiks-qt/Helpers/exiftoolframing.h \
+    ../../xpiks-qt/Helpers/exiftoolwriting.h \
+    ../../xpiks-qt/Helpers/loadmonitor.h \
+    ../../xpiks-qt/Helpers/queuetelemetry.h \
     faileduploadstest.h \
     ../../xpiks-qt/KeywordsPresets/presetgroupsmodel.h \
     undoadddirectorytest.h \
@@ -494,7 +521,9 @@ HEADERS += \
     ../../xpiks-qt/Commands/maindelegator.h \
     ../../xpiks-qt/KeywordsPresets/groupmodel.h \
     ../../xpiks-qt/KeywordsPresets/presetmodel.h \
-    importlostmetadatatest.h
+    importlostmetadatatest.h \
+    exiftoolpooltest.h \
+    exiv2iotest.h
 
 INCLUDEPATH += ../../../vendors/tiny-aes
 INCLUDEPATH += ../../../vendors/cpp-libface
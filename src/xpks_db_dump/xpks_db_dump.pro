@@ -4,6 +4,7 @@ CONFIG += c++11 console
 CONFIG -= app_bundle
 
 DEFINES += DEBUG_UTILITY
+DEFINES += SQLITE_ENABLE_FTS5
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked deprecated (the exact warnings
@@ -21,6 +22,7 @@ INCLUDEPATH += ../../vendors/libthmbnlr
 SOURCES += main.cpp \
     ../xpiks-qt/Helpers/database.cpp \
     ../xpiks-qt/MetadataIO/cachedartwork.cpp \
+    ../xpiks-qt/MetadataIO/cachedartworkrecord.cpp \
     ../xpiks-qt/MetadataIO/metadatacache.cpp \
     ../xpiks-qt/Common/baseentity.cpp \
     ../xpiks-qt/Common/basickeywordsmodel.cpp \
@@ -43,6 +45,7 @@ SOURCES += main.cpp \
 HEADERS += \
     ../xpiks-qt/Helpers/database.h \
     ../xpiks-qt/MetadataIO/cachedartwork.h \
+    ../xpiks-qt/MetadataIO/cachedartworkrecord.h \
     ../xpiks-qt/MetadataIO/metadatacache.h \
     ../xpiks-qt/MetadataIO/originalmetadata.h \
     ../xpiks-qt/Common/abstractlistmodel.h \